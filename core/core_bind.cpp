@@ -86,6 +86,30 @@ RES _ResourceLoader::load_threaded_get(const String &p_path) {
 	return res;
 }
 
+Error _ResourceLoader::load_threaded_cancel(const String &p_path) {
+	return ResourceLoader::load_threaded_cancel(p_path);
+}
+
+Array _ResourceLoader::get_load_timings() {
+	List<ResourceLoader::LoadTiming> timings;
+	ResourceLoader::get_load_timings(&timings);
+
+	Array ret;
+	for (List<ResourceLoader::LoadTiming>::Element *E = timings.front(); E; E = E->next()) {
+		const ResourceLoader::LoadTiming &timing = E->get();
+		Dictionary d;
+		d["path"] = timing.path;
+		d["dependencies"] = timing.dependencies;
+		d["thread"] = (int64_t)timing.thread;
+		d["requested_usec"] = timing.requested_usec;
+		d["started_usec"] = timing.started_usec;
+		d["finished_usec"] = timing.finished_usec;
+		d["error"] = timing.error;
+		ret.push_back(d);
+	}
+	return ret;
+}
+
 RES _ResourceLoader::load(const String &p_path, const String &p_type_hint, CacheMode p_cache_mode) {
 	Error err = OK;
 	RES ret = ResourceLoader::load(p_path, p_type_hint, ResourceFormatLoader::CacheMode(p_cache_mode), &err);
@@ -134,6 +158,8 @@ void _ResourceLoader::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("load_threaded_request", "path", "type_hint", "use_sub_threads"), &_ResourceLoader::load_threaded_request, DEFVAL(""), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("load_threaded_get_status", "path", "progress"), &_ResourceLoader::load_threaded_get_status, DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("load_threaded_get", "path"), &_ResourceLoader::load_threaded_get);
+	ClassDB::bind_method(D_METHOD("load_threaded_cancel", "path"), &_ResourceLoader::load_threaded_cancel);
+	ClassDB::bind_method(D_METHOD("get_load_timings"), &_ResourceLoader::get_load_timings);
 
 	ClassDB::bind_method(D_METHOD("load", "path", "type_hint", "cache_mode"), &_ResourceLoader::load, DEFVAL(""), DEFVAL(CACHE_MODE_REUSE));
 	ClassDB::bind_method(D_METHOD("get_recognized_extensions_for_type", "type"), &_ResourceLoader::get_recognized_extensions_for_type);
@@ -183,6 +209,7 @@ void _ResourceSaver::_bind_methods() {
 	BIND_ENUM_CONSTANT(FLAG_SAVE_BIG_ENDIAN);
 	BIND_ENUM_CONSTANT(FLAG_COMPRESS);
 	BIND_ENUM_CONSTANT(FLAG_REPLACE_SUBRESOURCE_PATHS);
+	BIND_ENUM_CONSTANT(FLAG_COMPRESS_SECTIONS);
 }
 
 ////// _OS //////
@@ -30,6 +30,7 @@
 
 #include "file_access_pack.h"
 
+#include "core/crypto/crypto_core.h"
 #include "core/io/file_access_encrypted.h"
 #include "core/object/script_language.h"
 #include "core/version.h"
@@ -46,10 +47,61 @@ Error PackedData::add_pack(const String &p_path, bool p_replace_files, uint64_t
 	return ERR_FILE_UNRECOGNIZED;
 }
 
+PackedData::PathMD5::PathMD5(const String &p_path) {
+	CharString cs = p_path.utf8();
+	uint8_t hash[16];
+	CryptoCore::md5((const uint8_t *)cs.get_data(), cs.length(), hash);
+	memcpy(&a, &hash[0], 8);
+	memcpy(&b, &hash[8], 8);
+}
+
+void PackedData::_resize_file_slots(uint32_t p_size) {
+	LocalVector<FileSlot> old_slots = file_slots;
+	file_slots.clear();
+	file_slots.resize(p_size);
+
+	const uint32_t mask = p_size - 1;
+	for (uint32_t i = 0; i < old_slots.size(); i++) {
+		if (old_slots[i].index == EMPTY_FILE_SLOT) {
+			continue;
+		}
+		uint32_t pos = uint32_t(old_slots[i].md5.a) & mask;
+		while (file_slots[pos].index != EMPTY_FILE_SLOT) {
+			pos = (pos + 1) & mask;
+		}
+		file_slots[pos] = old_slots[i];
+	}
+}
+
+void PackedData::reserve_files(uint32_t p_count) {
+	const uint32_t needed = (file_list.size() + p_count) * 2;
+	if (needed <= file_slots.size()) {
+		return;
+	}
+	file_list.reserve(file_list.size() + p_count);
+	_resize_file_slots(next_power_of_2(needed));
+}
+
+void PackedData::_insert_file(const PathMD5 &p_md5, const PackedFile &p_file) {
+	if ((file_list.size() + 1) * 2 > file_slots.size()) {
+		_resize_file_slots(MAX(64u, file_slots.size() * 2));
+	}
+
+	const uint32_t mask = file_slots.size() - 1;
+	uint32_t pos = uint32_t(p_md5.a) & mask;
+	while (file_slots[pos].index != EMPTY_FILE_SLOT) {
+		pos = (pos + 1) & mask;
+	}
+	file_slots[pos].md5 = p_md5;
+	file_slots[pos].index = file_list.size();
+	file_list.push_back(p_file);
+}
+
 void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted) {
-	PathMD5 pmd5(p_path.md5_buffer());
+	PathMD5 pmd5(p_path);
 
-	bool exists = files.has(pmd5);
+	PackedFile *existing = _find_file(pmd5);
+	bool exists = existing != nullptr;
 
 	PackedFile pf;
 	pf.encrypted = p_encrypted;
@@ -61,8 +113,10 @@ void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64
 	}
 	pf.src = p_src;
 
-	if (!exists || p_replace_files) {
-		files[pmd5] = pf;
+	if (!exists) {
+		_insert_file(pmd5, pf);
+	} else if (p_replace_files) {
+		*existing = pf;
 	}
 
 	if (!exists) {
@@ -192,6 +246,10 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 	}
 
 	int file_count = f->get_32();
+	if (file_count > 0 && (uint64_t)file_count * 40 <= f->get_len()) {
+		// Each entry takes 40 bytes or more, don't trust counts which can't fit.
+		PackedData::get_singleton()->reserve_files(file_count);
+	}
 
 	if (enc_directory) {
 		FileAccessEncrypted *fae = memnew(FileAccessEncrypted);
@@ -238,13 +296,56 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 
 	f->close();
 	memdelete(f);
+
+	_map_pack(p_path);
 	return true;
 }
 
+void PackedSourcePCK::_map_pack(const String &p_path) {
+	if (mappings.has(p_path)) {
+		return;
+	}
+
+	FileAccess *f = FileAccess::open_mapped(p_path);
+	if (!f) {
+		return;
+	}
+
+	// Only keep the pack open if the platform could map it, otherwise files
+	// are read through their own FileAccess as before.
+	uint64_t length = f->get_len();
+	const uint8_t *data = f->get_buffer_view(length);
+	if (!data) {
+		f->close();
+		memdelete(f);
+		return;
+	}
+
+	Mapping mapping;
+	mapping.file = f;
+	mapping.data = data;
+	mapping.length = length;
+	mappings[p_path] = mapping;
+}
+
 FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile *p_file) {
+	if (!p_file->encrypted) {
+		Map<String, Mapping>::Element *E = mappings.find(p_file->pack);
+		// Entries past the end of a truncated pack are left to the regular path, which reads short.
+		if (E && p_file->offset <= E->get().length && p_file->size <= E->get().length - p_file->offset) {
+			return memnew(FileAccessPack(p_path, *p_file, E->get().data + p_file->offset));
+		}
+	}
 	return memnew(FileAccessPack(p_path, *p_file));
 }
 
+PackedSourcePCK::~PackedSourcePCK() {
+	for (Map<String, Mapping>::Element *E = mappings.front(); E; E = E->next()) {
+		E->get().file->close();
+		memdelete(E->get().file);
+	}
+}
+
 //////////////////////////////////////////////////////////////////
 
 Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
@@ -253,11 +354,17 @@ Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
 }
 
 void FileAccessPack::close() {
-	f->close();
+	data = nullptr;
+	if (f) {
+		f->close();
+	}
 }
 
 bool FileAccessPack::is_open() const {
-	return f->is_open();
+	if (data) {
+		return true;
+	}
+	return f && f->is_open();
 }
 
 void FileAccessPack::seek(uint64_t p_position) {
@@ -267,7 +374,9 @@ void FileAccessPack::seek(uint64_t p_position) {
 		eof = false;
 	}
 
-	f->seek(off + p_position);
+	if (f) {
+		f->seek(off + p_position);
+	}
 	pos = p_position;
 }
 
@@ -293,6 +402,10 @@ uint8_t FileAccessPack::get_8() const {
 		return 0;
 	}
 
+	if (data) {
+		return data[pos++];
+	}
+
 	pos++;
 	return f->get_8();
 }
@@ -310,19 +423,37 @@ uint64_t FileAccessPack::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
 		to_read = (int64_t)pf.size - (int64_t)pos;
 	}
 
+	uint64_t from = pos;
 	pos += p_length;
 
 	if (to_read <= 0) {
 		return 0;
 	}
-	f->get_buffer(p_dst, to_read);
+
+	if (data) {
+		memcpy(p_dst, data + from, to_read);
+	} else {
+		to_read = f->get_buffer(p_dst, to_read); // Short when the pack is truncated.
+	}
 
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_buffer_view(uint64_t p_length) const {
+	if (!data || pos > pf.size || p_length > pf.size - pos) {
+		return nullptr;
+	}
+
+	const uint8_t *view = data + pos;
+	pos += p_length;
+	return view;
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
-	f->set_endian_swap(p_swap);
+	if (f) {
+		f->set_endian_swap(p_swap);
+	}
 }
 
 Error FileAccessPack::get_error() const {
@@ -348,13 +479,22 @@ bool FileAccessPack::file_exists(const String &p_name) {
 	return false;
 }
 
-FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file) :
-		pf(p_file),
-		f(FileAccess::open(pf.pack, FileAccess::READ)) {
+FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const uint8_t *p_data) :
+		pf(p_file) {
+	pos = 0;
+	eof = false;
+	off = pf.offset;
+
+	if (p_data) {
+		// Read straight from the pack mapping, no file handle needed.
+		data = p_data;
+		return;
+	}
+
+	f = FileAccess::open(pf.pack, FileAccess::READ);
 	ERR_FAIL_COND_MSG(!f, "Can't open pack-referenced file '" + String(pf.pack) + "'.");
 
 	f->seek(pf.offset);
-	off = pf.offset;
 
 	if (pf.encrypted) {
 		FileAccessEncrypted *fae = memnew(FileAccessEncrypted);
@@ -376,8 +516,6 @@ FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFil
 		f = fae;
 		off = 0;
 	}
-	pos = 0;
-	eof = false;
 }
 
 FileAccessPack::~FileAccessPack() {
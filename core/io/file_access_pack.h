@@ -35,6 +35,7 @@
 #include "core/os/file_access.h"
 #include "core/string/print_string.h"
 #include "core/templates/list.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/map.h"
 #include "core/templates/set.h"
 
@@ -97,9 +98,23 @@ private:
 			a = *((uint64_t *)&p_buf[0]);
 			b = *((uint64_t *)&p_buf[8]);
 		}
+
+		explicit PathMD5(const String &p_path);
 	};
 
-	Map<PathMD5, PackedFile> files;
+	static const uint32_t EMPTY_FILE_SLOT = 0xFFFFFFFF;
+
+	struct FileSlot {
+		PathMD5 md5;
+		uint32_t index = EMPTY_FILE_SLOT;
+	};
+
+	// Files are stored contiguously in file_list, and found through an open
+	// addressing table of their path hashes (linear probing, at most half
+	// full). The MD5 is already uniform, so its low bits pick the slot.
+	// Files are never removed, erased ones just have an offset of zero.
+	LocalVector<PackedFile> file_list;
+	LocalVector<FileSlot> file_slots;
 
 	Vector<PackSource *> sources;
 
@@ -110,8 +125,13 @@ private:
 
 	void _free_packed_dirs(PackedDir *p_dir);
 
+	_FORCE_INLINE_ PackedFile *_find_file(const PathMD5 &p_md5);
+	void _insert_file(const PathMD5 &p_md5, const PackedFile &p_file);
+	void _resize_file_slots(uint32_t p_size);
+
 public:
 	void add_pack_source(PackSource *p_source);
+	void reserve_files(uint32_t p_count); // for PackSource, before adding a pack's files
 	void add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted = false); // for PackSource
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
@@ -138,9 +158,22 @@ public:
 };
 
 class PackedSourcePCK : public PackSource {
+	struct Mapping {
+		FileAccess *file = nullptr;
+		const uint8_t *data = nullptr;
+		uint64_t length = 0;
+	};
+
+	// Packs mapped into memory, shared by every file opened from them.
+	Map<String, Mapping> mappings;
+
+	void _map_pack(const String &p_path);
+
 public:
 	virtual bool try_open_pack(const String &p_path, bool p_replace_files, uint64_t p_offset);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
+
+	virtual ~PackedSourcePCK();
 };
 
 class FileAccessPack : public FileAccess {
@@ -150,7 +183,8 @@ class FileAccessPack : public FileAccess {
 	mutable bool eof;
 	uint64_t off;
 
-	FileAccess *f;
+	FileAccess *f = nullptr;
+	const uint8_t *data = nullptr;
 	virtual Error _open(const String &p_path, int p_mode_flags);
 	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 	virtual uint32_t _get_unix_permissions(const String &p_file) { return 0; }
@@ -170,6 +204,7 @@ public:
 	virtual uint8_t get_8() const;
 
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const;
+	virtual const uint8_t *get_buffer_view(uint64_t p_length) const;
 
 	virtual void set_endian_swap(bool p_swap);
 
@@ -182,25 +217,43 @@ public:
 
 	virtual bool file_exists(const String &p_name);
 
-	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file);
+	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const uint8_t *p_data = nullptr);
 	~FileAccessPack();
 };
 
+PackedData::PackedFile *PackedData::_find_file(const PathMD5 &p_md5) {
+	if (file_slots.is_empty()) {
+		return nullptr;
+	}
+
+	const uint32_t mask = file_slots.size() - 1;
+	uint32_t pos = uint32_t(p_md5.a) & mask;
+	while (true) {
+		const FileSlot &slot = file_slots[pos];
+		if (slot.index == EMPTY_FILE_SLOT) {
+			return nullptr;
+		}
+		if (slot.md5 == p_md5) {
+			return &file_list[slot.index];
+		}
+		pos = (pos + 1) & mask;
+	}
+}
+
 FileAccess *PackedData::try_open_path(const String &p_path) {
-	PathMD5 pmd5(p_path.md5_buffer());
-	Map<PathMD5, PackedFile>::Element *E = files.find(pmd5);
-	if (!E) {
+	PackedFile *pf = _find_file(PathMD5(p_path));
+	if (!pf) {
 		return nullptr; //not found
 	}
-	if (E->get().offset == 0) {
+	if (pf->offset == 0) {
 		return nullptr; //was erased
 	}
 
-	return E->get().src->get_file(p_path, &E->get());
+	return pf->src->get_file(p_path, pf);
 }
 
 bool PackedData::has_path(const String &p_path) {
-	return files.has(PathMD5(p_path.md5_buffer()));
+	return _find_file(PathMD5(p_path)) != nullptr;
 }
 
 bool PackedData::has_directory(const String &p_path) {
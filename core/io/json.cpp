@@ -45,56 +45,51 @@ const char *JSON::tk_name[TK_MAX] = {
 	"EOF",
 };
 
-static String _make_indent(const String &p_indent, int p_size) {
-	String indent_text = "";
-	if (!p_indent.is_empty()) {
-		for (int i = 0; i < p_size; i++) {
-			indent_text += p_indent;
-		}
+static void _add_indent(StringStream &r_stream, const String &p_indent, int p_size) {
+	for (int i = 0; i < p_size; i++) {
+		r_stream += p_indent;
 	}
-	return indent_text;
 }
 
-String JSON::_print_var(const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys) {
-	String colon = ":";
-	String end_statement = "";
-
-	if (!p_indent.is_empty()) {
-		colon += " ";
-		end_statement += "\n";
-	}
+void JSON::_print_var(StringStream &r_stream, const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys) {
+	const bool pretty = !p_indent.is_empty();
 
 	switch (p_var.get_type()) {
 		case Variant::NIL:
-			return "null";
+			r_stream += "null";
+			break;
 		case Variant::BOOL:
-			return p_var.operator bool() ? "true" : "false";
+			r_stream += p_var.operator bool() ? "true" : "false";
+			break;
 		case Variant::INT:
-			return itos(p_var);
+			r_stream += itos(p_var);
+			break;
 		case Variant::FLOAT:
-			return rtos(p_var);
+			r_stream += rtos(p_var);
+			break;
 		case Variant::PACKED_INT32_ARRAY:
 		case Variant::PACKED_INT64_ARRAY:
 		case Variant::PACKED_FLOAT32_ARRAY:
 		case Variant::PACKED_FLOAT64_ARRAY:
 		case Variant::PACKED_STRING_ARRAY:
 		case Variant::ARRAY: {
-			String s = "[";
-			s += end_statement;
+			r_stream += pretty ? "[\n" : "[";
 			Array a = p_var;
 			for (int i = 0; i < a.size(); i++) {
 				if (i > 0) {
-					s += ",";
-					s += end_statement;
+					r_stream += pretty ? ",\n" : ",";
 				}
-				s += _make_indent(p_indent, p_cur_indent + 1) + _print_var(a[i], p_indent, p_cur_indent + 1, p_sort_keys);
+				_add_indent(r_stream, p_indent, p_cur_indent + 1);
+				_print_var(r_stream, a[i], p_indent, p_cur_indent + 1, p_sort_keys);
 			}
-			s += end_statement + _make_indent(p_indent, p_cur_indent) + "]";
-			return s;
-		}
+			if (pretty) {
+				r_stream += "\n";
+			}
+			_add_indent(r_stream, p_indent, p_cur_indent);
+			r_stream += "]";
+		} break;
 		case Variant::DICTIONARY: {
-			String s = "{";
-			s += end_statement;
+			r_stream += pretty ? "{\n" : "{";
 			Dictionary d = p_var;
 			List<Variant> keys;
 			d.get_key_list(&keys);
@@ -105,24 +100,35 @@ String JSON::_print_var(const Variant &p_var, const String &p_indent, int p_cur_
 
 			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
 				if (E != keys.front()) {
-					s += ",";
-					s += end_statement;
+					r_stream += pretty ? ",\n" : ",";
 				}
-				s += _make_indent(p_indent, p_cur_indent + 1) + _print_var(String(E->get()), p_indent, p_cur_indent + 1, p_sort_keys);
-				s += colon;
-				s += _print_var(d[E->get()], p_indent, p_cur_indent + 1, p_sort_keys);
+				_add_indent(r_stream, p_indent, p_cur_indent + 1);
+				_print_var(r_stream, String(E->get()), p_indent, p_cur_indent + 1, p_sort_keys);
+				r_stream += pretty ? ": " : ":";
+				_print_var(r_stream, d[E->get()], p_indent, p_cur_indent + 1, p_sort_keys);
 			}
 
-			s += end_statement + _make_indent(p_indent, p_cur_indent) + "}";
-			return s;
-		}
+			if (pretty) {
+				r_stream += "\n";
+			}
+			_add_indent(r_stream, p_indent, p_cur_indent);
+			r_stream += "}";
+		} break;
 		default:
-			return "\"" + String(p_var).json_escape() + "\"";
+			r_stream += "\"";
+			r_stream += String(p_var).json_escape();
+			r_stream += "\"";
 	}
 }
 
 String JSON::print(const Variant &p_var, const String &p_indent, bool p_sort_keys) {
-	return _print_var(p_var, p_indent, 0, p_sort_keys);
+	StringStream stream;
+	_print_var(stream, p_var, p_indent, 0, p_sort_keys);
+	return stream.as_string();
+}
+
+void JSON::print_to_stream(const Variant &p_var, StringStream &r_stream, const String &p_indent, bool p_sort_keys) {
+	_print_var(r_stream, p_var, p_indent, 0, p_sort_keys);
 }
 
 Error JSON::_get_token(const char32_t *p_str, int &index, int p_len, Token &r_token, int &line, String &r_err_str) {
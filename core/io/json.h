@@ -32,6 +32,7 @@
 #define JSON_H
 
 #include "core/object/reference.h"
+#include "core/string/string_stream.h"
 #include "core/variant/variant.h"
 class JSON {
 	enum TokenType {
@@ -62,7 +63,7 @@ class JSON {
 
 	static const char *tk_name[TK_MAX];
 
-	static String _print_var(const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys);
+	static void _print_var(StringStream &r_stream, const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys);
 
 	static Error _get_token(const char32_t *p_str, int &index, int p_len, Token &r_token, int &line, String &r_err_str);
 	static Error _parse_value(Variant &value, Token &token, const char32_t *p_str, int &index, int p_len, int &line, String &r_err_str);
@@ -71,6 +72,7 @@ class JSON {
 
 public:
 	static String print(const Variant &p_var, const String &p_indent = "", bool p_sort_keys = true);
+	static void print_to_stream(const Variant &p_var, StringStream &r_stream, const String &p_indent = "", bool p_sort_keys = true);
 	static Error parse(const String &p_json, Variant &r_ret, String &r_err_str, int &r_err_line);
 };
 
@@ -774,8 +774,7 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
 	PathSentCache *psc = path_send_cache.getptr(from_path);
 	if (!psc) {
 		// Path is not cached, create.
-		path_send_cache[from_path] = PathSentCache();
-		psc = path_send_cache.getptr(from_path);
+		psc = &path_send_cache.insert(from_path, PathSentCache())->value();
 		psc->id = last_send_cache_id++;
 	}
 
@@ -983,12 +982,9 @@ void MultiplayerAPI::_del_peer(int p_id) {
 	// Cleanup get cache.
 	path_get_cache.erase(p_id);
 	// Cleanup sent cache.
-	// Some refactoring is needed to make this faster and do paths GC.
-	List<NodePath> keys;
-	path_send_cache.get_key_list(&keys);
-	for (List<NodePath>::Element *E = keys.front(); E; E = E->next()) {
-		PathSentCache *psc = path_send_cache.getptr(E->get());
-		psc->confirmed_peers.erase(p_id);
+	// Some refactoring is needed to do paths GC.
+	for (FlatHashMap<NodePath, PathSentCache>::Element *E = path_send_cache.front(); E; E = E->next()) {
+		E->value().confirmed_peers.erase(p_id);
 	}
 	emit_signal("network_peer_disconnected", p_id);
 }
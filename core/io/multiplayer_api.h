@@ -57,7 +57,7 @@ private:
 	Ref<NetworkedMultiplayerPeer> network_peer;
 	int rpc_sender_id = 0;
 	Set<int> connected_peers;
-	HashMap<NodePath, PathSentCache> path_send_cache;
+	FlatHashMap<NodePath, PathSentCache> path_send_cache;
 	Map<int, PathGetCache> path_get_cache;
 	int last_send_cache_id;
 	Vector<uint8_t> packet_cache;
@@ -31,6 +31,7 @@
 #include "resource_format_binary.h"
 
 #include "core/config/project_settings.h"
+#include "core/io/compression.h"
 #include "core/io/file_access_compressed.h"
 #include "core/io/image.h"
 #include "core/io/marshalls.h"
@@ -80,15 +81,28 @@ enum {
 	VARIANT_VECTOR3I = 47,
 	VARIANT_INT64_ARRAY = 48,
 	VARIANT_FLOAT64_ARRAY = 49,
+	VARIANT_SECTION = 50,
 	OBJECT_EMPTY = 0,
 	OBJECT_EXTERNAL_RESOURCE = 1,
 	OBJECT_INTERNAL_RESOURCE = 2,
 	OBJECT_EXTERNAL_RESOURCE_INDEX = 3,
 	//version 2: added 64 bits support for float and int
 	//version 3: changed nodepath encoding
-	FORMAT_VERSION = 3,
+	//version 4: large packed arrays are stored as size prefixed sections, resources start with a property offset table
+	FORMAT_VERSION = 4,
 	FORMAT_VERSION_CAN_RENAME_DEPS = 1,
 	FORMAT_VERSION_NO_NODEPATH_PROPERTY = 3,
+	FORMAT_VERSION_SECTIONS = 4,
+	FORMAT_VERSION_PROPERTY_TABLE = 4,
+	//property name index (32 bits) and offset of the value from the start of the resource (64 bits)
+	PROPERTY_TABLE_ENTRY_SIZE = 12,
+};
+
+enum {
+	SECTION_UNCOMPRESSED = 0,
+	SECTION_COMPRESSED_ZSTD = 1,
+	//packed arrays smaller than this keep the element by element encoding
+	SECTION_MIN_SIZE = 16384,
 };
 
 void ResourceLoaderBinary::_advance_padding(uint32_t p_len) {
@@ -110,6 +124,12 @@ StringName ResourceLoaderBinary::_get_string() {
 		if (len == 0) {
 			return StringName();
 		}
+		const uint8_t *view = f->get_buffer_view(len);
+		if (view) {
+			String s;
+			s.parse_utf8((const char *)view, len);
+			return s;
+		}
 		f->get_buffer((uint8_t *)&str_buf[0], len);
 		String s;
 		s.parse_utf8(&str_buf[0]);
@@ -119,6 +139,93 @@ StringName ResourceLoaderBinary::_get_string() {
 	return string_map[id];
 }
 
+Error ResourceLoaderBinary::_parse_section(uint8_t *p_dst, uint64_t p_size, uint32_t p_word_size) {
+	// Sections hold the array memory in little endian native layout, so they
+	// decode with a single copy (or a single decompression) into the array.
+	ERR_FAIL_COND_V_MSG(f->get_endian_swap(), ERR_FILE_CORRUPT, "Sections can't be read from big endian resources.");
+
+	uint32_t mode = f->get_32();
+	uint64_t stored_size = f->get_64();
+
+	switch (mode) {
+		case SECTION_UNCOMPRESSED: {
+			ERR_FAIL_COND_V(stored_size != p_size, ERR_FILE_CORRUPT);
+			ERR_FAIL_COND_V(f->get_buffer(p_dst, p_size) != p_size, ERR_FILE_CORRUPT);
+		} break;
+		case SECTION_COMPRESSED_ZSTD: {
+			ERR_FAIL_COND_V(stored_size > INT32_MAX || p_size > INT32_MAX, ERR_FILE_CORRUPT);
+			Vector<uint8_t> compressed;
+			const uint8_t *src = f->get_buffer_view(stored_size);
+			if (!src) {
+				compressed.resize(stored_size);
+				ERR_FAIL_COND_V(f->get_buffer(compressed.ptrw(), stored_size) != stored_size, ERR_FILE_CORRUPT);
+				src = compressed.ptr();
+			}
+			int ret = Compression::decompress(p_dst, p_size, src, stored_size, Compression::MODE_ZSTD);
+			ERR_FAIL_COND_V(ret < 0 || uint64_t(ret) != p_size, ERR_FILE_CORRUPT);
+		} break;
+		default: {
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		}
+	}
+	_advance_padding(stored_size);
+
+#ifdef BIG_ENDIAN_ENABLED
+	if (p_word_size == 4) {
+		uint32_t *ptr = (uint32_t *)p_dst;
+		for (uint64_t i = 0; i < p_size / 4; i++) {
+			ptr[i] = BSWAP32(ptr[i]);
+		}
+	} else if (p_word_size == 8) {
+		uint64_t *ptr = (uint64_t *)p_dst;
+		for (uint64_t i = 0; i < p_size / 8; i++) {
+			ptr[i] = BSWAP64(ptr[i]);
+		}
+	}
+#endif
+
+	return OK;
+}
+
+template <class T>
+Error ResourceLoaderBinary::_parse_section_array(uint32_t p_len, uint32_t p_word_size, Variant &r_v) {
+	Vector<T> array;
+	ERR_FAIL_COND_V(array.resize(p_len) != OK, ERR_OUT_OF_MEMORY);
+	Error err = _parse_section((uint8_t *)array.ptrw(), uint64_t(p_len) * sizeof(T), p_word_size);
+	if (err != OK) {
+		return err;
+	}
+	r_v = array;
+	return OK;
+}
+
+template <class T>
+Error ResourceLoaderBinary::_parse_real_section_array(uint32_t p_len, Variant &r_v) {
+	// Vector sections always hold 32-bit floats, whatever real_t is.
+#ifdef REAL_T_IS_DOUBLE
+	const uint64_t count = uint64_t(p_len) * (sizeof(T) / sizeof(real_t));
+	ERR_FAIL_COND_V(count > INT32_MAX, ERR_FILE_CORRUPT);
+	Vector<float> floats;
+	ERR_FAIL_COND_V(floats.resize(count) != OK, ERR_OUT_OF_MEMORY);
+	Error err = _parse_section((uint8_t *)floats.ptrw(), count * sizeof(float), sizeof(float));
+	if (err != OK) {
+		return err;
+	}
+
+	Vector<T> array;
+	ERR_FAIL_COND_V(array.resize(p_len) != OK, ERR_OUT_OF_MEMORY);
+	real_t *w = (real_t *)array.ptrw();
+	const float *r = floats.ptr();
+	for (uint64_t i = 0; i < count; i++) {
+		w[i] = r[i];
+	}
+	r_v = array;
+	return OK;
+#else
+	return _parse_section_array<T>(p_len, sizeof(float), r_v);
+#endif
+}
+
 Error ResourceLoaderBinary::parse_variant(Variant &r_v) {
 	uint32_t type = f->get_32();
 	print_bl("find property of type: " + itos(type));
@@ -590,6 +697,32 @@ Error ResourceLoaderBinary::parse_variant(Variant &r_v) {
 
 			r_v = array;
 		} break;
+		case VARIANT_SECTION: {
+			uint32_t type = f->get_32();
+			uint32_t len = f->get_32();
+
+			switch (type) {
+				case VARIANT_RAW_ARRAY:
+					return _parse_section_array<uint8_t>(len, 1, r_v);
+				case VARIANT_INT32_ARRAY:
+					return _parse_section_array<int32_t>(len, 4, r_v);
+				case VARIANT_INT64_ARRAY:
+					return _parse_section_array<int64_t>(len, 8, r_v);
+				case VARIANT_FLOAT32_ARRAY:
+					return _parse_section_array<float>(len, 4, r_v);
+				case VARIANT_FLOAT64_ARRAY:
+					return _parse_section_array<double>(len, 8, r_v);
+				case VARIANT_VECTOR2_ARRAY:
+					return _parse_real_section_array<Vector2>(len, r_v);
+				case VARIANT_VECTOR3_ARRAY:
+					return _parse_real_section_array<Vector3>(len, r_v);
+				case VARIANT_COLOR_ARRAY:
+					return _parse_section_array<Color>(len, sizeof(float), r_v);
+				default: {
+					ERR_FAIL_V(ERR_FILE_CORRUPT);
+				}
+			}
+		} break;
 		default: {
 			ERR_FAIL_V(ERR_FILE_CORRUPT);
 		} break;
@@ -731,6 +864,11 @@ Error ResourceLoaderBinary::load() {
 
 		int pc = f->get_32();
 
+		if (ver_format >= FORMAT_VERSION_PROPERTY_TABLE) {
+			// Everything is loaded, so the table of where each property is isn't needed.
+			f->seek(f->get_position() + uint64_t(pc) * PROPERTY_TABLE_ENTRY_SIZE);
+		}
+
 		//set properties
 
 		for (int j = 0; j < pc; j++) {
@@ -801,6 +939,13 @@ String ResourceLoaderBinary::get_unicode_string() {
 	if (len == 0) {
 		return String();
 	}
+	// Mapped files can be decoded in place, without the staging copy.
+	const uint8_t *view = f->get_buffer_view(len);
+	if (view) {
+		String s;
+		s.parse_utf8((const char *)view, len);
+		return s;
+	}
 	f->get_buffer((uint8_t *)&str_buf[0], len);
 	String s;
 	s.parse_utf8(&str_buf[0]);
@@ -976,7 +1121,7 @@ RES ResourceFormatLoaderBinary::load(const String &p_path, const String &p_origi
 	}
 
 	Error err;
-	FileAccess *f = FileAccess::open(p_path, FileAccess::READ, &err);
+	FileAccess *f = FileAccess::open_mapped(p_path, &err);
 
 	ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot open file '" + p_path + "'.");
 
@@ -1269,11 +1414,63 @@ void ResourceFormatSaverBinaryInstance::_pad_buffer(FileAccess *f, int p_bytes)
 	}
 }
 
+bool ResourceFormatSaverBinaryInstance::_write_section(FileAccess *f, uint32_t p_type, uint32_t p_len, const uint8_t *p_data, uint64_t p_size, SectionMode p_section_mode) {
+#ifdef BIG_ENDIAN_ENABLED
+	return false; // Sections are written straight from memory, which must be little endian.
+#endif
+	if (p_section_mode == SECTIONS_DISABLED || p_size < SECTION_MIN_SIZE || p_size > INT32_MAX || f->get_endian_swap()) {
+		return false;
+	}
+
+	f->store_32(VARIANT_SECTION);
+	f->store_32(p_type);
+	f->store_32(p_len);
+
+	if (p_section_mode == SECTIONS_COMPRESSED) {
+		Vector<uint8_t> compressed;
+		compressed.resize(Compression::get_max_compressed_buffer_size(p_size, Compression::MODE_ZSTD));
+		int compressed_size = Compression::compress(compressed.ptrw(), p_data, p_size, Compression::MODE_ZSTD);
+		// Keep the raw copy when compressing doesn't save at least an eighth.
+		if (compressed_size > 0 && uint64_t(compressed_size) < p_size - p_size / 8) {
+			f->store_32(SECTION_COMPRESSED_ZSTD);
+			f->store_64(compressed_size);
+			f->store_buffer(compressed.ptr(), compressed_size);
+			_pad_buffer(f, compressed_size);
+			return true;
+		}
+	}
+
+	f->store_32(SECTION_UNCOMPRESSED);
+	f->store_64(p_size);
+	f->store_buffer(p_data, p_size);
+	_pad_buffer(f, p_size);
+	return true;
+}
+
+bool ResourceFormatSaverBinaryInstance::_write_real_section(FileAccess *f, uint32_t p_type, uint32_t p_len, const real_t *p_reals, uint64_t p_count, SectionMode p_section_mode) {
+	// Stored as 32-bit floats like the element by element encoding, so the
+	// files don't depend on the precision of the build which saved them.
+#ifdef REAL_T_IS_DOUBLE
+	if (p_section_mode == SECTIONS_DISABLED || p_count * sizeof(float) < SECTION_MIN_SIZE || p_count > INT32_MAX) {
+		return false;
+	}
+	Vector<float> floats;
+	floats.resize(p_count);
+	float *w = floats.ptrw();
+	for (uint64_t i = 0; i < p_count; i++) {
+		w[i] = p_reals[i];
+	}
+	return _write_section(f, p_type, p_len, (const uint8_t *)floats.ptr(), p_count * sizeof(float), p_section_mode);
+#else
+	return _write_section(f, p_type, p_len, (const uint8_t *)p_reals, p_count * sizeof(float), p_section_mode);
+#endif
+}
+
 void ResourceFormatSaverBinaryInstance::_write_variant(const Variant &p_property, const PropertyInfo &p_hint) {
-	write_variant(f, p_property, resource_set, external_resources, string_map, p_hint);
+	write_variant(f, p_property, resource_set, external_resources, string_map, p_hint, section_mode);
 }
 
-void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint) {
+void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint, SectionMode p_section_mode) {
 	switch (p_property.get_type()) {
 		case Variant::NIL: {
 			f->store_32(VARIANT_NIL);
@@ -1526,8 +1723,8 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 					continue;
 				*/
 
-				write_variant(f, E->get(), resource_set, external_resources, string_map);
-				write_variant(f, d[E->get()], resource_set, external_resources, string_map);
+				write_variant(f, E->get(), resource_set, external_resources, string_map, PropertyInfo(), p_section_mode);
+				write_variant(f, d[E->get()], resource_set, external_resources, string_map, PropertyInfo(), p_section_mode);
 			}
 
 		} break;
@@ -1536,13 +1733,16 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			Array a = p_property;
 			f->store_32(uint32_t(a.size()));
 			for (int i = 0; i < a.size(); i++) {
-				write_variant(f, a[i], resource_set, external_resources, string_map);
+				write_variant(f, a[i], resource_set, external_resources, string_map, PropertyInfo(), p_section_mode);
 			}
 
 		} break;
 		case Variant::PACKED_BYTE_ARRAY: {
-			f->store_32(VARIANT_RAW_ARRAY);
 			Vector<uint8_t> arr = p_property;
+			if (_write_section(f, VARIANT_RAW_ARRAY, arr.size(), (const uint8_t *)arr.ptr(), uint64_t(arr.size()) * sizeof(uint8_t), p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_RAW_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const uint8_t *r = arr.ptr();
@@ -1551,8 +1751,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_INT32_ARRAY: {
-			f->store_32(VARIANT_INT32_ARRAY);
 			Vector<int32_t> arr = p_property;
+			if (_write_section(f, VARIANT_INT32_ARRAY, arr.size(), (const uint8_t *)arr.ptr(), uint64_t(arr.size()) * sizeof(int32_t), p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_INT32_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const int32_t *r = arr.ptr();
@@ -1562,8 +1765,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_INT64_ARRAY: {
-			f->store_32(VARIANT_INT64_ARRAY);
 			Vector<int64_t> arr = p_property;
+			if (_write_section(f, VARIANT_INT64_ARRAY, arr.size(), (const uint8_t *)arr.ptr(), uint64_t(arr.size()) * sizeof(int64_t), p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_INT64_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const int64_t *r = arr.ptr();
@@ -1573,8 +1779,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_FLOAT32_ARRAY: {
-			f->store_32(VARIANT_FLOAT32_ARRAY);
 			Vector<float> arr = p_property;
+			if (_write_section(f, VARIANT_FLOAT32_ARRAY, arr.size(), (const uint8_t *)arr.ptr(), uint64_t(arr.size()) * sizeof(float), p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_FLOAT32_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const float *r = arr.ptr();
@@ -1584,8 +1793,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_FLOAT64_ARRAY: {
-			f->store_32(VARIANT_FLOAT64_ARRAY);
 			Vector<double> arr = p_property;
+			if (_write_section(f, VARIANT_FLOAT64_ARRAY, arr.size(), (const uint8_t *)arr.ptr(), uint64_t(arr.size()) * sizeof(double), p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_FLOAT64_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const double *r = arr.ptr();
@@ -1606,8 +1818,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_VECTOR3_ARRAY: {
-			f->store_32(VARIANT_VECTOR3_ARRAY);
 			Vector<Vector3> arr = p_property;
+			if (_write_real_section(f, VARIANT_VECTOR3_ARRAY, arr.size(), (const real_t *)arr.ptr(), uint64_t(arr.size()) * 3, p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_VECTOR3_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const Vector3 *r = arr.ptr();
@@ -1619,8 +1834,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_VECTOR2_ARRAY: {
-			f->store_32(VARIANT_VECTOR2_ARRAY);
 			Vector<Vector2> arr = p_property;
+			if (_write_real_section(f, VARIANT_VECTOR2_ARRAY, arr.size(), (const real_t *)arr.ptr(), uint64_t(arr.size()) * 2, p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_VECTOR2_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const Vector2 *r = arr.ptr();
@@ -1631,8 +1849,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_COLOR_ARRAY: {
-			f->store_32(VARIANT_COLOR_ARRAY);
 			Vector<Color> arr = p_property;
+			if (_write_section(f, VARIANT_COLOR_ARRAY, arr.size(), (const uint8_t *)arr.ptr(), uint64_t(arr.size()) * sizeof(Color), p_section_mode)) {
+				break;
+			}
+			f->store_32(VARIANT_COLOR_ARRAY);
 			int len = arr.size();
 			f->store_32(len);
 			const Color *r = arr.ptr();
@@ -1781,6 +2002,13 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 	big_endian = p_flags & ResourceSaver::FLAG_SAVE_BIG_ENDIAN;
 	takeover_paths = p_flags & ResourceSaver::FLAG_REPLACE_SUBRESOURCE_PATHS;
 
+	// A compressed file is compressed as a whole already.
+	if ((p_flags & ResourceSaver::FLAG_COMPRESS_SECTIONS) && !(p_flags & ResourceSaver::FLAG_COMPRESS)) {
+		section_mode = SECTIONS_COMPRESSED;
+	} else {
+		section_mode = SECTIONS_RAW;
+	}
+
 	if (!p_path.begins_with("res://")) {
 		takeover_paths = false;
 	}
@@ -1934,15 +2162,35 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 	for (List<ResourceData>::Element *E = resources.front(); E; E = E->next()) {
 		ResourceData &rd = E->get();
 
-		ofs_table.push_back(f->get_position());
+		uint64_t resource_ofs = f->get_position();
+		ofs_table.push_back(resource_ofs);
 		save_unicode_string(f, rd.type);
 		f->store_32(rd.properties.size());
 
+		// Where the value of each property starts, relative to the resource, so a
+		// property can be read without decoding the ones before it. Filled in below.
+		uint64_t property_table_ofs = f->get_position();
+		for (int i = 0; i < rd.properties.size(); i++) {
+			f->store_32(0);
+			f->store_64(0);
+		}
+
+		Vector<uint64_t> property_ofs;
 		for (List<Property>::Element *F = rd.properties.front(); F; F = F->next()) {
 			Property &p = F->get();
 			f->store_32(p.name_idx);
+			property_ofs.push_back(f->get_position() - resource_ofs);
 			_write_variant(p.value, F->get().pi);
 		}
+
+		uint64_t resource_end = f->get_position();
+		f->seek(property_table_ofs);
+		int j = 0;
+		for (List<Property>::Element *F = rd.properties.front(); F; F = F->next(), j++) {
+			f->store_32(F->get().name_idx);
+			f->store_64(property_ofs[j]);
+		}
+		f->seek(resource_end);
 	}
 
 	for (int i = 0; i < ofs_table.size(); i++) {
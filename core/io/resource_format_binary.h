@@ -83,6 +83,11 @@ class ResourceLoaderBinary {
 	friend class ResourceFormatLoaderBinary;
 
 	Error parse_variant(Variant &r_v);
+	Error _parse_section(uint8_t *p_dst, uint64_t p_size, uint32_t p_word_size);
+	template <class T>
+	Error _parse_section_array(uint32_t p_len, uint32_t p_word_size, Variant &r_v);
+	template <class T>
+	Error _parse_real_section_array(uint32_t p_len, Variant &r_v);
 
 	Map<String, RES> dependency_cache;
 
@@ -113,6 +118,14 @@ public:
 };
 
 class ResourceFormatSaverBinaryInstance {
+public:
+	enum SectionMode {
+		SECTIONS_DISABLED, // Format 3 compatible, every array is stored element by element.
+		SECTIONS_RAW,
+		SECTIONS_COMPRESSED,
+	};
+
+private:
 	String local_path;
 	String path;
 
@@ -121,6 +134,7 @@ class ResourceFormatSaverBinaryInstance {
 	bool skip_editor;
 	bool big_endian;
 	bool takeover_paths;
+	SectionMode section_mode = SECTIONS_RAW;
 	FileAccess *f;
 	String magic;
 	Set<RES> resource_set;
@@ -150,6 +164,8 @@ class ResourceFormatSaverBinaryInstance {
 	};
 
 	static void _pad_buffer(FileAccess *f, int p_bytes);
+	static bool _write_section(FileAccess *f, uint32_t p_type, uint32_t p_len, const uint8_t *p_data, uint64_t p_size, SectionMode p_section_mode);
+	static bool _write_real_section(FileAccess *f, uint32_t p_type, uint32_t p_len, const real_t *p_reals, uint64_t p_count, SectionMode p_section_mode);
 	void _write_variant(const Variant &p_property, const PropertyInfo &p_hint = PropertyInfo());
 	void _find_resources(const Variant &p_variant, bool p_main = false);
 	static void save_unicode_string(FileAccess *f, const String &p_string, bool p_bit_on_len = false);
@@ -157,7 +173,7 @@ class ResourceFormatSaverBinaryInstance {
 
 public:
 	Error save(const String &p_path, const RES &p_resource, uint32_t p_flags = 0);
-	static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint = PropertyInfo());
+	static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint = PropertyInfo(), SectionMode p_section_mode = SECTIONS_DISABLED);
 };
 
 class ResourceFormatSaverBinary : public ResourceFormatSaver {
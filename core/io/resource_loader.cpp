@@ -210,13 +210,28 @@ RES ResourceLoader::_load(const String &p_path, const String &p_original_path, c
 }
 
 void ResourceLoader::_thread_load_function(void *p_userdata) {
-	ThreadLoadTask &load_task = *(ThreadLoadTask *)p_userdata;
-	load_task.loader_id = Thread::get_caller_id();
+	// Scheduler task, the userdata is a copy of the path. By now the load may
+	// have been run by a thread waiting for it, or canceled.
+	String *local_path = (String *)p_userdata;
 
-	if (load_task.semaphore) {
-		//this is an actual thread, so wait for Ok from semaphore
-		thread_load_semaphore->wait(); //wait until its ok to start loading
+	thread_load_mutex->lock();
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(*local_path);
+	memdelete(local_path);
+	if (!load_task || load_task->started) {
+		thread_load_mutex->unlock();
+		return;
 	}
+	load_task->started = true;
+	load_task->loader_id = Thread::get_caller_id();
+	load_task->started_usec = OS::get_singleton()->get_ticks_usec();
+	thread_load_mutex->unlock();
+
+	_run_load_task(*load_task);
+}
+
+void ResourceLoader::_run_load_task(ThreadLoadTask &p_load_task) {
+	ThreadLoadTask &load_task = p_load_task;
+
 	load_task.resource = _load(load_task.remapped_path, load_task.remapped_path != load_task.local_path ? load_task.local_path : String(), load_task.type_hint, load_task.cache_mode, &load_task.error, load_task.use_sub_threads, &load_task.progress);
 
 	load_task.progress = 1.0; //it was fully loaded at this point, so force progress to 1.0
@@ -227,23 +242,6 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 	} else {
 		load_task.status = THREAD_LOAD_LOADED;
 	}
-	if (load_task.semaphore) {
-		if (load_task.start_next && thread_waiting_count > 0) {
-			thread_waiting_count--;
-			//thread loading count remains constant, this ends but another one begins
-			thread_load_semaphore->post();
-		} else {
-			thread_loading_count--; //no threads waiting, just reduce loading count
-		}
-
-		print_lt("END: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
-
-		for (int i = 0; i < load_task.poll_requests; i++) {
-			load_task.semaphore->post();
-		}
-		memdelete(load_task.semaphore);
-		load_task.semaphore = nullptr;
-	}
 
 	if (load_task.resource.is_valid()) {
 		load_task.resource->set_path(load_task.local_path);
@@ -267,10 +265,179 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 		}
 	}
 
+	LoadTiming timing;
+	timing.path = load_task.local_path;
+	timing.dependencies = load_task.dependencies;
+	timing.thread = load_task.loader_id;
+	timing.requested_usec = load_task.requested_usec;
+	timing.started_usec = load_task.started_usec;
+	timing.finished_usec = OS::get_singleton()->get_ticks_usec();
+	timing.error = load_task.error;
+	if (load_timings.size() >= MAX_LOAD_TIMINGS) {
+		load_timings.pop_front();
+	}
+	load_timings.push_back(timing);
+
+	print_lt("END: " + load_task.local_path + " in " + itos(timing.finished_usec - timing.started_usec) + " usec, queued for " + itos(timing.started_usec - timing.requested_usec) + " usec");
+
+	if (load_task.task) {
+		TaskScheduler::get_singleton()->release_task(load_task.task);
+		load_task.task = nullptr;
+	}
+
+	for (int i = 0; i < load_task.waiters; i++) {
+		load_task.semaphore->post();
+	}
+
+	// The dependencies are in the cache (or referenced by the resource) now.
+	Vector<String> dependencies = load_task.dependencies;
+	load_task.dependencies.clear();
+
+	if (load_task.requests == 0) {
+		// All requests were canceled while loading.
+		String local_path = load_task.local_path;
+		thread_load_tasks.erase(local_path);
+	}
+
+	thread_load_mutex->unlock();
+
+	for (int i = 0; i < dependencies.size(); i++) {
+		_release_load_request(dependencies[i]);
+	}
+}
+
+void ResourceLoader::_release_load_request(const String &p_local_path) {
+	thread_load_mutex->lock();
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(p_local_path);
+	if (!load_task) {
+		thread_load_mutex->unlock();
+		return;
+	}
+
+	load_task->requests--;
+	if (load_task->requests > 0 || (load_task->started && load_task->status == THREAD_LOAD_IN_PROGRESS)) {
+		// Still wanted, or loading, in which case it is erased once done.
+		thread_load_mutex->unlock();
+		return;
+	}
+
+	// Either done, or nobody wants it anymore and it did not start yet.
+	Vector<String> dependencies = load_task->dependencies;
+	if (load_task->task) {
+		// The scheduler task still runs, but won't find anything to load.
+		TaskScheduler::get_singleton()->release_task(load_task->task);
+	}
+	thread_load_tasks.erase(p_local_path);
+
 	thread_load_mutex->unlock();
+
+	for (int i = 0; i < dependencies.size(); i++) {
+		_release_load_request(dependencies[i]);
+	}
+}
+
+void ResourceLoader::_request_dependencies(const String &p_local_path) {
+	List<String> dependencies;
+	get_dependencies(p_local_path, &dependencies);
+
+	Vector<String> requested;
+	for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+		String path = E->get().get_slice("::", 0);
+		if (path.is_rel_path()) {
+			path = "res://" + path;
+		} else {
+			path = ProjectSettings::get_singleton()->localize_path(path);
+		}
+		if (path == p_local_path || requested.has(path)) {
+			continue;
+		}
+		// Already on a worker, the dependencies of dependencies are scanned right away so
+		// their loads exist by the time this one is scheduled after them.
+		if (_load_threaded_request(path, "", true, ResourceFormatLoader::CACHE_MODE_REUSE, String(), true) == OK) {
+			requested.push_back(path);
+		}
+	}
+
+	thread_load_mutex->lock();
+	ThreadLoadTask *load_task_ptr = thread_load_tasks.getptr(p_local_path);
+	if (!load_task_ptr || load_task_ptr->started) {
+		// Canceled while scanning, or a thread waiting for it got to load it
+		// first and did without these.
+		thread_load_mutex->unlock();
+		for (int i = 0; i < requested.size(); i++) {
+			_release_load_request(requested[i]);
+		}
+		return;
+	}
+	ThreadLoadTask &load_task = *load_task_ptr;
+
+	LocalVector<TaskScheduler::TaskID> dependency_tasks;
+	for (int i = 0; i < requested.size(); i++) {
+		const ThreadLoadTask *dependency = thread_load_tasks.getptr(requested[i]);
+		if (dependency && dependency->task && dependency->status == THREAD_LOAD_IN_PROGRESS) {
+			dependency_tasks.push_back(dependency->task);
+		}
+	}
+	load_task.dependencies = requested;
+
+	if (TaskScheduler::get_singleton()->get_worker_count() == 0) {
+		// Nothing would run the task in the background, load it right away.
+		load_task.started = true;
+		load_task.loader_id = Thread::get_caller_id();
+		load_task.started_usec = OS::get_singleton()->get_ticks_usec();
+		thread_load_mutex->unlock();
+		_run_load_task(load_task);
+		return;
+	}
+
+	if (load_task.task) {
+		// The scan task, which is finishing.
+		TaskScheduler::get_singleton()->release_task(load_task.task);
+	}
+	load_task.task = TaskScheduler::get_singleton()->add_task(_thread_load_function, memnew(String(p_local_path)), dependency_tasks.ptr(), dependency_tasks.size(), TaskScheduler::PRIORITY_LOW);
+	if (load_task.promoted) {
+		// Waited on while scanning, the dependencies weren't known then.
+		TaskScheduler::get_singleton()->promote_task(load_task.task);
+		for (int i = 0; i < requested.size(); i++) {
+			_promote_load_task(requested[i]);
+		}
+	}
+	thread_load_mutex->unlock();
+}
+
+void ResourceLoader::_promote_load_task(const String &p_local_path) {
+	// Must be called with the mutex locked.
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(p_local_path);
+	if (!load_task || load_task->promoted || load_task->status != THREAD_LOAD_IN_PROGRESS) {
+		return;
+	}
+	load_task->promoted = true;
+
+	if (load_task->task) {
+		TaskScheduler::get_singleton()->promote_task(load_task->task);
+	}
+	for (int i = 0; i < load_task->dependencies.size(); i++) {
+		_promote_load_task(load_task->dependencies[i]);
+	}
+	for (Set<String>::Element *E = load_task->sub_tasks.front(); E; E = E->next()) {
+		_promote_load_task(E->get());
+	}
+}
+
+void ResourceLoader::_thread_scan_function(void *p_userdata) {
+	// Scheduler task, the userdata is a copy of the path.
+	String *local_path = (String *)p_userdata;
+	String path = *local_path;
+	memdelete(local_path);
+
+	_request_dependencies(path);
 }
 
 Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource) {
+	return _load_threaded_request(p_path, p_type_hint, p_use_sub_threads, p_cache_mode, p_source_resource, false);
+}
+
+Error ResourceLoader::_load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource, bool p_scan_now) {
 	String local_path;
 	if (p_path.is_rel_path()) {
 		local_path = "res://" + p_path;
@@ -319,13 +486,10 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 		load_task.type_hint = p_type_hint;
 		load_task.cache_mode = p_cache_mode;
 		load_task.use_sub_threads = p_use_sub_threads;
+		load_task.requested_usec = OS::get_singleton()->get_ticks_usec();
 
 		{ //must check if resource is already loaded before attempting to load it in a thread
 
-			if (load_task.loader_id == Thread::get_caller_id()) {
-				thread_load_mutex->unlock();
-				ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Attempted to load a resource already being loaded from this thread, cyclic reference?");
-			}
 			//lock first if possible
 			ResourceCache::lock.read_lock();
 
@@ -354,23 +518,38 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 
 	ThreadLoadTask &load_task = thread_load_tasks[local_path];
 
-	if (load_task.resource.is_null()) { //needs  to be loaded in thread
+	if (load_task.resource.is_valid()) {
+		thread_load_mutex->unlock();
+		return OK;
+	}
 
-		load_task.semaphore = memnew(Semaphore);
-		if (thread_loading_count < thread_load_max) {
-			thread_loading_count++;
-			thread_load_semaphore->post(); //we have free threads, so allow one
-		} else {
-			thread_waiting_count++;
+	print_lt("REQUEST: " + local_path);
+
+	if (p_use_sub_threads && p_cache_mode == ResourceFormatLoader::CACHE_MODE_REUSE) {
+		// The dependencies are requested first, the load is scheduled after them.
+		if (p_scan_now || TaskScheduler::get_singleton()->get_worker_count() == 0) {
+			thread_load_mutex->unlock();
+			_request_dependencies(local_path);
+			return OK;
 		}
 
-		print_lt("REQUEST: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+		// Finding them reads the file, which is left to a task.
+		load_task.task = TaskScheduler::get_singleton()->add_task(_thread_scan_function, memnew(String(local_path)), nullptr, 0, TaskScheduler::PRIORITY_LOW);
+		thread_load_mutex->unlock();
+		return OK;
+	}
 
-		load_task.thread = memnew(Thread);
-		load_task.thread->start(_thread_load_function, &thread_load_tasks[local_path]);
-		load_task.loader_id = load_task.thread->get_id();
+	if (TaskScheduler::get_singleton()->get_worker_count() == 0) {
+		// Nothing would run the task in the background, load it right away.
+		load_task.started = true;
+		load_task.loader_id = Thread::get_caller_id();
+		load_task.started_usec = load_task.requested_usec;
+		thread_load_mutex->unlock();
+		_run_load_task(load_task);
+		return OK;
 	}
 
+	load_task.task = TaskScheduler::get_singleton()->add_task(_thread_load_function, memnew(String(local_path)), nullptr, 0, TaskScheduler::PRIORITY_LOW);
 	thread_load_mutex->unlock();
 
 	return OK;
@@ -379,12 +558,15 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 float ResourceLoader::_dependency_get_progress(const String &p_path) {
 	if (thread_load_tasks.has(p_path)) {
 		ThreadLoadTask &load_task = thread_load_tasks[p_path];
-		int dep_count = load_task.sub_tasks.size();
+		int dep_count = load_task.sub_tasks.size() + load_task.dependencies.size();
 		if (dep_count > 0) {
 			float dep_progress = 0;
 			for (Set<String>::Element *E = load_task.sub_tasks.front(); E; E = E->next()) {
 				dep_progress += _dependency_get_progress(E->get());
 			}
+			for (int i = 0; i < load_task.dependencies.size(); i++) {
+				dep_progress += _dependency_get_progress(load_task.dependencies[i]);
+			}
 			dep_progress /= float(dep_count);
 			dep_progress *= 0.5;
 			dep_progress += load_task.progress * 0.5;
@@ -440,69 +622,90 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 		return RES();
 	}
 
-	ThreadLoadTask &load_task = thread_load_tasks[local_path];
+	ThreadLoadTask *load_task = &thread_load_tasks[local_path];
 
-	//semaphore still exists, meaning it's still loading, request poll
-	Semaphore *semaphore = load_task.semaphore;
-	if (semaphore) {
-		load_task.poll_requests++;
+	if (load_task->status == THREAD_LOAD_IN_PROGRESS) {
+		// Loads still queued for it are run by the workers before other loads.
+		_promote_load_task(local_path);
 
-		{
-			// As we got a semaphore, this means we are going to have to wait
-			// until the sub-resource is done loading
-			//
-			// As this thread will become 'blocked' we should "exchange" its
-			// active status with a waiting one, to ensure load continues.
-			//
-			// This ensures loading is never blocked and that is also within
-			// the maximum number of active threads.
-
-			if (thread_waiting_count > 0) {
-				thread_waiting_count--;
-				thread_loading_count++;
-				thread_load_semaphore->post();
-
-				load_task.start_next = false; //do not start next since we are doing it here
-			}
+		if (!load_task->started) {
+			// Not started yet, so waiting for it would only block this thread.
+			// Load it here instead.
+			load_task->started = true;
+			load_task->loader_id = Thread::get_caller_id();
+			load_task->started_usec = OS::get_singleton()->get_ticks_usec();
+			thread_load_mutex->unlock();
 
-			thread_suspended_count++;
+			print_lt("GET: " + local_path + ", loading on this thread");
+			_run_load_task(*load_task);
 
-			print_lt("GET: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
-		}
+			thread_load_mutex->lock();
+		} else {
+			if (load_task->loader_id == Thread::get_caller_id()) {
+				thread_load_mutex->unlock();
+				if (r_error) {
+					*r_error = ERR_CYCLIC_LINK;
+				}
+				ERR_FAIL_V_MSG(RES(), "Attempted to load a resource already being loaded from this thread, cyclic reference? '" + local_path + "'.");
+			}
 
-		thread_load_mutex->unlock();
-		semaphore->wait();
-		thread_load_mutex->lock();
+			// Loading in another thread, wait for it to be done.
+			if (!load_task->semaphore) {
+				load_task->semaphore = memnew(Semaphore);
+			}
+			load_task->waiters++;
+			Semaphore *semaphore = load_task->semaphore;
 
-		thread_suspended_count--;
+			print_lt("GET: " + local_path + ", waiting");
 
-		if (!thread_load_tasks.has(local_path)) { //may have been erased during unlock and this was always an invalid call
 			thread_load_mutex->unlock();
-			if (r_error) {
-				*r_error = ERR_INVALID_PARAMETER;
+			semaphore->wait();
+			thread_load_mutex->lock();
+
+			load_task->waiters--;
+			if (load_task->waiters == 0) {
+				memdelete(load_task->semaphore);
+				load_task->semaphore = nullptr;
 			}
-			return RES();
 		}
 	}
 
-	RES resource = load_task.resource;
+	RES resource = load_task->resource;
 	if (r_error) {
-		*r_error = load_task.error;
+		*r_error = load_task->error;
 	}
 
-	load_task.requests--;
+	thread_load_mutex->unlock();
+
+	_release_load_request(local_path);
 
-	if (load_task.requests == 0) {
-		if (load_task.thread) { //thread may not have been used
-			load_task.thread->wait_to_finish();
-			memdelete(load_task.thread);
-		}
-		thread_load_tasks.erase(local_path);
+	return resource;
+}
+
+Error ResourceLoader::load_threaded_cancel(const String &p_path) {
+	String local_path;
+	if (p_path.is_rel_path()) {
+		local_path = "res://" + p_path;
+	} else {
+		local_path = ProjectSettings::get_singleton()->localize_path(p_path);
 	}
 
+	thread_load_mutex->lock();
+	bool requested = thread_load_tasks.has(local_path);
 	thread_load_mutex->unlock();
+	ERR_FAIL_COND_V_MSG(!requested, ERR_INVALID_PARAMETER, "There is no thread loading resource '" + local_path + "'.");
 
-	return resource;
+	print_lt("CANCEL: " + local_path);
+	_release_load_request(local_path);
+	return OK;
+}
+
+void ResourceLoader::get_load_timings(List<LoadTiming> *r_timings) {
+	thread_load_mutex->lock();
+	for (const List<LoadTiming>::Element *E = load_timings.front(); E; E = E->next()) {
+		r_timings->push_back(E->get());
+	}
+	thread_load_mutex->unlock();
 }
 
 RES ResourceLoader::load(const String &p_path, const String &p_type_hint, ResourceFormatLoader::CacheMode p_cache_mode, Error *r_error) {
@@ -567,12 +770,16 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, Resour
 		load_task.type_hint = p_type_hint;
 		load_task.cache_mode = p_cache_mode; //ignore
 		load_task.loader_id = Thread::get_caller_id();
+		load_task.started = true;
+		load_task.requested_usec = OS::get_singleton()->get_ticks_usec();
+		load_task.started_usec = load_task.requested_usec;
 
 		thread_load_tasks[local_path] = load_task;
+		ThreadLoadTask *task = &thread_load_tasks[local_path];
 
 		thread_load_mutex->unlock();
 
-		_thread_load_function(&thread_load_tasks[local_path]);
+		_run_load_task(*task);
 
 		return load_threaded_get(p_path, r_error);
 
@@ -1097,16 +1304,11 @@ void ResourceLoader::remove_custom_loaders() {
 
 void ResourceLoader::initialize() {
 	thread_load_mutex = memnew(Mutex);
-	thread_load_max = OS::get_singleton()->get_processor_count();
-	thread_loading_count = 0;
-	thread_waiting_count = 0;
-	thread_suspended_count = 0;
-	thread_load_semaphore = memnew(Semaphore);
 }
 
 void ResourceLoader::finalize() {
 	memdelete(thread_load_mutex);
-	memdelete(thread_load_semaphore);
+	load_timings.clear();
 }
 
 ResourceLoadErrorNotify ResourceLoader::err_notify = nullptr;
@@ -1120,12 +1322,7 @@ bool ResourceLoader::timestamp_on_load = false;
 
 Mutex *ResourceLoader::thread_load_mutex = nullptr;
 HashMap<String, ResourceLoader::ThreadLoadTask> ResourceLoader::thread_load_tasks;
-Semaphore *ResourceLoader::thread_load_semaphore = nullptr;
-
-int ResourceLoader::thread_loading_count = 0;
-int ResourceLoader::thread_waiting_count = 0;
-int ResourceLoader::thread_suspended_count = 0;
-int ResourceLoader::thread_load_max = 0;
+List<ResourceLoader::LoadTiming> ResourceLoader::load_timings;
 
 SelfList<Resource>::List ResourceLoader::remapped_list;
 HashMap<String, Vector<String>> ResourceLoader::translation_remaps;
@@ -33,6 +33,7 @@
 
 #include "core/io/resource.h"
 #include "core/os/semaphore.h"
+#include "core/os/task_scheduler.h"
 #include "core/os/thread.h"
 
 class ResourceFormatLoader : public Reference {
@@ -87,6 +88,18 @@ public:
 		THREAD_LOAD_LOADED
 	};
 
+	// When and where a resource was loaded, kept for the last MAX_LOAD_TIMINGS loads.
+	// Following the dependencies of the slowest loads gives the critical path.
+	struct LoadTiming {
+		String path;
+		Vector<String> dependencies; // Requested ahead of the load, in parallel.
+		Thread::ID thread = 0;
+		uint64_t requested_usec = 0;
+		uint64_t started_usec = 0;
+		uint64_t finished_usec = 0;
+		Error error = OK;
+	};
+
 private:
 	static Ref<ResourceFormatLoader> loader[MAX_LOADERS];
 	static int loader_count;
@@ -114,10 +127,21 @@ private:
 
 	static Ref<ResourceFormatLoader> _find_custom_resource_format_loader(String path);
 
+	enum {
+		MAX_LOAD_TIMINGS = 1024
+	};
+
+	// Threaded loads run as TaskScheduler tasks. Requests with sub threads
+	// first request the dependencies of the resource (as returned by
+	// get_dependencies()), and its task only runs once theirs have, so the
+	// whole dependency graph loads in parallel. Waiting for a load which has
+	// not started yet runs it on the waiting thread instead, so blocking loads
+	// never queue behind streaming ones.
 	struct ThreadLoadTask {
-		Thread *thread = nullptr;
+		TaskScheduler::TaskID task = nullptr; // Released once the load is done.
 		Thread::ID loader_id = 0;
-		Semaphore *semaphore = nullptr;
+		Semaphore *semaphore = nullptr; // Created for threads waiting on a load running elsewhere.
+		int waiters = 0;
 		String local_path;
 		String remapped_path;
 		String type_hint;
@@ -128,20 +152,25 @@ private:
 		RES resource;
 		bool xl_remapped = false;
 		bool use_sub_threads = false;
-		bool start_next = true;
+		bool started = false;
+		bool promoted = false; // Waited on, so its tasks go ahead of other loads.
 		int requests = 0;
-		int poll_requests = 0;
 		Set<String> sub_tasks;
+		Vector<String> dependencies; // Requested by this load, released when it is done.
+		uint64_t requested_usec = 0;
+		uint64_t started_usec = 0;
 	};
 
 	static void _thread_load_function(void *p_userdata);
+	static void _run_load_task(ThreadLoadTask &p_load_task);
+	static void _release_load_request(const String &p_local_path);
+	static void _request_dependencies(const String &p_local_path);
+	static void _thread_scan_function(void *p_userdata);
+	static void _promote_load_task(const String &p_local_path);
+	static Error _load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource, bool p_scan_now);
 	static Mutex *thread_load_mutex;
 	static HashMap<String, ThreadLoadTask> thread_load_tasks;
-	static Semaphore *thread_load_semaphore;
-	static int thread_waiting_count;
-	static int thread_loading_count;
-	static int thread_suspended_count;
-	static int thread_load_max;
+	static List<LoadTiming> load_timings;
 
 	static float _dependency_get_progress(const String &p_path);
 
@@ -149,6 +178,8 @@ public:
 	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "", bool p_use_sub_threads = false, ResourceFormatLoader::CacheMode p_cache_mode = ResourceFormatLoader::CACHE_MODE_REUSE, const String &p_source_resource = String());
 	static ThreadLoadStatus load_threaded_get_status(const String &p_path, float *r_progress = nullptr);
 	static RES load_threaded_get(const String &p_path, Error *r_error = nullptr);
+	static Error load_threaded_cancel(const String &p_path);
+	static void get_load_timings(List<LoadTiming> *r_timings);
 
 	static RES load(const String &p_path, const String &p_type_hint = "", ResourceFormatLoader::CacheMode p_cache_mode = ResourceFormatLoader::CACHE_MODE_REUSE, Error *r_error = nullptr);
 	static bool exists(const String &p_path, const String &p_type_hint = "");
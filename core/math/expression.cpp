@@ -596,6 +596,7 @@ Expression::ENode *Expression::_parse_expression() {
 					//function call
 					CallNode *func_call = alloc_node<CallNode>();
 					func_call->method = identifier;
+					func_call->call_site.set_method(identifier);
 					SelfNode *self_node = alloc_node<SelfNode>();
 					func_call->base = self_node;
 
@@ -827,6 +828,7 @@ Expression::ENode *Expression::_parse_expression() {
 						//function call
 						CallNode *func_call = alloc_node<CallNode>();
 						func_call->method = identifier;
+						func_call->call_site.set_method(identifier);
 						func_call->base = expr;
 
 						while (true) {
@@ -1369,7 +1371,7 @@ bool Expression::_execute(const Array &p_inputs, Object *p_instance, Expression:
 			}
 
 			Callable::CallError ce;
-			base.call(call->method, (const Variant **)argp.ptr(), argp.size(), r_ret, ce);
+			call->call_site.call(base, (const Variant **)argp.ptr(), argp.size(), r_ret, ce);
 
 			if (ce.error != Callable::CallError::CALL_OK) {
 				r_error_str = vformat(RTR("On call to '%s':"), String(call->method));
@@ -32,6 +32,7 @@
 #define EXPRESSION_H
 
 #include "core/object/reference.h"
+#include "core/variant/variant_call_site.h"
 
 class Expression : public Reference {
 	GDCLASS(Expression, Reference);
@@ -214,6 +215,7 @@ private:
 		ENode *base = nullptr;
 		StringName method;
 		Vector<ENode *> arguments;
+		mutable VariantCallSite call_site;
 
 		CallNode() {
 			type = TYPE_CALL;
@@ -0,0 +1,220 @@
+/*************************************************************************/
+/*  math_batch.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "math_batch.h"
+
+void MathBatch::make_plane_blocks(const Plane *p_planes, int p_plane_count, PlaneBlock *r_blocks) {
+	const int block_count = get_plane_block_count(p_plane_count);
+	for (int i = 0; i < block_count * 4; i++) {
+		PlaneBlock &block = r_blocks[i / 4];
+		const int lane = i % 4;
+		if (i < p_plane_count) {
+			block.normal_x[lane] = p_planes[i].normal.x;
+			block.normal_y[lane] = p_planes[i].normal.y;
+			block.normal_z[lane] = p_planes[i].normal.z;
+			block.d[lane] = p_planes[i].d;
+		} else {
+			block.normal_x[lane] = 0;
+			block.normal_y[lane] = 0;
+			block.normal_z[lane] = 0;
+			block.d[lane] = 1;
+		}
+	}
+}
+
+void MathBatch::cull_boxes(const PlaneBlock *p_blocks, int p_block_count, const real_t *p_min_max, int p_count, uint8_t *r_inside) {
+	for (int i = 0; i < p_count; i++) {
+		r_inside[i] = is_box_inside(p_blocks, p_block_count, p_min_max + i * 6);
+	}
+}
+
+#if defined(MATH_BATCH_SSE2)
+
+// Transforms 4 points held by component, keeping the operation order of Transform::xform().
+// p_coefficients holds each value of the transform rows (basis then origin) broadcast to all lanes.
+static _FORCE_INLINE_ void _xform_components(const __m128 *p_coefficients, __m128 &r_x, __m128 &r_y, __m128 &r_z) {
+	__m128 result[3];
+	for (int i = 0; i < 3; i++) {
+		const __m128 *c = p_coefficients + i * 4;
+		__m128 v = _mm_add_ps(_mm_mul_ps(c[0], r_x), _mm_mul_ps(c[1], r_y));
+		result[i] = _mm_add_ps(_mm_add_ps(v, _mm_mul_ps(c[2], r_z)), c[3]);
+	}
+	r_x = result[0];
+	r_y = result[1];
+	r_z = result[2];
+}
+
+void MathBatch::xform_points(const Transform &p_xform, const Vector3 *p_src, Vector3 *r_dst, int p_count, int p_stride) {
+	__m128 coefficients[12];
+	for (int i = 0; i < 3; i++) {
+		coefficients[i * 4 + 0] = _mm_set1_ps(p_xform.basis.elements[i][0]);
+		coefficients[i * 4 + 1] = _mm_set1_ps(p_xform.basis.elements[i][1]);
+		coefficients[i * 4 + 2] = _mm_set1_ps(p_xform.basis.elements[i][2]);
+		coefficients[i * 4 + 3] = _mm_set1_ps(p_xform.origin[i]);
+	}
+	const uint8_t *src = (const uint8_t *)p_src;
+	uint8_t *dst = (uint8_t *)r_dst;
+
+	int i = 0;
+	if (p_stride == sizeof(Vector3)) {
+		// Packed points, 4 of them are 3 loads which are shuffled into components.
+		for (; i + 4 <= p_count; i += 4) {
+			const float *f = (const float *)(src + i * sizeof(Vector3));
+			const __m128 l0 = _mm_loadu_ps(f); // x0 y0 z0 x1
+			const __m128 l1 = _mm_loadu_ps(f + 4); // y1 z1 x2 y2
+			const __m128 l2 = _mm_loadu_ps(f + 8); // z2 x3 y3 z3
+
+			__m128 x = _mm_shuffle_ps(l0, _mm_shuffle_ps(l1, l2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+			__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(l0, l1, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(l1, l2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(l0, l1, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(l2, l2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+			_xform_components(coefficients, x, y, z);
+
+			float *w = (float *)(dst + i * sizeof(Vector3));
+			_mm_storeu_ps(w, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(w + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(w + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+	} else {
+		// Points inside larger structs, gathered one component at a time.
+		for (; i + 4 <= p_count; i += 4) {
+			const Vector3 &p0 = *(const Vector3 *)(src + (i + 0) * p_stride);
+			const Vector3 &p1 = *(const Vector3 *)(src + (i + 1) * p_stride);
+			const Vector3 &p2 = *(const Vector3 *)(src + (i + 2) * p_stride);
+			const Vector3 &p3 = *(const Vector3 *)(src + (i + 3) * p_stride);
+			__m128 x = _mm_set_ps(p3.x, p2.x, p1.x, p0.x);
+			__m128 y = _mm_set_ps(p3.y, p2.y, p1.y, p0.y);
+			__m128 z = _mm_set_ps(p3.z, p2.z, p1.z, p0.z);
+
+			_xform_components(coefficients, x, y, z);
+
+			float result[3][4];
+			_mm_storeu_ps(result[0], x);
+			_mm_storeu_ps(result[1], y);
+			_mm_storeu_ps(result[2], z);
+			for (int j = 0; j < 4; j++) {
+				Vector3 &w = *(Vector3 *)(dst + (i + j) * p_stride);
+				w.x = result[0][j];
+				w.y = result[1][j];
+				w.z = result[2][j];
+			}
+		}
+	}
+
+	for (; i < p_count; i++) {
+		*(Vector3 *)(dst + i * p_stride) = p_xform.xform(*(const Vector3 *)(src + i * p_stride));
+	}
+}
+
+#elif defined(MATH_BATCH_NEON)
+
+// Transforms 4 points held by component, keeping the operation order of Transform::xform().
+static _FORCE_INLINE_ float32x4x3_t _xform_components(const float32x4_t *p_rows, const float32x4x3_t &p_points) {
+	float32x4x3_t result;
+	for (int i = 0; i < 3; i++) {
+		const float32x4_t row = p_rows[i];
+		float32x4_t v = vaddq_f32(vmulq_laneq_f32(p_points.val[0], row, 0), vmulq_laneq_f32(p_points.val[1], row, 1));
+		v = vaddq_f32(v, vmulq_laneq_f32(p_points.val[2], row, 2));
+		result.val[i] = vaddq_f32(v, vdupq_laneq_f32(row, 3));
+	}
+	return result;
+}
+
+void MathBatch::xform_points(const Transform &p_xform, const Vector3 *p_src, Vector3 *r_dst, int p_count, int p_stride) {
+	const float32x4_t rows[3] = {
+		_math_batch_transform_row(p_xform, 0),
+		_math_batch_transform_row(p_xform, 1),
+		_math_batch_transform_row(p_xform, 2),
+	};
+	const uint8_t *src = (const uint8_t *)p_src;
+	uint8_t *dst = (uint8_t *)r_dst;
+
+	int i = 0;
+	if (p_stride == sizeof(Vector3)) {
+		// Packed points are split into components, and merged back, by the structure loads and stores.
+		for (; i + 4 <= p_count; i += 4) {
+			const float32x4x3_t points = vld3q_f32((const float *)(src + i * sizeof(Vector3)));
+			vst3q_f32((float *)(dst + i * sizeof(Vector3)), _xform_components(rows, points));
+		}
+	} else {
+		// Points inside larger structs, gathered one component at a time.
+		for (; i + 4 <= p_count; i += 4) {
+			float components[3][4];
+			for (int j = 0; j < 4; j++) {
+				const Vector3 &p = *(const Vector3 *)(src + (i + j) * p_stride);
+				components[0][j] = p.x;
+				components[1][j] = p.y;
+				components[2][j] = p.z;
+			}
+			float32x4x3_t points;
+			points.val[0] = vld1q_f32(components[0]);
+			points.val[1] = vld1q_f32(components[1]);
+			points.val[2] = vld1q_f32(components[2]);
+
+			const float32x4x3_t result = _xform_components(rows, points);
+			vst1q_f32(components[0], result.val[0]);
+			vst1q_f32(components[1], result.val[1]);
+			vst1q_f32(components[2], result.val[2]);
+			for (int j = 0; j < 4; j++) {
+				Vector3 &w = *(Vector3 *)(dst + (i + j) * p_stride);
+				w.x = components[0][j];
+				w.y = components[1][j];
+				w.z = components[2][j];
+			}
+		}
+	}
+
+	for (; i < p_count; i++) {
+		*(Vector3 *)(dst + i * p_stride) = p_xform.xform(*(const Vector3 *)(src + i * p_stride));
+	}
+}
+
+#else
+
+void MathBatch::xform_points(const Transform &p_xform, const Vector3 *p_src, Vector3 *r_dst, int p_count, int p_stride) {
+	const uint8_t *src = (const uint8_t *)p_src;
+	uint8_t *dst = (uint8_t *)r_dst;
+	for (int i = 0; i < p_count; i++) {
+		*(Vector3 *)(dst + i * p_stride) = p_xform.xform(*(const Vector3 *)(src + i * p_stride));
+	}
+}
+
+#endif
+
+void MathBatch::multiply_transforms(const Transform &p_a, const Transform *p_b, Transform *r_dst, int p_count) {
+	for (int i = 0; i < p_count; i++) {
+		multiply_transform(p_a, p_b[i], r_dst[i]);
+	}
+}
+
+void MathBatch::multiply_transforms(const Transform *p_a, const Transform *p_b, Transform *r_dst, int p_count) {
+	for (int i = 0; i < p_count; i++) {
+		multiply_transform(p_a[i], p_b[i], r_dst[i]);
+	}
+}
@@ -0,0 +1,245 @@
+/*************************************************************************/
+/*  math_batch.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef MATH_BATCH_H
+#define MATH_BATCH_H
+
+#include "core/math/plane.h"
+#include "core/math/transform.h"
+
+// The vectorized paths work on 32-bit floats, SSE2 and NEON are always there on the platforms they are enabled for.
+#ifndef REAL_T_IS_DOUBLE
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_BATCH_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MATH_BATCH_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+/**
+ * Math operations over arrays of points, boxes and transforms.
+ *
+ * Each operation has a scalar version and, with 32-bit floats, a SSE2 or NEON
+ * one. They return the same values as the scalar math types, computing the
+ * same products in the same order.
+ */
+class MathBatch {
+public:
+	// Four planes stored by component, so a box can be tested against all of them at once.
+	struct PlaneBlock {
+		real_t normal_x[4];
+		real_t normal_y[4];
+		real_t normal_z[4];
+		real_t d[4];
+	};
+
+	static _FORCE_INLINE_ int get_plane_block_count(int p_plane_count) { return (p_plane_count + 3) / 4; }
+	// r_blocks must have room for get_plane_block_count() blocks. Unused slots get a plane no box is outside of.
+	static void make_plane_blocks(const Plane *p_planes, int p_plane_count, PlaneBlock *r_blocks);
+
+	// Tests a box, given as its minimum then maximum coordinates, against a convex set of planes facing out.
+	// For each plane only the corner furthest behind it is checked, like Plane::distance_to() on that corner,
+	// so boxes near the edges of the convex may be reported inside.
+	static _FORCE_INLINE_ bool is_box_inside(const PlaneBlock *p_blocks, int p_block_count, const real_t *p_min_max);
+	// Sets r_inside[i] to 1 for each box which is inside, 0 otherwise. Boxes are 6 values each, as in is_box_inside().
+	static void cull_boxes(const PlaneBlock *p_blocks, int p_block_count, const real_t *p_min_max, int p_count, uint8_t *r_inside);
+
+	// r_dst[i] = p_xform.xform(p_src[i]). Strides are in bytes, so points can be members of larger structs.
+	// r_dst can be the same array as p_src.
+	static void xform_points(const Transform &p_xform, const Vector3 *p_src, Vector3 *r_dst, int p_count, int p_stride = sizeof(Vector3));
+
+	// r_dst = p_a * p_b. r_dst can be p_a or p_b.
+	static _FORCE_INLINE_ void multiply_transform(const Transform &p_a, const Transform &p_b, Transform &r_dst);
+	// r_dst[i] = p_a * p_b[i].
+	static void multiply_transforms(const Transform &p_a, const Transform *p_b, Transform *r_dst, int p_count);
+	// r_dst[i] = p_a[i] * p_b[i].
+	static void multiply_transforms(const Transform *p_a, const Transform *p_b, Transform *r_dst, int p_count);
+};
+
+#if defined(MATH_BATCH_SSE2)
+
+// A transform row extended with the origin component of that row: basis[p_row] then origin[p_row].
+static _FORCE_INLINE_ __m128 _math_batch_transform_row(const Transform &p_xform, int p_row) {
+	const float *f = &p_xform.basis.elements[0][0];
+	// Rows are loaded 4 at a time, the last lane is then replaced by the origin.
+	const __m128 row = _mm_loadu_ps(f + p_row * 3);
+	const __m128 origin = _mm_loadu_ps(f + 8); // basis[2][2], origin.x, origin.y, origin.z.
+	__m128 pair;
+	switch (p_row) {
+		case 0:
+			pair = _mm_shuffle_ps(row, origin, _MM_SHUFFLE(1, 1, 2, 2));
+			break;
+		case 1:
+			pair = _mm_shuffle_ps(row, origin, _MM_SHUFFLE(2, 2, 2, 2));
+			break;
+		default:
+			pair = _mm_shuffle_ps(row, origin, _MM_SHUFFLE(3, 3, 2, 2));
+			break;
+	}
+	return _mm_shuffle_ps(row, pair, _MM_SHUFFLE(2, 0, 1, 0));
+}
+
+#elif defined(MATH_BATCH_NEON)
+
+static _FORCE_INLINE_ float32x4_t _math_batch_transform_row(const Transform &p_xform, int p_row) {
+	const float *f = &p_xform.basis.elements[0][0];
+	return vsetq_lane_f32(f[9 + p_row], vld1q_f32(f + p_row * 3), 3);
+}
+
+#endif
+
+bool MathBatch::is_box_inside(const PlaneBlock *p_blocks, int p_block_count, const real_t *p_min_max) {
+#if defined(MATH_BATCH_SSE2)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 min_x = _mm_set1_ps(p_min_max[0]);
+	const __m128 min_y = _mm_set1_ps(p_min_max[1]);
+	const __m128 min_z = _mm_set1_ps(p_min_max[2]);
+	const __m128 max_x = _mm_set1_ps(p_min_max[3]);
+	const __m128 max_y = _mm_set1_ps(p_min_max[4]);
+	const __m128 max_z = _mm_set1_ps(p_min_max[5]);
+
+	for (int i = 0; i < p_block_count; i++) {
+		const PlaneBlock &block = p_blocks[i];
+		const __m128 nx = _mm_loadu_ps(block.normal_x);
+		const __m128 ny = _mm_loadu_ps(block.normal_y);
+		const __m128 nz = _mm_loadu_ps(block.normal_z);
+
+		// The minimum coordinate along positive normals, the maximum otherwise.
+		__m128 positive = _mm_cmpgt_ps(nx, zero);
+		const __m128 x = _mm_or_ps(_mm_and_ps(positive, min_x), _mm_andnot_ps(positive, max_x));
+		positive = _mm_cmpgt_ps(ny, zero);
+		const __m128 y = _mm_or_ps(_mm_and_ps(positive, min_y), _mm_andnot_ps(positive, max_y));
+		positive = _mm_cmpgt_ps(nz, zero);
+		const __m128 z = _mm_or_ps(_mm_and_ps(positive, min_z), _mm_andnot_ps(positive, max_z));
+
+		__m128 distance = _mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y));
+		distance = _mm_sub_ps(_mm_add_ps(distance, _mm_mul_ps(nz, z)), _mm_loadu_ps(block.d));
+		if (_mm_movemask_ps(_mm_cmpge_ps(distance, zero))) {
+			return false;
+		}
+	}
+	return true;
+#elif defined(MATH_BATCH_NEON)
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t min_x = vdupq_n_f32(p_min_max[0]);
+	const float32x4_t min_y = vdupq_n_f32(p_min_max[1]);
+	const float32x4_t min_z = vdupq_n_f32(p_min_max[2]);
+	const float32x4_t max_x = vdupq_n_f32(p_min_max[3]);
+	const float32x4_t max_y = vdupq_n_f32(p_min_max[4]);
+	const float32x4_t max_z = vdupq_n_f32(p_min_max[5]);
+
+	for (int i = 0; i < p_block_count; i++) {
+		const PlaneBlock &block = p_blocks[i];
+		const float32x4_t nx = vld1q_f32(block.normal_x);
+		const float32x4_t ny = vld1q_f32(block.normal_y);
+		const float32x4_t nz = vld1q_f32(block.normal_z);
+
+		// The minimum coordinate along positive normals, the maximum otherwise.
+		const float32x4_t x = vbslq_f32(vcgtq_f32(nx, zero), min_x, max_x);
+		const float32x4_t y = vbslq_f32(vcgtq_f32(ny, zero), min_y, max_y);
+		const float32x4_t z = vbslq_f32(vcgtq_f32(nz, zero), min_z, max_z);
+
+		float32x4_t distance = vaddq_f32(vmulq_f32(nx, x), vmulq_f32(ny, y));
+		distance = vsubq_f32(vaddq_f32(distance, vmulq_f32(nz, z)), vld1q_f32(block.d));
+		if (vmaxvq_u32(vcgeq_f32(distance, zero))) {
+			return false;
+		}
+	}
+	return true;
+#else
+	for (int i = 0; i < p_block_count; i++) {
+		const PlaneBlock &block = p_blocks[i];
+		for (int j = 0; j < 4; j++) {
+			Vector3 corner(
+					block.normal_x[j] > 0 ? p_min_max[0] : p_min_max[3],
+					block.normal_y[j] > 0 ? p_min_max[1] : p_min_max[4],
+					block.normal_z[j] > 0 ? p_min_max[2] : p_min_max[5]);
+			if (Plane(block.normal_x[j], block.normal_y[j], block.normal_z[j], block.d[j]).distance_to(corner) >= 0) {
+				return false;
+			}
+		}
+	}
+	return true;
+#endif
+}
+
+void MathBatch::multiply_transform(const Transform &p_a, const Transform &p_b, Transform &r_dst) {
+#if defined(MATH_BATCH_SSE2)
+	const __m128 b0 = _math_batch_transform_row(p_b, 0);
+	const __m128 b1 = _math_batch_transform_row(p_b, 1);
+	const __m128 b2 = _math_batch_transform_row(p_b, 2);
+	const __m128 origin_lane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+	__m128 rows[3];
+	for (int i = 0; i < 3; i++) {
+		// Every row of the result combines the rows of p_b, the origin of p_a is added in the last lane.
+		const __m128 a = _math_batch_transform_row(p_a, i);
+		__m128 row = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b0), _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+		rows[i] = _mm_add_ps(row, _mm_and_ps(a, origin_lane));
+	}
+
+	// Rows overlap the next one by a lane, so they are written in order and the origin last.
+	float *f = &r_dst.basis.elements[0][0];
+	_mm_storeu_ps(f, rows[0]);
+	_mm_storeu_ps(f + 3, rows[1]);
+	_mm_storeu_ps(f + 6, rows[2]);
+	f[9] = _mm_cvtss_f32(_mm_shuffle_ps(rows[0], rows[0], _MM_SHUFFLE(3, 3, 3, 3)));
+	f[10] = _mm_cvtss_f32(_mm_shuffle_ps(rows[1], rows[1], _MM_SHUFFLE(3, 3, 3, 3)));
+	f[11] = _mm_cvtss_f32(_mm_shuffle_ps(rows[2], rows[2], _MM_SHUFFLE(3, 3, 3, 3)));
+#elif defined(MATH_BATCH_NEON)
+	const float32x4_t b0 = _math_batch_transform_row(p_b, 0);
+	const float32x4_t b1 = _math_batch_transform_row(p_b, 1);
+	const float32x4_t b2 = _math_batch_transform_row(p_b, 2);
+
+	float32x4_t rows[3];
+	for (int i = 0; i < 3; i++) {
+		// Every row of the result combines the rows of p_b, the origin of p_a is added in the last lane.
+		const float32x4_t a = _math_batch_transform_row(p_a, i);
+		float32x4_t row = vaddq_f32(vmulq_laneq_f32(b0, a, 0), vmulq_laneq_f32(b1, a, 1));
+		row = vaddq_f32(row, vmulq_laneq_f32(b2, a, 2));
+		rows[i] = vaddq_f32(row, vsetq_lane_f32(vgetq_lane_f32(a, 3), vdupq_n_f32(0.0f), 3));
+	}
+
+	// Rows overlap the next one by a lane, so they are written in order and the origin last.
+	float *f = &r_dst.basis.elements[0][0];
+	vst1q_f32(f, rows[0]);
+	vst1q_f32(f + 3, rows[1]);
+	vst1q_f32(f + 6, rows[2]);
+	f[9] = vgetq_lane_f32(rows[0], 3);
+	f[10] = vgetq_lane_f32(rows[1], 3);
+	f[11] = vgetq_lane_f32(rows[2], 3);
+#else
+	r_dst = p_a * p_b;
+#endif
+}
+
+#endif // MATH_BATCH_H
@@ -32,6 +32,8 @@
 
 #include "core/config/engine.h"
 #include "core/os/mutex.h"
+#include "core/os/spin_lock.h"
+#include "core/variant/variant_internal.h"
 #include "core/version.h"
 
 #define OBJTYPE_RLOCK RWLockRead _rw_lockr_(lock);
@@ -238,10 +240,132 @@ ClassDB::APIType ClassDB::get_current_api() {
 	return current_api;
 }
 
-HashMap<StringName, ClassDB::ClassInfo> ClassDB::classes;
+FlatHashMap<StringName, ClassDB::ClassInfo> ClassDB::classes;
 HashMap<StringName, StringName> ClassDB::resource_base_extensions;
 HashMap<StringName, StringName> ClassDB::compat_classes;
 
+std::atomic<ClassDB::SealedClassDB *> ClassDB::sealed(nullptr);
+LocalVector<ClassDB::SealedClassDB *> ClassDB::retired_sealed;
+static SpinLock retired_sealed_lock;
+
+template <class K, class V>
+static void _seal_hash_map(const HashMap<StringName, K> &p_from, PerfectHashMap<StringName, V> &r_to) {
+	LocalVector<typename PerfectHashMap<StringName, V>::Pair> pairs;
+	pairs.reserve(p_from.size());
+	const StringName *key = nullptr;
+	while ((key = p_from.next(key))) {
+		typename PerfectHashMap<StringName, V>::Pair pair;
+		pair.key = *key;
+		pair.value = *p_from.getptr(*key);
+		pairs.push_back(pair);
+	}
+	r_to.build(pairs);
+}
+
+void ClassDB::seal() {
+	SealedClassDB *db = memnew(SealedClassDB);
+
+	// Published while still locked, so no writer can slip in between.
+	OBJTYPE_RLOCK;
+
+	LocalVector<PerfectHashMap<StringName, uint32_t>::Pair> index_pairs;
+	index_pairs.reserve(classes.size());
+	for (const FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next()) {
+		PerfectHashMap<StringName, uint32_t>::Pair pair;
+		pair.key = E->key();
+		pair.value = index_pairs.size();
+		index_pairs.push_back(pair);
+	}
+	db->class_index.build(index_pairs);
+	db->classes.resize(index_pairs.size());
+
+	uint32_t index = 0;
+	for (const FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next(), index++) {
+		const ClassInfo &ti = E->value();
+		SealedClass &sc = db->classes[index];
+		sc.name = ti.name;
+		sc.inherits = ti.inherits_ptr ? db->get_class(ti.inherits_ptr->name) : nullptr;
+		sc.api = ti.api;
+		sc.disabled = ti.disabled;
+		sc.creation_func = ti.creation_func;
+
+		_seal_hash_map(ti.method_map, sc.methods);
+		_seal_hash_map(ti.property_setget, sc.property_setget);
+		_seal_hash_map(ti.constant_map, sc.constants);
+
+		LocalVector<PerfectHashMap<StringName, bool>::Pair> signal_pairs;
+		const StringName *key = nullptr;
+		while ((key = ti.signal_map.next(key))) {
+			PerfectHashMap<StringName, bool>::Pair pair;
+			pair.key = *key;
+			pair.value = true;
+			signal_pairs.push_back(pair);
+		}
+		sc.signals.build(signal_pairs);
+	}
+
+	// Every class is sealed now, so the properties can point to the tables of the classes they come from.
+	index = 0;
+	for (const FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next(), index++) {
+		SealedClass &sc = db->classes[index];
+
+		HashMap<StringName, SealedProperty> properties;
+		for (const SealedClass *from = &sc; from; from = from->inherits) {
+			const ClassInfo *from_info = classes.getptr(from->name);
+			const StringName *key = nullptr;
+			while ((key = from_info->property_setget.next(key))) {
+				if (properties.has(*key)) {
+					continue; // Overridden by a derived class.
+				}
+
+				SealedProperty property;
+				property.setget = from->property_setget.getptr(*key);
+				for (const SealedClass *derived = &sc; derived != from; derived = derived->inherits) {
+					if (derived->constants.has(*key) || derived->methods.has(*key) || derived->signals.has(*key)) {
+						property.shadowed = true;
+						break;
+					}
+				}
+				properties[*key] = property;
+			}
+		}
+		_seal_hash_map(properties, sc.all_properties);
+	}
+
+	_seal_hash_map(compat_classes, db->compat_classes);
+
+	SealedClassDB *previous = sealed.exchange(db, std::memory_order_acq_rel);
+	if (previous) {
+		retired_sealed_lock.lock();
+		retired_sealed.push_back(previous);
+		retired_sealed_lock.unlock();
+	}
+}
+
+void ClassDB::_unseal() {
+	if (likely(!sealed.load(std::memory_order_relaxed))) {
+		return;
+	}
+
+	SealedClassDB *previous = sealed.exchange(nullptr, std::memory_order_acq_rel);
+	if (previous) {
+		retired_sealed_lock.lock();
+		retired_sealed.push_back(previous);
+		retired_sealed_lock.unlock();
+	}
+}
+
+void ClassDB::_unseal_class(const StringName &p_class) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	if (sealed_db && sealed_db->class_index.has(p_class)) {
+		_unseal();
+	}
+}
+
+bool ClassDB::is_sealed() {
+	return _get_sealed() != nullptr;
+}
+
 bool ClassDB::_is_parent_class(const StringName &p_class, const StringName &p_inherits) {
 	if (!classes.has(p_class)) {
 		return false;
@@ -259,6 +383,17 @@ bool ClassDB::_is_parent_class(const StringName &p_class, const StringName &p_in
 }
 
 bool ClassDB::is_parent_class(const StringName &p_class, const StringName &p_inherits) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+		for (const SealedClass *check = sc; check; check = check->inherits) {
+			if (check->name == p_inherits) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	OBJTYPE_RLOCK;
 
 	return _is_parent_class(p_class, p_inherits);
@@ -267,10 +402,8 @@ bool ClassDB::is_parent_class(const StringName &p_class, const StringName &p_inh
 void ClassDB::get_class_list(List<StringName> *p_classes) {
 	OBJTYPE_RLOCK;
 
-	const StringName *k = nullptr;
-
-	while ((k = classes.next(k))) {
-		p_classes->push_back(*k);
+	for (const FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next()) {
+		p_classes->push_back(E->key());
 	}
 
 	p_classes->sort();
@@ -279,11 +412,9 @@ void ClassDB::get_class_list(List<StringName> *p_classes) {
 void ClassDB::get_inheriters_from_class(const StringName &p_class, List<StringName> *p_classes) {
 	OBJTYPE_RLOCK;
 
-	const StringName *k = nullptr;
-
-	while ((k = classes.next(k))) {
-		if (*k != p_class && _is_parent_class(*k, p_class)) {
-			p_classes->push_back(*k);
+	for (const FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next()) {
+		if (E->key() != p_class && _is_parent_class(E->key(), p_class)) {
+			p_classes->push_back(E->key());
 		}
 	}
 }
@@ -291,16 +422,20 @@ void ClassDB::get_inheriters_from_class(const StringName &p_class, List<StringNa
 void ClassDB::get_direct_inheriters_from_class(const StringName &p_class, List<StringName> *p_classes) {
 	OBJTYPE_RLOCK;
 
-	const StringName *k = nullptr;
-
-	while ((k = classes.next(k))) {
-		if (*k != p_class && _get_parent_class(*k) == p_class) {
-			p_classes->push_back(*k);
+	for (const FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next()) {
+		if (E->key() != p_class && _get_parent_class(E->key()) == p_class) {
+			p_classes->push_back(E->key());
 		}
 	}
 }
 
 StringName ClassDB::get_parent_class_nocheck(const StringName &p_class) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+		return sc->inherits ? sc->inherits->name : StringName();
+	}
+
 	OBJTYPE_RLOCK;
 
 	ClassInfo *ti = classes.getptr(p_class);
@@ -329,6 +464,12 @@ StringName ClassDB::_get_parent_class(const StringName &p_class) {
 }
 
 StringName ClassDB::get_parent_class(const StringName &p_class) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+		return sc->inherits ? sc->inherits->name : StringName();
+	}
+
 	OBJTYPE_RLOCK;
 
 	return _get_parent_class(p_class);
@@ -351,11 +492,11 @@ uint64_t ClassDB::get_api_hash(APIType p_api) {
 
 	List<StringName> names;
 
-	const StringName *k = nullptr;
-
-	while ((k = classes.next(k))) {
-		names.push_back(*k);
+	for (const FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next()) {
+		names.push_back(E->key());
 	}
+
+	const StringName *k = nullptr;
 	//must be alphabetically sorted for hash to compute
 	names.sort_custom<StringName::AlphCompare>();
 
@@ -492,20 +633,44 @@ uint64_t ClassDB::get_api_hash(APIType p_api) {
 }
 
 bool ClassDB::class_exists(const StringName &p_class) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	if (likely(sealed_db) && sealed_db->class_index.has(p_class)) {
+		return true;
+	}
+
 	OBJTYPE_RLOCK;
 	return classes.has(p_class);
 }
 
 void ClassDB::add_compatibility_class(const StringName &p_class, const StringName &p_fallback) {
 	OBJTYPE_WLOCK;
+	_unseal();
 	compat_classes[p_class] = p_fallback;
 }
 
 Object *ClassDB::instance(const StringName &p_class) {
-	ClassInfo *ti;
-	{
+	Object *(*creation_func)() = nullptr;
+	APIType api = API_NONE;
+
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = nullptr;
+	if (likely(sealed_db)) {
+		sc = sealed_db->get_class(p_class);
+		if (!sc || sc->disabled || !sc->creation_func) {
+			const StringName *compat = sealed_db->compat_classes.getptr(p_class);
+			if (compat) {
+				sc = sealed_db->get_class(*compat);
+			}
+		}
+	}
+	if (likely(sc)) {
+		ERR_FAIL_COND_V_MSG(sc->disabled, nullptr, "Class '" + String(p_class) + "' is disabled.");
+		ERR_FAIL_COND_V(!sc->creation_func, nullptr);
+		creation_func = sc->creation_func;
+		api = sc->api;
+	} else {
 		OBJTYPE_RLOCK;
-		ti = classes.getptr(p_class);
+		ClassInfo *ti = classes.getptr(p_class);
 		if (!ti || ti->disabled || !ti->creation_func) {
 			if (compat_classes.has(p_class)) {
 				ti = classes.getptr(compat_classes[p_class]);
@@ -514,17 +679,63 @@ Object *ClassDB::instance(const StringName &p_class) {
 		ERR_FAIL_COND_V_MSG(!ti, nullptr, "Cannot get class '" + String(p_class) + "'.");
 		ERR_FAIL_COND_V_MSG(ti->disabled, nullptr, "Class '" + String(p_class) + "' is disabled.");
 		ERR_FAIL_COND_V(!ti->creation_func, nullptr);
+		creation_func = ti->creation_func;
+		api = ti->api;
 	}
 #ifdef TOOLS_ENABLED
-	if (ti->api == API_EDITOR && !Engine::get_singleton()->is_editor_hint()) {
+	if (api == API_EDITOR && !Engine::get_singleton()->is_editor_hint()) {
 		ERR_PRINT("Class '" + String(p_class) + "' can only be instantiated by editor.");
 		return nullptr;
 	}
+#else
+	(void)api;
 #endif
-	return ti->creation_func();
+	return creation_func();
+}
+
+ClassDB::CreationFunc ClassDB::get_creation_func(const StringName &p_class) {
+	CreationFunc creation_func = nullptr;
+	APIType api = API_NONE;
+
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+		if (sc->disabled) {
+			return nullptr;
+		}
+		creation_func = sc->creation_func;
+		api = sc->api;
+	} else {
+		OBJTYPE_RLOCK;
+		ClassInfo *ti = classes.getptr(p_class);
+		if (!ti || ti->disabled) {
+			return nullptr;
+		}
+		creation_func = ti->creation_func;
+		api = ti->api;
+	}
+#ifdef TOOLS_ENABLED
+	if (api == API_EDITOR && !Engine::get_singleton()->is_editor_hint()) {
+		return nullptr;
+	}
+#else
+	(void)api;
+#endif
+	return creation_func;
 }
 
 bool ClassDB::can_instance(const StringName &p_class) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+#ifdef TOOLS_ENABLED
+		if (sc->api == API_EDITOR && !Engine::get_singleton()->is_editor_hint()) {
+			return false;
+		}
+#endif
+		return (!sc->disabled && sc->creation_func != nullptr);
+	}
+
 	OBJTYPE_RLOCK;
 
 	ClassInfo *ti = classes.getptr(p_class);
@@ -538,14 +749,14 @@ bool ClassDB::can_instance(const StringName &p_class) {
 }
 
 void ClassDB::_add_class2(const StringName &p_class, const StringName &p_inherits) {
+	// Not unsealed, the new class is looked up in the locked tables until the next seal().
 	OBJTYPE_WLOCK;
 
 	const StringName &name = p_class;
 
 	ERR_FAIL_COND_MSG(classes.has(name), "Class '" + String(p_class) + "' already exists.");
 
-	classes[name] = ClassInfo();
-	ClassInfo &ti = classes[name];
+	ClassInfo &ti = classes.insert(name, ClassInfo())->value();
 	ti.name = name;
 	ti.inherits = p_inherits;
 	ti.api = current_api;
@@ -687,6 +898,18 @@ bool ClassDB::get_method_info(StringName p_class, StringName p_method, MethodInf
 }
 
 MethodBind *ClassDB::get_method(StringName p_class, StringName p_name) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+		for (const SealedClass *check = sc; check; check = check->inherits) {
+			MethodBind *const *method = check->methods.getptr(p_name);
+			if (method && *method) {
+				return *method;
+			}
+		}
+		return nullptr;
+	}
+
 	OBJTYPE_RLOCK;
 
 	ClassInfo *type = classes.getptr(p_class);
@@ -703,6 +926,7 @@ MethodBind *ClassDB::get_method(StringName p_class, StringName p_name) {
 
 void ClassDB::bind_integer_constant(const StringName &p_class, const StringName &p_enum, const StringName &p_name, int p_constant) {
 	OBJTYPE_WLOCK;
+	_unseal_class(p_class);
 
 	ClassInfo *type = classes.getptr(p_class);
 
@@ -892,6 +1116,7 @@ bool ClassDB::has_enum(const StringName &p_class, const StringName &p_name, bool
 
 void ClassDB::add_signal(StringName p_class, const MethodInfo &p_signal) {
 	OBJTYPE_WLOCK;
+	_unseal_class(p_class);
 
 	ClassInfo *type = classes.getptr(p_class);
 	ERR_FAIL_COND(!type);
@@ -1018,6 +1243,7 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
 #endif
 
 	OBJTYPE_WLOCK
+	_unseal_class(p_class);
 
 	type->property_list.push_back(p_pinfo);
 	type->property_map[p_pinfo.name] = p_pinfo;
@@ -1036,6 +1262,22 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
 	psg._getptr = mb_get;
 	psg.index = p_index;
 	psg.type = p_pinfo.type;
+#ifdef DEBUG_METHODS_ENABLED
+	// Objects are left to call(), which checks their class.
+	if (mb_set && !mb_set->is_vararg() && (p_index < 0 || mb_set->get_argument_type(0) == Variant::INT)) {
+		Variant::Type set_type = mb_set->get_argument_type(p_index >= 0 ? 1 : 0);
+		if (set_type != Variant::OBJECT) {
+			psg._set_ptr_type = set_type;
+		}
+	}
+	// Indexed getters are called through the object, which scripts can override.
+	if (mb_get && p_index < 0 && !mb_get->is_vararg() && mb_get->has_return()) {
+		Variant::Type get_type = mb_get->get_argument_type(-1);
+		if (get_type != Variant::OBJECT) {
+			psg._get_ptr_type = get_type;
+		}
+	}
+#endif
 
 	type->property_setget[p_pinfo.name] = psg;
 }
@@ -1094,81 +1336,205 @@ bool ClassDB::get_property_info(StringName p_class, StringName p_property, Prope
 	return false;
 }
 
-bool ClassDB::set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid) {
-	ERR_FAIL_NULL_V(p_object, false);
+const ClassDB::PropertySetGet *ClassDB::_get_property_setget(const StringName &p_class, const StringName &p_property) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+		const SealedProperty *property = sc->all_properties.getptr(p_property);
+		return property ? property->setget : nullptr;
+	}
 
-	ClassInfo *type = classes.getptr(p_object->get_class_name());
-	ClassInfo *check = type;
+	ClassInfo *check = classes.getptr(p_class);
 	while (check) {
 		const PropertySetGet *psg = check->property_setget.getptr(p_property);
 		if (psg) {
-			if (!psg->setter) {
-				if (r_valid) {
-					*r_valid = false;
-				}
-				return true; //return true but do nothing
-			}
+			return psg;
+		}
+		check = check->inherits_ptr;
+	}
+	return nullptr;
+}
 
-			Callable::CallError ce;
+static bool _call_property_setter(Object *p_object, const ClassDB::PropertySetGet *psg, const Variant &p_value) {
+	Callable::CallError ce;
 
-			if (psg->index >= 0) {
-				Variant index = psg->index;
-				const Variant *arg[2] = { &index, &p_value };
-				//p_object->call(psg->setter,arg,2,ce);
-				if (psg->_setptr) {
-					psg->_setptr->call(p_object, arg, 2, ce);
-				} else {
-					p_object->call(psg->setter, arg, 2, ce);
-				}
+	if (psg->_set_ptr_type != Variant::VARIANT_MAX && (psg->_set_ptr_type == Variant::NIL || psg->_set_ptr_type == p_value.get_type())) {
+		const void *value = psg->_set_ptr_type == Variant::NIL ? &p_value : VariantInternal::get_opaque_pointer(&p_value);
+		if (psg->index >= 0) {
+			int64_t index = psg->index;
+			const void *args[2] = { &index, value };
+			psg->_setptr->ptrcall(p_object, args, nullptr);
+		} else {
+			psg->_setptr->ptrcall(p_object, &value, nullptr);
+		}
 
-			} else {
-				const Variant *arg[1] = { &p_value };
-				if (psg->_setptr) {
-					psg->_setptr->call(p_object, arg, 1, ce);
-				} else {
-					p_object->call(psg->setter, arg, 1, ce);
-				}
-			}
+	} else if (psg->index >= 0) {
+		Variant index = psg->index;
+		const Variant *arg[2] = { &index, &p_value };
+		//p_object->call(psg->setter,arg,2,ce);
+		if (psg->_setptr) {
+			psg->_setptr->call(p_object, arg, 2, ce);
+		} else {
+			p_object->call(psg->setter, arg, 2, ce);
+		}
+
+	} else {
+		const Variant *arg[1] = { &p_value };
+		if (psg->_setptr) {
+			psg->_setptr->call(p_object, arg, 1, ce);
+		} else {
+			p_object->call(psg->setter, arg, 1, ce);
+		}
+	}
+
+	return ce.error == Callable::CallError::CALL_OK;
+}
+
+bool ClassDB::set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid) {
+	ERR_FAIL_NULL_V(p_object, false);
+
+	const PropertySetGet *psg = _get_property_setget(p_object->get_class_name(), p_property);
+	if (!psg) {
+		return false;
+	}
+
+	if (!psg->setter) {
+		if (r_valid) {
+			*r_valid = false;
+		}
+		return true; //return true but do nothing
+	}
+
+	bool valid = _call_property_setter(p_object, psg, p_value);
+	if (r_valid) {
+		*r_valid = valid;
+	}
+
+	return true;
+}
+
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	if (likely(sealed_db) && sealed_db->class_index.has(p_class)) {
+		return _get_property_setget(p_class, p_property);
+	}
+
+	OBJTYPE_RLOCK;
+	return _get_property_setget(p_class, p_property);
+}
 
-			if (r_valid) {
-				*r_valid = ce.error == Callable::CallError::CALL_OK;
+bool ClassDB::call_property_setter(Object *p_object, const PropertySetGet *p_setget, const Variant &p_value) {
+	ERR_FAIL_NULL_V(p_object, false);
+	ERR_FAIL_NULL_V(p_setget, false);
+	if (!p_setget->setter) {
+		return false;
+	}
+	return _call_property_setter(p_object, p_setget, p_value);
+}
+
+int ClassDB::set_properties(Object *p_object, const StringName *p_properties, const Variant *const *p_values, int p_count) {
+	ERR_FAIL_NULL_V(p_object, 0);
+
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_object->get_class_name()) : nullptr;
+	if (unlikely(!sc)) {
+		for (int i = 0; i < p_count; i++) {
+			if (!set_property(p_object, p_properties[i], *p_values[i])) {
+				return i;
 			}
+		}
+		return p_count;
+	}
 
-			return true;
+	for (int i = 0; i < p_count; i++) {
+		const SealedProperty *property = sc->all_properties.getptr(p_properties[i]);
+		if (!property) {
+			return i;
+		}
+		if (property->setget->setter) {
+			_call_property_setter(p_object, property->setget, *p_values[i]);
 		}
+	}
+	return p_count;
+}
 
-		check = check->inherits_ptr;
+static void _call_property_getter(Object *p_object, const ClassDB::PropertySetGet *psg, Variant &r_value) {
+	if (!psg->getter) {
+		return; //do nothing
 	}
 
+	if (psg->_get_ptr_type != Variant::VARIANT_MAX) {
+		if (psg->_get_ptr_type == Variant::NIL) {
+			psg->_getptr->ptrcall(p_object, nullptr, &r_value);
+		} else {
+			VariantInternal::initialize(&r_value, psg->_get_ptr_type);
+			psg->_getptr->ptrcall(p_object, nullptr, VariantInternal::get_opaque_pointer(&r_value));
+		}
+
+	} else if (psg->index >= 0) {
+		Variant index = psg->index;
+		const Variant *arg[1] = { &index };
+		Callable::CallError ce;
+		r_value = p_object->call(psg->getter, arg, 1, ce);
+
+	} else {
+		Callable::CallError ce;
+		if (psg->_getptr) {
+			r_value = psg->_getptr->call(p_object, nullptr, 0, ce);
+		} else {
+			r_value = p_object->call(psg->getter, nullptr, 0, ce);
+		}
+	}
+}
+
+bool ClassDB::_get_sealed_property(const SealedClass *p_class, Object *p_object, const StringName &p_property, Variant &r_value) {
+	const SealedProperty *property = p_class->all_properties.getptr(p_property);
+	if (property && !property->shadowed) {
+		_call_property_getter(p_object, property->setget, r_value);
+		return true;
+	}
+
+	for (const SealedClass *check = p_class; check; check = check->inherits) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+			_call_property_getter(p_object, psg, r_value);
+			return true;
+		}
+
+		const int *c = check->constants.getptr(p_property); //constants count
+		if (c) {
+			r_value = *c;
+			return true;
+		}
+
+		if (check->methods.has(p_property)) { //methods count
+			r_value = Callable(p_object, p_property);
+			return true;
+		}
+
+		if (check->signals.has(p_property)) { //signals count
+			r_value = Signal(p_object, p_property);
+			return true;
+		}
+	}
 	return false;
 }
 
 bool ClassDB::get_property(Object *p_object, const StringName &p_property, Variant &r_value) {
 	ERR_FAIL_NULL_V(p_object, false);
 
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_object->get_class_name()) : nullptr;
+	if (likely(sc)) {
+		return _get_sealed_property(sc, p_object, p_property, r_value);
+	}
+
 	ClassInfo *type = classes.getptr(p_object->get_class_name());
 	ClassInfo *check = type;
 	while (check) {
 		const PropertySetGet *psg = check->property_setget.getptr(p_property);
 		if (psg) {
-			if (!psg->getter) {
-				return true; //return true but do nothing
-			}
-
-			if (psg->index >= 0) {
-				Variant index = psg->index;
-				const Variant *arg[1] = { &index };
-				Callable::CallError ce;
-				r_value = p_object->call(psg->getter, arg, 1, ce);
-
-			} else {
-				Callable::CallError ce;
-				if (psg->_getptr) {
-					r_value = psg->_getptr->call(p_object, nullptr, 0, ce);
-				} else {
-					r_value = p_object->call(psg->getter, nullptr, 0, ce);
-				}
-			}
+			_call_property_getter(p_object, psg, r_value);
 			return true;
 		}
 
@@ -1194,48 +1560,39 @@ bool ClassDB::get_property(Object *p_object, const StringName &p_property, Varia
 	return false;
 }
 
-int ClassDB::get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
-	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
-			if (r_is_valid) {
-				*r_is_valid = true;
-			}
+void ClassDB::get_properties(Object *p_object, const StringName *p_properties, int p_count, Variant *r_values, bool *r_handled) {
+	ERR_FAIL_NULL(p_object);
 
-			return psg->index;
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_object->get_class_name()) : nullptr;
+	if (unlikely(!sc)) {
+		for (int i = 0; i < p_count; i++) {
+			r_handled[i] = get_property(p_object, p_properties[i], r_values[i]);
 		}
+		return;
+	}
 
-		check = check->inherits_ptr;
+	for (int i = 0; i < p_count; i++) {
+		r_handled[i] = _get_sealed_property(sc, p_object, p_properties[i], r_values[i]);
 	}
+}
+
+int ClassDB::get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
+	const PropertySetGet *psg = _get_property_setget(p_class, p_property);
 	if (r_is_valid) {
-		*r_is_valid = false;
+		*r_is_valid = psg != nullptr;
 	}
 
-	return -1;
+	return psg ? psg->index : -1;
 }
 
 Variant::Type ClassDB::get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
-	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
-			if (r_is_valid) {
-				*r_is_valid = true;
-			}
-
-			return psg->type;
-		}
-
-		check = check->inherits_ptr;
-	}
+	const PropertySetGet *psg = _get_property_setget(p_class, p_property);
 	if (r_is_valid) {
-		*r_is_valid = false;
+		*r_is_valid = psg != nullptr;
 	}
 
-	return Variant::NIL;
+	return psg ? psg->type : Variant::NIL;
 }
 
 StringName ClassDB::get_property_setter(StringName p_class, const StringName &p_property) {
@@ -1295,6 +1652,20 @@ void ClassDB::set_method_flags(StringName p_class, StringName p_method, int p_fl
 }
 
 bool ClassDB::has_method(StringName p_class, StringName p_method, bool p_no_inheritance) {
+	const SealedClassDB *sealed_db = _get_sealed();
+	const SealedClass *sc = sealed_db ? sealed_db->get_class(p_class) : nullptr;
+	if (likely(sc)) {
+		for (const SealedClass *check = sc; check; check = check->inherits) {
+			if (check->methods.has(p_method)) {
+				return true;
+			}
+			if (p_no_inheritance) {
+				return false;
+			}
+		}
+		return false;
+	}
+
 	ClassInfo *type = classes.getptr(p_class);
 	ClassInfo *check = type;
 	while (check) {
@@ -1323,6 +1694,7 @@ MethodBind *ClassDB::bind_methodfi(uint32_t p_flags, MethodBind *p_bind, const c
 	p_bind->set_name(mdname);
 
 	String instance_type = p_bind->get_instance_class();
+	_unseal_class(instance_type);
 
 #ifdef DEBUG_ENABLED
 
@@ -1406,6 +1778,7 @@ void ClassDB::get_virtual_methods(const StringName &p_class, List<MethodInfo> *p
 
 void ClassDB::set_class_enabled(StringName p_class, bool p_enable) {
 	OBJTYPE_WLOCK;
+	_unseal_class(p_class);
 
 	ERR_FAIL_COND_MSG(!classes.has(p_class), "Request for nonexistent class '" + p_class + "'.");
 	classes[p_class].disabled = !p_enable;
@@ -1555,10 +1928,14 @@ void ClassDB::cleanup_defaults() {
 void ClassDB::cleanup() {
 	//OBJTYPE_LOCK; hah not here
 
-	const StringName *k = nullptr;
+	_unseal();
+	for (uint32_t i = 0; i < retired_sealed.size(); i++) {
+		memdelete(retired_sealed[i]);
+	}
+	retired_sealed.clear();
 
-	while ((k = classes.next(k))) {
-		ClassInfo &ti = classes[*k];
+	for (FlatHashMap<StringName, ClassInfo>::Element *E = classes.front(); E; E = E->next()) {
+		ClassInfo &ti = E->value();
 
 		const StringName *m = nullptr;
 		while ((m = ti.method_map.next(m))) {
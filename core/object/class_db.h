@@ -34,6 +34,9 @@
 #include "core/object/method_bind.h"
 #include "core/object/object.h"
 #include "core/string/print_string.h"
+#include "core/templates/perfect_hash_map.h"
+
+#include <atomic>
 
 /** To bind more then 6 parameters include this:
  *
@@ -108,6 +111,10 @@ public:
 		MethodBind *_setptr;
 		MethodBind *_getptr;
 		Variant::Type type;
+		// Types taken by the setter and returned by the getter when they can be called with ptrcall(),
+		// NIL meaning a Variant. VARIANT_MAX when they can't, or argument types aren't known (release builds).
+		Variant::Type _set_ptr_type = Variant::VARIANT_MAX;
+		Variant::Type _get_ptr_type = Variant::VARIANT_MAX;
 	};
 
 	struct ClassInfo {
@@ -147,7 +154,7 @@ public:
 	}
 
 	static RWLock lock;
-	static HashMap<StringName, ClassInfo> classes;
+	static FlatHashMap<StringName, ClassInfo> classes;
 	static HashMap<StringName, StringName> resource_base_extensions;
 	static HashMap<StringName, StringName> compat_classes;
 
@@ -165,11 +172,58 @@ public:
 	static Set<StringName> default_values_cached;
 
 private:
+	// Copy of the class tables made by seal(), it is never modified so it can be read without locking.
+	struct SealedProperty {
+		const PropertySetGet *setget = nullptr;
+		// A constant, method or signal of a derived class has the same name, which get_property() returns instead.
+		bool shadowed = false;
+	};
+
+	struct SealedClass {
+		StringName name;
+		const SealedClass *inherits = nullptr;
+		APIType api = API_NONE;
+		bool disabled = false;
+		Object *(*creation_func)() = nullptr;
+		PerfectHashMap<StringName, MethodBind *> methods;
+		PerfectHashMap<StringName, PropertySetGet> property_setget;
+		PerfectHashMap<StringName, int> constants;
+		PerfectHashMap<StringName, bool> signals;
+		// Properties of the class and of the classes it inherits, so they are found with a single lookup.
+		PerfectHashMap<StringName, SealedProperty> all_properties;
+	};
+
+	struct SealedClassDB {
+		LocalVector<SealedClass> classes;
+		PerfectHashMap<StringName, uint32_t> class_index;
+		PerfectHashMap<StringName, StringName> compat_classes;
+
+		_FORCE_INLINE_ const SealedClass *get_class(const StringName &p_class) const {
+			const uint32_t *index = class_index.getptr(p_class);
+			return index ? &classes[*index] : nullptr;
+		}
+	};
+
+	static std::atomic<SealedClassDB *> sealed;
+	// Readers may still be using the tables which were unsealed, they are freed by cleanup().
+	static LocalVector<SealedClassDB *> retired_sealed;
+
+	_FORCE_INLINE_ static const SealedClassDB *_get_sealed() {
+		return sealed.load(std::memory_order_acquire);
+	}
+
 	// Non-locking variants of get_parent_class and is_parent_class.
 	static StringName _get_parent_class(const StringName &p_class);
 	static bool _is_parent_class(const StringName &p_class, const StringName &p_inherits);
+	static const PropertySetGet *_get_property_setget(const StringName &p_class, const StringName &p_property);
+	static bool _get_sealed_property(const SealedClass *p_class, Object *p_object, const StringName &p_property, Variant &r_value);
 
 public:
+	// Called by everything that modifies the class tables, lookups take the lock again until the next seal().
+	static void _unseal();
+	// Classes registered after seal() are not in the sealed tables, so changing them doesn't unseal.
+	static void _unseal_class(const StringName &p_class);
+
 	// DO NOT USE THIS!!!!!! NEEDS TO BE PUBLIC BUT DO NOT USE NO MATTER WHAT!!!
 	template <class T>
 	static void _add_class() {
@@ -179,6 +233,7 @@ public:
 	template <class T>
 	static void register_class() {
 		GLOBAL_LOCK_FUNCTION;
+		_unseal_class(T::get_class_static());
 		T::initialize_class();
 		ClassInfo *t = classes.getptr(T::get_class_static());
 		ERR_FAIL_COND(!t);
@@ -191,6 +246,7 @@ public:
 	template <class T>
 	static void register_virtual_class() {
 		GLOBAL_LOCK_FUNCTION;
+		_unseal_class(T::get_class_static());
 		T::initialize_class();
 		ClassInfo *t = classes.getptr(T::get_class_static());
 		ERR_FAIL_COND(!t);
@@ -207,6 +263,7 @@ public:
 	template <class T>
 	static void register_custom_instance_class() {
 		GLOBAL_LOCK_FUNCTION;
+		_unseal_class(T::get_class_static());
 		T::initialize_class();
 		ClassInfo *t = classes.getptr(T::get_class_static());
 		ERR_FAIL_COND(!t);
@@ -226,6 +283,9 @@ public:
 	static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
 	static bool can_instance(const StringName &p_class);
 	static Object *instance(const StringName &p_class);
+	typedef Object *(*CreationFunc)();
+	// The function instance() would call, or null when it would fail (compat classes are not resolved).
+	static CreationFunc get_creation_func(const StringName &p_class);
 	static APIType get_api_type(const StringName &p_class);
 
 	static uint64_t get_api_hash(APIType p_api);
@@ -312,6 +372,7 @@ public:
 		bind->set_default_arguments(p_default_args);
 
 		String instance_type = bind->get_instance_class();
+		_unseal_class(instance_type);
 
 		ClassInfo *type = classes.getptr(instance_type);
 		if (!type) {
@@ -347,6 +408,15 @@ public:
 	static bool get_property_info(StringName p_class, StringName p_property, PropertyInfo *r_info, bool p_no_inheritance = false, const Object *p_validator = nullptr);
 	static bool set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid = nullptr);
 	static bool get_property(Object *p_object, const StringName &p_property, Variant &r_value);
+	// Batched versions of set_property() and get_property(), the class of the object is only looked up once.
+	// Properties are set in order until one isn't a property of the class, returns how many were set.
+	static int set_properties(Object *p_object, const StringName *p_properties, const Variant *const *p_values, int p_count);
+	// r_handled receives what get_property() would return for each property.
+	static void get_properties(Object *p_object, const StringName *p_properties, int p_count, Variant *r_values, bool *r_handled);
+	// Resolved once for callers which set the same properties on many objects of one class (see SceneState::instance()).
+	// Only stable while the tables are sealed, the returned setter then stays valid until cleanup().
+	static const PropertySetGet *get_property_setget(const StringName &p_class, const StringName &p_property);
+	static bool call_property_setter(Object *p_object, const PropertySetGet *p_setget, const Variant &p_value);
 	static bool has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance = false);
 	static int get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid = nullptr);
 	static Variant::Type get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid = nullptr);
@@ -390,6 +460,15 @@ public:
 
 	static void set_current_api(APIType p_api);
 	static APIType get_current_api();
+
+	// Freezes the class tables once the types are registered, so the most
+	// common lookups (get_method(), instance(), is_parent_class(), etc.) no
+	// longer lock. Changing a sealed class afterwards unseals them, while
+	// classes registered later (e.g. lazily, when first created) are looked
+	// up in the locked tables and keep the others sealed.
+	static void seal();
+	static bool is_sealed();
+
 	static void cleanup_defaults();
 	static void cleanup();
 };
@@ -33,15 +33,133 @@
 #include "core/config/project_settings.h"
 #include "core/core_string_names.h"
 #include "core/object/script_language.h"
+#include "core/os/os.h"
 
 MessageQueue *MessageQueue::singleton = nullptr;
+uint32_t MessageQueue::last_queue_id = 0;
+thread_local MessageQueue::ThreadSegment MessageQueue::thread_segment;
+
+MessageQueue::ThreadSegment::~ThreadSegment() {
+	// Threads are expected to be finished before the queue is destroyed, the
+	// segment is freed by the next flush once it has been emptied.
+	if (segment && singleton && singleton->queue_id == queue_id) {
+		segment->lock.lock();
+		segment->orphaned = true;
+		segment->lock.unlock();
+	}
+}
 
 MessageQueue *MessageQueue::get_singleton() {
 	return singleton;
 }
 
-Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
-	return push_callable(Callable(p_id, p_method), p_args, p_argcount, p_show_error);
+MessageQueue::Segment *MessageQueue::_create_segment() {
+	Segment *segment = memnew(Segment);
+
+	mutex.lock();
+	segments.push_back(segment);
+	mutex.unlock();
+
+	thread_segment.queue_id = queue_id;
+	thread_segment.segment = segment;
+	return segment;
+}
+
+MessageQueue::Page *MessageQueue::_alloc_page(uint32_t p_min_size) {
+	if (p_min_size <= PAGE_SIZE) {
+		page_lock.lock();
+		Page *page = free_pages;
+		if (page) {
+			free_pages = page->next;
+			free_page_bytes -= PAGE_SIZE;
+		}
+		page_lock.unlock();
+
+		if (page) {
+			page->next = nullptr;
+			page->used = 0;
+			return page;
+		}
+	}
+
+	// Messages which don't fit in a regular page get one of their own.
+	uint32_t size = MAX(p_min_size, (uint32_t)PAGE_SIZE);
+	Page *page = (Page *)memalloc(sizeof(Page) + size);
+	memnew_placement(page, Page);
+	page->size = size;
+	return page;
+}
+
+void MessageQueue::_free_page(Page *p_page) {
+	if (p_page->size == PAGE_SIZE) {
+		page_lock.lock();
+		if (free_page_bytes + PAGE_SIZE <= retained_size) {
+			p_page->next = free_pages;
+			free_pages = p_page;
+			free_page_bytes += PAGE_SIZE;
+			p_page = nullptr;
+		}
+		page_lock.unlock();
+	}
+
+	if (p_page) {
+		memfree(p_page);
+	}
+}
+
+// Must be called with the segment locked.
+MessageQueue::Message *MessageQueue::_alloc_message(Segment *p_segment, int p_argcount) {
+	uint32_t size = sizeof(Message) + sizeof(Variant) * p_argcount;
+
+	Page *page = p_segment->last;
+	if (!page || page->used + size > page->size) {
+		page = _alloc_page(size);
+		if (p_segment->last) {
+			p_segment->last->next = page;
+		} else {
+			p_segment->first = page;
+		}
+		p_segment->last = page;
+	}
+
+	Message *msg = memnew_placement(page->get_data() + page->used, Message);
+	page->used += size;
+	msg->sequence = sequence.increment();
+	return msg;
+}
+
+// Must be called with the segment locked.
+MessageQueue::Message *MessageQueue::_find_coalescable(Segment *p_segment, uint32_t p_hash, const Callable &p_callable) {
+	Message *pending = nullptr;
+	if (!p_segment->pending.lookup(p_hash, pending) || pending->callable != p_callable) {
+		return nullptr;
+	}
+
+	Message *last = nullptr;
+	p_segment->last_for_object.lookup(uint64_t(p_callable.get_object_id()), last);
+	return last == pending ? pending : nullptr;
+}
+
+uint32_t MessageQueue::_get_message_size(const Message *p_message) {
+	uint32_t size = sizeof(Message);
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		size += sizeof(Variant) * p_message->args;
+	}
+	return size;
+}
+
+void MessageQueue::_destroy_message(Message *p_message) {
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
+	p_message->~Message();
+}
+
+Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error, bool p_coalesce) {
+	return push_callable(Callable(p_id, p_method), p_args, p_argcount, p_show_error, p_coalesce);
 }
 
 Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT_ARG_DECLARE) {
@@ -60,56 +178,46 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 }
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
-	_THREAD_SAFE_METHOD_
-
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id)) {
-			type = ObjectDB::get_instance(p_id)->get_class();
-		}
-		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
+	Callable callable(p_id, p_prop);
+	uint32_t hash = hash_djb2_one_32(TYPE_SET, callable.hash());
+
+	Segment *segment = _get_segment();
+	segment->lock.lock();
+
+	Message *pending = _find_coalescable(segment, hash, callable);
+	if (pending && (pending->type & FLAG_MASK) == TYPE_SET) {
+		// Only the last value would be visible after the flush anyway.
+		*(Variant *)(pending + 1) = p_value;
+		segment->coalesced++;
+		segment->lock.unlock();
+		return OK;
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = _alloc_message(segment, 1);
 	msg->args = 1;
-	msg->callable = Callable(p_id, p_prop);
+	msg->callable = callable;
 	msg->type = TYPE_SET;
+	memnew_placement(msg + 1, Variant(p_value));
+	segment->pending.set(hash, msg);
+	segment->last_for_object.set(uint64_t(p_id), msg);
 
-	buffer_end += sizeof(Message);
-
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
-	*v = p_value;
-
+	segment->lock.unlock();
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
-
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Segment *segment = _get_segment();
+	segment->lock.lock();
 
+	Message *msg = _alloc_message(segment, 0);
 	msg->type = TYPE_NOTIFICATION;
 	msg->callable = Callable(p_id, CoreStringNames::get_singleton()->notification); //name is meaningless but callable needs it
-	//msg->target;
 	msg->notification = p_notification;
+	segment->last_for_object.set(uint64_t(p_id), msg);
 
-	buffer_end += sizeof(Message);
-
+	segment->lock.unlock();
 	return OK;
 }
 
@@ -125,18 +233,48 @@ Error MessageQueue::push_set(Object *p_object, const StringName &p_prop, const V
 	return push_set(p_object->get_instance_id(), p_prop, p_value);
 }
 
-Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error) {
-	_THREAD_SAFE_METHOD_
+Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error, bool p_coalesce) {
+	ERR_FAIL_COND_V(p_argcount < 0 || p_argcount > INT16_MAX, ERR_INVALID_PARAMETER);
 
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	// Calls taking containers are never coalesced, hashing and comparing them
+	// would cost more than the call.
+	bool can_coalesce = p_coalesce;
+	uint32_t hash = 0;
+	if (can_coalesce) {
+		hash = hash_djb2_one_32(TYPE_CALL, p_callable.hash());
+	}
+	for (int i = 0; can_coalesce && i < p_argcount; i++) {
+		if (p_args[i]->get_type() >= Variant::DICTIONARY) {
+			can_coalesce = false;
+			break;
+		}
+		hash = hash_djb2_one_32(p_args[i]->hash(), hash);
+	}
 
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed method: " + p_callable);
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
+	Segment *segment = _get_segment();
+	segment->lock.lock();
+
+	Message *pending = can_coalesce ? _find_coalescable(segment, hash, p_callable) : nullptr;
+	if (pending && (pending->type & FLAG_MASK) == TYPE_CALL && pending->args == p_argcount) {
+		const Variant *pending_args = (const Variant *)(pending + 1);
+		bool same = true;
+		for (int i = 0; i < p_argcount; i++) {
+			if (!pending_args[i].hash_compare(*p_args[i])) {
+				same = false;
+				break;
+			}
+		}
+		if (same) {
+			if (p_show_error) {
+				pending->type |= FLAG_SHOW_ERROR;
+			}
+			segment->coalesced++;
+			segment->lock.unlock();
+			return OK;
+		}
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = _alloc_message(segment, p_argcount);
 	msg->args = p_argcount;
 	msg->callable = p_callable;
 	msg->type = TYPE_CALL;
@@ -144,14 +282,17 @@ Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_
 		msg->type |= FLAG_SHOW_ERROR;
 	}
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
-		*v = *p_args[i];
+		memnew_placement(&args[i], Variant(*p_args[i]));
 	}
 
+	if (can_coalesce) {
+		segment->pending.set(hash, msg);
+	}
+	segment->last_for_object.set(uint64_t(p_callable.get_object_id()), msg);
+
+	segment->lock.unlock();
 	return OK;
 }
 
@@ -170,78 +311,22 @@ Error MessageQueue::push_callable(const Callable &p_callable, VARIANT_ARG_DECLAR
 	return push_callable(p_callable, argptr, argc);
 }
 
-void MessageQueue::statistics() {
-	Map<StringName, int> set_count;
-	Map<int, int> notify_count;
-	Map<Callable, int> call_count;
-	int null_count = 0;
-
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
-
-		Object *target = message->callable.get_object();
-
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					if (!call_count.has(message->callable)) {
-						call_count[message->callable] = 0;
-					}
-
-					call_count[message->callable]++;
-
-				} break;
-				case TYPE_NOTIFICATION: {
-					if (!notify_count.has(message->notification)) {
-						notify_count[message->notification] = 0;
-					}
-
-					notify_count[message->notification]++;
-
-				} break;
-				case TYPE_SET: {
-					StringName t = message->callable.get_method();
-					if (!set_count.has(t)) {
-						set_count[t] = 0;
-					}
-
-					set_count[t]++;
-
-				} break;
-			}
-
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
-
-			null_count++;
-		}
-
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
-		}
-	}
-
-	print_line("TOTAL BYTES: " + itos(buffer_end));
-	print_line("NULL count: " + itos(null_count));
-
-	for (Map<StringName, int>::Element *E = set_count.front(); E; E = E->next()) {
-		print_line("SET " + E->key() + ": " + itos(E->get()));
-	}
-
-	for (Map<Callable, int>::Element *E = call_count.front(); E; E = E->next()) {
-		print_line("CALL " + E->key() + ": " + itos(E->get()));
-	}
+int MessageQueue::get_max_buffer_usage() const {
+	return buffer_max_used;
+}
 
-	for (Map<int, int>::Element *E = notify_count.front(); E; E = E->next()) {
-		print_line("NOTIFY " + itos(E->key()) + ": " + itos(E->get()));
-	}
+void MessageQueue::update_stats() {
+	stats_lock.lock();
+	last_stats = accumulated_stats;
+	accumulated_stats = Stats();
+	stats_lock.unlock();
 }
 
-int MessageQueue::get_max_buffer_usage() const {
-	return buffer_max_used;
+MessageQueue::Stats MessageQueue::get_stats() {
+	stats_lock.lock();
+	Stats stats = last_stats;
+	stats_lock.unlock();
+	return stats;
 }
 
 void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error) {
@@ -261,78 +346,143 @@ void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_a
 	}
 }
 
-void MessageQueue::flush() {
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
+// Takes the pages of all segments, so threads keep pushing to new ones while
+// the messages are being called.
+void MessageQueue::_detach_segments() {
+	uint64_t coalesced = 0;
+
+	MutexLock lock(mutex);
+	for (uint32_t i = 0; i < segments.size(); i++) {
+		Segment *segment = segments[i];
+
+		segment->lock.lock();
+		if (segment->first) {
+			Chain chain;
+			chain.page = segment->first;
+			chains.push_back(chain);
+			segment->first = nullptr;
+			segment->last = nullptr;
+		}
+		if (!segment->pending.is_empty()) {
+			segment->pending.clear();
+		}
+		if (!segment->last_for_object.is_empty()) {
+			segment->last_for_object.clear();
+		}
+		coalesced += segment->coalesced;
+		segment->coalesced = 0;
+		bool orphaned = segment->orphaned;
+		segment->lock.unlock();
+
+		if (orphaned) {
+			memdelete(segment);
+			segments.remove_unordered(i);
+			i--;
+		}
 	}
 
-	uint32_t read_pos = 0;
-
-	//using reverse locking strategy
-	_THREAD_SAFE_LOCK_
+	if (coalesced) {
+		stats_lock.lock();
+		accumulated_stats.coalesced += coalesced;
+		stats_lock.unlock();
+	}
+}
 
+void MessageQueue::flush() {
+	mutex.lock();
 	if (flushing) {
-		_THREAD_SAFE_UNLOCK_
+		mutex.unlock();
 		ERR_FAIL_COND(flushing); //already flushing, you did something odd
 	}
 	flushing = true;
-
-	while (read_pos < buffer_end) {
-		//lock on each iteration, so a call can re-add itself to the message queue
-
-		Message *message = (Message *)&buffer[read_pos];
-
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			advance += sizeof(Variant) * message->args;
+	mutex.unlock();
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	uint64_t messages = 0;
+	uint64_t bytes = 0;
+
+	// Messages pushed while flushing are called in the same flush, as before.
+	_detach_segments();
+	while (chains.size()) {
+		uint32_t pending_bytes = 0;
+		for (uint32_t i = 0; i < chains.size(); i++) {
+			for (Page *page = chains[i].page; page; page = page->next) {
+				pending_bytes += page->used;
+			}
 		}
+		buffer_max_used = MAX(buffer_max_used, pending_bytes);
+		bytes += pending_bytes;
+
+		while (chains.size()) {
+			// Merge the segments back in push order, there are only as many as
+			// threads which pushed something.
+			uint32_t next = 0;
+			uint64_t next_sequence = UINT64_MAX;
+			for (uint32_t i = 0; i < chains.size(); i++) {
+				const Message *message = (const Message *)(chains[i].page->get_data() + chains[i].read_pos);
+				if (message->sequence < next_sequence) {
+					next_sequence = message->sequence;
+					next = i;
+				}
+			}
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
-
-		_THREAD_SAFE_UNLOCK_
+			Chain &chain = chains[next];
+			Message *message = (Message *)(chain.page->get_data() + chain.read_pos);
+			chain.read_pos += _get_message_size(message);
 
-		Object *target = message->callable.get_object();
+			Object *target = message->callable.get_object();
 
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					Variant *args = (Variant *)(message + 1);
+			if (target != nullptr) {
+				switch (message->type & FLAG_MASK) {
+					case TYPE_CALL: {
+						Variant *args = (Variant *)(message + 1);
 
-					// messages don't expect a return value
+						// messages don't expect a return value
 
-					_call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
+						_call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
 
-				} break;
-				case TYPE_NOTIFICATION: {
-					// messages don't expect a return value
-					target->notification(message->notification);
+					} break;
+					case TYPE_NOTIFICATION: {
+						// messages don't expect a return value
+						target->notification(message->notification);
 
-				} break;
-				case TYPE_SET: {
-					Variant *arg = (Variant *)(message + 1);
-					// messages don't expect a return value
-					target->set(message->callable.get_method(), *arg);
+					} break;
+					case TYPE_SET: {
+						Variant *arg = (Variant *)(message + 1);
+						// messages don't expect a return value
+						target->set(message->callable.get_method(), *arg);
 
-				} break;
+					} break;
+				}
 			}
-		}
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
+			_destroy_message(message);
+			messages++;
+
+			// Nested flushes are refused, so the chain is still valid.
+			if (chain.read_pos >= chain.page->used) {
+				Page *page = chain.page;
+				chain.page = page->next;
+				chain.read_pos = 0;
+				_free_page(page);
+				if (!chain.page) {
+					chains.remove_unordered(next);
+				}
 			}
 		}
 
-		message->~Message();
-
-		_THREAD_SAFE_LOCK_
+		_detach_segments();
 	}
 
-	buffer_end = 0; // reset buffer
+	stats_lock.lock();
+	accumulated_stats.messages += messages;
+	accumulated_stats.bytes += bytes;
+	accumulated_stats.time_usec += OS::get_singleton()->get_ticks_usec() - from;
+	stats_lock.unlock();
+
+	mutex.lock();
 	flushing = false;
-	_THREAD_SAFE_UNLOCK_
+	mutex.unlock();
 }
 
 bool MessageQueue::is_flushing() const {
@@ -342,33 +492,35 @@ bool MessageQueue::is_flushing() const {
 MessageQueue::MessageQueue() {
 	ERR_FAIL_COND_MSG(singleton != nullptr, "A MessageQueue singleton already exists.");
 	singleton = this;
+	queue_id = ++last_queue_id;
 
-	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
+	retained_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_RETAINED_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater"));
-	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+	retained_size *= 1024;
 }
 
 MessageQueue::~MessageQueue() {
-	uint32_t read_pos = 0;
-
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++) {
-				args[i].~Variant();
+	for (uint32_t i = 0; i < segments.size(); i++) {
+		Page *page = segments[i]->first;
+		while (page) {
+			uint32_t read_pos = 0;
+			while (read_pos < page->used) {
+				Message *message = (Message *)(page->get_data() + read_pos);
+				read_pos += _get_message_size(message);
+				_destroy_message(message);
 			}
+			Page *next = page->next;
+			memfree(page);
+			page = next;
 		}
-		message->~Message();
+		memdelete(segments[i]);
+	}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
-		}
+	while (free_pages) {
+		Page *next = free_pages->next;
+		memfree(free_pages);
+		free_pages = next;
 	}
 
 	singleton = nullptr;
-	memdelete_arr(buffer);
 }
@@ -32,13 +32,33 @@
 #define MESSAGE_QUEUE_H
 
 #include "core/object/class_db.h"
-#include "core/os/thread_safe.h"
+#include "core/os/mutex.h"
+#include "core/os/spin_lock.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/oa_hash_map.h"
+#include "core/templates/safe_refcount.h"
+
+// Every thread pushes to its own segment, so call_deferred() from worker
+// threads does not contend with the main thread. Segments are made of pages
+// which are allocated on demand, and flush() merges them back in push order.
+//
+// A set of the same property on the same object, or a call identical to one
+// which is still pending on the same thread, does not add a new message. The
+// set overwrites the pending value, the call is dropped.
 
 class MessageQueue {
-	_THREAD_SAFE_CLASS_
+public:
+	struct Stats {
+		uint64_t messages = 0;
+		uint64_t bytes = 0;
+		uint64_t coalesced = 0;
+		uint64_t time_usec = 0;
+	};
 
+private:
 	enum {
-		DEFAULT_QUEUE_SIZE_KB = 4096
+		PAGE_SIZE = 64 * 1024,
+		DEFAULT_RETAINED_SIZE_KB = 4096
 	};
 
 	enum {
@@ -52,6 +72,7 @@ class MessageQueue {
 
 	struct Message {
 		Callable callable;
+		uint64_t sequence;
 		int16_t type;
 		union {
 			int16_t notification;
@@ -59,11 +80,78 @@ class MessageQueue {
 		};
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end = 0;
+	struct alignas(8) Page {
+		Page *next = nullptr;
+		uint32_t size = 0;
+		uint32_t used = 0;
+
+		_FORCE_INLINE_ uint8_t *get_data() { return (uint8_t *)(this + 1); }
+	};
+
+	struct Segment {
+		SpinLock lock;
+		Page *first = nullptr;
+		Page *last = nullptr;
+		uint64_t coalesced = 0;
+		// Pending calls and sets which can still be coalesced, by hash.
+		OAHashMap<uint32_t, Message *> pending;
+		// The last message queued for each object. A message is only coalesced
+		// into a pending one which is still the last for its object, so it
+		// never moves past other messages for that object. Pushes from other
+		// threads aren't ordered against this thread's, they are not checked.
+		OAHashMap<uint64_t, Message *> last_for_object;
+		bool orphaned = false; // The thread that owned it has exited.
+	};
+
+	// Pages of a segment taken by flush(), read in order.
+	struct Chain {
+		Page *page = nullptr;
+		uint32_t read_pos = 0;
+	};
+
+	struct ThreadSegment {
+		uint32_t queue_id = 0;
+		Segment *segment = nullptr;
+		~ThreadSegment();
+	};
+
+	static thread_local ThreadSegment thread_segment;
+	static uint32_t last_queue_id;
+
+	uint32_t queue_id = 0;
+	SafeNumeric<uint64_t> sequence;
+
+	Mutex mutex;
+	LocalVector<Segment *> segments;
+	LocalVector<Chain> chains; // Only used by flush().
+
+	SpinLock page_lock;
+	Page *free_pages = nullptr;
+	uint32_t free_page_bytes = 0;
+	uint32_t retained_size = 0;
+
 	uint32_t buffer_max_used = 0;
-	uint32_t buffer_size;
 
+	SpinLock stats_lock;
+	Stats accumulated_stats;
+	Stats last_stats;
+
+	_FORCE_INLINE_ Segment *_get_segment() {
+		if (likely(thread_segment.queue_id == queue_id)) {
+			return thread_segment.segment;
+		}
+		return _create_segment();
+	}
+	Segment *_create_segment();
+
+	Page *_alloc_page(uint32_t p_min_size);
+	void _free_page(Page *p_page);
+	Message *_alloc_message(Segment *p_segment, int p_argcount);
+	static Message *_find_coalescable(Segment *p_segment, uint32_t p_hash, const Callable &p_callable);
+	static uint32_t _get_message_size(const Message *p_message);
+	static void _destroy_message(Message *p_message);
+
+	void _detach_segments();
 	void _call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	static MessageQueue *singleton;
@@ -73,24 +161,29 @@ class MessageQueue {
 public:
 	static MessageQueue *get_singleton();
 
-	Error push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error = false);
+	// Identical calls and sets of the same property are coalesced into a pending one which is still the last
+	// message for their object. Pass p_coalesce as false when every call must run, such as deferred signals.
+	Error push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error = false, bool p_coalesce = true);
 	Error push_call(ObjectID p_id, const StringName &p_method, VARIANT_ARG_LIST);
 	Error push_notification(ObjectID p_id, int p_notification);
 	Error push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value);
-	Error push_callable(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error = false);
+	Error push_callable(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error = false, bool p_coalesce = true);
 	Error push_callable(const Callable &p_callable, VARIANT_ARG_LIST);
 
 	Error push_call(Object *p_object, const StringName &p_method, VARIANT_ARG_LIST);
 	Error push_notification(Object *p_object, int p_notification);
 	Error push_set(Object *p_object, const StringName &p_prop, const Variant &p_value);
 
-	void statistics();
 	void flush();
 
 	bool is_flushing() const;
 
 	int get_max_buffer_usage() const;
 
+	// Flush statistics are accumulated, and published once per second by update_stats().
+	void update_stats();
+	Stats get_stats();
+
 	MessageQueue();
 	~MessageQueue();
 };
@@ -38,6 +38,7 @@
 #include "core/os/os.h"
 #include "core/string/print_string.h"
 #include "core/string/translation.h"
+#include "core/variant/variant_internal.h"
 
 #ifdef DEBUG_ENABLED
 
@@ -396,29 +397,26 @@ void Object::set(const StringName &p_name, const Variant &p_value, bool *r_valid
 		}
 	}
 
+	bool valid = _set_fallback(p_name, p_value);
+	if (r_valid) {
+		*r_valid = valid;
+	}
+}
+
+bool Object::_set_fallback(const StringName &p_name, const Variant &p_value) {
 	if (p_name == CoreStringNames::get_singleton()->_script) {
 		set_script(p_value);
-		if (r_valid) {
-			*r_valid = true;
-		}
-		return;
+		return true;
 
 	} else if (p_name == CoreStringNames::get_singleton()->_meta) {
 		//set_meta(p_name,p_value);
 		metadata = p_value.duplicate();
-		if (r_valid) {
-			*r_valid = true;
-		}
-		return;
+		return true;
 	}
 
 	//something inside the object... :|
-	bool success = _setv(p_name, p_value);
-	if (success) {
-		if (r_valid) {
-			*r_valid = true;
-		}
-		return;
+	if (_setv(p_name, p_value)) {
+		return true;
 	}
 
 #ifdef TOOLS_ENABLED
@@ -426,17 +424,12 @@ void Object::set(const StringName &p_name, const Variant &p_value, bool *r_valid
 		bool valid;
 		script_instance->property_set_fallback(p_name, p_value, &valid);
 		if (valid) {
-			if (r_valid) {
-				*r_valid = true;
-			}
-			return;
+			return true;
 		}
 	}
 #endif
 
-	if (r_valid) {
-		*r_valid = false;
-	}
+	return false;
 }
 
 Variant Object::get(const StringName &p_name, bool *r_valid) const {
@@ -461,48 +454,118 @@ Variant Object::get(const StringName &p_name, bool *r_valid) const {
 		}
 	}
 
+	bool valid = _get_fallback(p_name, ret);
+	if (r_valid) {
+		*r_valid = valid;
+	}
+	return ret;
+}
+
+bool Object::_get_fallback(const StringName &p_name, Variant &r_ret) const {
 	if (p_name == CoreStringNames::get_singleton()->_script) {
-		ret = get_script();
-		if (r_valid) {
-			*r_valid = true;
-		}
-		return ret;
+		r_ret = get_script();
+		return true;
 
 	} else if (p_name == CoreStringNames::get_singleton()->_meta) {
-		ret = metadata;
-		if (r_valid) {
-			*r_valid = true;
-		}
-		return ret;
+		r_ret = metadata;
+		return true;
+	}
 
-	} else {
-		//something inside the object... :|
-		bool success = _getv(p_name, ret);
-		if (success) {
-			if (r_valid) {
-				*r_valid = true;
-			}
-			return ret;
-		}
+	//something inside the object... :|
+	if (_getv(p_name, r_ret)) {
+		return true;
+	}
 
 #ifdef TOOLS_ENABLED
-		if (script_instance) {
-			bool valid;
-			ret = script_instance->property_get_fallback(p_name, &valid);
-			if (valid) {
-				if (r_valid) {
-					*r_valid = true;
-				}
-				return ret;
-			}
+	if (script_instance) {
+		bool valid;
+		r_ret = script_instance->property_get_fallback(p_name, &valid);
+		if (valid) {
+			return true;
 		}
+	}
 #endif
 
-		if (r_valid) {
-			*r_valid = false;
+	r_ret = Variant();
+	return false;
+}
+
+void Object::set_properties(const Dictionary &p_properties) {
+	const int count = p_properties.size();
+	if (count == 0) {
+		return;
+	}
+
+#ifdef TOOLS_ENABLED
+	_edited = true;
+#endif
+
+	LocalVector<StringName> names;
+	LocalVector<const Variant *> values;
+	names.resize(count);
+	values.resize(count);
+	int index = 0;
+	for (const Variant *key = p_properties.next(); key; key = p_properties.next(key), index++) {
+		names[index] = *key;
+		values[index] = p_properties.getptr(*key);
+	}
+
+	const StringName &script_name = CoreStringNames::get_singleton()->_script;
+	int from = 0;
+	while (from < count) {
+		// Setting the script adds an instance, which has to see the properties set after it.
+		if (script_instance || names[from] == script_name) {
+			set(names[from], *values[from]);
+			from++;
+			continue;
 		}
-		return Variant();
+
+		int to = from + 1;
+		while (to < count && names[to] != script_name) {
+			to++;
+		}
+
+		from += ClassDB::set_properties(this, &names[from], &values[from], to - from);
+		if (from < to) {
+			_set_fallback(names[from], *values[from]);
+			from++;
+		}
+	}
+}
+
+Dictionary Object::get_properties(const PackedStringArray &p_properties) const {
+	Dictionary ret;
+	const int count = p_properties.size();
+	if (count == 0) {
+		return ret;
+	}
+
+	if (script_instance) {
+		for (int i = 0; i < count; i++) {
+			ret[p_properties[i]] = get(p_properties[i]);
+		}
+		return ret;
+	}
+
+	LocalVector<StringName> names;
+	LocalVector<Variant> values;
+	LocalVector<bool> handled;
+	names.resize(count);
+	values.resize(count);
+	handled.resize(count);
+	for (int i = 0; i < count; i++) {
+		names[i] = p_properties[i];
+	}
+
+	ClassDB::get_properties(const_cast<Object *>(this), names.ptr(), count, values.ptr(), handled.ptr());
+
+	for (int i = 0; i < count; i++) {
+		if (!handled[i]) {
+			_get_fallback(names[i], values[i]);
+		}
+		ret[p_properties[i]] = values[i];
 	}
+	return ret;
 }
 
 void Object::set_indexed(const Vector<StringName> &p_names, const Variant &p_value, bool *r_valid) {
@@ -789,6 +852,11 @@ Variant Object::call(const StringName &p_method, const Variant **p_args, int p_a
 	return ret;
 }
 
+Variant Object::call_method_bind(MethodBind *p_method, const Variant **p_args, int p_argcount, Callable::CallError &r_error) {
+	OBJ_DEBUG_LOCK
+	return p_method->call(this, p_args, p_argcount, r_error);
+}
+
 void Object::notification(int p_notification, bool p_reversed) {
 	_notificationv(p_notification, p_reversed);
 
@@ -939,10 +1007,11 @@ void Object::add_user_signal(const MethodInfo &p_signal) {
 }
 
 bool Object::_has_user_signal(const StringName &p_name) const {
-	if (!signal_map.has(p_name)) {
+	const SignalData *s = signal_map.getptr(p_name);
+	if (!s) {
 		return false;
 	}
-	return signal_map[p_name].user.name.length() > 0;
+	return s->user.name.length() > 0;
 }
 
 struct _ObjectSignalDisconnectData {
@@ -950,6 +1019,111 @@ struct _ObjectSignalDisconnectData {
 	Callable callable;
 };
 
+// The targets of a signal, resolved once after its connections change instead
+// of on every emit. Emits hold a reference, so connecting or disconnecting
+// while emitting replaces the dispatch instead of copying the connections.
+struct Object::SignalDispatch {
+	struct Target {
+		Callable callable;
+		ObjectID object;
+		uint32_t flags = 0;
+		Vector<Variant> binds;
+		// The method of a plain Callable, called directly if the object has no script.
+		MethodBind *method = nullptr;
+		bool can_ptrcall = false;
+	};
+
+	// The signal holds one reference, every emit in progress holds another.
+	// Several threads may emit the same signal at once.
+	SafeRefCount refcount;
+	uint32_t max_binds = 0;
+	LocalVector<Target> targets;
+
+	SignalDispatch() {
+		refcount.init();
+	}
+};
+
+Object::SignalData::SignalData(const SignalData &p_from) :
+		user(p_from.user),
+		slot_map(p_from.slot_map) {
+}
+
+Object::SignalData &Object::SignalData::operator=(const SignalData &p_from) {
+	user = p_from.user;
+	slot_map = p_from.slot_map;
+	invalidate_dispatch();
+	return *this;
+}
+
+Object::SignalData::~SignalData() {
+	invalidate_dispatch();
+}
+
+void Object::SignalData::invalidate_dispatch() {
+	SignalDispatch *previous = dispatch.exchange(nullptr, std::memory_order_acq_rel);
+	if (previous) {
+		_unref_signal_dispatch(previous);
+	}
+}
+
+Object::SignalDispatch *Object::_build_signal_dispatch(const SignalData &p_signal) {
+	SignalDispatch *dispatch = memnew(SignalDispatch);
+
+	int slot_count = p_signal.slot_map.size();
+	dispatch->targets.resize(slot_count);
+
+	for (int i = 0; i < slot_count; i++) {
+		const Connection &c = p_signal.slot_map.getv(i).conn;
+		SignalDispatch::Target &t = dispatch->targets[i];
+		t.callable = c.callable;
+		t.object = c.callable.get_object_id();
+		t.flags = c.flags;
+		t.binds = c.binds;
+		dispatch->max_binds = MAX(dispatch->max_binds, (uint32_t)c.binds.size());
+
+		if (c.callable.is_custom() || (c.flags & CONNECT_DEFERRED)) {
+			continue;
+		}
+
+		Object *target = ObjectDB::get_instance(t.object);
+		StringName method = c.callable.get_method();
+		if (target && method != CoreStringNames::get_singleton()->_free) {
+			t.method = ClassDB::get_method(target->get_class_name(), method);
+		}
+		if (t.method) {
+			// Without a return value there is nothing to decode.
+			t.can_ptrcall = !t.method->is_vararg() && !t.method->has_return();
+		}
+	}
+
+	return dispatch;
+}
+
+void Object::_unref_signal_dispatch(SignalDispatch *p_dispatch) {
+	if (p_dispatch->refcount.unref()) {
+		memdelete(p_dispatch);
+	}
+}
+
+#ifdef DEBUG_METHODS_ENABLED
+// Arguments can be passed to ptrcall() as they are when they have the exact
+// types the method takes. Objects are left to call(), which checks their class.
+static _FORCE_INLINE_ bool _get_signal_ptrcall_args(const MethodBind *p_method, const Variant **p_args, int p_argcount, const void **r_ptr_args) {
+	for (int i = 0; i < p_argcount; i++) {
+		Variant::Type type = p_method->get_argument_type(i);
+		if (type == Variant::NIL) {
+			r_ptr_args[i] = p_args[i]; // Takes a Variant.
+		} else if (type == p_args[i]->get_type() && type != Variant::OBJECT) {
+			r_ptr_args[i] = VariantInternal::get_opaque_pointer(p_args[i]);
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+#endif
+
 Variant Object::_emit_signal(const Variant **p_args, int p_argcount, Callable::CallError &r_error) {
 	r_error.error = Callable::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS;
 
@@ -993,25 +1167,42 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 		return ERR_UNAVAILABLE;
 	}
 
-	List<_ObjectSignalDisconnectData> disconnect_data;
-
-	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
-	//this happens automatically and will not change the performance of calling.
-	//awesome, isn't it?
-	VMap<Callable, SignalData::Slot> slot_map = s->slot_map;
+	// Disconnecting the signal or even deleting the object while emitting
+	// replaces or frees s->dispatch, this reference keeps the one being called.
+	SignalDispatch *dispatch = s->dispatch.load(std::memory_order_acquire);
+	if (!dispatch) {
+		// Threads emitting at the same time may all build one, only the first is published.
+		SignalDispatch *built = _build_signal_dispatch(*s);
+		if (s->dispatch.compare_exchange_strong(dispatch, built, std::memory_order_acq_rel, std::memory_order_acquire)) {
+			dispatch = built;
+		} else {
+			memdelete(built);
+		}
+	}
+	dispatch->refcount.ref();
 
-	int ssize = slot_map.size();
+	List<_ObjectSignalDisconnectData> disconnect_data;
 
 	OBJ_DEBUG_LOCK
 
-	Vector<const Variant *> bind_mem;
+	int max_argc = p_argcount + dispatch->max_binds;
+	const Variant **bind_args = nullptr;
+	if (dispatch->max_binds) {
+		bind_args = (const Variant **)alloca(sizeof(Variant *) * max_argc);
+		for (int j = 0; j < p_argcount; j++) {
+			bind_args[j] = p_args[j];
+		}
+	}
+#ifdef DEBUG_METHODS_ENABLED
+	const void **ptr_args = max_argc ? (const void **)alloca(sizeof(void *) * max_argc) : nullptr;
+#endif
 
 	Error err = OK;
 
-	for (int i = 0; i < ssize; i++) {
-		const Connection &c = slot_map.getv(i).conn;
+	for (uint32_t i = 0; i < dispatch->targets.size(); i++) {
+		const SignalDispatch::Target &t = dispatch->targets[i];
 
-		Object *target = c.callable.get_object();
+		Object *target = ObjectDB::get_instance(t.object);
 		if (!target) {
 			// Target might have been deleted during signal callback, this is expected and OK.
 			continue;
@@ -1020,48 +1211,58 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 		const Variant **args = p_args;
 		int argc = p_argcount;
 
-		if (c.binds.size()) {
+		if (t.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
-
-			for (int j = 0; j < p_argcount; j++) {
-				bind_mem.write[j] = p_args[j];
-			}
-			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem.write[p_argcount + j] = &c.binds[j];
+			for (int j = 0; j < t.binds.size(); j++) {
+				bind_args[p_argcount + j] = &t.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_args;
+			argc = p_argcount + t.binds.size();
 		}
 
-		if (c.flags & CONNECT_DEFERRED) {
-			MessageQueue::get_singleton()->push_callable(c.callable, args, argc, true);
+		if (t.flags & CONNECT_DEFERRED) {
+			// Every emission is delivered, even when it repeats the previous one.
+			MessageQueue::get_singleton()->push_callable(t.callable, args, argc, true, false);
 		} else {
 			Callable::CallError ce;
 			_emitting = true;
-			Variant ret;
-			c.callable.call(args, argc, ret, ce);
+			if (t.method && !target->script_instance) {
+#ifdef DEBUG_ENABLED
+				_ObjectDebugLock target_lock(target);
+#endif
+#ifdef DEBUG_METHODS_ENABLED
+				if (t.can_ptrcall && argc == t.method->get_argument_count() && _get_signal_ptrcall_args(t.method, args, argc, ptr_args)) {
+					t.method->ptrcall(target, ptr_args, nullptr);
+				} else
+#endif
+				{
+					t.method->call(target, args, argc, ce);
+				}
+			} else {
+				Variant ret;
+				t.callable.call(args, argc, ret, ce);
+			}
 			_emitting = false;
 
 			if (ce.error != Callable::CallError::CALL_OK) {
 #ifdef DEBUG_ENABLED
-				if (c.flags & CONNECT_PERSIST && Engine::get_singleton()->is_editor_hint() && (script.is_null() || !Ref<Script>(script)->is_tool())) {
+				if (t.flags & CONNECT_PERSIST && Engine::get_singleton()->is_editor_hint() && (script.is_null() || !Ref<Script>(script)->is_tool())) {
 					continue;
 				}
 #endif
 				if (ce.error == Callable::CallError::CALL_ERROR_INVALID_METHOD && !ClassDB::class_exists(target->get_class_name())) {
 					//most likely object is not initialized yet, do not throw error.
 				} else {
-					ERR_PRINT("Error calling from signal '" + String(p_name) + "' to callable: " + Variant::get_callable_error_text(c.callable, args, argc, ce) + ".");
+					ERR_PRINT("Error calling from signal '" + String(p_name) + "' to callable: " + Variant::get_callable_error_text(t.callable, args, argc, ce) + ".");
 					err = ERR_METHOD_NOT_FOUND;
 				}
 			}
 		}
 
-		bool disconnect = c.flags & CONNECT_ONESHOT;
+		bool disconnect = t.flags & CONNECT_ONESHOT;
 #ifdef TOOLS_ENABLED
-		if (disconnect && (c.flags & CONNECT_PERSIST) && Engine::get_singleton()->is_editor_hint()) {
+		if (disconnect && (t.flags & CONNECT_PERSIST) && Engine::get_singleton()->is_editor_hint()) {
 			//this signal was connected from the editor, and is being edited. just don't disconnect for now
 			disconnect = false;
 		}
@@ -1069,11 +1270,13 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 		if (disconnect) {
 			_ObjectSignalDisconnectData dd;
 			dd.signal = p_name;
-			dd.callable = c.callable;
+			dd.callable = t.callable;
 			disconnect_data.push_back(dd);
 		}
 	}
 
+	_unref_signal_dispatch(dispatch);
+
 	while (!disconnect_data.is_empty()) {
 		const _ObjectSignalDisconnectData &dd = disconnect_data.front()->get();
 
@@ -1191,21 +1394,17 @@ void Object::get_signal_list(List<MethodInfo> *p_signals) const {
 
 	ClassDB::get_signal_list(get_class_name(), p_signals);
 	//find maybe usersignals?
-	const StringName *S = nullptr;
-
-	while ((S = signal_map.next(S))) {
-		if (signal_map[*S].user.name != "") {
+	for (const FlatHashMap<StringName, SignalData>::Element *E = signal_map.front(); E; E = E->next()) {
+		if (E->value().user.name != "") {
 			//user signal
-			p_signals->push_back(signal_map[*S].user);
+			p_signals->push_back(E->value().user);
 		}
 	}
 }
 
 void Object::get_all_signal_connections(List<Connection> *p_connections) const {
-	const StringName *S = nullptr;
-
-	while ((S = signal_map.next(S))) {
-		const SignalData *s = &signal_map[*S];
+	for (const FlatHashMap<StringName, SignalData>::Element *E = signal_map.front(); E; E = E->next()) {
+		const SignalData *s = &E->value();
 
 		for (int i = 0; i < s->slot_map.size(); i++) {
 			p_connections->push_back(s->slot_map.getv(i).conn);
@@ -1226,10 +1425,8 @@ void Object::get_signal_connection_list(const StringName &p_signal, List<Connect
 
 int Object::get_persistent_signal_connection_count() const {
 	int count = 0;
-	const StringName *S = nullptr;
-
-	while ((S = signal_map.next(S))) {
-		const SignalData *s = &signal_map[*S];
+	for (const FlatHashMap<StringName, SignalData>::Element *E = signal_map.front(); E; E = E->next()) {
+		const SignalData *s = &E->value();
 
 		for (int i = 0; i < s->slot_map.size(); i++) {
 			if (s->slot_map.getv(i).conn.flags & CONNECT_PERSIST) {
@@ -1273,8 +1470,7 @@ Error Object::connect(const StringName &p_signal, const Callable &p_callable, co
 
 		ERR_FAIL_COND_V_MSG(!signal_is_valid, ERR_INVALID_PARAMETER, "In Object of type '" + String(get_class()) + "': Attempt to connect nonexistent signal '" + p_signal + "' to callable '" + p_callable + "'.");
 
-		signal_map[p_signal] = SignalData();
-		s = &signal_map[p_signal];
+		s = &signal_map.insert(p_signal, SignalData())->value();
 	}
 
 	Callable target = p_callable;
@@ -1304,6 +1500,7 @@ Error Object::connect(const StringName &p_signal, const Callable &p_callable, co
 
 	//use callable version as key, so binds can be ignored
 	s->slot_map[*target.get_base_comparator()] = slot;
+	s->invalidate_dispatch();
 
 	return OK;
 }
@@ -1362,6 +1559,7 @@ void Object::_disconnect(const StringName &p_signal, const Callable &p_callable,
 
 	target_object->connections.erase(slot->cE);
 	s->slot_map.erase(*p_callable.get_base_comparator());
+	s->invalidate_dispatch();
 
 	if (s->slot_map.is_empty() && ClassDB::has_signal(get_class_name(), p_signal)) {
 		//not user signal, delete
@@ -1492,6 +1690,8 @@ void Object::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get", "property"), &Object::_get_bind);
 	ClassDB::bind_method(D_METHOD("set_indexed", "property", "value"), &Object::_set_indexed_bind);
 	ClassDB::bind_method(D_METHOD("get_indexed", "property"), &Object::_get_indexed_bind);
+	ClassDB::bind_method(D_METHOD("set_properties", "properties"), &Object::set_properties);
+	ClassDB::bind_method(D_METHOD("get_properties", "properties"), &Object::get_properties);
 	ClassDB::bind_method(D_METHOD("get_property_list"), &Object::_get_property_list_bind);
 	ClassDB::bind_method(D_METHOD("get_method_list"), &Object::_get_method_list_bind);
 	ClassDB::bind_method(D_METHOD("notification", "what", "reversed"), &Object::notification, DEFVAL(false));
@@ -1770,15 +1970,13 @@ Object::~Object() {
 	}
 	script_instance = nullptr;
 
-	const StringName *S = nullptr;
-
 	if (_emitting) {
 		//@todo this may need to actually reach the debugger prioritarily somehow because it may crash before
 		ERR_PRINT("Object " + to_string() + " was freed or unreferenced while a signal is being emitted from it. Try connecting to the signal using 'CONNECT_DEFERRED' flag, or use queue_free() to free the object (if this object is a Node) to avoid this error and potential crashes.");
 	}
 
-	while ((S = signal_map.next(nullptr))) {
-		SignalData *s = &signal_map[*S];
+	while (signal_map.front()) {
+		SignalData *s = &signal_map.front()->value();
 
 		//brute force disconnect for performance
 		int slot_count = s->slot_map.size();
@@ -1788,7 +1986,7 @@ Object::~Object() {
 			slot_list[i].value.conn.callable.get_object()->connections.erase(slot_list[i].value.cE);
 		}
 
-		signal_map.erase(*S);
+		signal_map.erase(signal_map.front());
 	}
 
 	//signals from nodes that connect to this node
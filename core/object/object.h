@@ -34,6 +34,7 @@
 #include "core/object/object_id.h"
 #include "core/os/rw_lock.h"
 #include "core/os/spin_lock.h"
+#include "core/templates/flat_hash_map.h"
 #include "core/templates/hash_map.h"
 #include "core/templates/list.h"
 #include "core/templates/map.h"
@@ -43,6 +44,8 @@
 #include "core/variant/callable_bind.h"
 #include "core/variant/variant.h"
 
+#include <atomic>
+
 #define VARIANT_ARG_LIST const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant(), const Variant &p_arg3 = Variant(), const Variant &p_arg4 = Variant(), const Variant &p_arg5 = Variant()
 #define VARIANT_ARG_PASS p_arg1, p_arg2, p_arg3, p_arg4, p_arg5
 #define VARIANT_ARG_DECLARE const Variant &p_arg1, const Variant &p_arg2, const Variant &p_arg3, const Variant &p_arg4, const Variant &p_arg5
@@ -404,6 +407,7 @@ public:                                                                 \
                                                                         \
 private:
 
+class MethodBind;
 class ScriptInstance;
 
 class Object {
@@ -440,6 +444,8 @@ private:
 	friend bool predelete_handler(Object *);
 	friend void postinitialize_handler(Object *);
 
+	struct SignalDispatch;
+
 	struct SignalData {
 		struct Slot {
 			int reference_count = 0;
@@ -449,9 +455,21 @@ private:
 
 		MethodInfo user;
 		VMap<Callable, Slot> slot_map;
+		// Built from slot_map by the first emit after connections changed.
+		std::atomic<SignalDispatch *> dispatch = { nullptr };
+
+		void invalidate_dispatch();
+
+		SignalData() {}
+		SignalData(const SignalData &p_from);
+		SignalData &operator=(const SignalData &p_from);
+		~SignalData();
 	};
 
-	HashMap<StringName, SignalData> signal_map;
+	static SignalDispatch *_build_signal_dispatch(const SignalData &p_signal);
+	static void _unref_signal_dispatch(SignalDispatch *p_dispatch);
+
+	FlatHashMap<StringName, SignalData> signal_map;
 	List<Connection> connections;
 #ifdef DEBUG_ENABLED
 	SafeRefCount _lock_index;
@@ -484,6 +502,9 @@ private:
 	Variant _get_bind(const String &p_name) const;
 	void _set_indexed_bind(const NodePath &p_name, const Variant &p_value);
 	Variant _get_indexed_bind(const NodePath &p_name) const;
+	// What set() and get() try after the script instance and ClassDB.
+	bool _set_fallback(const StringName &p_name, const Variant &p_value);
+	bool _get_fallback(const StringName &p_name, Variant &r_ret) const;
 
 	_FORCE_INLINE_ void _construct_object(bool p_reference);
 
@@ -632,6 +653,9 @@ public:
 	Variant get(const StringName &p_name, bool *r_valid = nullptr) const;
 	void set_indexed(const Vector<StringName> &p_names, const Variant &p_value, bool *r_valid = nullptr);
 	Variant get_indexed(const Vector<StringName> &p_names, bool *r_valid = nullptr) const;
+	// Same as calling set() or get() for each property, but the class accessors are looked up once.
+	void set_properties(const Dictionary &p_properties);
+	Dictionary get_properties(const PackedStringArray &p_properties) const;
 
 	void get_property_list(List<PropertyInfo> *p_list, bool p_reversed = false) const;
 
@@ -639,6 +663,10 @@ public:
 	void get_method_list(List<MethodInfo> *p_list) const;
 	Variant callv(const StringName &p_method, const Array &p_args);
 	virtual Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, Callable::CallError &r_error);
+	// Classes overriding call() must return true, so their method binds are never called directly.
+	virtual bool is_call_overridden() const { return false; }
+	// Calls a method bind of this class, skipping the script instance and the method lookup.
+	Variant call_method_bind(MethodBind *p_method, const Variant **p_args, int p_argcount, Callable::CallError &r_error);
 	Variant call(const StringName &p_name, VARIANT_ARG_LIST); // C++ helper
 
 	void notification(int p_notification, bool p_reversed = false);
@@ -37,6 +37,7 @@
 #include "core/os/os.h"
 
 FileAccess::CreateFunc FileAccess::create_func[ACCESS_MAX] = { nullptr, nullptr };
+FileAccess::CreateFunc FileAccess::create_mapped_func = nullptr;
 
 FileAccess::FileCloseFailNotify FileAccess::close_fail_notify = nullptr;
 
@@ -113,6 +114,29 @@ FileAccess *FileAccess::open(const String &p_path, int p_mode_flags, Error *r_er
 	return ret;
 }
 
+FileAccess *FileAccess::open_mapped(const String &p_path, Error *r_error) {
+	if (create_mapped_func && !(PackedData::get_singleton() && !PackedData::get_singleton()->is_disabled() && PackedData::get_singleton()->has_path(p_path))) {
+		FileAccess *ret = create_mapped_func();
+		if (p_path.begins_with("res://")) {
+			ret->_set_access_type(ACCESS_RESOURCES);
+		} else if (p_path.begins_with("user://")) {
+			ret->_set_access_type(ACCESS_USERDATA);
+		}
+
+		Error err = ret->_open(p_path, READ);
+		if (err == OK) {
+			if (r_error) {
+				*r_error = OK;
+			}
+			return ret;
+		}
+		memdelete(ret);
+		// Not something which can be mapped, let the regular file access try.
+	}
+
+	return open(p_path, READ, r_error);
+}
+
 FileAccess::CreateFunc FileAccess::get_create_func(AccessType p_access) {
 	return create_func[p_access];
 }
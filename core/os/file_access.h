@@ -70,6 +70,7 @@ private:
 
 	AccessType _access_type = ACCESS_FILESYSTEM;
 	static CreateFunc create_func[ACCESS_MAX]; /** default file access creation function for a platform */
+	static CreateFunc create_mapped_func; /** read-only, memory mapped file access for the platform, if any */
 	template <class T>
 	static FileAccess *_create_builtin() {
 		return memnew(T);
@@ -110,6 +111,13 @@ public:
 	virtual real_t get_real() const;
 
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const; ///< get an array of bytes
+	/**
+	 * Get the next p_length bytes without copying them, and move past them.
+	 * The memory is read-only and stays valid until the file is closed.
+	 * Returns nullptr, without moving, when the file is not memory mapped or
+	 * there are not enough bytes left; use get_buffer() then.
+	 */
+	virtual const uint8_t *get_buffer_view(uint64_t p_length) const { return nullptr; }
 	virtual String get_line() const;
 	virtual String get_token() const;
 	virtual Vector<String> get_csv_line(const String &p_delim = ",") const;
@@ -151,6 +159,7 @@ public:
 	static FileAccess *create(AccessType p_access); /// Create a file access (for the current platform) this is the only portable way of accessing files.
 	static FileAccess *create_for_path(const String &p_path);
 	static FileAccess *open(const String &p_path, int p_mode_flags, Error *r_error = nullptr); /// Create a file access (for the current platform) this is the only portable way of accessing files.
+	static FileAccess *open_mapped(const String &p_path, Error *r_error = nullptr); /// Open for reading through a memory mapping where the platform supports it, otherwise same as open().
 	static CreateFunc get_create_func(AccessType p_access);
 	static bool exists(const String &p_name); ///< return true if a file exists
 	static uint64_t get_modified_time(const String &p_file);
@@ -172,6 +181,11 @@ public:
 		create_func[p_access] = _create_builtin<T>;
 	}
 
+	template <class T>
+	static void make_mapped_default() {
+		create_mapped_func = _create_builtin<T>;
+	}
+
 	FileAccess() {}
 	virtual ~FileAccess() {}
 };
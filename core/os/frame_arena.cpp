@@ -0,0 +1,155 @@
+/*************************************************************************/
+/*  frame_arena.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "frame_arena.h"
+
+#include "core/os/memory.h"
+
+#include <string.h>
+
+thread_local FrameArena FrameArena::thread_arena;
+
+void *FrameArena::_alloc_slow(size_t p_bytes) {
+	uint32_t footprint = _get_footprint(p_bytes);
+
+	// Move on to the next block that fits, the ones skipped stay unused until the arena is rewound.
+	while (current_block + 1 < blocks.size()) {
+		base += blocks[current_block].size;
+		current_block++;
+		offset = 0;
+		if (footprint <= blocks[current_block].size) {
+			return alloc(p_bytes);
+		}
+	}
+
+	// Grow geometrically, so a frame needs few blocks even while the arena warms up.
+	uint64_t capacity = get_capacity();
+	Block block;
+	block.size = MAX(uint32_t(MIN_BLOCK_SIZE), MAX(footprint, uint32_t(MIN(capacity, uint64_t(0x40000000)))));
+	block.memory = (uint8_t *)memalloc(block.size);
+	CRASH_COND_MSG(!block.memory, "Out of memory");
+	block_allocations++;
+
+	if (current_block < blocks.size()) {
+		base += blocks[current_block].size;
+		current_block++;
+	}
+	offset = 0;
+	blocks.push_back(block);
+	return alloc(p_bytes);
+}
+
+void *FrameArena::realloc(void *p_ptr, size_t p_bytes) {
+	if (!p_ptr) {
+		return alloc(p_bytes);
+	}
+
+	uint64_t &size = _get_size(p_ptr);
+	if (p_bytes <= size) {
+		if (_is_last(p_ptr)) {
+			offset -= _get_footprint(size) - _get_footprint(p_bytes);
+		}
+		size = p_bytes;
+		return p_ptr;
+	}
+
+	if (_is_last(p_ptr)) {
+		uint32_t start = offset - _get_footprint(size);
+		uint32_t footprint = _get_footprint(p_bytes);
+		if (start + footprint <= blocks[current_block].size) {
+			// Last allocation, grow it in place.
+			offset = start + footprint;
+			if (base + offset > peak) {
+				peak = base + offset;
+			}
+			size = p_bytes;
+			return p_ptr;
+		}
+	}
+
+	void *mem = alloc(p_bytes);
+	memcpy(mem, p_ptr, size);
+	return mem;
+}
+
+void FrameArena::rewind(const Marker &p_marker) {
+	current_block = p_marker.block;
+	offset = p_marker.offset;
+	base = p_marker.base;
+}
+
+void FrameArena::reset() {
+	ERR_FAIL_COND_MSG(scope_depth > 0, "Can't reset a frame arena while a scope is using it.");
+
+	if (blocks.size() > 1) {
+		// The frame didn't fit in a single block, merge them so the next one does.
+		uint64_t capacity = get_capacity();
+		_free_blocks();
+
+		Block block;
+		block.size = uint32_t(MIN(capacity, uint64_t(0x80000000)));
+		block.memory = (uint8_t *)memalloc(block.size);
+		CRASH_COND_MSG(!block.memory, "Out of memory");
+		block_allocations++;
+		blocks.push_back(block);
+	}
+
+	current_block = 0;
+	offset = 0;
+	base = 0;
+}
+
+uint64_t FrameArena::get_capacity() const {
+	uint64_t capacity = 0;
+	for (uint32_t i = 0; i < blocks.size(); i++) {
+		capacity += blocks[i].size;
+	}
+	return capacity;
+}
+
+FrameArena::Stats FrameArena::get_stats() const {
+	Stats stats;
+	stats.used = get_used();
+	stats.capacity = get_capacity();
+	stats.peak = peak;
+	stats.block_allocations = block_allocations;
+	return stats;
+}
+
+void FrameArena::_free_blocks() {
+	for (uint32_t i = 0; i < blocks.size(); i++) {
+		memfree(blocks[i].memory);
+	}
+	blocks.reset();
+}
+
+FrameArena::~FrameArena() {
+	_free_blocks();
+}
@@ -0,0 +1,178 @@
+/*************************************************************************/
+/*  frame_arena.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include "core/error/error_macros.h"
+#include "core/templates/list.h"
+#include "core/templates/local_vector.h"
+
+// Bump allocator for scratch data that doesn't outlive the current frame.
+//
+// Every thread owns an arena (get_thread_arena()). Allocating is a pointer
+// bump, and freeing does nothing unless the block is the last one allocated.
+// Memory is reclaimed in bulk, either when a Scope ends or when the owning
+// thread calls reset() at the end of its frame. When a frame needed more than
+// one block, reset() replaces them with a single block large enough for all of
+// them, so after the first few frames the arena stops touching the heap.
+
+class FrameArena {
+public:
+	enum {
+		ALIGNMENT = 16,
+		MIN_BLOCK_SIZE = 64 * 1024,
+	};
+
+	struct Marker {
+		uint32_t block = 0;
+		uint32_t offset = 0;
+		uint64_t base = 0;
+	};
+
+	// Rewinds the arena to where it was when the scope was created.
+	// Scopes can be nested, and reset() is refused while any is active.
+	class Scope {
+		FrameArena *arena;
+		Marker marker;
+
+	public:
+		_FORCE_INLINE_ Scope(FrameArena *p_arena = get_thread_arena()) {
+			arena = p_arena;
+			marker = arena->get_marker();
+			arena->scope_depth++;
+		}
+		_FORCE_INLINE_ ~Scope() {
+			arena->scope_depth--;
+			arena->rewind(marker);
+		}
+	};
+
+	struct Stats {
+		uint64_t used = 0;
+		uint64_t capacity = 0;
+		uint64_t peak = 0;
+		uint64_t block_allocations = 0;
+	};
+
+private:
+	struct Block {
+		uint8_t *memory = nullptr;
+		uint32_t size = 0;
+	};
+
+	LocalVector<Block> blocks;
+	uint32_t current_block = 0;
+	uint32_t offset = 0; // Inside the current block.
+	uint64_t base = 0; // Bytes in the blocks before the current one.
+	uint64_t peak = 0;
+	uint64_t block_allocations = 0;
+	uint32_t scope_depth = 0;
+
+	static thread_local FrameArena thread_arena;
+
+	// Every allocation is preceded by a header holding its size, which keeps the
+	// returned pointers aligned and lets realloc() know how much to copy.
+	static _FORCE_INLINE_ uint32_t _get_footprint(size_t p_bytes) {
+		return ALIGNMENT + ((p_bytes + ALIGNMENT - 1) & ~size_t(ALIGNMENT - 1));
+	}
+	static _FORCE_INLINE_ uint64_t &_get_size(void *p_ptr) {
+		return *(uint64_t *)((uint8_t *)p_ptr - ALIGNMENT);
+	}
+	_FORCE_INLINE_ bool _is_last(void *p_ptr) {
+		return current_block < blocks.size() && (uint8_t *)p_ptr + _get_footprint(_get_size(p_ptr)) - ALIGNMENT == blocks[current_block].memory + offset;
+	}
+
+	void *_alloc_slow(size_t p_bytes);
+	void _free_blocks();
+
+public:
+	_FORCE_INLINE_ void *alloc(size_t p_bytes) {
+		uint32_t footprint = _get_footprint(p_bytes);
+		if (unlikely(current_block >= blocks.size() || offset + footprint > blocks[current_block].size)) {
+			return _alloc_slow(p_bytes);
+		}
+		uint8_t *mem = blocks[current_block].memory + offset;
+		offset += footprint;
+		if (base + offset > peak) {
+			peak = base + offset;
+		}
+		*(uint64_t *)mem = p_bytes;
+		return mem + ALIGNMENT;
+	}
+
+	void *realloc(void *p_ptr, size_t p_bytes);
+
+	_FORCE_INLINE_ void free(void *p_ptr) {
+		if (p_ptr && _is_last(p_ptr)) {
+			offset -= _get_footprint(_get_size(p_ptr));
+		}
+	}
+
+	_FORCE_INLINE_ Marker get_marker() const {
+		Marker marker;
+		marker.block = current_block;
+		marker.offset = offset;
+		marker.base = base;
+		return marker;
+	}
+	void rewind(const Marker &p_marker);
+
+	// Releases everything allocated from the arena. Called by the owning thread
+	// once its frame is done.
+	void reset();
+
+	_FORCE_INLINE_ uint64_t get_used() const { return base + offset; }
+	uint64_t get_capacity() const;
+	Stats get_stats() const;
+
+	static _FORCE_INLINE_ FrameArena *get_thread_arena() { return &thread_arena; }
+
+	FrameArena() {}
+	~FrameArena();
+};
+
+// Allocator for containers that take one (LocalVector, List), backed by the
+// calling thread's arena. Containers using it must be destroyed on the thread
+// that created them, before the end of the frame.
+class FrameArenaAllocator {
+public:
+	_FORCE_INLINE_ static void *alloc(size_t p_memory) { return FrameArena::get_thread_arena()->alloc(p_memory); }
+	_FORCE_INLINE_ static void *realloc(void *p_ptr, size_t p_memory) { return FrameArena::get_thread_arena()->realloc(p_ptr, p_memory); }
+	_FORCE_INLINE_ static void free(void *p_ptr) { FrameArena::get_thread_arena()->free(p_ptr); }
+};
+
+template <class T>
+using FrameLocalVector = LocalVector<T, uint32_t, false, FrameArenaAllocator>;
+
+template <class T>
+using FrameList = List<T, FrameArenaAllocator>;
+
+#endif // FRAME_ARENA_H
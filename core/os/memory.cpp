@@ -31,10 +31,12 @@
 #include "memory.h"
 
 #include "core/error/error_macros.h"
+#include "core/os/small_object_allocator.h"
 #include "core/templates/safe_refcount.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 void *operator new(size_t p_size, const char *p_description) {
 	return Memory::alloc_static(p_size, false);
@@ -65,14 +67,36 @@ SafeNumeric<uint64_t> Memory::max_usage;
 
 SafeNumeric<uint64_t> Memory::alloc_count;
 
+// The size stored in the padding keeps its top byte for the size class of
+// the block, 0 when it comes from malloc().
+#define SIZE_CLASS_SHIFT 56
+#define SIZE_MASK ((uint64_t(1) << SIZE_CLASS_SHIFT) - 1)
+
+static _FORCE_INLINE_ void _free_block(void *p_mem, uint32_t p_size_class) {
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	if (p_size_class) {
+		SmallObjectAllocator::free(p_mem, p_size_class);
+		return;
+	}
+#endif
+	free(p_mem);
+}
+
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
 #endif
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	// Blocks always carry the padding, to know their size class when freed.
+	uint32_t size_class = SmallObjectAllocator::get_size_class(p_bytes + PAD_ALIGN);
+	void *mem = size_class ? SmallObjectAllocator::alloc(size_class) : malloc(p_bytes + PAD_ALIGN);
+#else
+	uint32_t size_class = 0;
 	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+#endif
 
 	ERR_FAIL_COND_V(!mem, nullptr);
 
@@ -80,7 +104,7 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
 	if (prepad) {
 		uint64_t *s = (uint64_t *)mem;
-		*s = p_bytes;
+		*s = p_bytes | (uint64_t(size_class) << SIZE_CLASS_SHIFT);
 
 		uint8_t *s8 = (uint8_t *)mem;
 
@@ -101,7 +125,7 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_memory;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -110,31 +134,54 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 	if (prepad) {
 		mem -= PAD_ALIGN;
 		uint64_t *s = (uint64_t *)mem;
+		uint32_t size_class = *s >> SIZE_CLASS_SHIFT;
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
+		uint64_t old_bytes = *s & SIZE_MASK;
+#endif
 
 #ifdef DEBUG_ENABLED
-		if (p_bytes > *s) {
-			uint64_t new_mem_usage = mem_usage.add(p_bytes - *s);
+		if (p_bytes > old_bytes) {
+			uint64_t new_mem_usage = mem_usage.add(p_bytes - old_bytes);
 			max_usage.exchange_if_greater(new_mem_usage);
 		} else {
-			mem_usage.sub(*s - p_bytes);
+			mem_usage.sub(old_bytes - p_bytes);
 		}
 #endif
 
 		if (p_bytes == 0) {
-			free(mem);
+			_free_block(mem, size_class);
 			return nullptr;
-		} else {
-			*s = p_bytes;
+		}
 
-			mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
-			ERR_FAIL_COND_V(!mem, nullptr);
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+		if (size_class) {
+			if (p_bytes + PAD_ALIGN <= SmallObjectAllocator::get_block_size(size_class)) {
+				*s = p_bytes | (uint64_t(size_class) << SIZE_CLASS_SHIFT);
+				return mem + PAD_ALIGN;
+			}
 
-			s = (uint64_t *)mem;
+			// Outgrew its size class, move it. The rest of the padding is
+			// copied too, as CowData keeps its header there.
+			uint32_t new_size_class = SmallObjectAllocator::get_size_class(p_bytes + PAD_ALIGN);
+			uint8_t *new_mem = (uint8_t *)(new_size_class ? SmallObjectAllocator::alloc(new_size_class) : malloc(p_bytes + PAD_ALIGN));
+			ERR_FAIL_COND_V(!new_mem, nullptr);
 
-			*s = p_bytes;
+			memcpy(new_mem + sizeof(uint64_t), mem + sizeof(uint64_t), PAD_ALIGN - sizeof(uint64_t) + MIN(old_bytes, (uint64_t)p_bytes));
+			SmallObjectAllocator::free(mem, size_class);
 
-			return mem + PAD_ALIGN;
+			*(uint64_t *)new_mem = p_bytes | (uint64_t(new_size_class) << SIZE_CLASS_SHIFT);
+			return new_mem + PAD_ALIGN;
 		}
+#endif
+
+		mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
+		ERR_FAIL_COND_V(!mem, nullptr);
+
+		s = (uint64_t *)mem;
+
+		*s = p_bytes;
+
+		return mem + PAD_ALIGN;
 	} else {
 		mem = (uint8_t *)realloc(mem, p_bytes);
 
@@ -149,7 +196,7 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_ptr;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -159,13 +206,13 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 	if (prepad) {
 		mem -= PAD_ALIGN;
+		uint64_t *s = (uint64_t *)mem;
 
 #ifdef DEBUG_ENABLED
-		uint64_t *s = (uint64_t *)mem;
-		mem_usage.sub(*s);
+		mem_usage.sub(*s & SIZE_MASK);
 #endif
 
-		free(mem);
+		_free_block(mem, *s >> SIZE_CLASS_SHIFT);
 	} else {
 		free(mem);
 	}
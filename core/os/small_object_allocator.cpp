@@ -0,0 +1,320 @@
+/*************************************************************************/
+/*  small_object_allocator.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "small_object_allocator.h"
+
+#include "core/os/memory.h"
+#include "core/os/spin_lock.h"
+#include "core/string/print_string.h"
+#include "core/variant/variant.h"
+
+#include <stdlib.h>
+#include <atomic>
+
+const uint8_t SmallObjectAllocator::size_classes[MAX_BLOCK_SIZE / 16 + 1] = {
+	1, 1, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 14, 14, 14, 14,
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16
+};
+
+const uint32_t SmallObjectAllocator::block_sizes[SIZE_CLASS_COUNT + 1] = {
+	0, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 512, 768, 1024
+};
+
+// Free blocks are chained through their first bytes. The first block of a
+// batch also links to the next batch in the depot.
+struct SmallObjectFreeBlock {
+	SmallObjectFreeBlock *next;
+	SmallObjectFreeBlock *next_batch;
+	uint32_t batch_count;
+};
+
+struct SmallObjectDepot {
+	SpinLock lock;
+	SmallObjectFreeBlock *batches = nullptr;
+	std::atomic<uint64_t> reserved_blocks = { 0 };
+};
+
+struct SmallObjectThreadCache {
+	SmallObjectFreeBlock *free_lists[SmallObjectAllocator::SIZE_CLASS_COUNT + 1] = {};
+	uint32_t free_counts[SmallObjectAllocator::SIZE_CLASS_COUNT + 1] = {};
+	// Only written by the owner thread, read by get_stats().
+	std::atomic<uint64_t> allocations[SmallObjectAllocator::SIZE_CLASS_COUNT + 1] = {};
+	std::atomic<uint64_t> frees[SmallObjectAllocator::SIZE_CLASS_COUNT + 1] = {};
+
+	SmallObjectThreadCache *prev = nullptr;
+	SmallObjectThreadCache *next = nullptr;
+};
+
+struct SmallObjectThreadCacheGuard {
+	bool active = false;
+	~SmallObjectThreadCacheGuard();
+};
+
+static SmallObjectDepot depots[SmallObjectAllocator::SIZE_CLASS_COUNT + 1];
+
+static SpinLock caches_lock;
+static SmallObjectThreadCache *caches = nullptr;
+// Counters of exited threads, and of allocations made after a thread released its cache.
+static std::atomic<uint64_t> retired_allocations[SmallObjectAllocator::SIZE_CLASS_COUNT + 1] = {};
+static std::atomic<uint64_t> retired_frees[SmallObjectAllocator::SIZE_CLASS_COUNT + 1] = {};
+
+static thread_local SmallObjectThreadCache *thread_cache = nullptr;
+static thread_local bool thread_cache_released = false;
+static thread_local SmallObjectThreadCacheGuard thread_cache_guard;
+
+static _FORCE_INLINE_ uint32_t _get_batch_size(uint32_t p_size_class) {
+	return MAX(4u, 4096 / SmallObjectAllocator::get_block_size(p_size_class));
+}
+
+static _FORCE_INLINE_ void _increment(std::atomic<uint64_t> &p_counter) {
+	// Single writer, no need for an atomic read-modify-write.
+	p_counter.store(p_counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+static void _push_batch(uint32_t p_size_class, SmallObjectFreeBlock *p_batch, uint32_t p_count) {
+	SmallObjectDepot &depot = depots[p_size_class];
+	p_batch->batch_count = p_count;
+	depot.lock.lock();
+	p_batch->next_batch = depot.batches;
+	depot.batches = p_batch;
+	depot.lock.unlock();
+}
+
+// Takes a batch from the depot, carving a new chunk if it is empty.
+static SmallObjectFreeBlock *_pop_batch(uint32_t p_size_class, uint32_t &r_count) {
+	SmallObjectDepot &depot = depots[p_size_class];
+
+	depot.lock.lock();
+	SmallObjectFreeBlock *batch = depot.batches;
+	if (batch) {
+		depot.batches = batch->next_batch;
+		depot.lock.unlock();
+		r_count = batch->batch_count;
+		return batch;
+	}
+	depot.lock.unlock();
+
+	uint8_t *chunk = (uint8_t *)malloc(SmallObjectAllocator::CHUNK_SIZE);
+	if (!chunk) {
+		r_count = 0;
+		return nullptr;
+	}
+
+	uint32_t block_size = SmallObjectAllocator::get_block_size(p_size_class);
+	uint32_t block_count = SmallObjectAllocator::CHUNK_SIZE / block_size;
+	uint32_t batch_size = _get_batch_size(p_size_class);
+	depot.reserved_blocks.fetch_add(block_count, std::memory_order_relaxed);
+
+	// Keep the first batch, hand the others to the depot.
+	SmallObjectFreeBlock *first = nullptr;
+	uint32_t first_count = 0;
+	for (uint32_t from = 0; from < block_count; from += batch_size) {
+		uint32_t count = MIN(batch_size, block_count - from);
+		SmallObjectFreeBlock *head = (SmallObjectFreeBlock *)(chunk + from * block_size);
+		for (uint32_t i = 0; i < count; i++) {
+			SmallObjectFreeBlock *block = (SmallObjectFreeBlock *)(chunk + (from + i) * block_size);
+			block->next = i + 1 < count ? (SmallObjectFreeBlock *)(chunk + (from + i + 1) * block_size) : nullptr;
+		}
+		if (!first) {
+			first = head;
+			first_count = count;
+		} else {
+			_push_batch(p_size_class, head, count);
+		}
+	}
+
+	r_count = first_count;
+	return first;
+}
+
+static SmallObjectThreadCache *_get_thread_cache() {
+	SmallObjectThreadCache *cache = thread_cache;
+	if (likely(cache)) {
+		return cache;
+	}
+	if (thread_cache_released) {
+		return nullptr; // The thread is exiting.
+	}
+
+	void *mem = malloc(sizeof(SmallObjectThreadCache));
+	if (!mem) {
+		return nullptr;
+	}
+	cache = memnew_placement(mem, SmallObjectThreadCache);
+
+	caches_lock.lock();
+	cache->next = caches;
+	if (caches) {
+		caches->prev = cache;
+	}
+	caches = cache;
+	caches_lock.unlock();
+
+	thread_cache = cache;
+	thread_cache_guard.active = true; // Registers the guard, so the cache is released when the thread exits.
+	return cache;
+}
+
+SmallObjectThreadCacheGuard::~SmallObjectThreadCacheGuard() {
+	SmallObjectThreadCache *cache = thread_cache;
+	thread_cache = nullptr;
+	thread_cache_released = true;
+	if (!cache) {
+		return;
+	}
+
+	caches_lock.lock();
+	for (uint32_t i = 1; i <= SmallObjectAllocator::SIZE_CLASS_COUNT; i++) {
+		if (cache->free_lists[i]) {
+			_push_batch(i, cache->free_lists[i], cache->free_counts[i]);
+		}
+		retired_allocations[i].fetch_add(cache->allocations[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		retired_frees[i].fetch_add(cache->frees[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	if (cache->prev) {
+		cache->prev->next = cache->next;
+	} else {
+		caches = cache->next;
+	}
+	if (cache->next) {
+		cache->next->prev = cache->prev;
+	}
+	caches_lock.unlock();
+
+	cache->~SmallObjectThreadCache();
+	::free(cache);
+}
+
+void *SmallObjectAllocator::_alloc_from_depot(uint32_t p_size_class) {
+	uint32_t count;
+	SmallObjectFreeBlock *batch = _pop_batch(p_size_class, count);
+	if (!batch) {
+		return nullptr;
+	}
+	if (batch->next) {
+		_push_batch(p_size_class, batch->next, count - 1);
+	}
+	retired_allocations[p_size_class].fetch_add(1, std::memory_order_relaxed);
+	return batch;
+}
+
+void SmallObjectAllocator::_free_to_depot(void *p_ptr, uint32_t p_size_class) {
+	SmallObjectFreeBlock *block = (SmallObjectFreeBlock *)p_ptr;
+	block->next = nullptr;
+	_push_batch(p_size_class, block, 1);
+	retired_frees[p_size_class].fetch_add(1, std::memory_order_relaxed);
+}
+
+void *SmallObjectAllocator::alloc(uint32_t p_size_class) {
+	SmallObjectThreadCache *cache = _get_thread_cache();
+	if (unlikely(!cache)) {
+		return _alloc_from_depot(p_size_class);
+	}
+
+	SmallObjectFreeBlock *block = cache->free_lists[p_size_class];
+	if (unlikely(!block)) {
+		block = _pop_batch(p_size_class, cache->free_counts[p_size_class]);
+		if (!block) {
+			return nullptr;
+		}
+	}
+
+	cache->free_lists[p_size_class] = block->next;
+	cache->free_counts[p_size_class]--;
+	_increment(cache->allocations[p_size_class]);
+	return block;
+}
+
+void SmallObjectAllocator::free(void *p_ptr, uint32_t p_size_class) {
+	SmallObjectThreadCache *cache = _get_thread_cache();
+	if (unlikely(!cache)) {
+		_free_to_depot(p_ptr, p_size_class);
+		return;
+	}
+
+	SmallObjectFreeBlock *block = (SmallObjectFreeBlock *)p_ptr;
+	block->next = cache->free_lists[p_size_class];
+	cache->free_lists[p_size_class] = block;
+	cache->free_counts[p_size_class]++;
+	_increment(cache->frees[p_size_class]);
+
+	uint32_t batch_size = _get_batch_size(p_size_class);
+	if (unlikely(cache->free_counts[p_size_class] >= batch_size * 2)) {
+		// Give a batch back, so blocks freed by this thread can be reused by others.
+		SmallObjectFreeBlock *last = block;
+		for (uint32_t i = 1; i < batch_size; i++) {
+			last = last->next;
+		}
+		cache->free_lists[p_size_class] = last->next;
+		cache->free_counts[p_size_class] -= batch_size;
+		last->next = nullptr;
+		_push_batch(p_size_class, block, batch_size);
+	}
+}
+
+void SmallObjectAllocator::get_stats(SizeClassStats *r_stats) {
+	for (uint32_t i = 1; i <= SIZE_CLASS_COUNT; i++) {
+		SizeClassStats &stats = r_stats[i - 1];
+		stats.block_size = block_sizes[i];
+		stats.allocations = retired_allocations[i].load(std::memory_order_relaxed);
+		stats.frees = retired_frees[i].load(std::memory_order_relaxed);
+		stats.reserved_blocks = depots[i].reserved_blocks.load(std::memory_order_relaxed);
+	}
+
+	caches_lock.lock();
+	for (SmallObjectThreadCache *cache = caches; cache; cache = cache->next) {
+		for (uint32_t i = 1; i <= SIZE_CLASS_COUNT; i++) {
+			r_stats[i - 1].allocations += cache->allocations[i].load(std::memory_order_relaxed);
+			r_stats[i - 1].frees += cache->frees[i].load(std::memory_order_relaxed);
+		}
+	}
+	caches_lock.unlock();
+}
+
+void SmallObjectAllocator::print_stats() {
+	SizeClassStats stats[SIZE_CLASS_COUNT];
+	get_stats(stats);
+
+	for (uint32_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+		if (stats[i].allocations == 0) {
+			continue;
+		}
+		print_line(vformat("SmallObjectAllocator: %d bytes: %d allocations, %d frees, %d live, %d KiB reserved.", stats[i].block_size,
+				stats[i].allocations, stats[i].frees, stats[i].allocations - stats[i].frees, stats[i].reserved_blocks * stats[i].block_size / 1024));
+	}
+}
+
+bool SmallObjectAllocator::is_enabled() {
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,88 @@
+/*************************************************************************/
+/*  small_object_allocator.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SMALL_OBJECT_ALLOCATOR_H
+#define SMALL_OBJECT_ALLOCATOR_H
+
+#include "core/typedefs.h"
+
+#include <stddef.h>
+
+// Size class allocator for small blocks, used by Memory::alloc_static when
+// built with small_object_allocator=yes.
+//
+// Every thread keeps a free list per size class, so most allocations and frees
+// don't synchronize at all. Lists exchange fixed size batches of blocks with a
+// central depot when they run empty or grow too long, and the depot carves new
+// blocks out of larger chunks. Chunks are never given back to the system.
+
+class SmallObjectAllocator {
+public:
+	enum {
+		SIZE_CLASS_COUNT = 16,
+		MAX_BLOCK_SIZE = 1024,
+		CHUNK_SIZE = 64 * 1024,
+	};
+
+	struct SizeClassStats {
+		uint32_t block_size = 0;
+		uint64_t allocations = 0;
+		uint64_t frees = 0;
+		uint64_t reserved_blocks = 0;
+	};
+
+private:
+	static const uint8_t size_classes[MAX_BLOCK_SIZE / 16 + 1];
+	static const uint32_t block_sizes[SIZE_CLASS_COUNT + 1];
+
+	static void *_alloc_from_depot(uint32_t p_size_class);
+	static void _free_to_depot(void *p_ptr, uint32_t p_size_class);
+
+public:
+	// Returns the size class (starting at 1) for blocks of p_bytes, or 0 if
+	// p_bytes is too large for this allocator.
+	static _FORCE_INLINE_ uint32_t get_size_class(size_t p_bytes) {
+		return p_bytes <= MAX_BLOCK_SIZE ? size_classes[(p_bytes + 15) >> 4] : 0;
+	}
+	static _FORCE_INLINE_ uint32_t get_block_size(uint32_t p_size_class) {
+		return block_sizes[p_size_class];
+	}
+
+	static void *alloc(uint32_t p_size_class);
+	static void free(void *p_ptr, uint32_t p_size_class);
+
+	// Fills SIZE_CLASS_COUNT entries, one per size class.
+	static void get_stats(SizeClassStats *r_stats);
+	static void print_stats();
+
+	static bool is_enabled();
+};
+
+#endif // SMALL_OBJECT_ALLOCATOR_H
@@ -0,0 +1,382 @@
+/*************************************************************************/
+/*  task_scheduler.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "task_scheduler.h"
+
+#include "core/os/os.h"
+
+TaskScheduler *TaskScheduler::singleton = nullptr;
+thread_local int TaskScheduler::worker_index = -1;
+
+void TaskScheduler::TaskQueue::_grow() {
+	uint32_t c = count.load(std::memory_order_relaxed);
+	uint32_t new_capacity = capacity ? capacity * 2 : 64;
+	Task **new_tasks = (Task **)memalloc(sizeof(Task *) * new_capacity);
+	for (uint32_t i = 0; i < c; i++) {
+		new_tasks[i] = tasks[(head + i) & (capacity - 1)];
+	}
+	if (tasks) {
+		memfree(tasks);
+	}
+	tasks = new_tasks;
+	capacity = new_capacity;
+	head = 0;
+}
+
+void TaskScheduler::TaskQueue::push_back(Task *p_task) {
+	lock.lock();
+	uint32_t c = count.load(std::memory_order_relaxed);
+	if (c == capacity) {
+		_grow();
+	}
+	tasks[(head + c) & (capacity - 1)] = p_task;
+	count.store(c + 1, std::memory_order_relaxed);
+	lock.unlock();
+}
+
+void TaskScheduler::TaskQueue::push_front(Task *p_task) {
+	lock.lock();
+	uint32_t c = count.load(std::memory_order_relaxed);
+	if (c == capacity) {
+		_grow();
+	}
+	head = (head - 1) & (capacity - 1);
+	tasks[head] = p_task;
+	count.store(c + 1, std::memory_order_relaxed);
+	lock.unlock();
+}
+
+TaskScheduler::Task *TaskScheduler::TaskQueue::pop_back() {
+	if (count.load(std::memory_order_relaxed) == 0) {
+		return nullptr;
+	}
+	Task *task = nullptr;
+	lock.lock();
+	uint32_t c = count.load(std::memory_order_relaxed);
+	if (c > 0) {
+		c--;
+		task = tasks[(head + c) & (capacity - 1)];
+		count.store(c, std::memory_order_relaxed);
+	}
+	lock.unlock();
+	return task;
+}
+
+TaskScheduler::Task *TaskScheduler::TaskQueue::pop_front() {
+	if (count.load(std::memory_order_relaxed) == 0) {
+		return nullptr;
+	}
+	Task *task = nullptr;
+	lock.lock();
+	uint32_t c = count.load(std::memory_order_relaxed);
+	if (c > 0) {
+		task = tasks[head];
+		head = (head + 1) & (capacity - 1);
+		count.store(c - 1, std::memory_order_relaxed);
+	}
+	lock.unlock();
+	return task;
+}
+
+bool TaskScheduler::TaskQueue::move_to_front(Task *p_task) {
+	bool found = false;
+	lock.lock();
+	uint32_t c = count.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < c; i++) {
+		if (tasks[(head + i) & (capacity - 1)] != p_task) {
+			continue;
+		}
+		for (uint32_t j = i; j > 0; j--) {
+			tasks[(head + j) & (capacity - 1)] = tasks[(head + j - 1) & (capacity - 1)];
+		}
+		tasks[head] = p_task;
+		found = true;
+		break;
+	}
+	lock.unlock();
+	return found;
+}
+
+void TaskScheduler::_enqueue(Task *p_task) {
+	if (p_task->priority == PRIORITY_LOW) {
+		low_priority_lock.lock();
+		if (p_task->promoted) {
+			low_priority_queue.push_front(p_task);
+		} else {
+			low_priority_queue.push_back(p_task);
+		}
+		low_priority_lock.unlock();
+	} else if (worker_index >= 0) {
+		workers[worker_index].queue.push_back(p_task);
+	} else {
+		injection_queue.push_back(p_task);
+	}
+
+	if (sleeping_workers.load() > 0) {
+		work_available.post();
+	}
+}
+
+TaskScheduler::Task *TaskScheduler::_pop_task(bool p_low_priority) {
+	Task *task = nullptr;
+	uint32_t start = 0;
+
+	if (worker_index >= 0) {
+		task = workers[worker_index].queue.pop_back();
+		if (task) {
+			return task;
+		}
+		start = worker_index + 1;
+	}
+
+	task = injection_queue.pop_front();
+	if (task) {
+		return task;
+	}
+
+	// Steal from the other workers, starting with the next one to spread the load.
+	for (uint32_t i = 0; i < worker_count; i++) {
+		uint32_t victim = (start + i) % worker_count;
+		if ((int)victim == worker_index) {
+			continue;
+		}
+		task = workers[victim].queue.pop_front();
+		if (task) {
+			return task;
+		}
+	}
+
+	return p_low_priority ? low_priority_queue.pop_front() : nullptr;
+}
+
+void TaskScheduler::_run_task(Task *p_task) {
+	p_task->func(p_task->userdata);
+
+	LocalVector<Task *> dependents;
+	p_task->lock.lock();
+	p_task->completed.store(true);
+	SWAP(dependents, p_task->dependents);
+	p_task->lock.unlock();
+
+	for (uint32_t i = 0; i < dependents.size(); i++) {
+		if (dependents[i]->pending_dependencies.fetch_sub(1) == 1) {
+			_enqueue(dependents[i]);
+		}
+	}
+
+	if (p_task->waiting.load()) {
+		p_task->done.post();
+	}
+
+	_unref(p_task);
+}
+
+void TaskScheduler::_unref(Task *p_task) {
+	if (p_task->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		task_alloc_lock.lock();
+		task_allocator.free(p_task);
+		task_alloc_lock.unlock();
+	}
+}
+
+void TaskScheduler::_worker_function(void *p_user) {
+	Worker *worker = static_cast<Worker *>(p_user);
+	TaskScheduler *scheduler = worker->scheduler;
+	worker_index = worker->index;
+
+	while (true) {
+		Task *task = scheduler->_pop_task(true);
+		if (task) {
+			scheduler->_run_task(task);
+			continue;
+		}
+
+		if (scheduler->exit_threads.load()) {
+			break;
+		}
+
+		// Announce the intent to sleep before checking the queues one last time,
+		// so a task pushed in between is guaranteed to post the semaphore.
+		scheduler->sleeping_workers.fetch_add(1);
+		task = scheduler->_pop_task(true);
+		if (task || scheduler->exit_threads.load()) {
+			scheduler->sleeping_workers.fetch_sub(1);
+			if (task) {
+				scheduler->_run_task(task);
+			}
+			continue;
+		}
+		scheduler->work_available.wait();
+		scheduler->sleeping_workers.fetch_sub(1);
+	}
+
+	worker_index = -1;
+}
+
+TaskScheduler::TaskID TaskScheduler::add_task(TaskFunc p_func, void *p_userdata, const TaskID *p_dependencies, uint32_t p_dependency_count, Priority p_priority) {
+	ERR_FAIL_NULL_V(p_func, nullptr);
+
+	task_alloc_lock.lock();
+	Task *task = task_allocator.alloc();
+	task_alloc_lock.unlock();
+
+	task->func = p_func;
+	task->userdata = p_userdata;
+	task->refcount.store(2);
+	task->completed.store(false);
+	task->waiting.store(false);
+	task->priority = p_priority;
+	task->promoted = false;
+	// Held until all dependencies are registered, so the task can't be queued early.
+	task->pending_dependencies.store(1);
+
+	for (uint32_t i = 0; i < p_dependency_count; i++) {
+		Task *dependency = p_dependencies[i];
+		ERR_CONTINUE(dependency == nullptr);
+		dependency->lock.lock();
+		if (!dependency->completed.load()) {
+			task->pending_dependencies.fetch_add(1);
+			dependency->dependents.push_back(task);
+		}
+		dependency->lock.unlock();
+	}
+
+	if (task->pending_dependencies.fetch_sub(1) == 1) {
+		_enqueue(task);
+	}
+
+	return task;
+}
+
+bool TaskScheduler::is_task_completed(TaskID p_task) const {
+	ERR_FAIL_NULL_V(p_task, true);
+	return p_task->completed.load();
+}
+
+void TaskScheduler::promote_task(TaskID p_task) {
+	ERR_FAIL_NULL(p_task);
+	if (p_task->priority != PRIORITY_LOW) {
+		return;
+	}
+
+	low_priority_lock.lock();
+	if (!p_task->promoted) {
+		p_task->promoted = true;
+		// Not found when still waiting on dependencies (it's queued at the front
+		// then), or when already running.
+		low_priority_queue.move_to_front(p_task);
+	}
+	low_priority_lock.unlock();
+}
+
+void TaskScheduler::wait_for_task(TaskID p_task) {
+	ERR_FAIL_NULL(p_task);
+
+	// Without workers, nothing else would run the low priority tasks.
+	bool low_priority = p_task->priority == PRIORITY_LOW || worker_count == 0;
+	while (!p_task->completed.load()) {
+		Task *task = _pop_task(low_priority);
+		if (task) {
+			_run_task(task);
+			continue;
+		}
+
+		// Nothing left to help with, the task is running (or waiting on
+		// dependencies that are running) in another thread.
+		p_task->waiting.store(true);
+		if (!p_task->completed.load()) {
+			p_task->done.wait();
+		}
+		break;
+	}
+
+	_unref(p_task);
+}
+
+void TaskScheduler::release_task(TaskID p_task) {
+	ERR_FAIL_NULL(p_task);
+	_unref(p_task);
+}
+
+void TaskScheduler::init(int p_worker_count) {
+	ERR_FAIL_COND(workers != nullptr);
+
+#if !defined(NO_THREADS)
+	if (p_worker_count < 0) {
+		p_worker_count = OS::get_singleton()->get_processor_count();
+	}
+#else
+	// Without threads, all tasks are run by the thread that waits on them.
+	p_worker_count = 0;
+#endif
+
+	exit_threads.store(false);
+	worker_count = p_worker_count;
+	if (worker_count == 0) {
+		return;
+	}
+
+	workers = memnew_arr(Worker, worker_count);
+	for (uint32_t i = 0; i < worker_count; i++) {
+		workers[i].index = i;
+		workers[i].scheduler = this;
+		workers[i].thread.start(&TaskScheduler::_worker_function, &workers[i]);
+	}
+}
+
+void TaskScheduler::finish() {
+	if (workers == nullptr) {
+		return;
+	}
+
+	exit_threads.store(true);
+	for (uint32_t i = 0; i < worker_count; i++) {
+		work_available.post();
+	}
+	for (uint32_t i = 0; i < worker_count; i++) {
+		workers[i].thread.wait_to_finish();
+	}
+
+	memdelete_arr(workers);
+	workers = nullptr;
+	worker_count = 0;
+}
+
+TaskScheduler::TaskScheduler() :
+		task_allocator(256) {
+	sleeping_workers.store(0);
+	exit_threads.store(false);
+	singleton = this;
+}
+
+TaskScheduler::~TaskScheduler() {
+	finish();
+	singleton = nullptr;
+}
@@ -0,0 +1,218 @@
+/*************************************************************************/
+/*  task_scheduler.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include "core/os/memory.h"
+#include "core/os/semaphore.h"
+#include "core/os/spin_lock.h"
+#include "core/os/thread.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/paged_allocator.h"
+
+#include <atomic>
+
+// Engine-wide work-stealing task scheduler.
+//
+// Every worker thread owns a deque: tasks spawned from a worker are pushed to
+// the back of its own deque and popped from there (LIFO, cache friendly), idle
+// workers steal from the front of the other deques. Tasks added from threads
+// that are not workers go into a shared injection queue.
+//
+// Waiting on a task never blocks a thread while there is work left to do, the
+// waiter runs pending tasks instead. This makes nested parallel_for() (and
+// ThreadWorkPool::do_work() called from within a task) safe.
+//
+// Low priority tasks (background work like resource loads) go into a separate
+// queue, which only idle workers take from. A thread waiting on a high priority
+// task never runs them, so a frame can't end up waiting on a load.
+
+class TaskScheduler {
+public:
+	typedef void (*TaskFunc)(void *p_userdata);
+
+	enum Priority {
+		PRIORITY_HIGH,
+		PRIORITY_LOW,
+	};
+
+	struct Task;
+	typedef Task *TaskID;
+
+	struct Task {
+	private:
+		friend class TaskScheduler;
+
+		TaskFunc func = nullptr;
+		void *userdata = nullptr;
+
+		std::atomic<uint32_t> refcount; // One reference for the handle, one until completion.
+		std::atomic<uint32_t> pending_dependencies;
+		std::atomic<bool> completed;
+		std::atomic<bool> waiting;
+		Priority priority = PRIORITY_HIGH;
+		bool promoted = false; // Protected by low_priority_lock.
+
+		SpinLock lock; // Protects dependents.
+		LocalVector<Task *> dependents;
+		Semaphore done;
+	};
+
+private:
+	struct TaskQueue {
+		SpinLock lock;
+		Task **tasks = nullptr;
+		uint32_t capacity = 0;
+		uint32_t head = 0;
+		std::atomic<uint32_t> count;
+
+		void _grow();
+		void push_back(Task *p_task);
+		void push_front(Task *p_task);
+		Task *pop_back();
+		Task *pop_front();
+		bool move_to_front(Task *p_task);
+
+		TaskQueue() { count.store(0); }
+		~TaskQueue() {
+			if (tasks) {
+				memfree(tasks);
+			}
+		}
+	};
+
+	struct Worker {
+		Thread thread;
+		TaskQueue queue;
+		uint32_t index = 0;
+		TaskScheduler *scheduler = nullptr;
+	};
+
+	template <class C, class M, class U>
+	struct ParallelFor {
+		std::atomic<uint32_t> index;
+		uint32_t elements = 0;
+		C *instance = nullptr;
+		M method;
+		U userdata;
+
+		static void work(void *p_self) {
+			ParallelFor *self = static_cast<ParallelFor *>(p_self);
+			while (true) {
+				uint32_t work_index = self->index.fetch_add(1, std::memory_order_relaxed);
+				if (work_index >= self->elements) {
+					break;
+				}
+				(self->instance->*self->method)(work_index, self->userdata);
+			}
+		}
+	};
+
+	static TaskScheduler *singleton;
+	static thread_local int worker_index; // -1 on threads that are not workers.
+
+	Worker *workers = nullptr;
+	uint32_t worker_count = 0;
+
+	TaskQueue injection_queue;
+	TaskQueue low_priority_queue;
+	SpinLock low_priority_lock; // Queueing and promoting low priority tasks.
+
+	Semaphore work_available;
+	std::atomic<uint32_t> sleeping_workers;
+	std::atomic<bool> exit_threads;
+
+	SpinLock task_alloc_lock;
+	PagedAllocator<Task> task_allocator;
+
+	void _enqueue(Task *p_task);
+	Task *_pop_task(bool p_low_priority);
+	void _run_task(Task *p_task);
+	void _unref(Task *p_task);
+
+	static void _worker_function(void *p_user);
+
+public:
+	// Adds a task that runs once all of p_dependencies have completed.
+	// The returned handle must be passed to wait_for_task() or release_task().
+	TaskID add_task(TaskFunc p_func, void *p_userdata, const TaskID *p_dependencies = nullptr, uint32_t p_dependency_count = 0, Priority p_priority = PRIORITY_HIGH);
+	bool is_task_completed(TaskID p_task) const;
+	// Moves a low priority task ahead of the other low priority tasks, once it is queued.
+	void promote_task(TaskID p_task);
+	// Runs other tasks until p_task is completed, then releases the handle.
+	// Low priority tasks are only run while waiting on a low priority task.
+	void wait_for_task(TaskID p_task);
+	// Releases the handle without waiting, the task still runs.
+	void release_task(TaskID p_task);
+
+	// Calls (p_instance->*p_method)(index, p_userdata) for every index in [0, p_elements),
+	// spreading the calls over the workers and the calling thread. Can be nested.
+	template <class C, class M, class U>
+	void parallel_for(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		if (p_elements == 0) {
+			return;
+		}
+
+		ParallelFor<C, M, U> pf;
+		pf.index.store(0, std::memory_order_relaxed);
+		pf.elements = p_elements;
+		pf.instance = p_instance;
+		pf.method = p_method;
+		pf.userdata = p_userdata;
+
+		// The calling thread takes part in the work, so one task less is needed.
+		uint32_t task_count = MIN(p_elements, worker_count + 1) - 1;
+		TaskID *tasks = task_count ? (TaskID *)alloca(sizeof(TaskID) * task_count) : nullptr;
+		for (uint32_t i = 0; i < task_count; i++) {
+			tasks[i] = add_task(&ParallelFor<C, M, U>::work, &pf);
+		}
+
+		ParallelFor<C, M, U>::work(&pf);
+
+		for (uint32_t i = 0; i < task_count; i++) {
+			wait_for_task(tasks[i]);
+		}
+	}
+
+	_FORCE_INLINE_ uint32_t get_worker_count() const { return worker_count; }
+	// Index of the calling worker thread, or -1 when not called from a worker.
+	_FORCE_INLINE_ static int get_current_worker_index() { return worker_index; }
+
+	static TaskScheduler *get_singleton() { return singleton; }
+
+	void init(int p_worker_count = -1);
+	void finish();
+
+	TaskScheduler();
+	~TaskScheduler();
+};
+
+#endif // TASK_SCHEDULER_H
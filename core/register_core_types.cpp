@@ -68,8 +68,10 @@
 #include "core/object/class_db.h"
 #include "core/object/undo_redo.h"
 #include "core/os/main_loop.h"
+#include "core/os/task_scheduler.h"
 #include "core/string/optimized_translation.h"
 #include "core/string/translation.h"
+#include "core/variant/packed_struct_array.h"
 
 static Ref<ResourceFormatSaverBinary> resource_saver_binary;
 static Ref<ResourceFormatLoaderBinary> resource_loader_binary;
@@ -90,6 +92,8 @@ static _EngineDebugger *_engine_debugger = nullptr;
 
 static IP *ip = nullptr;
 
+static TaskScheduler *task_scheduler = nullptr;
+
 static _Geometry2D *_geometry_2d = nullptr;
 static _Geometry3D *_geometry_3d = nullptr;
 
@@ -104,6 +108,9 @@ void register_core_types() {
 
 	ObjectDB::setup();
 
+	task_scheduler = memnew(TaskScheduler);
+	task_scheduler->init();
+
 	StringName::setup();
 	ResourceLoader::initialize();
 
@@ -210,6 +217,7 @@ void register_core_types() {
 	ClassDB::register_class<AStar2D>();
 	ClassDB::register_class<EncodedObjectAsID>();
 	ClassDB::register_class<RandomNumberGenerator>();
+	ClassDB::register_class<PackedStructArray>();
 
 	ClassDB::register_class<JSONParseResult>();
 
@@ -326,4 +334,6 @@ void unregister_core_types() {
 	ResourceCache::clear();
 	CoreStringNames::free();
 	StringName::cleanup();
+
+	memdelete(task_scheduler);
 }
@@ -39,66 +39,191 @@ StaticCString StaticCString::create(const char *p_ptr) {
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+StringName::_Shard StringName::_shards[STRING_TABLE_SHARDS];
 
 StringName _scs_create(const char *p_chr) {
 	return (p_chr[0] ? StringName(StaticCString::create(p_chr)) : StringName());
 }
 
 bool StringName::configured = false;
-Mutex StringName::mutex;
+
+bool StringName::_Data::is_named(const char *p_name) const {
+	if (cname) {
+		return strcmp(cname, p_name) == 0;
+	}
+	return name == p_name;
+}
+
+bool StringName::_Data::is_named(const char32_t *p_name) const {
+	if (cname) {
+		// Static names are Latin-1, like String(const char *).
+		const char *c = cname;
+		while (*c && (char32_t)(uint8_t)*c == *p_name) {
+			c++;
+			p_name++;
+		}
+		return (char32_t)(uint8_t)*c == *p_name;
+	}
+	return name == p_name;
+}
+
+bool StringName::_Data::is_named(const String &p_name) const {
+	if (cname) {
+		return p_name == cname;
+	}
+	return name == p_name;
+}
+
+template <class T>
+StringName::_Data *StringName::_find(_Shard &p_shard, const T &p_name, uint32_t p_hash) {
+	_Data *data = p_shard.buckets[p_hash & p_shard.mask];
+
+	while (data) {
+		// compare hash first
+		if (data->hash == p_hash && data->is_named(p_name)) {
+			return data;
+		}
+		data = data->next;
+	}
+
+	return nullptr;
+}
+
+void StringName::_insert(_Shard &p_shard, _Data *p_data) {
+	if (p_shard.count > p_shard.mask) {
+		// Over a load factor of 1, double the buckets of this shard.
+		uint32_t new_size = (p_shard.mask + 1) << 1;
+		uint32_t new_mask = new_size - 1;
+		_Data **new_buckets = (_Data **)memalloc(sizeof(_Data *) * new_size);
+		memset(new_buckets, 0, sizeof(_Data *) * new_size);
+
+		for (uint32_t i = 0; i <= p_shard.mask; i++) {
+			_Data *data = p_shard.buckets[i];
+			while (data) {
+				_Data *next = data->next;
+				uint32_t idx = data->hash & new_mask;
+				data->prev = nullptr;
+				data->next = new_buckets[idx];
+				if (new_buckets[idx]) {
+					new_buckets[idx]->prev = data;
+				}
+				new_buckets[idx] = data;
+				data = next;
+			}
+		}
+
+		memfree(p_shard.buckets);
+		p_shard.buckets = new_buckets;
+		p_shard.mask = new_mask;
+	}
+
+	uint32_t idx = p_data->hash & p_shard.mask;
+	p_data->next = p_shard.buckets[idx];
+	p_data->prev = nullptr;
+	if (p_shard.buckets[idx]) {
+		p_shard.buckets[idx]->prev = p_data;
+	}
+	p_shard.buckets[idx] = p_data;
+	p_shard.count++;
+}
 
 void StringName::setup() {
 	ERR_FAIL_COND(configured);
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		_table[i] = nullptr;
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
+		uint32_t size = 1 << STRING_TABLE_SHARD_INITIAL_BITS;
+		_shards[i].buckets = (_Data **)memalloc(sizeof(_Data *) * size);
+		memset(_shards[i].buckets, 0, sizeof(_Data *) * size);
+		_shards[i].mask = size - 1;
+		_shards[i].count = 0;
 	}
 	configured = true;
 }
 
 void StringName::cleanup() {
-	MutexLock lock(mutex);
-
 	int lost_strings = 0;
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		while (_table[i]) {
-			_Data *d = _table[i];
-			lost_strings++;
-			if (OS::get_singleton()->is_stdout_verbose()) {
-				if (d->cname) {
-					print_line("Orphan StringName: " + String(d->cname));
-				} else {
-					print_line("Orphan StringName: " + String(d->name));
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
+		_Shard &shard = _shards[i];
+		MutexLock lock(shard.mutex);
+
+		for (uint32_t j = 0; j <= shard.mask; j++) {
+			while (shard.buckets[j]) {
+				_Data *d = shard.buckets[j];
+				lost_strings++;
+				if (OS::get_singleton()->is_stdout_verbose()) {
+					if (d->cname) {
+						print_line("Orphan StringName: " + String(d->cname));
+					} else {
+						print_line("Orphan StringName: " + String(d->name));
+					}
 				}
-			}
 
-			_table[i] = _table[i]->next;
-			memdelete(d);
+				shard.buckets[j] = shard.buckets[j]->next;
+				memdelete(d);
+			}
 		}
+
+		memfree(shard.buckets);
+		shard.buckets = nullptr;
+		shard.mask = 0;
+		shard.count = 0;
 	}
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
+	configured = false;
+}
+
+StringName::TableStats StringName::get_table_stats() {
+	TableStats stats;
+	ERR_FAIL_COND_V(!configured, stats);
+
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
+		_Shard &shard = _shards[i];
+		MutexLock lock(shard.mutex);
+
+		stats.names += shard.count;
+		stats.buckets += shard.mask + 1;
+		for (uint32_t j = 0; j <= shard.mask; j++) {
+			uint32_t chain = 0;
+			for (_Data *d = shard.buckets[j]; d; d = d->next) {
+				chain++;
+			}
+			if (chain) {
+				stats.used_buckets++;
+			}
+			stats.longest_chain = MAX(stats.longest_chain, chain);
+		}
+	}
+
+	stats.load_factor = stats.buckets ? float(stats.names) / float(stats.buckets) : 0.0;
+	return stats;
 }
 
 void StringName::unref() {
-	ERR_FAIL_COND(!configured);
+	if (!configured) {
+		// Names outliving cleanup() were already freed as orphans.
+		_data = nullptr;
+		return;
+	}
 
 	if (_data && _data->refcount.unref()) {
-		MutexLock lock(mutex);
+		_Shard &shard = _get_shard(_data->hash);
+		MutexLock lock(shard.mutex);
 
 		if (_data->prev) {
 			_data->prev->next = _data->next;
 		} else {
-			if (_table[_data->idx] != _data) {
+			uint32_t idx = _data->hash & shard.mask;
+			if (shard.buckets[idx] != _data) {
 				ERR_PRINT("BUG!");
 			}
-			_table[_data->idx] = _data->next;
+			shard.buckets[idx] = _data->next;
 		}
 
 		if (_data->next) {
 			_data->next->prev = _data->prev;
 		}
+		shard.count--;
 		memdelete(_data);
 	}
 
@@ -110,7 +235,7 @@ bool StringName::operator==(const String &p_name) const {
 		return (p_name.length() == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _data->is_named(p_name);
 }
 
 bool StringName::operator==(const char *p_name) const {
@@ -118,7 +243,7 @@ bool StringName::operator==(const char *p_name) const {
 		return (p_name[0] == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	return _data->is_named(p_name);
 }
 
 bool StringName::operator!=(const String &p_name) const {
@@ -162,21 +287,12 @@ StringName::StringName(const char *p_name) {
 		return; //empty, ignore
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
+	_Shard &shard = _get_shard(hash);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
+	MutexLock lock(shard.mutex);
 
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
+	_data = _find(shard, p_name, hash);
 
 	if (_data) {
 		if (_data->refcount.ref()) {
@@ -189,14 +305,8 @@ StringName::StringName(const char *p_name) {
 	_data->name = p_name;
 	_data->refcount.init();
 	_data->hash = hash;
-	_data->idx = idx;
 	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_insert(shard, _data);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -206,21 +316,12 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_static_string.ptr);
+	_Shard &shard = _get_shard(hash);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	MutexLock lock(shard.mutex);
 
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr) {
-			break;
-		}
-		_data = _data->next;
-	}
+	_data = _find(shard, p_static_string.ptr, hash);
 
 	if (_data) {
 		if (_data->refcount.ref()) {
@@ -233,14 +334,8 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	_data->refcount.init();
 	_data->hash = hash;
-	_data->idx = idx;
 	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_insert(shard, _data);
 }
 
 StringName::StringName(const String &p_name) {
@@ -248,23 +343,16 @@ StringName::StringName(const String &p_name) {
 
 	ERR_FAIL_COND(!configured);
 
-	if (p_name == String()) {
+	if (p_name.is_empty()) {
 		return;
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = p_name.hash();
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	_Shard &shard = _get_shard(hash);
 
-	_data = _table[idx];
+	MutexLock lock(shard.mutex);
 
-	while (_data) {
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
+	_data = _find(shard, p_name, hash);
 
 	if (_data) {
 		if (_data->refcount.ref()) {
@@ -277,14 +365,8 @@ StringName::StringName(const String &p_name) {
 	_data->name = p_name;
 	_data->refcount.init();
 	_data->hash = hash;
-	_data->idx = idx;
 	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_insert(shard, _data);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -295,20 +377,12 @@ StringName StringName::search(const char *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	_Shard &shard = _get_shard(hash);
 
-	_Data *_data = _table[idx];
+	MutexLock lock(shard.mutex);
 
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
+	_Data *_data = _find(shard, p_name, hash);
 
 	if (_data && _data->refcount.ref()) {
 		return StringName(_data);
@@ -325,21 +399,12 @@ StringName StringName::search(const char32_t *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
+	_Shard &shard = _get_shard(hash);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	MutexLock lock(shard.mutex);
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
+	_Data *_data = _find(shard, p_name, hash);
 
 	if (_data && _data->refcount.ref()) {
 		return StringName(_data);
@@ -349,23 +414,16 @@ StringName StringName::search(const char32_t *p_name) {
 }
 
 StringName StringName::search(const String &p_name) {
-	ERR_FAIL_COND_V(p_name == "", StringName());
+	ERR_FAIL_COND_V(!configured, StringName());
 
-	MutexLock lock(mutex);
+	ERR_FAIL_COND_V(p_name == "", StringName());
 
 	uint32_t hash = p_name.hash();
+	_Shard &shard = _get_shard(hash);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	MutexLock lock(shard.mutex);
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name()) {
-			break;
-		}
-		_data = _data->next;
-	}
+	_Data *_data = _find(shard, p_name, hash);
 
 	if (_data && _data->refcount.ref()) {
 		return StringName(_data);
@@ -379,15 +437,15 @@ StringName::~StringName() {
 }
 
 bool operator==(const String &p_name, const StringName &p_string_name) {
-	return p_name == p_string_name.operator String();
+	return p_string_name == p_name;
 }
 bool operator!=(const String &p_name, const StringName &p_string_name) {
-	return p_name != p_string_name.operator String();
+	return p_string_name != p_name;
 }
 
 bool operator==(const char *p_name, const StringName &p_string_name) {
-	return p_name == p_string_name.operator String();
+	return p_string_name == p_name;
 }
 bool operator!=(const char *p_name, const StringName &p_string_name) {
-	return p_name != p_string_name.operator String();
+	return !(p_string_name == p_name);
 }
@@ -43,10 +43,13 @@ struct StaticCString {
 };
 
 class StringName {
+	// The intern table is split in shards, selected by the high bits of the hash,
+	// each with its own lock and bucket array. Buckets use the low bits, and every
+	// shard grows independently once its load factor goes over 1.
 	enum {
-		STRING_TABLE_BITS = 12,
-		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_SHARD_BITS = 6,
+		STRING_TABLE_SHARDS = 1 << STRING_TABLE_SHARD_BITS,
+		STRING_TABLE_SHARD_INITIAL_BITS = 6,
 	};
 
 	struct _Data {
@@ -55,14 +58,32 @@ class StringName {
 		String name;
 
 		String get_name() const { return cname ? String(cname) : name; }
-		int idx = 0;
+		// Compare without building a temporary String.
+		bool is_named(const char *p_name) const;
+		bool is_named(const char32_t *p_name) const;
+		bool is_named(const String &p_name) const;
 		uint32_t hash = 0;
 		_Data *prev = nullptr;
 		_Data *next = nullptr;
 		_Data() {}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	struct _Shard {
+		BinaryMutex mutex;
+		_Data **buckets = nullptr;
+		uint32_t mask = 0;
+		uint32_t count = 0;
+	};
+
+	static _Shard _shards[STRING_TABLE_SHARDS];
+
+	_FORCE_INLINE_ static _Shard &_get_shard(uint32_t p_hash) {
+		return _shards[p_hash >> (32 - STRING_TABLE_SHARD_BITS)];
+	}
+
+	template <class T>
+	static _Data *_find(_Shard &p_shard, const T &p_name, uint32_t p_hash);
+	static void _insert(_Shard &p_shard, _Data *p_data);
 
 	_Data *_data = nullptr;
 
@@ -75,7 +96,6 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 	friend class Main;
-	static Mutex mutex;
 	static void setup();
 	static void cleanup();
 	static bool configured;
@@ -124,6 +144,16 @@ public:
 	static StringName search(const char32_t *p_name);
 	static StringName search(const String &p_name);
 
+	struct TableStats {
+		uint32_t names = 0;
+		uint32_t buckets = 0;
+		uint32_t used_buckets = 0;
+		uint32_t longest_chain = 0;
+		float load_factor = 0.0;
+	};
+
+	static TableStats get_table_stats();
+
 	struct AlphCompare {
 		_FORCE_INLINE_ bool operator()(const StringName &l, const StringName &r) const {
 			const char *l_cname = l._data ? l._data->cname : "";
@@ -0,0 +1,148 @@
+/*************************************************************************/
+/*  string_stream.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "string_stream.h"
+
+#include "core/os/file_access.h"
+
+void StringStream::_write_chunk(const char32_t *p_chars, int p_length) {
+	const CharString utf8 = String(p_chars, p_length).utf8();
+	file->store_buffer((const uint8_t *)utf8.get_data(), utf8.length());
+}
+
+LocalVector<char32_t> &StringStream::_get_free_chunk() {
+	if (!chunks.is_empty()) {
+		LocalVector<char32_t> &last = chunks[chunks.size() - 1];
+		if (last.size() < last.get_capacity()) {
+			return last;
+		}
+
+		if (file) {
+			// The only chunk is full. Grow it while it is small, or write it out and reuse it.
+			if (last.get_capacity() < CHUNK_SIZE) {
+				last.reserve(MIN(last.get_capacity() * 2, (uint32_t)CHUNK_SIZE));
+			} else {
+				_write_chunk(last.ptr(), last.size());
+				last.clear();
+			}
+			return last;
+		}
+	}
+
+	uint32_t size = chunks.is_empty() ? FIRST_CHUNK_SIZE : MIN(chunks[chunks.size() - 1].get_capacity() * 2, (uint32_t)CHUNK_SIZE);
+	chunks.push_back(LocalVector<char32_t>());
+	LocalVector<char32_t> &chunk = chunks[chunks.size() - 1];
+	chunk.reserve(size);
+	return chunk;
+}
+
+StringStream &StringStream::append(const char32_t *p_chars, int p_length) {
+	length += p_length;
+
+	while (p_length > 0) {
+		LocalVector<char32_t> &chunk = _get_free_chunk();
+		const uint32_t used = chunk.size();
+		const int count = MIN(p_length, int(chunk.get_capacity() - used));
+		chunk.resize(used + count);
+		memcpy(chunk.ptr() + used, p_chars, count * sizeof(char32_t));
+		p_chars += count;
+		p_length -= count;
+	}
+
+	return *this;
+}
+
+StringStream &StringStream::append(const String &p_string) {
+	if (file && p_string.length() >= CHUNK_SIZE) {
+		// Large strings go straight to the file, after what is pending.
+		flush();
+		length += p_string.length();
+		_write_chunk(p_string.get_data(), p_string.length());
+		return *this;
+	}
+
+	return append(p_string.get_data(), p_string.length());
+}
+
+StringStream &StringStream::append(const char *p_cstring) {
+	char32_t buffer[256];
+	int count = 0;
+	for (const char *c = p_cstring; *c; c++) {
+		if (count == 256) {
+			append(buffer, count);
+			count = 0;
+		}
+		buffer[count++] = *c;
+	}
+	return append(buffer, count);
+}
+
+String StringStream::as_string() const {
+	int total = 0;
+	for (uint32_t i = 0; i < chunks.size(); i++) {
+		total += chunks[i].size();
+	}
+	if (total == 0) {
+		return String();
+	}
+
+	String ret;
+	ret.resize(total + 1);
+	char32_t *dst = ret.ptrw();
+	for (uint32_t i = 0; i < chunks.size(); i++) {
+		memcpy(dst, chunks[i].ptr(), chunks[i].size() * sizeof(char32_t));
+		dst += chunks[i].size();
+	}
+	*dst = 0;
+
+	return ret;
+}
+
+void StringStream::flush() {
+	if (file && !chunks.is_empty()) {
+		LocalVector<char32_t> &chunk = chunks[0];
+		if (chunk.size()) {
+			_write_chunk(chunk.ptr(), chunk.size());
+			chunk.clear();
+		}
+	}
+}
+
+void StringStream::clear() {
+	chunks.clear();
+	length = 0;
+}
+
+StringStream::StringStream(FileAccess *p_file) {
+	file = p_file;
+}
+
+StringStream::~StringStream() {
+	flush();
+}
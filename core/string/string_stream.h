@@ -0,0 +1,98 @@
+/*************************************************************************/
+/*  string_stream.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef STRING_STREAM_H
+#define STRING_STREAM_H
+
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+
+class FileAccess;
+
+// Builds text out of many small pieces. Characters are kept in chunks, so
+// appending never reallocates or copies what was already written, and the
+// final String is assembled with a single allocation. The first chunk is
+// small and each new one doubles in size up to CHUNK_SIZE, so short texts
+// don't pay for a full chunk.
+//
+// When created with a FileAccess, its single chunk grows up to CHUNK_SIZE,
+// then is written to the file as UTF-8 every time it fills up, so the
+// complete text is never held in memory.
+class StringStream {
+	enum {
+		FIRST_CHUNK_SIZE = 64, // In characters.
+		CHUNK_SIZE = 4096,
+	};
+
+	LocalVector<LocalVector<char32_t>> chunks;
+	uint64_t length = 0;
+	FileAccess *file = nullptr;
+
+	void _write_chunk(const char32_t *p_chars, int p_length);
+	LocalVector<char32_t> &_get_free_chunk();
+
+public:
+	StringStream &append(const char32_t *p_chars, int p_length);
+	StringStream &append(const String &p_string);
+	StringStream &append(const char *p_cstring); // Latin-1, like String.
+
+	_FORCE_INLINE_ StringStream &append(char32_t p_char) {
+		return append(&p_char, 1);
+	}
+
+	_FORCE_INLINE_ StringStream &operator+=(const String &p_string) {
+		return append(p_string);
+	}
+
+	_FORCE_INLINE_ StringStream &operator+=(const char *p_cstring) {
+		return append(p_cstring);
+	}
+
+	_FORCE_INLINE_ StringStream &operator+=(char32_t p_char) {
+		return append(p_char);
+	}
+
+	// Total amount of characters appended, including those already written to the file.
+	_FORCE_INLINE_ uint64_t get_length() const {
+		return length;
+	}
+
+	// Returns the text which was not written to a file yet.
+	String as_string() const;
+
+	// Writes the pending text to the file, if there is one.
+	void flush();
+	void clear();
+
+	StringStream() {}
+	explicit StringStream(FileAccess *p_file);
+	~StringStream();
+};
+
+#endif // STRING_STREAM_H
@@ -54,12 +54,268 @@
 #define snprintf _snprintf_s
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USTRING_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define USTRING_NEON
+#include <arm_neon.h>
+#endif
+
 #define MAX_DIGITS 6
 #define UPPERCASE(m_c) (((m_c) >= 'a' && (m_c) <= 'z') ? ((m_c) - ('a' - 'A')) : (m_c))
 #define LOWERCASE(m_c) (((m_c) >= 'A' && (m_c) <= 'Z') ? ((m_c) + ('a' - 'A')) : (m_c))
 #define IS_DIGIT(m_d) ((m_d) >= '0' && (m_d) <= '9')
 #define IS_HEX_DIGIT(m_d) (((m_d) >= '0' && (m_d) <= '9') || ((m_d) >= 'a' && (m_d) <= 'f') || ((m_d) >= 'A' && (m_d) <= 'F'))
 
+/*
+ * Block helpers for the hot String loops (search, comparison, case conversion
+ * and UTF-8 transcoding). The vector loops only skip over blocks in which
+ * nothing interesting happens; the block which stops them, and the tail, go
+ * through the same scalar checks, so the results are exactly those of the
+ * plain loops.
+ */
+
+// Returns the index of the first p_char in p_str, or -1.
+static int _find_char(const char32_t *p_str, int p_len, char32_t p_char) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i needle = _mm_set1_epi32((int)p_char);
+	for (; i + 4 <= p_len; i += 4) {
+		const __m128i chars = _mm_loadu_si128((const __m128i *)(p_str + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(chars, needle))) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	const uint32x4_t needle = vdupq_n_u32(p_char);
+	for (; i + 4 <= p_len; i += 4) {
+		if (vmaxvq_u32(vceqq_u32(vld1q_u32((const uint32_t *)(p_str + i)), needle))) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		if (p_str[i] == p_char) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Returns the length of the run of characters at the start of p_str which are
+// ASCII and outside of [p_first, p_last]. Pass an empty range to only stop at
+// non-ASCII characters.
+static int _ascii_run_length(const char32_t *p_str, int p_len, char32_t p_first = 1, char32_t p_last = 0) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	// Non-ASCII characters are caught by the mask, so signed compares are fine for the range.
+	const __m128i high = _mm_set1_epi32(~0x7f);
+	const __m128i first = _mm_set1_epi32((int)p_first);
+	const __m128i last = _mm_set1_epi32((int)p_last);
+	for (; i + 4 <= p_len; i += 4) {
+		const __m128i chars = _mm_loadu_si128((const __m128i *)(p_str + i));
+		const __m128i ascii = _mm_cmpeq_epi32(_mm_and_si128(chars, high), _mm_setzero_si128());
+		const __m128i outside = _mm_or_si128(_mm_cmplt_epi32(chars, first), _mm_cmpgt_epi32(chars, last));
+		if (_mm_movemask_epi8(_mm_and_si128(ascii, outside)) != 0xffff) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	const uint32x4_t high = vdupq_n_u32(0x80);
+	const uint32x4_t first = vdupq_n_u32(p_first);
+	const uint32x4_t last = vdupq_n_u32(p_last);
+	for (; i + 4 <= p_len; i += 4) {
+		const uint32x4_t chars = vld1q_u32((const uint32_t *)(p_str + i));
+		const uint32x4_t inside = vandq_u32(vcgeq_u32(chars, first), vcleq_u32(chars, last));
+		if (vmaxvq_u32(vorrq_u32(vcgeq_u32(chars, high), inside))) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		const char32_t c = p_str[i];
+		if (c >= 0x80 || (c >= p_first && c <= p_last)) {
+			break;
+		}
+	}
+	return i;
+}
+
+// Copies the run of ASCII characters at the start of p_src to p_dst, switching
+// the case of the letters in [p_first, p_last], and returns its length.
+static int _convert_ascii_case_run(const char32_t *p_src, int p_len, char32_t p_first, char32_t p_last, char32_t *p_dst) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i high = _mm_set1_epi32(~0x7f);
+	const __m128i first = _mm_set1_epi32((int)p_first);
+	const __m128i last = _mm_set1_epi32((int)p_last);
+	const __m128i case_bit = _mm_set1_epi32(0x20);
+	for (; i + 4 <= p_len; i += 4) {
+		const __m128i chars = _mm_loadu_si128((const __m128i *)(p_src + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(chars, high), _mm_setzero_si128())) != 0xffff) {
+			break;
+		}
+		const __m128i outside = _mm_or_si128(_mm_cmplt_epi32(chars, first), _mm_cmpgt_epi32(chars, last));
+		_mm_storeu_si128((__m128i *)(p_dst + i), _mm_xor_si128(chars, _mm_andnot_si128(outside, case_bit)));
+	}
+#elif defined(USTRING_NEON)
+	const uint32x4_t high = vdupq_n_u32(0x80);
+	const uint32x4_t first = vdupq_n_u32(p_first);
+	const uint32x4_t last = vdupq_n_u32(p_last);
+	const uint32x4_t case_bit = vdupq_n_u32(0x20);
+	for (; i + 4 <= p_len; i += 4) {
+		const uint32x4_t chars = vld1q_u32((const uint32_t *)(p_src + i));
+		if (vmaxvq_u32(vcgeq_u32(chars, high))) {
+			break;
+		}
+		const uint32x4_t inside = vandq_u32(vcgeq_u32(chars, first), vcleq_u32(chars, last));
+		vst1q_u32((uint32_t *)(p_dst + i), veorq_u32(chars, vandq_u32(inside, case_bit)));
+	}
+#endif
+	for (; i < p_len && p_src[i] < 0x80; i++) {
+		const char32_t c = p_src[i];
+		p_dst[i] = (c >= p_first && c <= p_last) ? (c ^ 0x20) : c;
+	}
+	return i;
+}
+
+// Returns the first index at which p_a and p_b differ, or p_a holds a null
+// character, or p_len if there is none.
+static int _find_mismatch_or_null(const char32_t *p_a, const char32_t *p_b, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	for (; i + 4 <= p_len; i += 4) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(p_a + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(p_b + i));
+		const __m128i stop = _mm_or_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()), _mm_xor_si128(_mm_cmpeq_epi32(a, b), _mm_set1_epi32(-1)));
+		if (_mm_movemask_epi8(stop)) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 4 <= p_len; i += 4) {
+		const uint32x4_t a = vld1q_u32((const uint32_t *)(p_a + i));
+		const uint32x4_t b = vld1q_u32((const uint32_t *)(p_b + i));
+		if (vminvq_u32(vandq_u32(vceqq_u32(a, b), vtstq_u32(a, a))) == 0) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len; i++) {
+		if (p_a[i] != p_b[i] || p_a[i] == 0) {
+			return i;
+		}
+	}
+	return p_len;
+}
+
+// Copies the run of ASCII characters at the start of p_src to p_dst as bytes,
+// and returns its length.
+static int _narrow_ascii_run(const char32_t *p_src, int p_len, uint8_t *p_dst) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i high = _mm_set1_epi32(~0x7f);
+	for (; i + 16 <= p_len; i += 16) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(p_src + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(p_src + i + 4));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(p_src + i + 8));
+		const __m128i d = _mm_loadu_si128((const __m128i *)(p_src + i + 12));
+		const __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, high), _mm_setzero_si128())) != 0xffff) {
+			break;
+		}
+		const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		_mm_storeu_si128((__m128i *)(p_dst + i), bytes);
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 16 <= p_len; i += 16) {
+		const uint32x4_t a = vld1q_u32((const uint32_t *)(p_src + i));
+		const uint32x4_t b = vld1q_u32((const uint32_t *)(p_src + i + 4));
+		const uint32x4_t c = vld1q_u32((const uint32_t *)(p_src + i + 8));
+		const uint32x4_t d = vld1q_u32((const uint32_t *)(p_src + i + 12));
+		if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80) {
+			break;
+		}
+		const uint16x8_t ab = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+		const uint16x8_t cd = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+		vst1q_u8(p_dst + i, vcombine_u8(vmovn_u16(ab), vmovn_u16(cd)));
+	}
+#endif
+	for (; i < p_len && p_src[i] < 0x80; i++) {
+		p_dst[i] = p_src[i];
+	}
+	return i;
+}
+
+// Returns the length of the run of non-null ASCII bytes at the start of p_str.
+static int _ascii_byte_run_length(const uint8_t *p_str, int p_len) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= p_len; i += 16) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i *)(p_str + i));
+		if (_mm_movemask_epi8(_mm_or_si128(bytes, _mm_cmpeq_epi8(bytes, zero)))) {
+			break;
+		}
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 16 <= p_len; i += 16) {
+		const uint8x16_t bytes = vld1q_u8(p_str + i);
+		if (vmaxvq_u8(bytes) >= 0x80 || vminvq_u8(bytes) == 0) {
+			break;
+		}
+	}
+#endif
+	for (; i < p_len && uint8_t(p_str[i] - 1) < 0x7f; i++) {
+	}
+	return i;
+}
+
+// Copies the run of non-null ASCII bytes at the start of p_src to p_dst as
+// characters, and returns its length.
+static int _widen_ascii_run(const uint8_t *p_src, int p_len, char32_t *p_dst) {
+	int i = 0;
+#if defined(USTRING_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= p_len; i += 16) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i *)(p_src + i));
+		if (_mm_movemask_epi8(_mm_or_si128(bytes, _mm_cmpeq_epi8(bytes, zero)))) {
+			break;
+		}
+		const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_si128((__m128i *)(p_dst + i), _mm_unpacklo_epi16(low, zero));
+		_mm_storeu_si128((__m128i *)(p_dst + i + 4), _mm_unpackhi_epi16(low, zero));
+		_mm_storeu_si128((__m128i *)(p_dst + i + 8), _mm_unpacklo_epi16(high, zero));
+		_mm_storeu_si128((__m128i *)(p_dst + i + 12), _mm_unpackhi_epi16(high, zero));
+	}
+#elif defined(USTRING_NEON)
+	for (; i + 16 <= p_len; i += 16) {
+		const uint8x16_t bytes = vld1q_u8(p_src + i);
+		if (vmaxvq_u8(bytes) >= 0x80 || vminvq_u8(bytes) == 0) {
+			break;
+		}
+		const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+		const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+		vst1q_u32((uint32_t *)(p_dst + i), vmovl_u16(vget_low_u16(low)));
+		vst1q_u32((uint32_t *)(p_dst + i + 4), vmovl_u16(vget_high_u16(low)));
+		vst1q_u32((uint32_t *)(p_dst + i + 8), vmovl_u16(vget_low_u16(high)));
+		vst1q_u32((uint32_t *)(p_dst + i + 12), vmovl_u16(vget_high_u16(high)));
+	}
+#endif
+	for (; i < p_len && uint8_t(p_src[i] - 1) < 0x7f; i++) {
+		p_dst[i] = p_src[i];
+	}
+	return i;
+}
+
+// Four djb2 steps at once. The expanded form wraps around the same way as the
+// single steps do, but only depends on the previous hash once.
+static _FORCE_INLINE_ uint32_t _hash_block(uint32_t p_hash, const char32_t *p_chars) {
+	return p_hash * (33 * 33 * 33 * 33) + uint32_t(p_chars[0]) * (33 * 33 * 33) + uint32_t(p_chars[1]) * (33 * 33) + uint32_t(p_chars[2]) * 33 + uint32_t(p_chars[3]);
+}
+
 const char CharString::_null = 0;
 const char16_t Char16String::_null = 0;
 const char32_t String::_null = 0;
@@ -649,19 +905,7 @@ bool String::operator==(const String &p_str) const {
 		return true;
 	}
 
-	int l = length();
-
-	const char32_t *src = get_data();
-	const char32_t *dst = p_str.get_data();
-
-	/* Compare char by char */
-	for (int i = 0; i < l; i++) {
-		if (src[i] != dst[i]) {
-			return false;
-		}
-	}
-
-	return true;
+	return memcmp(get_data(), p_str.get_data(), length() * sizeof(char32_t)) == 0;
 }
 
 bool String::operator==(const StrRange &p_str_range) const {
@@ -781,7 +1025,11 @@ bool String::operator<(const char32_t *p_str) const {
 }
 
 bool String::operator<(const String &p_str) const {
-	return operator<(p_str.get_data());
+	// Both strings are null terminated, so this stops at the end of the shorter one.
+	const char32_t *l = get_data();
+	const char32_t *r = p_str.get_data();
+	const int i = _find_mismatch_or_null(l, r, MIN(length(), p_str.length()) + 1);
+	return l[i] < r[i];
 }
 
 signed char String::nocasecmp_to(const String &p_str) const {
@@ -1332,32 +1580,45 @@ char32_t String::char_lowercase(char32_t p_char) {
 	return _find_lower(p_char);
 }
 
-String String::to_upper() const {
-	String upper = *this;
+// Maps the characters of p_str with p_find_case. In ASCII, that only switches
+// the case of the letters in [p_first, p_last], which is done a block at a time.
+static String _convert_case(const String &p_str, char32_t p_first, char32_t p_last, int (*p_find_case)(int)) {
+	const char32_t *src = p_str.get_data();
+	const int len = p_str.length();
 
-	for (int i = 0; i < upper.size(); i++) {
-		const char32_t s = upper[i];
-		const char32_t t = _find_upper(s);
-		if (s != t) { // avoid copy on write
-			upper[i] = t;
+	// Look for the first character which changes, to avoid copy on write if there is none.
+	int i = 0;
+	while (true) {
+		i += _ascii_run_length(src + i, len - i, p_first, p_last);
+		if (i == len) {
+			return p_str;
 		}
+		if (src[i] < 0x80 || char32_t(p_find_case(src[i])) != src[i]) {
+			break;
+		}
+		i++;
 	}
 
-	return upper;
-}
-
-String String::to_lower() const {
-	String lower = *this;
-
-	for (int i = 0; i < lower.size(); i++) {
-		const char32_t s = lower[i];
-		const char32_t t = _find_lower(s);
-		if (s != t) { // avoid copy on write
-			lower[i] = t;
+	String ret = p_str;
+	char32_t *dst = ret.ptrw();
+	while (true) {
+		i += _convert_ascii_case_run(src + i, len - i, p_first, p_last, dst + i);
+		if (i == len) {
+			break;
 		}
+		dst[i] = p_find_case(src[i]);
+		i++;
 	}
 
-	return lower;
+	return ret;
+}
+
+String String::to_upper() const {
+	return _convert_case(*this, 'a', 'z', _find_upper);
+}
+
+String String::to_lower() const {
+	return _convert_case(*this, 'A', 'Z', _find_lower);
 }
 
 String String::chr(char32_t p_char) {
@@ -1790,12 +2051,24 @@ bool String::parse_utf8(const char *p_utf8, int p_len) {
 		}
 	}
 
+	if (p_len < 0) {
+		p_len = strlen(p_utf8);
+	}
+
 	{
 		const char *ptrtmp = p_utf8;
 		const char *ptrtmp_limit = &p_utf8[p_len];
 		int skip = 0;
 		while (ptrtmp != ptrtmp_limit && *ptrtmp) {
 			if (skip == 0) {
+				const int ascii = _ascii_byte_run_length((const uint8_t *)ptrtmp, ptrtmp_limit - ptrtmp);
+				str_size += ascii;
+				cstr_size += ascii;
+				ptrtmp += ascii;
+				if (ptrtmp == ptrtmp_limit || !*ptrtmp) {
+					break;
+				}
+
 				uint8_t c = *ptrtmp >= 0 ? *ptrtmp : uint8_t(256 + *ptrtmp);
 
 				/* Determine the number of characters in sequence */
@@ -1843,6 +2116,14 @@ bool String::parse_utf8(const char *p_utf8, int p_len) {
 	dst[str_size] = 0;
 
 	while (cstr_size) {
+		const int ascii = _widen_ascii_run((const uint8_t *)p_utf8, cstr_size, dst);
+		dst += ascii;
+		cstr_size -= ascii;
+		p_utf8 += ascii;
+		if (!cstr_size) {
+			break;
+		}
+
 		int len = 0;
 
 		/* Determine the number of characters in sequence */
@@ -1913,6 +2194,13 @@ CharString String::utf8() const {
 	const char32_t *d = &operator[](0);
 	int fl = 0;
 	for (int i = 0; i < l; i++) {
+		const int ascii = _ascii_run_length(d + i, l - i);
+		fl += ascii;
+		i += ascii;
+		if (i == l) {
+			break;
+		}
+
 		uint32_t c = d[i];
 		if (c <= 0x7f) { // 7 bits.
 			fl += 1;
@@ -1943,6 +2231,13 @@ CharString String::utf8() const {
 #define APPEND_CHAR(m_c) *(cdst++) = m_c
 
 	for (int i = 0; i < l; i++) {
+		const int ascii = _narrow_ascii_run(d + i, l - i, cdst);
+		cdst += ascii;
+		i += ascii;
+		if (i == l) {
+			break;
+		}
+
 		uint32_t c = d[i];
 
 		if (c <= 0x7f) { // 7 bits.
@@ -2695,7 +2990,11 @@ uint32_t String::hash(const wchar_t *p_cstr) {
 
 uint32_t String::hash(const char32_t *p_cstr, int p_len) {
 	uint32_t hashv = 5381;
-	for (int i = 0; i < p_len; i++) {
+	int i = 0;
+	for (; i + 4 <= p_len; i += 4) {
+		hashv = _hash_block(hashv, p_cstr + i);
+	}
+	for (; i < p_len; i++) {
 		hashv = ((hashv << 5) + hashv) + p_cstr[i]; /* hash * 33 + c */
 	}
 
@@ -2720,6 +3019,13 @@ uint32_t String::hash() const {
 	uint32_t hashv = 5381;
 	uint32_t c;
 
+	// Hashing stops at the first null character, so blocks containing one are left to the loop below.
+	const char32_t *block_end = chr + (length() & ~3);
+	while (chr != block_end && chr[0] && chr[1] && chr[2] && chr[3]) {
+		hashv = _hash_block(hashv, chr);
+		chr += 4;
+	}
+
 	while ((c = *chr++)) {
 		hashv = ((hashv << 5) + hashv) + c; /* hash * 33 + c */
 	}
@@ -2862,23 +3168,16 @@ int String::find(const String &p_str, int p_from) const {
 	const char32_t *src = get_data();
 	const char32_t *str = p_str.get_data();
 
-	for (int i = p_from; i <= (len - src_len); i++) {
-		bool found = true;
-		for (int j = 0; j < src_len; j++) {
-			int read_pos = i + j;
-
-			if (read_pos >= len) {
-				ERR_PRINT("read_pos>=len");
-				return -1;
-			}
-
-			if (src[read_pos] != str[j]) {
-				found = false;
-				break;
-			}
+	// Look for the first character a block at a time, then check the rest.
+	const int last = len - src_len;
+	for (int i = p_from; i <= last; i++) {
+		const int next = _find_char(src + i, last - i + 1, str[0]);
+		if (next < 0) {
+			return -1;
 		}
+		i += next;
 
-		if (found) {
+		if (memcmp(src + i + 1, str + 1, (src_len - 1) * sizeof(char32_t)) == 0) {
 			return i;
 		}
 	}
@@ -2905,26 +3204,24 @@ int String::find(const char *p_str, int p_from) const {
 	}
 
 	if (src_len == 1) {
-		const char32_t needle = p_str[0];
+		if (p_from < len) {
+			const int i = _find_char(src + p_from, len - p_from, p_str[0]);
+			return i < 0 ? -1 : p_from + i;
+		}
 
-		for (int i = p_from; i < len; i++) {
-			if (src[i] == needle) {
-				return i;
+	} else if (src_len > 1) {
+		// Look for the first character a block at a time, then check the rest.
+		const int last = len - src_len;
+		for (int i = p_from; i <= last; i++) {
+			const int next = _find_char(src + i, last - i + 1, p_str[0]);
+			if (next < 0) {
+				return -1;
 			}
-		}
+			i += next;
 
-	} else {
-		for (int i = p_from; i <= (len - src_len); i++) {
 			bool found = true;
-			for (int j = 0; j < src_len; j++) {
-				int read_pos = i + j;
-
-				if (read_pos >= len) {
-					ERR_PRINT("read_pos>=len");
-					return -1;
-				}
-
-				if (src[read_pos] != (char32_t)p_str[j]) {
+			for (int j = 1; j < src_len; j++) {
+				if (src[i + j] != (char32_t)p_str[j]) {
 					found = false;
 					break;
 				}
@@ -2934,6 +3231,9 @@ int String::find(const char *p_str, int p_from) const {
 				return i;
 			}
 		}
+
+	} else if (p_from <= len) {
+		return p_from; // The empty string is found right away.
 	}
 
 	return -1;
@@ -3439,49 +3739,48 @@ String String::format(const Variant &values, String placeholder) const {
 }
 
 String String::replace(const String &p_key, const String &p_with) const {
-	String new_string;
-	int search_from = 0;
-	int result = 0;
+	const int key_len = p_key.length();
+	const int with_len = p_with.length();
 
-	while ((result = find(p_key, search_from)) >= 0) {
-		new_string += substr(search_from, result - search_from);
-		new_string += p_with;
-		search_from = result + p_key.length();
+	// Count the matches first, so the result is allocated only once.
+	int count = 0;
+	int result = 0;
+	for (int search_from = 0; (result = find(p_key, search_from)) >= 0; search_from = result + key_len) {
+		count++;
 	}
 
-	if (search_from == 0) {
+	if (count == 0) {
 		return *this;
 	}
 
-	new_string += substr(search_from, length() - search_from);
-
-	return new_string;
-}
+	const int new_len = length() + count * (with_len - key_len);
+	if (new_len == 0) {
+		return String();
+	}
 
-String String::replace(const char *p_key, const char *p_with) const {
 	String new_string;
-	int search_from = 0;
-	int result = 0;
+	new_string.resize(new_len + 1);
+	const char32_t *src = get_data();
+	char32_t *dst = new_string.ptrw();
 
+	int search_from = 0;
 	while ((result = find(p_key, search_from)) >= 0) {
-		new_string += substr(search_from, result - search_from);
-		new_string += p_with;
-		int k = 0;
-		while (p_key[k] != '\0') {
-			k++;
-		}
-		search_from = result + k;
-	}
-
-	if (search_from == 0) {
-		return *this;
+		memcpy(dst, src + search_from, (result - search_from) * sizeof(char32_t));
+		dst += result - search_from;
+		memcpy(dst, p_with.get_data(), with_len * sizeof(char32_t));
+		dst += with_len;
+		search_from = result + key_len;
 	}
-
-	new_string += substr(search_from, length() - search_from);
+	memcpy(dst, src + search_from, (length() - search_from) * sizeof(char32_t));
+	new_string.ptrw()[new_len] = 0;
 
 	return new_string;
 }
 
+String String::replace(const char *p_key, const char *p_with) const {
+	return replace(String(p_key), String(p_with));
+}
+
 String String::replace_first(const String &p_key, const String &p_with) const {
 	int pos = find(p_key);
 	if (pos >= 0) {
@@ -33,65 +33,117 @@
 #include "core/config/project_settings.h"
 #include "core/os/os.h"
 
-void CommandQueueMT::lock() {
-	mutex.lock();
-}
-
-void CommandQueueMT::unlock() {
-	mutex.unlock();
-}
-
 void CommandQueueMT::wait_for_flush() {
 	// wait one millisecond for a flush to happen
 	OS::get_singleton()->delay_usec(1000);
 }
 
 CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
-	int idx = -1;
-
 	while (true) {
-		lock();
 		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
-			if (!sync_sems[i].in_use) {
-				sync_sems[i].in_use = true;
-				idx = i;
-				break;
+			bool expected = false;
+			if (sync_sems[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+				return &sync_sems[i];
+			}
+		}
+		wait_for_flush();
+	}
+}
+
+void CommandQueueMT::_release(uint64_t p_to) {
+	// Hand the memory back zeroed, so unpublished headers never look ready.
+	uint64_t from = release_pos.load(std::memory_order_relaxed);
+	while (from != p_to) {
+		uint32_t offset = from % command_mem_size;
+		uint32_t size = MIN(p_to - from, uint64_t(command_mem_size - offset));
+		memset(&command_mem[offset], 0, size);
+		from += size;
+	}
+	release_pos.store(p_to, std::memory_order_release);
+}
+
+bool CommandQueueMT::_flush_one() {
+	uint64_t pos = read_pos.load(std::memory_order_relaxed);
+
+	while (pos != write_pos.load(std::memory_order_acquire)) {
+		std::atomic<uint32_t> *header = _header(pos);
+		uint32_t value = header->load(std::memory_order_acquire);
+		if (!(value & HEADER_READY)) {
+			return false; // Reserved, but the producer is still writing it.
+		}
+
+		uint32_t size = value >> HEADER_SIZE_SHIFT;
+		pos += size;
+		read_pos.store(pos, std::memory_order_relaxed);
+
+		if (value & HEADER_SKIP) {
+			if (flush_depth == 0) {
+				_release(pos);
 			}
+			continue;
 		}
-		unlock();
 
-		if (idx == -1) {
-			wait_for_flush();
-		} else {
-			break;
+		CommandBase *cmd = reinterpret_cast<CommandBase *>(reinterpret_cast<uint8_t *>(header) + HEADER_SIZE);
+		flush_depth++;
+		cmd->call();
+		flush_depth--;
+		cmd->post();
+		cmd->~CommandBase();
+
+		if (flush_depth == 0) {
+			// Also releases the commands run by flushes from within this one,
+			// their memory is only handed back once this command is done with its own.
+			_release(read_pos.load(std::memory_order_relaxed));
+		}
+		return true;
+	}
+
+	return false;
+}
+
+bool CommandQueueMT::_try_flush(bool p_all) {
+	// The mutex is recursive, so a command can flush the queue it runs from.
+	// That runs the commands pushed after it right away, as the queue always did.
+	MutexLock lock(flush_mutex);
+	bool flushed = _flush_one();
+	if (p_all && flushed) {
+		while (_flush_one()) {
 		}
 	}
 
-	return &sync_sems[idx];
+	return flushed;
 }
 
-bool CommandQueueMT::dealloc_one() {
-tryagain:
-	if (dealloc_ptr == (write_ptr_and_epoch >> 1)) {
-		// The queue is empty
-		return false;
+void CommandQueueMT::_wait_for_commands() {
+	consumer_waiting.store(true, std::memory_order_relaxed);
+	// Pairs with the fence in commit().
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	uint64_t pos = read_pos.load(std::memory_order_relaxed);
+	bool ready = pos != write_pos.load(std::memory_order_acquire) && (_header(pos)->load(std::memory_order_acquire) & HEADER_READY);
+	if (!ready) {
+		sync->wait();
 	}
 
-	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
+	consumer_waiting.store(false, std::memory_order_relaxed);
+}
 
-	if (size == 0) {
-		// End of command buffer wrap down
-		dealloc_ptr = 0;
-		goto tryagain;
+void CommandQueueMT::wait_and_flush_one() {
+	ERR_FAIL_COND(!sync);
+	while (!_try_flush(false)) {
+		_wait_for_commands();
 	}
+}
 
-	if (size & 1) {
-		// Still used, nothing can be deallocated
-		return false;
+void CommandQueueMT::wait_and_flush() {
+	ERR_FAIL_COND(!sync);
+	while (!_try_flush(true)) {
+		_wait_for_commands();
 	}
+}
 
-	dealloc_ptr += (size >> 1) + 8;
-	return true;
+void CommandQueueMT::flush_all() {
+	_try_flush(true);
 }
 
 CommandQueueMT::CommandQueueMT(bool p_sync) {
@@ -99,6 +151,13 @@ CommandQueueMT::CommandQueueMT(bool p_sync) {
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/command_queue/multithreading_queue_size_kb", PropertyInfo(Variant::INT, "memory/limits/command_queue/multithreading_queue_size_kb", PROPERTY_HINT_RANGE, "1,4096,1,or_greater"));
 	command_mem_size *= 1024;
 	command_mem = (uint8_t *)memalloc(command_mem_size);
+	memset(command_mem, 0, command_mem_size);
+
+	write_pos.store(0);
+	read_pos.store(0);
+	release_pos.store(0);
+	consumer_waiting.store(false);
+
 	if (p_sync) {
 		sync = memnew(Semaphore);
 	}
@@ -37,6 +37,8 @@
 #include "core/templates/simple_type.h"
 #include "core/typedefs.h"
 
+#include <atomic>
+
 #define COMMA(N) _COMMA_##N
 #define _COMMA_0
 #define _COMMA_1 ,
@@ -248,13 +250,11 @@
 #define DECL_PUSH(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>       \
 	void push(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
-		CMD_TYPE(N) *cmd = allocate_and_lock<CMD_TYPE(N)>();                 \
+		CMD_TYPE(N) *cmd = allocate_or_wait<CMD_TYPE(N)>();                  \
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
-		if (sync)                                                            \
-			sync->post();                                                    \
+		commit(cmd);                                                         \
 	}
 
 #define CMD_RET_TYPE(N) CommandRet##N<T, M, COMMA_SEP_LIST(TYPE_ARG, N) COMMA(N) R>
@@ -263,17 +263,15 @@
 	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R>                \
 	void push_and_ret(T *p_instance, M p_method, COMMA_SEP_LIST(PARAM, N) COMMA(N) R *r_ret) { \
 		SyncSemaphore *ss = _alloc_sync_sem();                                                 \
-		CMD_RET_TYPE(N) *cmd = allocate_and_lock<CMD_RET_TYPE(N)>();                           \
+		CMD_RET_TYPE(N) *cmd = allocate_or_wait<CMD_RET_TYPE(N)>();                            \
 		cmd->instance = p_instance;                                                            \
 		cmd->method = p_method;                                                                \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
-		if (sync)                                                                              \
-			sync->post();                                                                      \
+		commit(cmd);                                                                           \
 		ss->sem.wait();                                                                        \
-		ss->in_use = false;                                                                    \
+		ss->in_use.store(false, std::memory_order_release);                                    \
 	}
 
 #define CMD_SYNC_TYPE(N) CommandSync##N<T, M COMMA(N) COMMA_SEP_LIST(TYPE_ARG, N)>
@@ -282,24 +280,41 @@
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>                \
 	void push_and_sync(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
 		SyncSemaphore *ss = _alloc_sync_sem();                                        \
-		CMD_SYNC_TYPE(N) *cmd = allocate_and_lock<CMD_SYNC_TYPE(N)>();                \
+		CMD_SYNC_TYPE(N) *cmd = allocate_or_wait<CMD_SYNC_TYPE(N)>();                 \
 		cmd->instance = p_instance;                                                   \
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
-		if (sync)                                                                     \
-			sync->post();                                                             \
+		commit(cmd);                                                                  \
 		ss->sem.wait();                                                               \
-		ss->in_use = false;                                                           \
+		ss->in_use.store(false, std::memory_order_release);                           \
 	}
 
 #define MAX_CMD_PARAMS 15
 
+// Multi-producer, single-consumer command ring.
+//
+// Producers never take a lock: space is reserved with a CAS on the write
+// position, the command is constructed in place, then published by setting
+// the READY bit of its header. The consumer executes published commands in
+// reservation order, so commands pushed by one thread after another thread's
+// push returned always run after it.
+//
+// Memory is laid out as [header (8 bytes)][command]... with sizes rounded to
+// 8 bytes. When a command doesn't fit before the end of the buffer, the tail
+// is reserved as a SKIP entry and the command starts at the beginning.
+// Consumed memory is zeroed before being handed back to producers, so a
+// header that has been reserved but not published yet always reads as 0.
+//
+// Flushing from within a command (e.g. flush_if_pending()) runs the commands
+// pushed after it before it returns.
+
 class CommandQueueMT {
 	struct SyncSemaphore {
 		Semaphore sem;
-		bool in_use = false;
+		std::atomic<bool> in_use;
+
+		SyncSemaphore() { in_use.store(false); }
 	};
 
 	struct CommandBase {
@@ -331,153 +346,92 @@ class CommandQueueMT {
 
 	enum {
 		DEFAULT_COMMAND_MEM_SIZE_KB = 256,
-		SYNC_SEMAPHORES = 8
+		SYNC_SEMAPHORES = 8,
+		HEADER_SIZE = 8,
+		HEADER_READY = 1,
+		HEADER_SKIP = 2,
+		HEADER_SIZE_SHIFT = 2,
 	};
 
 	uint8_t *command_mem = nullptr;
-	uint32_t read_ptr_and_epoch = 0;
-	uint32_t write_ptr_and_epoch = 0;
-	uint32_t dealloc_ptr = 0;
 	uint32_t command_mem_size = 0;
+
+	// Positions are byte counts since creation, they never wrap.
+	std::atomic<uint64_t> write_pos; // Reserved by producers.
+	std::atomic<uint64_t> read_pos; // Consumed, owned by the flushing thread.
+	std::atomic<uint64_t> release_pos; // Zeroed and available to producers again.
+
 	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
-	Mutex mutex;
+	Mutex flush_mutex; // Only taken by consumers, in case several threads flush.
+	uint32_t flush_depth = 0; // Commands running on the flushing thread, more than one when they flush too.
 	Semaphore *sync = nullptr;
+	std::atomic<bool> consumer_waiting;
+
+	_FORCE_INLINE_ std::atomic<uint32_t> *_header(uint64_t p_pos) {
+		return reinterpret_cast<std::atomic<uint32_t> *>(&command_mem[p_pos % command_mem_size]);
+	}
 
 	template <class T>
 	T *allocate() {
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = ((sizeof(T) + 8 - 1) & ~(8 - 1)) + 8;
+		static_assert(alignof(T) <= HEADER_SIZE, "Commands can't require more than 8 byte alignment.");
+		// alloc size is header+T, rounded to the header size.
+		uint32_t alloc_size = ((sizeof(T) + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1)) + HEADER_SIZE;
 
 		// Assert that the buffer is big enough to hold at least two messages.
-		ERR_FAIL_COND_V(alloc_size * 2 + sizeof(uint32_t) > command_mem_size, nullptr);
-
-	tryagain:
-		uint32_t write_ptr = write_ptr_and_epoch >> 1;
-
-		if (write_ptr < dealloc_ptr) {
-			// behind dealloc_ptr, check that there is room
-			if ((dealloc_ptr - write_ptr) <= alloc_size) {
-				// There is no more room, try to deallocate something
-				if (dealloc_one()) {
-					goto tryagain;
-				}
-				return nullptr;
+		ERR_FAIL_COND_V(alloc_size * 2 > command_mem_size, nullptr);
+
+		uint64_t pos = write_pos.load(std::memory_order_relaxed);
+		uint32_t skip;
+		while (true) {
+			uint32_t offset = pos % command_mem_size;
+			skip = offset + alloc_size > command_mem_size ? command_mem_size - offset : 0;
+			uint64_t end = pos + skip + alloc_size;
+			if (end - release_pos.load(std::memory_order_acquire) > command_mem_size) {
+				return nullptr; // Full, wait for the consumer.
 			}
-		} else {
-			// ahead of dealloc_ptr, check that there is room
-
-			if ((command_mem_size - write_ptr) < alloc_size + sizeof(uint32_t)) {
-				// no room at the end, wrap down;
-
-				if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
-
-					// There is no more room, try to deallocate something
-					if (dealloc_one()) {
-						goto tryagain;
-					}
-					return nullptr;
-				}
-
-				// if this happens, it's a bug
-				ERR_FAIL_COND_V((command_mem_size - write_ptr) < 8, nullptr);
-				// zero means, wrap to beginning
-
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-				*p = 1;
-				write_ptr_and_epoch = 0 | (1 & ~write_ptr_and_epoch); // Invert epoch.
-				// See if we can get the thread to run and clear up some more space while we wait.
-				// This is required if alloc_size * 2 + 4 > COMMAND_MEM_SIZE
-				if (sync) {
-					sync->post();
-				}
-				goto tryagain;
+			if (write_pos.compare_exchange_weak(pos, end, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				break;
 			}
 		}
-		// Allocate the size and the 'in use' bit.
-		// First bit used to mark if command is still in use (1)
-		// or if it has been destroyed and can be deallocated (0).
-		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-		*p = (size << 1) | 1;
-		write_ptr += 8;
-		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += size;
-		write_ptr_and_epoch = (write_ptr << 1) | (write_ptr_and_epoch & 1);
-		return cmd;
+
+		if (skip) {
+			_header(pos)->store((skip << HEADER_SIZE_SHIFT) | HEADER_SKIP | HEADER_READY, std::memory_order_release);
+			pos += skip;
+		}
+
+		return memnew_placement(&command_mem[pos % command_mem_size] + HEADER_SIZE, T);
 	}
 
 	template <class T>
-	T *allocate_and_lock() {
-		lock();
+	T *allocate_or_wait() {
 		T *ret;
-
 		while ((ret = allocate<T>()) == nullptr) {
-			unlock();
 			// sleep a little until fetch happened and some room is made
 			wait_for_flush();
-			lock();
 		}
-
 		return ret;
 	}
 
-	bool flush_one(bool p_lock = true) {
-		if (p_lock) {
-			lock();
-		}
-	tryagain:
-
-		// tried to read an empty queue
-		if (read_ptr_and_epoch == write_ptr_and_epoch) {
-			if (p_lock) {
-				unlock();
-			}
-			return false;
-		}
-
-		uint32_t read_ptr = read_ptr_and_epoch >> 1;
-		uint32_t size_ptr = read_ptr;
-		uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
-
-		if (size == 0) {
-			*(uint32_t *)&command_mem[read_ptr] = 0; // clear in-use bit.
-			//end of ringbuffer, wrap
-			read_ptr_and_epoch = 0 | (1 & ~read_ptr_and_epoch); // Invert epoch.
-			goto tryagain;
-		}
-
-		read_ptr += 8;
-
-		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
-
-		read_ptr += size;
-
-		read_ptr_and_epoch = (read_ptr << 1) | (read_ptr_and_epoch & 1);
-
-		if (p_lock) {
-			unlock();
-		}
-		cmd->call();
-		if (p_lock) {
-			lock();
-		}
-
-		cmd->post();
-		cmd->~CommandBase();
-		*(uint32_t *)&command_mem[size_ptr] &= ~1;
-
-		if (p_lock) {
-			unlock();
+	template <class T>
+	_FORCE_INLINE_ void commit(T *p_cmd) {
+		uint32_t alloc_size = ((sizeof(T) + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1)) + HEADER_SIZE;
+		std::atomic<uint32_t> *header = reinterpret_cast<std::atomic<uint32_t> *>(reinterpret_cast<uint8_t *>(p_cmd) - HEADER_SIZE);
+		header->store((alloc_size << HEADER_SIZE_SHIFT) | HEADER_READY, std::memory_order_release);
+
+		// Pairs with the fence in _wait_for_commands(), so either the consumer sees the command or we see it sleeping.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sync && consumer_waiting.load(std::memory_order_relaxed)) {
+			sync->post();
 		}
-		return true;
 	}
 
-	void lock();
-	void unlock();
+	void _release(uint64_t p_to);
+	bool _flush_one();
+	bool _try_flush(bool p_all);
+	void _wait_for_commands();
+
 	void wait_for_flush();
 	SyncSemaphore *_alloc_sync_sem();
-	bool dealloc_one();
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -492,24 +446,21 @@ public:
 	DECL_PUSH_AND_SYNC(0)
 	SPACE_SEP_LIST(DECL_PUSH_AND_SYNC, 15)
 
-	void wait_and_flush_one() {
-		ERR_FAIL_COND(!sync);
-		sync->wait();
-		flush_one();
+	// Sleeps until a command is available, then runs it.
+	void wait_and_flush_one();
+	// Sleeps until a command is available, then runs all available commands in one batch.
+	void wait_and_flush();
+
+	_FORCE_INLINE_ bool has_pending() const {
+		return read_pos.load(std::memory_order_relaxed) != write_pos.load(std::memory_order_acquire);
 	}
 
 	_FORCE_INLINE_ void flush_if_pending() {
-		if (unlikely(read_ptr_and_epoch != write_ptr_and_epoch)) {
+		if (unlikely(has_pending())) {
 			flush_all();
 		}
 	}
-	void flush_all() {
-		//ERR_FAIL_COND(sync);
-		lock();
-		while (flush_one(false)) {
-		}
-		unlock();
-	}
+	void flush_all();
 
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
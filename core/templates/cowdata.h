@@ -36,6 +36,7 @@
 #include "core/templates/safe_refcount.h"
 
 #include <string.h>
+#include <utility>
 
 template <class T>
 class Vector;
@@ -49,6 +50,21 @@ class VMap;
 SAFE_NUMERIC_TYPE_PUN_GUARANTEES(uint32_t)
 #endif
 
+// Counts the bytes duplicated by copy on write, which happens when shared data
+// is written to. Only counted in debug builds, Main publishes it once per frame.
+class CowDataStats {
+	static SafeNumeric<uint64_t> copied_bytes;
+	static uint64_t last_frame_copied_bytes;
+
+public:
+	static _FORCE_INLINE_ void add_copied_bytes(uint64_t p_bytes) {
+		copied_bytes.add(p_bytes);
+	}
+
+	static void end_frame();
+	static uint64_t get_last_frame_copied_bytes();
+};
+
 template <class T>
 class CowData {
 	template <class TV>
@@ -119,6 +135,14 @@ private:
 
 public:
 	void operator=(const CowData<T> &p_from) { _ref(p_from); }
+	_FORCE_INLINE_ void operator=(CowData<T> &&p_from) {
+		if (_ptr == p_from._ptr) {
+			return;
+		}
+		_unref(_ptr);
+		_ptr = p_from._ptr;
+		p_from._ptr = nullptr;
+	}
 
 	_FORCE_INLINE_ T *ptrw() {
 		_copy_on_write();
@@ -188,6 +212,10 @@ public:
 	_FORCE_INLINE_ CowData() {}
 	_FORCE_INLINE_ ~CowData();
 	_FORCE_INLINE_ CowData(CowData<T> &p_from) { _ref(p_from); };
+	_FORCE_INLINE_ CowData(CowData<T> &&p_from) {
+		_ptr = p_from._ptr;
+		p_from._ptr = nullptr;
+	}
 };
 
 template <class T>
@@ -198,7 +226,9 @@ void CowData<T>::_unref(void *p_data) {
 
 	SafeNumeric<uint32_t> *refc = _get_refcount();
 
-	if (refc->decrement() > 0) {
+	// When this is the only reference nobody else can take a new one, so the
+	// atomic decrement can be skipped.
+	if (refc->get() > 1 && refc->decrement() > 0) {
 		return; // still in use
 	}
 	// clean up
@@ -230,6 +260,10 @@ uint32_t CowData<T>::_copy_on_write() {
 		/* in use by more than me */
 		uint32_t current_size = *_get_size();
 
+#ifdef DEBUG_ENABLED
+		CowDataStats::add_copied_bytes(current_size * sizeof(T));
+#endif
+
 		uint32_t *mem_new = (uint32_t *)Memory::alloc_static(_get_alloc_size(current_size), true);
 
 		new (mem_new - 2, sizeof(uint32_t), "") SafeNumeric<uint32_t>(1); //refcount
@@ -0,0 +1,560 @@
+/*************************************************************************/
+/*  flat_hash_map.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include "core/error/error_macros.h"
+#include "core/os/memory.h"
+#include "core/string/ustring.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/list.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define FLAT_HASH_MAP_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * A HashMap with a flat, open addressing table, in the style of Swiss tables.
+ *
+ * The table stores one control byte per slot, holding either EMPTY or 7 bits
+ * of the hash of the element in that slot. Lookups compare 16 control bytes at
+ * a time (with SSE2 or NEON when available), and only touch the elements whose
+ * bits match. Collisions are resolved with linear probing, so erasing shifts
+ * the following elements back instead of leaving tombstones.
+ *
+ * Elements are allocated one by one and also linked in insertion order, so
+ * pointers to keys and values stay valid until the element is erased, and
+ * iterating with front() and Element::next() is deterministic.
+ *
+ * Maps with up to SMALL_SIZE elements don't allocate the table at all, their
+ * lookups walk the insertion list and compare the stored hashes. Most maps
+ * stay that small (e.g. Dictionary rows and RPC arguments) and a short scan is
+ * cheaper than probing.
+ *
+ * find_as() and has_as() look up a key of another type, as long as the hasher
+ * hashes it like the key type and the comparator can compare them, e.g. a
+ * `const char *` in a map of StringName keys, without building a StringName.
+ */
+
+struct FlatHashMapHasherDefault : public HashMapHasherDefault {
+	using HashMapHasherDefault::hash;
+	// Hash C strings like StringName and String do.
+	static _FORCE_INLINE_ uint32_t hash(const char *p_cstr) { return String::hash(p_cstr); }
+};
+
+template <class T>
+struct FlatHashMapComparatorDefault {
+	static _FORCE_INLINE_ bool compare(const T &p_lhs, const T &p_rhs) {
+		return HashMapComparatorDefault<T>::compare(p_lhs, p_rhs);
+	}
+
+	template <class K>
+	static _FORCE_INLINE_ bool compare(const T &p_lhs, const K &p_rhs) {
+		return p_lhs == p_rhs;
+	}
+};
+
+struct FlatHashMapGroup {
+	enum {
+		WIDTH = 16,
+	};
+
+	static const uint8_t EMPTY = 0x80;
+
+	// Bit i of the result is set when p_ctrl[i] equals p_tag.
+	static _FORCE_INLINE_ uint32_t match(const uint8_t *p_ctrl, uint8_t p_tag) {
+#if defined(FLAT_HASH_MAP_SSE2)
+		__m128i ctrl = _mm_loadu_si128((const __m128i *)p_ctrl);
+		return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)p_tag)));
+#elif defined(FLAT_HASH_MAP_NEON)
+		return _to_mask(vceqq_u8(vld1q_u8(p_ctrl), vdupq_n_u8(p_tag)));
+#else
+		uint32_t mask = 0;
+		for (uint32_t i = 0; i < WIDTH; i++) {
+			mask |= uint32_t(p_ctrl[i] == p_tag) << i;
+		}
+		return mask;
+#endif
+	}
+
+	// Bit i of the result is set when p_ctrl[i] is EMPTY.
+	static _FORCE_INLINE_ uint32_t match_empty(const uint8_t *p_ctrl) {
+#if defined(FLAT_HASH_MAP_SSE2)
+		return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p_ctrl));
+#elif defined(FLAT_HASH_MAP_NEON)
+		return _to_mask(vtstq_u8(vld1q_u8(p_ctrl), vdupq_n_u8(EMPTY)));
+#else
+		uint32_t mask = 0;
+		for (uint32_t i = 0; i < WIDTH; i++) {
+			mask |= uint32_t(p_ctrl[i] >> 7) << i;
+		}
+		return mask;
+#endif
+	}
+
+	static _FORCE_INLINE_ uint32_t lowest_bit(uint32_t p_mask) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, p_mask);
+		return index;
+#else
+		return __builtin_ctz(p_mask);
+#endif
+	}
+
+#ifdef FLAT_HASH_MAP_NEON
+	static _FORCE_INLINE_ uint32_t _to_mask(uint8x16_t p_bytes) {
+		static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+		uint8x16_t masked = vandq_u8(p_bytes, vld1q_u8(bits));
+		return uint32_t(vaddv_u8(vget_low_u8(masked))) | (uint32_t(vaddv_u8(vget_high_u8(masked))) << 8);
+	}
+#endif
+};
+
+template <class TKey, class TValue, class Hasher = FlatHashMapHasherDefault, class Comparator = FlatHashMapComparatorDefault<TKey>>
+class FlatHashMap {
+public:
+	class Element {
+		friend class FlatHashMap;
+
+		Element *next_ptr = nullptr;
+		Element *prev_ptr = nullptr;
+		uint32_t hash = 0;
+		TKey _key;
+		TValue _value;
+
+	public:
+		_FORCE_INLINE_ const TKey &key() const { return _key; }
+		_FORCE_INLINE_ TValue &value() { return _value; }
+		_FORCE_INLINE_ const TValue &value() const { return _value; }
+		_FORCE_INLINE_ TValue &get() { return _value; }
+		_FORCE_INLINE_ const TValue &get() const { return _value; }
+		_FORCE_INLINE_ Element *next() { return next_ptr; }
+		_FORCE_INLINE_ const Element *next() const { return next_ptr; }
+		_FORCE_INLINE_ Element *prev() { return prev_ptr; }
+		_FORCE_INLINE_ const Element *prev() const { return prev_ptr; }
+
+		Element(const TKey &p_key, const TValue &p_value) :
+				_key(p_key),
+				_value(p_value) {}
+	};
+
+	enum {
+		SMALL_SIZE = 8,
+	};
+
+private:
+	enum {
+		MIN_CAPACITY = FlatHashMapGroup::WIDTH,
+		TAG_BITS = 7,
+		TAG_MASK = (1 << TAG_BITS) - 1,
+	};
+
+	// capacity + WIDTH - 1 control bytes, the last ones mirror the first so
+	// a group can always be loaded at any position.
+	uint8_t *ctrl = nullptr;
+	Element **slots = nullptr;
+	uint32_t capacity = 0;
+	uint32_t num_elements = 0;
+
+	Element *head = nullptr;
+	Element *tail = nullptr;
+
+	template <class K>
+	static _FORCE_INLINE_ uint32_t _hash(const K &p_key) {
+		// Finalizer from MurmurHash3, so both the tag and the position get good bits.
+		uint32_t h = Hasher::hash(p_key);
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	_FORCE_INLINE_ uint32_t _home(uint32_t p_hash) const {
+		return (p_hash >> TAG_BITS) & (capacity - 1);
+	}
+
+	_FORCE_INLINE_ void _set_ctrl(uint32_t p_pos, uint8_t p_value) {
+		ctrl[p_pos] = p_value;
+		if (p_pos < FlatHashMapGroup::WIDTH - 1) {
+			ctrl[capacity + p_pos] = p_value;
+		}
+	}
+
+	template <class K>
+	bool _lookup_pos(const K &p_key, uint32_t p_hash, uint32_t &r_pos) const {
+		if (unlikely(!slots)) {
+			return false;
+		}
+
+		const uint32_t mask = capacity - 1;
+		const uint8_t tag = p_hash & TAG_MASK;
+		uint32_t pos = _home(p_hash);
+
+		while (true) {
+			const uint8_t *group = ctrl + pos;
+			uint32_t matches = FlatHashMapGroup::match(group, tag);
+			uint32_t empty = FlatHashMapGroup::match_empty(group);
+			if (empty) {
+				// The probe sequence ends at the first empty slot.
+				matches &= (empty & (~empty + 1)) - 1;
+			}
+
+			while (matches) {
+				uint32_t slot = (pos + FlatHashMapGroup::lowest_bit(matches)) & mask;
+				const Element *e = slots[slot];
+				if (e->hash == p_hash && Comparator::compare(e->_key, p_key)) {
+					r_pos = slot;
+					return true;
+				}
+				matches &= matches - 1;
+			}
+
+			if (empty) {
+				return false;
+			}
+			pos = (pos + FlatHashMapGroup::WIDTH) & mask;
+		}
+	}
+
+	void _place(Element *p_element) {
+		const uint32_t mask = capacity - 1;
+		uint32_t pos = _home(p_element->hash);
+
+		while (true) {
+			uint32_t empty = FlatHashMapGroup::match_empty(ctrl + pos);
+			if (empty) {
+				uint32_t slot = (pos + FlatHashMapGroup::lowest_bit(empty)) & mask;
+				_set_ctrl(slot, p_element->hash & TAG_MASK);
+				slots[slot] = p_element;
+				return;
+			}
+			pos = (pos + FlatHashMapGroup::WIDTH) & mask;
+		}
+	}
+
+	template <class K>
+	_FORCE_INLINE_ Element *_find(const K &p_key, uint32_t p_hash) const {
+		if (!slots) {
+			for (Element *e = head; e; e = e->next_ptr) {
+				if (e->hash == p_hash && Comparator::compare(e->_key, p_key)) {
+					return e;
+				}
+			}
+			return nullptr;
+		}
+
+		uint32_t pos;
+		return _lookup_pos(p_key, p_hash, pos) ? slots[pos] : nullptr;
+	}
+
+	void _resize(uint32_t p_capacity) {
+		if (ctrl) {
+			memfree(ctrl);
+			memfree(slots);
+		}
+
+		capacity = p_capacity;
+		ctrl = (uint8_t *)memalloc(capacity + FlatHashMapGroup::WIDTH - 1);
+		memset(ctrl, FlatHashMapGroup::EMPTY, capacity + FlatHashMapGroup::WIDTH - 1);
+		slots = (Element **)memalloc(sizeof(Element *) * capacity);
+
+		for (Element *e = head; e; e = e->next_ptr) {
+			_place(e);
+		}
+	}
+
+	Element *_insert(const TKey &p_key, const TValue &p_value, uint32_t p_hash) {
+		// Keep the load factor under 3/4, linear probing degrades quickly above it.
+		if ((num_elements + 1) * 4 > capacity * 3 && (slots || num_elements + 1 > SMALL_SIZE)) {
+			_resize(capacity ? capacity * 2 : (uint32_t)MIN_CAPACITY);
+		}
+
+		Element *e = memnew(Element(p_key, p_value));
+		e->hash = p_hash;
+		if (slots) {
+			_place(e);
+		}
+
+		e->prev_ptr = tail;
+		if (tail) {
+			tail->next_ptr = e;
+		} else {
+			head = e;
+		}
+		tail = e;
+		num_elements++;
+
+		return e;
+	}
+
+	void _erase_pos(uint32_t p_pos) {
+		Element *e = slots[p_pos];
+		const uint32_t mask = capacity - 1;
+
+		// Backward shift: move later elements of the probe sequence into the
+		// hole, as long as that does not move them before their home slot.
+		uint32_t hole = p_pos;
+		uint32_t pos = p_pos;
+		while (true) {
+			pos = (pos + 1) & mask;
+			if (ctrl[pos] == FlatHashMapGroup::EMPTY) {
+				break;
+			}
+			uint32_t home = _home(slots[pos]->hash);
+			if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+				_set_ctrl(hole, ctrl[pos]);
+				slots[hole] = slots[pos];
+				hole = pos;
+			}
+		}
+		_set_ctrl(hole, FlatHashMapGroup::EMPTY);
+
+		_unlink(e);
+	}
+
+	void _unlink(Element *e) {
+		if (e->prev_ptr) {
+			e->prev_ptr->next_ptr = e->next_ptr;
+		} else {
+			head = e->next_ptr;
+		}
+		if (e->next_ptr) {
+			e->next_ptr->prev_ptr = e->prev_ptr;
+		} else {
+			tail = e->prev_ptr;
+		}
+		memdelete(e);
+		num_elements--;
+	}
+
+public:
+	_FORCE_INLINE_ Element *find(const TKey &p_key) {
+		return _find(p_key, _hash(p_key));
+	}
+
+	_FORCE_INLINE_ const Element *find(const TKey &p_key) const {
+		return _find(p_key, _hash(p_key));
+	}
+
+	template <class K>
+	_FORCE_INLINE_ Element *find_as(const K &p_key) {
+		return _find(p_key, _hash(p_key));
+	}
+
+	template <class K>
+	_FORCE_INLINE_ const Element *find_as(const K &p_key) const {
+		return _find(p_key, _hash(p_key));
+	}
+
+	_FORCE_INLINE_ bool has(const TKey &p_key) const {
+		return find(p_key) != nullptr;
+	}
+
+	template <class K>
+	_FORCE_INLINE_ bool has_as(const K &p_key) const {
+		return find_as(p_key) != nullptr;
+	}
+
+	_FORCE_INLINE_ TValue *getptr(const TKey &p_key) {
+		Element *e = find(p_key);
+		return e ? &e->_value : nullptr;
+	}
+
+	_FORCE_INLINE_ const TValue *getptr(const TKey &p_key) const {
+		const Element *e = find(p_key);
+		return e ? &e->_value : nullptr;
+	}
+
+	const TValue &get(const TKey &p_key) const {
+		const TValue *res = getptr(p_key);
+		CRASH_COND_MSG(!res, "Map key not found.");
+		return *res;
+	}
+
+	TValue &get(const TKey &p_key) {
+		TValue *res = getptr(p_key);
+		CRASH_COND_MSG(!res, "Map key not found.");
+		return *res;
+	}
+
+	Element *insert(const TKey &p_key, const TValue &p_value) {
+		uint32_t hash = _hash(p_key);
+		Element *e = _find(p_key, hash);
+		if (e) {
+			e->_value = p_value;
+			return e;
+		}
+		return _insert(p_key, p_value, hash);
+	}
+
+	// Same as insert(), for compatibility with HashMap.
+	_FORCE_INLINE_ Element *set(const TKey &p_key, const TValue &p_value) {
+		return insert(p_key, p_value);
+	}
+
+	bool erase(const TKey &p_key) {
+		uint32_t hash = _hash(p_key);
+		if (!slots) {
+			Element *e = _find(p_key, hash);
+			if (!e) {
+				return false;
+			}
+			_unlink(e);
+			return true;
+		}
+
+		uint32_t pos;
+		if (!_lookup_pos(p_key, hash, pos)) {
+			return false;
+		}
+		_erase_pos(pos);
+		return true;
+	}
+
+	void erase(Element *p_element) {
+		ERR_FAIL_NULL(p_element);
+		if (!slots) {
+			_unlink(p_element);
+			return;
+		}
+		uint32_t pos;
+		bool found = _lookup_pos(p_element->_key, p_element->hash, pos);
+		ERR_FAIL_COND(!found || slots[pos] != p_element);
+		_erase_pos(pos);
+	}
+
+	inline const TValue &operator[](const TKey &p_key) const {
+		return get(p_key);
+	}
+
+	inline TValue &operator[](const TKey &p_key) {
+		uint32_t hash = _hash(p_key);
+		Element *e = _find(p_key, hash);
+		if (e) {
+			return e->_value;
+		}
+		return _insert(p_key, TValue(), hash)->_value;
+	}
+
+	_FORCE_INLINE_ Element *front() { return head; }
+	_FORCE_INLINE_ const Element *front() const { return head; }
+	_FORCE_INLINE_ Element *back() { return tail; }
+	_FORCE_INLINE_ const Element *back() const { return tail; }
+
+	/**
+	 * Same as HashMap::next(), returns the key after p_key in insertion order,
+	 * or the first one if p_key is null. Iterating over elements with front()
+	 * and Element::next() is faster, as it does not look up every key.
+	 */
+	const TKey *next(const TKey *p_key) const {
+		if (!p_key) {
+			return head ? &head->_key : nullptr;
+		}
+		const Element *e = find(*p_key);
+		ERR_FAIL_NULL_V(e, nullptr);
+		return e->next_ptr ? &e->next_ptr->_key : nullptr;
+	}
+
+	_FORCE_INLINE_ uint32_t size() const { return num_elements; }
+	_FORCE_INLINE_ bool is_empty() const { return num_elements == 0; }
+	_FORCE_INLINE_ uint32_t get_capacity() const { return capacity; }
+
+	void reserve(uint32_t p_elements) {
+		if (!slots && p_elements <= SMALL_SIZE) {
+			return;
+		}
+		uint32_t new_capacity = MAX(capacity, (uint32_t)MIN_CAPACITY);
+		while (p_elements * 4 > new_capacity * 3) {
+			new_capacity *= 2;
+		}
+		if (new_capacity != capacity) {
+			_resize(new_capacity);
+		}
+	}
+
+	void clear() {
+		while (head) {
+			Element *e = head;
+			head = head->next_ptr;
+			memdelete(e);
+		}
+		tail = nullptr;
+		num_elements = 0;
+
+		if (ctrl) {
+			memfree(ctrl);
+			memfree(slots);
+			ctrl = nullptr;
+			slots = nullptr;
+			capacity = 0;
+		}
+	}
+
+	void get_key_list(List<TKey> *r_keys) const {
+		for (const Element *e = head; e; e = e->next_ptr) {
+			r_keys->push_back(e->_key);
+		}
+	}
+
+	void operator=(const FlatHashMap &p_other) {
+		if (this == &p_other) {
+			return;
+		}
+		clear();
+		reserve(p_other.num_elements);
+		for (const Element *e = p_other.head; e; e = e->next_ptr) {
+			_insert(e->_key, e->_value, e->hash);
+		}
+	}
+
+	FlatHashMap(const FlatHashMap &p_other) {
+		operator=(p_other);
+	}
+
+	FlatHashMap() {}
+
+	~FlatHashMap() {
+		clear();
+	}
+};
+
+#endif // FLAT_HASH_MAP_H
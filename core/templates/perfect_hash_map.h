@@ -0,0 +1,222 @@
+/*************************************************************************/
+/*  perfect_hash_map.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PERFECT_HASH_MAP_H
+#define PERFECT_HASH_MAP_H
+
+#include "core/templates/hashfuncs.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/sort_array.h"
+
+/**
+ * An immutable HashMap, built once from a complete set of keys.
+ *
+ * Keys are spread over small buckets, and every bucket gets a seed that sends
+ * its keys to distinct slots ("hash and displace"). A lookup hashes the key,
+ * reads the seed of its bucket and compares a single slot, there is no probing
+ * and nothing is locked, so it can be shared freely between threads once built.
+ *
+ * The few keys that can't be placed, like distinct keys with the same hash, go
+ * to a small overflow list which is searched linearly.
+ */
+template <class TKey, class TValue,
+		class Hasher = HashMapHasherDefault,
+		class Comparator = HashMapComparatorDefault<TKey>>
+class PerfectHashMap {
+public:
+	struct Pair {
+		TKey key;
+		TValue value;
+	};
+
+private:
+	enum {
+		MAX_SEED_ATTEMPTS = 1024,
+	};
+
+	struct Slot {
+		Pair pair;
+		bool used = false;
+	};
+
+	struct BucketSizeSort {
+		const LocalVector<LocalVector<uint32_t>> *buckets;
+		_FORCE_INLINE_ bool operator()(uint32_t p_a, uint32_t p_b) const {
+			return (*buckets)[p_a].size() > (*buckets)[p_b].size();
+		}
+	};
+
+	LocalVector<uint32_t> seeds;
+	LocalVector<Slot> slots;
+	LocalVector<Pair> overflow;
+	uint32_t bucket_mask = 0;
+	uint32_t slot_mask = 0;
+	uint32_t num_elements = 0;
+
+	static _FORCE_INLINE_ uint32_t _mix(uint32_t p_hash, uint32_t p_seed) {
+		uint32_t h = p_hash ^ p_seed;
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	_FORCE_INLINE_ uint32_t _get_bucket(uint32_t p_hash) const {
+		return _mix(p_hash, 0x9e3779b9) & bucket_mask;
+	}
+
+public:
+	_FORCE_INLINE_ uint32_t size() const { return num_elements; }
+	_FORCE_INLINE_ bool is_empty() const { return num_elements == 0; }
+	_FORCE_INLINE_ uint32_t get_overflow_count() const { return overflow.size(); }
+
+	void clear() {
+		seeds.clear();
+		slots.clear();
+		overflow.clear();
+		bucket_mask = 0;
+		slot_mask = 0;
+		num_elements = 0;
+	}
+
+	// Keys must be unique.
+	void build(const LocalVector<Pair> &p_pairs) {
+		clear();
+		num_elements = p_pairs.size();
+		if (num_elements == 0) {
+			return;
+		}
+
+		// About 4 keys per bucket, and a fifth of the slots left empty.
+		uint32_t slot_count = next_power_of_2(num_elements + num_elements / 4);
+		uint32_t bucket_count = next_power_of_2(MAX(num_elements / 4, 1u));
+		slot_mask = slot_count - 1;
+		bucket_mask = bucket_count - 1;
+		slots.resize(slot_count);
+		seeds.resize(bucket_count);
+
+		LocalVector<uint32_t> hashes;
+		hashes.resize(num_elements);
+		LocalVector<LocalVector<uint32_t>> buckets;
+		buckets.resize(bucket_count);
+		for (uint32_t i = 0; i < num_elements; i++) {
+			hashes[i] = Hasher::hash(p_pairs[i].key);
+			buckets[_get_bucket(hashes[i])].push_back(i);
+		}
+
+		// Largest buckets first, while there are still many free slots.
+		LocalVector<uint32_t> order;
+		order.resize(bucket_count);
+		for (uint32_t i = 0; i < bucket_count; i++) {
+			order[i] = i;
+			seeds[i] = 0;
+		}
+		SortArray<uint32_t, BucketSizeSort> sorter;
+		sorter.compare.buckets = &buckets;
+		sorter.sort(order.ptr(), bucket_count);
+
+		LocalVector<uint32_t> positions;
+		for (uint32_t i = 0; i < bucket_count; i++) {
+			LocalVector<uint32_t> &bucket = buckets[order[i]];
+			if (bucket.is_empty()) {
+				break;
+			}
+
+			// Keys with the same hash always land together, no seed separates them.
+			for (uint32_t j = 1; j < bucket.size(); j++) {
+				for (uint32_t k = 0; k < j; k++) {
+					if (hashes[bucket[j]] == hashes[bucket[k]]) {
+						overflow.push_back(p_pairs[bucket[j]]);
+						bucket.remove(j);
+						j--;
+						break;
+					}
+				}
+			}
+
+			positions.resize(bucket.size());
+			bool placed = false;
+			for (uint32_t seed = 1; seed <= MAX_SEED_ATTEMPTS && !placed; seed++) {
+				placed = true;
+				for (uint32_t j = 0; j < bucket.size() && placed; j++) {
+					uint32_t pos = _mix(hashes[bucket[j]], seed) & slot_mask;
+					if (slots[pos].used) {
+						placed = false;
+					}
+					for (uint32_t k = 0; k < j && placed; k++) {
+						placed = positions[k] != pos;
+					}
+					positions[j] = pos;
+				}
+
+				if (placed) {
+					seeds[order[i]] = seed;
+					for (uint32_t j = 0; j < bucket.size(); j++) {
+						slots[positions[j]].pair = p_pairs[bucket[j]];
+						slots[positions[j]].used = true;
+					}
+				}
+			}
+
+			if (!placed) {
+				for (uint32_t j = 0; j < bucket.size(); j++) {
+					overflow.push_back(p_pairs[bucket[j]]);
+				}
+			}
+		}
+	}
+
+	const TValue *getptr(const TKey &p_key) const {
+		if (unlikely(num_elements == 0)) {
+			return nullptr;
+		}
+
+		uint32_t hash = Hasher::hash(p_key);
+		const Slot &slot = slots[_mix(hash, seeds[_get_bucket(hash)]) & slot_mask];
+		if (slot.used && Comparator::compare(slot.pair.key, p_key)) {
+			return &slot.pair.value;
+		}
+
+		for (uint32_t i = 0; i < overflow.size(); i++) {
+			if (Comparator::compare(overflow[i].key, p_key)) {
+				return &overflow[i].value;
+			}
+		}
+		return nullptr;
+	}
+
+	_FORCE_INLINE_ bool has(const TKey &p_key) const {
+		return getptr(p_key) != nullptr;
+	}
+};
+
+#endif // PERFECT_HASH_MAP_H
@@ -31,3 +31,5 @@
 #include "rid_owner.h"
 
 SafeNumeric<uint64_t> RID_AllocBase::base_id{ 1 };
+thread_local uint64_t RID_AllocBase::thread_next_id = 0;
+thread_local uint64_t RID_AllocBase::thread_end_id = 0;
@@ -35,17 +35,27 @@
 #include "core/os/spin_lock.h"
 #include "core/string/print_string.h"
 #include "core/templates/list.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/oa_hash_map.h"
 #include "core/templates/rid.h"
 #include "core/templates/safe_refcount.h"
 #include "core/templates/set.h"
 
+#include <atomic>
 #include <stdio.h>
 #include <typeinfo>
 
 class RID_AllocBase {
 	static SafeNumeric<uint64_t> base_id;
 
+	// Every thread reserves ids in batches, so threads creating RIDs at the same
+	// time don't all contend on base_id.
+	enum {
+		ID_BATCH_SIZE = 256,
+	};
+	static thread_local uint64_t thread_next_id;
+	static thread_local uint64_t thread_end_id;
+
 protected:
 	static RID _make_from_id(uint64_t p_id) {
 		RID rid;
@@ -53,8 +63,12 @@ protected:
 		return rid;
 	}
 
-	static uint64_t _gen_id() {
-		return base_id.increment();
+	static _FORCE_INLINE_ uint64_t _gen_id() {
+		if (unlikely(thread_next_id == thread_end_id)) {
+			thread_end_id = base_id.add(ID_BATCH_SIZE) + 1;
+			thread_next_id = thread_end_id - ID_BATCH_SIZE;
+		}
+		return thread_next_id++;
 	}
 
 	static RID _gen_rid() {
@@ -65,76 +79,154 @@ public:
 	virtual ~RID_AllocBase() {}
 };
 
+// Slots are allocated in chunks which are never moved or freed while the
+// allocator lives, so looking up a RID takes no lock: the index in the low
+// 32 bits finds the slot, and the validator in the high 32 bits must match the
+// stamp the slot got when it was allocated. Free slots form a lock-free list.
+// Only growing by a new chunk takes a lock.
 template <class T, bool THREAD_SAFE = false>
 class RID_Alloc : public RID_AllocBase {
-	T **chunks = nullptr;
-	uint32_t **free_list_chunks = nullptr;
-	uint32_t **validator_chunks = nullptr;
+	enum : uint32_t {
+		INVALID_VALIDATOR = 0xFFFFFFFF,
+		UNINITIALIZED_BIT = 0x80000000,
+		FREE_LIST_END = 0xFFFFFFFF,
+	};
+
+	struct Chunk {
+		T *data;
+		std::atomic<uint32_t> *validators;
+		std::atomic<uint32_t> *next_free; // Next slot in the free list, while this one is free.
+	};
+
+	// Grows by replacing the whole array. Replaced arrays are kept until
+	// destruction, as threads may still be reading from them.
+	std::atomic<Chunk *> chunks = { nullptr };
+	uint32_t chunk_capacity = 0;
+	LocalVector<Chunk *> retired_chunk_arrays;
+
+	std::atomic<uint32_t> max_alloc = { 0 };
+	SafeNumeric<uint32_t> alloc_count;
+
+	// First free slot in the low bits. The high bits count pushes and pops, so a
+	// pop can't succeed against a head that was popped and pushed back meanwhile.
+	std::atomic<uint64_t> free_head = { FREE_LIST_END };
 
 	uint32_t elements_in_chunk;
-	uint32_t max_alloc = 0;
-	uint32_t alloc_count = 0;
+	uint32_t chunk_shift = 0;
+	uint32_t chunk_mask;
 
 	const char *description = nullptr;
 
-	SpinLock spin_lock;
+	SpinLock grow_lock;
 
-	_FORCE_INLINE_ RID _allocate_rid(const T *p_initializer) {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
+	_FORCE_INLINE_ const Chunk &_get_chunk(uint32_t p_index) const {
+		return chunks.load(std::memory_order_acquire)[p_index >> chunk_shift];
+	}
 
-		if (alloc_count == max_alloc) {
-			//allocate a new chunk
-			uint32_t chunk_count = alloc_count == 0 ? 0 : (max_alloc / elements_in_chunk);
-
-			//grow chunks
-			chunks = (T **)memrealloc(chunks, sizeof(T *) * (chunk_count + 1));
-			chunks[chunk_count] = (T *)memalloc(sizeof(T) * elements_in_chunk); //but don't initialize
-
-			//grow validators
-			validator_chunks = (uint32_t **)memrealloc(validator_chunks, sizeof(uint32_t *) * (chunk_count + 1));
-			validator_chunks[chunk_count] = (uint32_t *)memalloc(sizeof(uint32_t) * elements_in_chunk);
-			//grow free lists
-			free_list_chunks = (uint32_t **)memrealloc(free_list_chunks, sizeof(uint32_t *) * (chunk_count + 1));
-			free_list_chunks[chunk_count] = (uint32_t *)memalloc(sizeof(uint32_t) * elements_in_chunk);
-
-			//initialize
-			for (uint32_t i = 0; i < elements_in_chunk; i++) {
-				//dont initialize chunk
-				validator_chunks[chunk_count][i] = 0xFFFFFFFF;
-				free_list_chunks[chunk_count][i] = alloc_count + i;
+	void _grow() {
+		uint32_t chunk_count = max_alloc.load(std::memory_order_relaxed) >> chunk_shift;
+		Chunk *chunk_array = chunks.load(std::memory_order_relaxed);
+
+		if (chunk_count == chunk_capacity) {
+			chunk_capacity = MAX(4u, chunk_capacity * 2);
+			Chunk *new_array = (Chunk *)memalloc(sizeof(Chunk) * chunk_capacity);
+			if (chunk_array) {
+				memcpy(new_array, chunk_array, sizeof(Chunk) * chunk_count);
+				retired_chunk_arrays.push_back(chunk_array);
 			}
+			chunk_array = new_array;
+			chunks.store(chunk_array, std::memory_order_release);
+		}
+
+		Chunk &chunk = chunk_array[chunk_count];
+		chunk.data = (T *)memalloc(sizeof(T) * elements_in_chunk); //but don't initialize
+		chunk.validators = (std::atomic<uint32_t> *)memalloc(sizeof(std::atomic<uint32_t>) * elements_in_chunk);
+		chunk.next_free = (std::atomic<uint32_t> *)memalloc(sizeof(std::atomic<uint32_t>) * elements_in_chunk);
+
+		uint32_t first = chunk_count << chunk_shift;
+		for (uint32_t i = 0; i < elements_in_chunk; i++) {
+			memnew_placement(&chunk.validators[i], std::atomic<uint32_t>);
+			memnew_placement(&chunk.next_free[i], std::atomic<uint32_t>);
+			chunk.validators[i].store(INVALID_VALIDATOR, std::memory_order_relaxed);
+			chunk.next_free[i].store(first + i + 1, std::memory_order_relaxed);
+		}
 
-			max_alloc += elements_in_chunk;
+		// Publish the chunk before any of its slots can be handed out.
+		max_alloc.store(first + elements_in_chunk, std::memory_order_release);
+		_push_free(first, first + elements_in_chunk - 1);
+	}
+
+	// Pushes the slots p_first..p_last, already linked together, onto the free list.
+	_FORCE_INLINE_ void _push_free(uint32_t p_first, uint32_t p_last) {
+		std::atomic<uint32_t> &last_next = _get_chunk(p_last).next_free[p_last & chunk_mask];
+		uint64_t head = free_head.load(std::memory_order_relaxed);
+		while (true) {
+			last_next.store(uint32_t(head), std::memory_order_relaxed);
+			uint64_t new_head = (((head >> 32) + 1) << 32) | p_first;
+			if (!THREAD_SAFE) {
+				free_head.store(new_head, std::memory_order_relaxed);
+				return;
+			}
+			if (free_head.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed)) {
+				return;
+			}
 		}
+	}
+
+	_FORCE_INLINE_ uint32_t _pop_free() {
+		uint64_t head = free_head.load(std::memory_order_acquire);
+		while (true) {
+			uint32_t index = uint32_t(head);
+			if (unlikely(index == FREE_LIST_END)) {
+				if (THREAD_SAFE) {
+					grow_lock.lock();
+				}
+				// Another thread may have grown it while this one waited.
+				if (uint32_t(free_head.load(std::memory_order_acquire)) == FREE_LIST_END) {
+					_grow();
+				}
+				if (THREAD_SAFE) {
+					grow_lock.unlock();
+				}
+				head = free_head.load(std::memory_order_acquire);
+				continue;
+			}
 
-		uint32_t free_index = free_list_chunks[alloc_count / elements_in_chunk][alloc_count % elements_in_chunk];
+			// May be stale if the slot was taken meanwhile, in which case the exchange fails.
+			uint32_t next = _get_chunk(index).next_free[index & chunk_mask].load(std::memory_order_relaxed);
+			uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+			if (!THREAD_SAFE) {
+				free_head.store(new_head, std::memory_order_relaxed);
+				return index;
+			}
+			if (free_head.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire)) {
+				return index;
+			}
+		}
+	}
 
-		uint32_t free_chunk = free_index / elements_in_chunk;
-		uint32_t free_element = free_index % elements_in_chunk;
+	_FORCE_INLINE_ RID _allocate_rid(const T *p_initializer) {
+		uint32_t index = _pop_free();
+		const Chunk &chunk = _get_chunk(index);
+		uint32_t element = index & chunk_mask;
 
 		if (p_initializer) {
-			T *ptr = &chunks[free_chunk][free_element];
+			T *ptr = &chunk.data[element];
 			memnew_placement(ptr, T(*p_initializer));
 		}
 
 		uint32_t validator = (uint32_t)(_gen_id() & 0x7FFFFFFF);
 		uint64_t id = validator;
 		id <<= 32;
-		id |= free_index;
-
-		validator_chunks[free_chunk][free_element] = validator;
+		id |= index;
 
 		if (!p_initializer) {
-			validator_chunks[free_chunk][free_element] |= 0x80000000; //mark uninitialized bit
+			validator |= UNINITIALIZED_BIT;
 		}
+		// Release, so threads that find the slot through the new RID see it constructed.
+		chunk.validators[element].store(validator, std::memory_order_release);
 
-		alloc_count++;
-
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
+		alloc_count.increment();
 
 		return _make_from_id(id);
 	}
@@ -153,180 +245,114 @@ public:
 		if (p_rid == RID()) {
 			return nullptr;
 		}
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
 
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
+		if (unlikely(idx >= max_alloc.load(std::memory_order_acquire))) {
 			return nullptr;
 		}
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
-		uint32_t idx_element = idx % elements_in_chunk;
+		const Chunk &chunk = _get_chunk(idx);
+		uint32_t idx_element = idx & chunk_mask;
 
 		uint32_t validator = uint32_t(id >> 32);
+		uint32_t current = chunk.validators[idx_element].load(std::memory_order_acquire);
 
 		if (unlikely(p_initialize)) {
-			if (unlikely(!(validator_chunks[idx_chunk][idx_element] & 0x80000000))) {
-				if (THREAD_SAFE) {
-					spin_lock.unlock();
-				}
+			if (unlikely(!(current & UNINITIALIZED_BIT))) {
 				ERR_FAIL_V_MSG(nullptr, "Initializing already initialized RID");
 			}
 
-			if (unlikely((validator_chunks[idx_chunk][idx_element] & 0x7FFFFFFF) != validator)) {
-				if (THREAD_SAFE) {
-					spin_lock.unlock();
-				}
+			if (unlikely((current & 0x7FFFFFFF) != validator)) {
 				ERR_FAIL_V_MSG(nullptr, "Attempting to initialize the wrong RID");
-				return nullptr;
 			}
 
-			validator_chunks[idx_chunk][idx_element] &= 0x7FFFFFFF; //initialized
+			chunk.validators[idx_element].store(validator, std::memory_order_release); //initialized
 
-		} else if (unlikely(validator_chunks[idx_chunk][idx_element] != validator)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			if (validator_chunks[idx_chunk][idx_element] & 0x80000000) {
+		} else if (unlikely(current != validator)) {
+			if (current & UNINITIALIZED_BIT) {
 				ERR_FAIL_V_MSG(nullptr, "Attempting to use an uninitialized RID");
 			}
 			return nullptr;
 		}
 
-		T *ptr = &chunks[idx_chunk][idx_element];
-
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
-
-		return ptr;
+		return &chunk.data[idx_element];
 	}
+
 	void initialize_rid(RID p_rid, const T &p_value) {
-		T *mem = getornull(p_rid, true);
-		ERR_FAIL_COND(!mem);
-		memnew_placement(mem, T(p_value));
+		uint64_t id = p_rid.get_id();
+		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
+		ERR_FAIL_COND(p_rid == RID() || idx >= max_alloc.load(std::memory_order_acquire));
+
+		const Chunk &chunk = _get_chunk(idx);
+		uint32_t idx_element = idx & chunk_mask;
+
+		uint32_t validator = uint32_t(id >> 32);
+		uint32_t current = chunk.validators[idx_element].load(std::memory_order_acquire);
+		ERR_FAIL_COND_MSG(!(current & UNINITIALIZED_BIT), "Initializing already initialized RID");
+		ERR_FAIL_COND_MSG((current & 0x7FFFFFFF) != validator, "Attempting to initialize the wrong RID");
+
+		// Construct before clearing the bit, so the RID is never valid without an object behind it.
+		memnew_placement(&chunk.data[idx_element], T(p_value));
+		chunk.validators[idx_element].store(validator, std::memory_order_release);
 	}
 
 	_FORCE_INLINE_ bool owns(const RID &p_rid) {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
+		if (unlikely(idx >= max_alloc.load(std::memory_order_acquire))) {
 			return false;
 		}
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
-		uint32_t idx_element = idx % elements_in_chunk;
-
 		uint32_t validator = uint32_t(id >> 32);
 
-		bool owned = (validator_chunks[idx_chunk][idx_element] & 0x7FFFFFFF) == validator;
-
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
-
-		return owned;
+		return (_get_chunk(idx).validators[idx & chunk_mask].load(std::memory_order_acquire) & 0x7FFFFFFF) == validator;
 	}
 
 	_FORCE_INLINE_ void free(const RID &p_rid) {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			ERR_FAIL();
-		}
+		ERR_FAIL_COND(idx >= max_alloc.load(std::memory_order_acquire));
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
-		uint32_t idx_element = idx % elements_in_chunk;
+		const Chunk &chunk = _get_chunk(idx);
+		uint32_t idx_element = idx & chunk_mask;
 
 		uint32_t validator = uint32_t(id >> 32);
-		if (unlikely(validator_chunks[idx_chunk][idx_element] & 0x80000000)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
+		uint32_t current = chunk.validators[idx_element].load(std::memory_order_acquire);
+		if (unlikely(current & UNINITIALIZED_BIT)) {
 			ERR_FAIL_MSG("Attempted to free an uninitialized or invalid RID");
-		} else if (unlikely(validator_chunks[idx_chunk][idx_element] != validator)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
+		} else if (unlikely(current != validator)) {
 			ERR_FAIL();
 		}
 
-		chunks[idx_chunk][idx_element].~T();
-		validator_chunks[idx_chunk][idx_element] = 0xFFFFFFFF; // go invalid
-
-		alloc_count--;
-		free_list_chunks[alloc_count / elements_in_chunk][alloc_count % elements_in_chunk] = idx;
-
+		// Invalidate first, so lookups fail from now on and only one of two threads freeing the same RID gets past this.
 		if (THREAD_SAFE) {
-			spin_lock.unlock();
+			ERR_FAIL_COND(!chunk.validators[idx_element].compare_exchange_strong(current, INVALID_VALIDATOR, std::memory_order_acq_rel));
+		} else {
+			chunk.validators[idx_element].store(INVALID_VALIDATOR, std::memory_order_relaxed);
 		}
-	}
 
-	_FORCE_INLINE_ uint32_t get_rid_count() const {
-		return alloc_count;
-	}
+		chunk.data[idx_element].~T();
 
-	_FORCE_INLINE_ T *get_ptr_by_index(uint32_t p_index) {
-		ERR_FAIL_UNSIGNED_INDEX_V(p_index, alloc_count, nullptr);
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-		uint64_t idx = free_list_chunks[p_index / elements_in_chunk][p_index % elements_in_chunk];
-		T *ptr = &chunks[idx / elements_in_chunk][idx % elements_in_chunk];
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
-		return ptr;
+		alloc_count.decrement();
+		_push_free(idx, idx);
 	}
 
-	_FORCE_INLINE_ RID get_rid_by_index(uint32_t p_index) {
-		ERR_FAIL_INDEX_V(p_index, alloc_count, RID());
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-		uint64_t idx = free_list_chunks[p_index / elements_in_chunk][p_index % elements_in_chunk];
-		uint64_t validator = validator_chunks[idx / elements_in_chunk][idx % elements_in_chunk];
-
-		RID rid = _make_from_id((validator << 32) | idx);
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
-		return rid;
+	_FORCE_INLINE_ uint32_t get_rid_count() const {
+		return alloc_count.get();
 	}
 
-	void get_owned_list(List<RID> *p_owned) {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-		for (size_t i = 0; i < max_alloc; i++) {
-			uint64_t validator = validator_chunks[i / elements_in_chunk][i % elements_in_chunk];
-			if (validator != 0xFFFFFFFF) {
+	// Lists the initialized RIDs. Not synchronized with make_rid() and free(),
+	// RIDs created or freed while this runs may or may not be listed.
+	template <class A>
+	void get_owned_list(List<RID, A> *p_owned) {
+		uint32_t count = max_alloc.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++) {
+			uint64_t validator = _get_chunk(i).validators[i & chunk_mask].load(std::memory_order_acquire);
+			if (!(validator & UNINITIALIZED_BIT)) {
 				p_owned->push_back(_make_from_id((validator << 32) | i));
 			}
 		}
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
 	}
 
 	void set_description(const char *p_descrption) {
@@ -335,39 +361,50 @@ public:
 
 	RID_Alloc(uint32_t p_target_chunk_byte_size = 4096) {
 		elements_in_chunk = sizeof(T) > p_target_chunk_byte_size ? 1 : (p_target_chunk_byte_size / sizeof(T));
+		// Power of two, so finding the slot of a RID is a shift and a mask.
+		while ((2u << chunk_shift) <= elements_in_chunk) {
+			chunk_shift++;
+		}
+		elements_in_chunk = 1 << chunk_shift;
+		chunk_mask = elements_in_chunk - 1;
 	}
 
 	~RID_Alloc() {
-		if (alloc_count) {
+		uint32_t count = max_alloc.load(std::memory_order_acquire);
+		Chunk *chunk_array = chunks.load(std::memory_order_acquire);
+
+		if (alloc_count.get()) {
 			if (description) {
-				print_error("ERROR: " + itos(alloc_count) + " RID allocations of type '" + description + "' were leaked at exit.");
+				print_error("ERROR: " + itos(alloc_count.get()) + " RID allocations of type '" + description + "' were leaked at exit.");
 			} else {
 #ifdef NO_SAFE_CAST
-				print_error("ERROR: " + itos(alloc_count) + " RID allocations of type 'unknown' were leaked at exit.");
+				print_error("ERROR: " + itos(alloc_count.get()) + " RID allocations of type 'unknown' were leaked at exit.");
 #else
-				print_error("ERROR: " + itos(alloc_count) + " RID allocations of type '" + typeid(T).name() + "' were leaked at exit.");
+				print_error("ERROR: " + itos(alloc_count.get()) + " RID allocations of type '" + typeid(T).name() + "' were leaked at exit.");
 #endif
 			}
 
-			for (size_t i = 0; i < max_alloc; i++) {
-				uint64_t validator = validator_chunks[i / elements_in_chunk][i % elements_in_chunk];
-				if (validator != 0xFFFFFFFF) {
-					chunks[i / elements_in_chunk][i % elements_in_chunk].~T();
+			for (uint32_t i = 0; i < count; i++) {
+				Chunk &chunk = chunk_array[i >> chunk_shift];
+				uint32_t validator = chunk.validators[i & chunk_mask].load(std::memory_order_relaxed);
+				if (!(validator & UNINITIALIZED_BIT)) {
+					chunk.data[i & chunk_mask].~T();
 				}
 			}
 		}
 
-		uint32_t chunk_count = max_alloc / elements_in_chunk;
+		uint32_t chunk_count = count >> chunk_shift;
 		for (uint32_t i = 0; i < chunk_count; i++) {
-			memfree(chunks[i]);
-			memfree(validator_chunks[i]);
-			memfree(free_list_chunks[i]);
+			memfree(chunk_array[i].data);
+			memfree(chunk_array[i].validators);
+			memfree(chunk_array[i].next_free);
 		}
 
-		if (chunks) {
-			memfree(chunks);
-			memfree(free_list_chunks);
-			memfree(validator_chunks);
+		if (chunk_array) {
+			memfree(chunk_array);
+		}
+		for (uint32_t i = 0; i < retired_chunk_arrays.size(); i++) {
+			memfree(retired_chunk_arrays[i]);
 		}
 	}
 };
@@ -415,15 +452,8 @@ public:
 		return alloc.get_rid_count();
 	}
 
-	_FORCE_INLINE_ RID get_rid_by_index(uint32_t p_index) {
-		return alloc.get_rid_by_index(p_index);
-	}
-
-	_FORCE_INLINE_ T *get_ptr_by_index(uint32_t p_index) {
-		return *alloc.get_ptr_by_index(p_index);
-	}
-
-	_FORCE_INLINE_ void get_owned_list(List<RID> *p_owned) {
+	template <class A>
+	_FORCE_INLINE_ void get_owned_list(List<RID, A> *p_owned) {
 		return alloc.get_owned_list(p_owned);
 	}
 
@@ -468,15 +498,8 @@ public:
 		return alloc.get_rid_count();
 	}
 
-	_FORCE_INLINE_ RID get_rid_by_index(uint32_t p_index) {
-		return alloc.get_rid_by_index(p_index);
-	}
-
-	_FORCE_INLINE_ T *get_ptr_by_index(uint32_t p_index) {
-		return alloc.get_ptr_by_index(p_index);
-	}
-
-	_FORCE_INLINE_ void get_owned_list(List<RID> *p_owned) {
+	template <class A>
+	_FORCE_INLINE_ void get_owned_list(List<RID, A> *p_owned) {
 		return alloc.get_owned_list(p_owned);
 	}
 
@@ -30,50 +30,188 @@
 
 #include "thread_work_pool.h"
 
+#include "core/math/math_funcs.h"
 #include "core/os/os.h"
 
-void ThreadWorkPool::_thread_function(void *p_user) {
-	ThreadData *thread = static_cast<ThreadData *>(p_user);
-	while (true) {
-		thread->start.wait();
-		if (thread->exit.load()) {
+SpinLock ThreadWorkPool::stats_lock;
+ThreadWorkPool::Stats ThreadWorkPool::accumulated_stats;
+ThreadWorkPool::Stats ThreadWorkPool::last_stats;
+
+void ThreadWorkPool::_run(BaseWork *p_work) {
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	p_work->work();
+	p_work->busy_usec.fetch_add(OS::get_singleton()->get_ticks_usec() - begin, std::memory_order_relaxed);
+}
+
+void ThreadWorkPool::_task_function(void *p_work) {
+	_run(static_cast<BaseWork *>(p_work));
+}
+
+void ThreadWorkPool::_prepare(BaseWork *p_work, uint32_t p_method_hash) {
+	p_work->index.store(0, std::memory_order_relaxed);
+	p_work->busy_usec.store(0, std::memory_order_relaxed);
+	p_work->method_hash = p_method_hash;
+
+	float usec_per_element = 0.0;
+	bool found = false;
+	history_lock.lock();
+	for (uint32_t i = 0; i < job_history.size(); i++) {
+		if (job_history[i].method_hash == p_method_hash) {
+			usec_per_element = job_history[i].usec_per_element;
+			found = true;
 			break;
 		}
-		thread->work->work();
-		thread->completed.post();
 	}
+	if (!found) {
+		if (job_history.size() >= MAX_JOB_HISTORY) {
+			job_history.remove(0);
+		}
+		JobHistory entry;
+		entry.method_hash = p_method_hash;
+		job_history.push_back(entry);
+	}
+	history_lock.unlock();
+
+	// Largest batch that still leaves enough batches for every thread to balance the load.
+	uint32_t max_batch = MAX(1u, p_work->max_elements / (thread_count * BATCHES_PER_THREAD));
+
+	if (usec_per_element <= 0.0) {
+		p_work->batch_size = max_batch; // First run, no timing yet.
+	} else {
+		uint32_t batch = uint32_t(Math::ceil(TARGET_BATCH_USEC / usec_per_element));
+		p_work->batch_size = CLAMP(batch, 1u, max_batch);
+	}
+}
+
+void ThreadWorkPool::_dispatch(BaseWork *p_work) {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	if (scheduler == nullptr) {
+		// No scheduler (yet), run the job in place.
+		_run(p_work);
+		return;
+	}
+
+	p_work->task_count = MIN(thread_count, p_work->max_elements);
+	if (p_work->task_count == 0) {
+		return;
+	}
+	if (p_work->in_arena) {
+		p_work->tasks = (TaskScheduler::TaskID *)FrameArena::get_thread_arena()->alloc(sizeof(TaskScheduler::TaskID) * p_work->task_count);
+	} else {
+		p_work->tasks = memnew_arr(TaskScheduler::TaskID, p_work->task_count);
+	}
+	for (uint32_t i = 0; i < p_work->task_count; i++) {
+		p_work->tasks[i] = scheduler->add_task(&ThreadWorkPool::_task_function, p_work);
+	}
+}
+
+bool ThreadWorkPool::is_work_completed(WorkID p_work) const {
+	ERR_FAIL_NULL_V(p_work, true);
+	if (p_work->index.load(std::memory_order_acquire) < p_work->max_elements) {
+		return false;
+	}
+	if (p_work->tasks) {
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		for (uint32_t i = 0; i < p_work->task_count; i++) {
+			if (!scheduler->is_task_completed(p_work->tasks[i])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void ThreadWorkPool::wait_for_work(WorkID p_work) {
+	ERR_FAIL_NULL(p_work);
+
+	// Take part in the job instead of sleeping while elements are left.
+	_run(p_work);
+
+	if (p_work->tasks) {
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		for (uint32_t i = 0; i < p_work->task_count; i++) {
+			scheduler->wait_for_task(p_work->tasks[i]);
+		}
+		if (!p_work->in_arena) {
+			memdelete_arr(p_work->tasks);
+		}
+		p_work->tasks = nullptr;
+	}
+
+	uint64_t busy_usec = p_work->busy_usec.load(std::memory_order_relaxed);
+	uint32_t elements = p_work->max_elements;
+	uint32_t batch_size = p_work->batch_size;
+
+	if (elements > 0) {
+		float usec_per_element = float(busy_usec) / elements;
+		history_lock.lock();
+		for (uint32_t i = 0; i < job_history.size(); i++) {
+			if (job_history[i].method_hash == p_work->method_hash) {
+				float &history = job_history[i].usec_per_element;
+				history = history > 0.0 ? Math::lerp(history, usec_per_element, 0.25f) : usec_per_element;
+				break;
+			}
+		}
+		history_lock.unlock();
+	}
+
+	stats_lock.lock();
+	accumulated_stats.jobs++;
+	accumulated_stats.elements += elements;
+	accumulated_stats.batches += (elements + batch_size - 1) / batch_size;
+	accumulated_stats.time_usec += busy_usec;
+	stats_lock.unlock();
+
+	if (p_work->in_arena) {
+		// Memory is given back when the scope in do_work() ends.
+		p_work->~BaseWork();
+	} else {
+		memdelete(p_work);
+	}
+}
+
+void ThreadWorkPool::end_work() {
+	ERR_FAIL_COND(current_work == nullptr);
+
+	BaseWork *work = current_work;
+	current_work = nullptr;
+	wait_for_work(work);
+}
+
+void ThreadWorkPool::update_stats() {
+	stats_lock.lock();
+	last_stats = accumulated_stats;
+	accumulated_stats = Stats();
+	stats_lock.unlock();
+}
+
+ThreadWorkPool::Stats ThreadWorkPool::get_stats() {
+	stats_lock.lock();
+	Stats stats = last_stats;
+	stats_lock.unlock();
+	return stats;
 }
 
 void ThreadWorkPool::init(int p_thread_count) {
-	ERR_FAIL_COND(threads != nullptr);
+	ERR_FAIL_COND(initialized);
 	if (p_thread_count < 0) {
 		p_thread_count = OS::get_singleton()->get_processor_count();
 	}
 
-	thread_count = p_thread_count;
-	threads = memnew_arr(ThreadData, thread_count);
-
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(false);
-		threads[i].thread.start(&ThreadWorkPool::_thread_function, &threads[i]);
-	}
+	thread_count = MAX(p_thread_count, 1);
+	initialized = true;
 }
 
 void ThreadWorkPool::finish() {
-	if (threads == nullptr) {
+	if (!initialized) {
 		return;
 	}
 
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(true);
-		threads[i].start.post();
-	}
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].thread.wait_to_finish();
+	if (current_work != nullptr) {
+		end_work();
 	}
 
-	memdelete_arr(threads);
-	threads = nullptr;
+	initialized = false;
 }
 
 ThreadWorkPool::~ThreadWorkPool() {
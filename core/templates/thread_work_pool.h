@@ -31,18 +31,41 @@
 #ifndef THREAD_WORK_POOL_H
 #define THREAD_WORK_POOL_H
 
+#include "core/os/frame_arena.h"
 #include "core/os/memory.h"
-#include "core/os/semaphore.h"
-#include "core/os/thread.h"
+#include "core/os/spin_lock.h"
+#include "core/os/task_scheduler.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/local_vector.h"
 
 #include <atomic>
 
+// Splits jobs over the engine-wide TaskScheduler.
+//
+// add_work() starts a job asynchronously and returns a handle, any number of
+// jobs can be in flight. wait_for_work() makes the calling thread process the
+// remaining elements of the job itself, then waits for the other threads.
+// begin_work()/end_work()/do_work() are kept for the single job use case.
+
 class ThreadWorkPool {
-	std::atomic<uint32_t> index;
+public:
+	struct Stats {
+		uint64_t jobs = 0;
+		uint64_t elements = 0;
+		uint64_t batches = 0;
+		uint64_t time_usec = 0;
+	};
 
+private:
 	struct BaseWork {
-		std::atomic<uint32_t> *index = nullptr;
+		std::atomic<uint32_t> index;
 		uint32_t max_elements = 0;
+		uint32_t batch_size = 1;
+		uint32_t method_hash = 0;
+		std::atomic<uint64_t> busy_usec;
+		TaskScheduler::TaskID *tasks = nullptr;
+		uint32_t task_count = 0;
+		bool in_arena = false; // Allocated from the frame arena of the thread that started it.
 		virtual void work() = 0;
 		virtual ~BaseWork() = default;
 	};
@@ -53,51 +76,87 @@ class ThreadWorkPool {
 		M method;
 		U userdata;
 		virtual void work() {
+			// Claim whole batches so the shared index isn't bounced between cores for every element.
 			while (true) {
-				uint32_t work_index = index->fetch_add(1, std::memory_order_relaxed);
-				if (work_index >= max_elements) {
+				uint32_t from = index.fetch_add(batch_size, std::memory_order_relaxed);
+				if (from >= max_elements) {
 					break;
 				}
-				(instance->*method)(work_index, userdata);
+				uint32_t to = MIN(from + batch_size, max_elements);
+				for (uint32_t work_index = from; work_index < to; work_index++) {
+					(instance->*method)(work_index, userdata);
+				}
 			}
 		}
 	};
 
-	struct ThreadData {
-		Thread thread;
-		Semaphore start;
-		Semaphore completed;
-		std::atomic<bool> exit;
-		BaseWork *work;
+public:
+	typedef BaseWork *WorkID;
+
+private:
+	// Timing history of the jobs run by this pool, used to pick the batch size.
+	struct JobHistory {
+		uint32_t method_hash = 0;
+		float usec_per_element = 0.0;
+	};
+
+	enum {
+		BATCHES_PER_THREAD = 4, // Lower bound on the batches each thread gets, for load balancing.
+		TARGET_BATCH_USEC = 50, // Batches shorter than this are merged, as claiming them costs more than running them.
+		MAX_JOB_HISTORY = 16,
 	};
 
-	ThreadData *threads = nullptr;
+	SpinLock history_lock;
+	LocalVector<JobHistory> job_history;
+
 	uint32_t thread_count = 0;
+	bool initialized = false;
 	BaseWork *current_work = nullptr;
 
-	static void _thread_function(void *p_user);
+	static SpinLock stats_lock;
+	static Stats accumulated_stats;
+	static Stats last_stats;
+
+	static void _run(BaseWork *p_work);
+	static void _task_function(void *p_work);
+
+	void _prepare(BaseWork *p_work, uint32_t p_method_hash);
+	void _dispatch(BaseWork *p_work);
 
-public:
 	template <class C, class M, class U>
-	void begin_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-		ERR_FAIL_COND(!threads); //never initialized
-		ERR_FAIL_COND(current_work != nullptr);
+	void _start(Work<C, M, U> *p_work, uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		p_work->instance = p_instance;
+		p_work->userdata = p_userdata;
+		p_work->method = p_method;
+		p_work->max_elements = p_elements;
+
+		_prepare(p_work, hash_djb2_buffer((const uint8_t *)&p_method, sizeof(M)));
+		_dispatch(p_work);
+	}
 
-		index.store(0, std::memory_order_release);
+public:
+	// Starts processing (p_instance->*p_method)(index, p_userdata) for every index
+	// in [0, p_elements) and returns immediately. The handle must be passed to
+	// wait_for_work() once.
+	template <class C, class M, class U>
+	WorkID add_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		ERR_FAIL_COND_V(!initialized, nullptr);
 
 		Work<C, M, U> *w = memnew((Work<C, M, U>));
-		w->instance = p_instance;
-		w->userdata = p_userdata;
-		w->method = p_method;
-		w->index = &index;
-		w->max_elements = p_elements;
+		_start(w, p_elements, p_instance, p_method, p_userdata);
+		return w;
+	}
 
-		current_work = w;
+	bool is_work_completed(WorkID p_work) const;
+	// Joins the job as one more worker, then waits until it's done and frees the handle.
+	void wait_for_work(WorkID p_work);
 
-		for (uint32_t i = 0; i < thread_count; i++) {
-			threads[i].work = w;
-			threads[i].start.post();
-		}
+	template <class C, class M, class U>
+	void begin_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		ERR_FAIL_COND(!initialized); //never initialized
+		ERR_FAIL_COND(current_work != nullptr);
+
+		current_work = add_work(p_elements, p_instance, p_method, p_userdata);
 	}
 
 	bool is_working() const {
@@ -106,36 +165,39 @@ public:
 
 	bool is_done_dispatching() const {
 		ERR_FAIL_COND_V(current_work == nullptr, false);
-		return index.load(std::memory_order_acquire) >= current_work->max_elements;
+		return current_work->index.load(std::memory_order_acquire) >= current_work->max_elements;
 	}
 
 	uint32_t get_work_index() const {
 		ERR_FAIL_COND_V(current_work == nullptr, 0);
-		uint32_t idx = index.load(std::memory_order_acquire);
+		uint32_t idx = current_work->index.load(std::memory_order_acquire);
 		return MIN(idx, current_work->max_elements);
 	}
 
-	void end_work() {
-		ERR_FAIL_COND(current_work == nullptr);
-		for (uint32_t i = 0; i < thread_count; i++) {
-			threads[i].completed.wait();
-			threads[i].work = nullptr;
-		}
-
-		memdelete(current_work);
-		current_work = nullptr;
-	}
+	void end_work();
 
 	template <class C, class M, class U>
 	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-		begin_work(p_elements, p_instance, p_method, p_userdata);
-		end_work();
+		ERR_FAIL_COND(!initialized);
+
+		// The job never outlives this call, so it doesn't need to go through the heap.
+		FrameArena::Scope scope;
+		typedef Work<C, M, U> WorkType;
+		WorkType *w = memnew_placement(FrameArena::get_thread_arena()->alloc(sizeof(WorkType)), WorkType);
+		w->in_arena = true;
+		_start(w, p_elements, p_instance, p_method, p_userdata);
+		wait_for_work(w);
 	}
 
 	_FORCE_INLINE_ int get_thread_count() const { return thread_count; }
+
+	// Statistics of all pools are accumulated, and published once per second by update_stats().
+	static void update_stats();
+	static Stats get_stats();
+
 	void init(int p_thread_count = -1);
 	void finish();
 	~ThreadWorkPool();
 };
 
-#endif // THREAD_POOL_H
+#endif // THREAD_WORK_POOL_H
@@ -130,6 +130,10 @@ public:
 		_cowdata._ref(p_from._cowdata);
 		return *this;
 	}
+	inline Vector &operator=(Vector &&p_from) {
+		_cowdata = std::move(p_from._cowdata);
+		return *this;
+	}
 
 	Vector<uint8_t> to_byte_array() const {
 		Vector<uint8_t> ret;
@@ -189,6 +193,8 @@ public:
 
 	_FORCE_INLINE_ Vector() {}
 	_FORCE_INLINE_ Vector(const Vector &p_from) { _cowdata._ref(p_from._cowdata); }
+	_FORCE_INLINE_ Vector(Vector &&p_from) :
+			_cowdata(std::move(p_from._cowdata)) {}
 
 	_FORCE_INLINE_ ~Vector() {}
 };
@@ -218,7 +224,7 @@ template <class T>
 bool Vector<T>::push_back(T p_elem) {
 	Error err = resize(size() + 1);
 	ERR_FAIL_COND_V(err, true);
-	set(size() - 1, p_elem);
+	_cowdata.ptrw()[size() - 1] = std::move(p_elem);
 
 	return false;
 }
@@ -40,10 +40,171 @@
 
 class ArrayPrivate {
 public:
+	enum {
+		INLINE_CAPACITY = 4,
+	};
+
 	SafeRefCount refcount;
+
+	// Arrays start with their elements stored inline, so small ones need no other allocation.
+	// They move to `array` when they outgrow it, and back only once emptied.
+	bool is_inline = true;
+	uint32_t inline_count = 0;
+	alignas(Variant) uint8_t inline_data[sizeof(Variant) * INLINE_CAPACITY];
 	Vector<Variant> array;
 
 	ContainerTypeValidate typed;
+
+	_FORCE_INLINE_ Variant *_inline_ptr() { return reinterpret_cast<Variant *>(inline_data); }
+	_FORCE_INLINE_ const Variant *_inline_ptr() const { return reinterpret_cast<const Variant *>(inline_data); }
+
+	_FORCE_INLINE_ int size() const { return is_inline ? (int)inline_count : array.size(); }
+	_FORCE_INLINE_ bool is_empty() const { return size() == 0; }
+	_FORCE_INLINE_ const Variant *ptr() const { return is_inline ? _inline_ptr() : array.ptr(); }
+	_FORCE_INLINE_ Variant *ptrw() { return is_inline ? _inline_ptr() : array.ptrw(); }
+
+	_FORCE_INLINE_ const Variant &get(int p_index) const {
+		CRASH_BAD_INDEX(p_index, size());
+		return ptr()[p_index];
+	}
+
+	_FORCE_INLINE_ Variant &getw(int p_index) {
+		CRASH_BAD_INDEX(p_index, size());
+		return ptrw()[p_index];
+	}
+
+	void _spill() {
+		Vector<Variant> spilled;
+		spilled.resize(inline_count);
+		Variant *dst = spilled.ptrw();
+		Variant *src = _inline_ptr();
+		for (uint32_t i = 0; i < inline_count; i++) {
+			dst[i] = std::move(src[i]);
+			src[i].~Variant();
+		}
+		array = std::move(spilled);
+		inline_count = 0;
+		is_inline = false;
+	}
+
+	Error resize(int p_size) {
+		ERR_FAIL_COND_V(p_size < 0, ERR_INVALID_PARAMETER);
+		if (!is_inline) {
+			if (p_size == 0) {
+				array.clear();
+				is_inline = true;
+				return OK;
+			}
+			return array.resize(p_size);
+		}
+
+		if (p_size > INLINE_CAPACITY) {
+			_spill();
+			return array.resize(p_size);
+		}
+
+		Variant *data = _inline_ptr();
+		for (uint32_t i = p_size; i < inline_count; i++) {
+			data[i].~Variant();
+		}
+		for (uint32_t i = inline_count; i < (uint32_t)p_size; i++) {
+			memnew_placement(&data[i], Variant);
+		}
+		inline_count = p_size;
+		return OK;
+	}
+
+	void clear() {
+		resize(0);
+	}
+
+	void push_back(const Variant &p_value) {
+		if (is_inline && inline_count < INLINE_CAPACITY) {
+			memnew_placement(&_inline_ptr()[inline_count], Variant(p_value));
+			inline_count++;
+			return;
+		}
+		if (is_inline) {
+			// The value may be one of the elements which are about to move.
+			Variant value = p_value;
+			_spill();
+			array.push_back(value);
+			return;
+		}
+		array.push_back(p_value);
+	}
+
+	Error insert(int p_pos, const Variant &p_value) {
+		int count = size();
+		ERR_FAIL_INDEX_V(p_pos, count + 1, ERR_INVALID_PARAMETER);
+		Variant value = p_value;
+		resize(count + 1);
+		Variant *data = ptrw();
+		for (int i = count; i > p_pos; i--) {
+			data[i] = std::move(data[i - 1]);
+		}
+		data[p_pos] = std::move(value);
+		return OK;
+	}
+
+	void remove(int p_pos) {
+		int count = size();
+		ERR_FAIL_INDEX(p_pos, count);
+		Variant *data = ptrw();
+		for (int i = p_pos; i < count - 1; i++) {
+			data[i] = std::move(data[i + 1]);
+		}
+		resize(count - 1);
+	}
+
+	int find(const Variant &p_value, int p_from) const {
+		if (p_from < 0) {
+			return -1;
+		}
+		const Variant *data = ptr();
+		int count = size();
+		for (int i = p_from; i < count; i++) {
+			if (data[i] == p_value) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	void assign(const ArrayPrivate &p_from) {
+		if (&p_from == this) {
+			return;
+		}
+		if (!p_from.is_inline) {
+			clear();
+			// Large arrays share their elements until one of them writes.
+			array = p_from.array;
+			is_inline = false;
+			return;
+		}
+		resize(p_from.inline_count);
+		Variant *data = ptrw();
+		for (uint32_t i = 0; i < p_from.inline_count; i++) {
+			data[i] = p_from._inline_ptr()[i];
+		}
+	}
+
+	void assign(const Vector<Variant> &p_from) {
+		clear();
+		if (p_from.size() <= INLINE_CAPACITY) {
+			resize(p_from.size());
+			for (int i = 0; i < p_from.size(); i++) {
+				_inline_ptr()[i] = p_from[i];
+			}
+			return;
+		}
+		array = p_from;
+		is_inline = false;
+	}
+
+	~ArrayPrivate() {
+		clear();
+	}
 };
 
 void Array::_ref(const Array &p_from) const {
@@ -76,23 +237,23 @@ void Array::_unref() const {
 }
 
 Variant &Array::operator[](int p_idx) {
-	return _p->array.write[p_idx];
+	return _p->getw(p_idx);
 }
 
 const Variant &Array::operator[](int p_idx) const {
-	return _p->array[p_idx];
+	return _p->get(p_idx);
 }
 
 int Array::size() const {
-	return _p->array.size();
+	return _p->size();
 }
 
 bool Array::is_empty() const {
-	return _p->array.is_empty();
+	return _p->is_empty();
 }
 
 void Array::clear() {
-	_p->array.clear();
+	_p->clear();
 }
 
 bool Array::operator==(const Array &p_array) const {
@@ -133,8 +294,9 @@ bool Array::operator>=(const Array &p_array) const {
 uint32_t Array::hash() const {
 	uint32_t h = hash_djb2_one_32(0);
 
-	for (int i = 0; i < _p->array.size(); i++) {
-		h = hash_djb2_one_32(_p->array[i].hash(), h);
+	const Variant *data = _p->ptr();
+	for (int i = 0; i < _p->size(); i++) {
+		h = hash_djb2_one_32(data[i].hash(), h);
 	}
 	return h;
 }
@@ -144,23 +306,23 @@ bool Array::_assign(const Array &p_array) {
 		//same type or untyped, just reference, should be fine
 		_ref(p_array);
 	} else if (_p->typed.type == Variant::NIL) { //from typed to untyped, must copy, but this is cheap anyway
-		_p->array = p_array._p->array;
+		_p->assign(*p_array._p);
 	} else if (p_array._p->typed.type == Variant::NIL) { //from untyped to typed, must try to check if they are all valid
 		if (_p->typed.type == Variant::OBJECT) {
 			//for objects, it needs full validation, either can be converted or fail
-			for (int i = 0; i < p_array._p->array.size(); i++) {
-				if (!_p->typed.validate(p_array._p->array[i], "assign")) {
+			for (int i = 0; i < p_array._p->size(); i++) {
+				if (!_p->typed.validate(p_array._p->get(i), "assign")) {
 					return false;
 				}
 			}
-			_p->array = p_array._p->array; //then just copy, which is cheap anyway
+			_p->assign(*p_array._p); //then just copy, which is cheap anyway
 
 		} else {
 			//for non objects, we need to check if there is a valid conversion, which needs to happen one by one, so this is the worst case.
 			Vector<Variant> new_array;
-			new_array.resize(p_array._p->array.size());
-			for (int i = 0; i < p_array._p->array.size(); i++) {
-				Variant src_val = p_array._p->array[i];
+			new_array.resize(p_array._p->size());
+			for (int i = 0; i < p_array._p->size(); i++) {
+				Variant src_val = p_array._p->get(i);
 				if (src_val.get_type() == _p->typed.type) {
 					new_array.write[i] = src_val;
 				} else if (Variant::can_convert_strict(src_val.get_type(), _p->typed.type)) {
@@ -175,7 +337,7 @@ bool Array::_assign(const Array &p_array) {
 				}
 			}
 
-			_p->array = new_array;
+			_p->assign(new_array);
 		}
 	} else if (_p->typed.can_reference(p_array._p->typed)) { //same type or compatible
 		_ref(p_array);
@@ -189,67 +351,92 @@ void Array::operator=(const Array &p_array) {
 	_ref(p_array);
 }
 
+void Array::operator=(Array &&p_array) {
+	// Swapping keeps both arrays valid without touching the reference counts,
+	// p_array releases what this one held when destroyed.
+	SWAP(_p, p_array._p);
+}
+
 void Array::push_back(const Variant &p_value) {
 	ERR_FAIL_COND(!_p->typed.validate(p_value, "push_back"));
-	_p->array.push_back(p_value);
+	_p->push_back(p_value);
 }
 
 void Array::append_array(const Array &p_array) {
 	ERR_FAIL_COND(!_p->typed.validate(p_array, "append_array"));
-	_p->array.append_array(p_array._p->array);
+	if (p_array._p == _p) {
+		Array copy = duplicate();
+		append_array(copy);
+		return;
+	}
+	int count = _p->size();
+	int other_count = p_array._p->size();
+	_p->resize(count + other_count);
+	Variant *data = _p->ptrw();
+	const Variant *other = p_array._p->ptr();
+	for (int i = 0; i < other_count; i++) {
+		data[count + i] = other[i];
+	}
 }
 
 Error Array::resize(int p_new_size) {
-	return _p->array.resize(p_new_size);
+	return _p->resize(p_new_size);
 }
 
 void Array::insert(int p_pos, const Variant &p_value) {
 	ERR_FAIL_COND(!_p->typed.validate(p_value, "insert"));
-	_p->array.insert(p_pos, p_value);
+	_p->insert(p_pos, p_value);
 }
 
 void Array::fill(const Variant &p_value) {
 	ERR_FAIL_COND(!_p->typed.validate(p_value, "fill"));
-	_p->array.fill(p_value);
+	Variant value = p_value;
+	Variant *data = _p->ptrw();
+	for (int i = 0; i < _p->size(); i++) {
+		data[i] = value;
+	}
 }
 
 void Array::erase(const Variant &p_value) {
 	ERR_FAIL_COND(!_p->typed.validate(p_value, "erase"));
-	_p->array.erase(p_value);
+	int idx = _p->find(p_value, 0);
+	if (idx >= 0) {
+		_p->remove(idx);
+	}
 }
 
 Variant Array::front() const {
-	ERR_FAIL_COND_V_MSG(_p->array.size() == 0, Variant(), "Can't take value from empty array.");
+	ERR_FAIL_COND_V_MSG(_p->size() == 0, Variant(), "Can't take value from empty array.");
 	return operator[](0);
 }
 
 Variant Array::back() const {
-	ERR_FAIL_COND_V_MSG(_p->array.size() == 0, Variant(), "Can't take value from empty array.");
-	return operator[](_p->array.size() - 1);
+	ERR_FAIL_COND_V_MSG(_p->size() == 0, Variant(), "Can't take value from empty array.");
+	return operator[](_p->size() - 1);
 }
 
 int Array::find(const Variant &p_value, int p_from) const {
 	ERR_FAIL_COND_V(!_p->typed.validate(p_value, "find"), -1);
-	return _p->array.find(p_value, p_from);
+	return _p->find(p_value, p_from);
 }
 
 int Array::rfind(const Variant &p_value, int p_from) const {
-	if (_p->array.size() == 0) {
+	if (_p->size() == 0) {
 		return -1;
 	}
 	ERR_FAIL_COND_V(!_p->typed.validate(p_value, "rfind"), -1);
 
 	if (p_from < 0) {
 		// Relative offset from the end
-		p_from = _p->array.size() + p_from;
+		p_from = _p->size() + p_from;
 	}
-	if (p_from < 0 || p_from >= _p->array.size()) {
+	if (p_from < 0 || p_from >= _p->size()) {
 		// Limit to array boundaries
-		p_from = _p->array.size() - 1;
+		p_from = _p->size() - 1;
 	}
 
 	for (int i = p_from; i >= 0; i--) {
-		if (_p->array[i] == p_value) {
+		if (_p->get(i) == p_value) {
 			return i;
 		}
 	}
@@ -264,13 +451,13 @@ int Array::find_last(const Variant &p_value) const {
 
 int Array::count(const Variant &p_value) const {
 	ERR_FAIL_COND_V(!_p->typed.validate(p_value, "count"), 0);
-	if (_p->array.size() == 0) {
+	if (_p->size() == 0) {
 		return 0;
 	}
 
 	int amount = 0;
-	for (int i = 0; i < _p->array.size(); i++) {
-		if (_p->array[i] == p_value) {
+	for (int i = 0; i < _p->size(); i++) {
+		if (_p->get(i) == p_value) {
 			amount++;
 		}
 	}
@@ -281,11 +468,11 @@ int Array::count(const Variant &p_value) const {
 bool Array::has(const Variant &p_value) const {
 	ERR_FAIL_COND_V(!_p->typed.validate(p_value, "use 'has'"), false);
 
-	return _p->array.find(p_value, 0) != -1;
+	return _p->find(p_value, 0) != -1;
 }
 
 void Array::remove(int p_pos) {
-	_p->array.remove(p_pos);
+	_p->remove(p_pos);
 }
 
 void Array::set(int p_idx, const Variant &p_value) {
@@ -447,7 +634,8 @@ struct _ArrayVariantSort {
 };
 
 void Array::sort() {
-	_p->array.sort_custom<_ArrayVariantSort>();
+	SortArray<Variant, _ArrayVariantSort> sorter;
+	sorter.sort(_p->ptrw(), _p->size());
 }
 
 struct _ArrayVariantSortCustom {
@@ -467,15 +655,15 @@ struct _ArrayVariantSortCustom {
 void Array::sort_custom(Callable p_callable) {
 	SortArray<Variant, _ArrayVariantSortCustom, true> avs;
 	avs.compare.func = p_callable;
-	avs.sort(_p->array.ptrw(), _p->array.size());
+	avs.sort(_p->ptrw(), _p->size());
 }
 
 void Array::shuffle() {
-	const int n = _p->array.size();
+	const int n = _p->size();
 	if (n < 2) {
 		return;
 	}
-	Variant *data = _p->array.ptrw();
+	Variant *data = _p->ptrw();
 	for (int i = n - 1; i >= 1; i--) {
 		const int j = Math::rand() % (i + 1);
 		const Variant tmp = data[j];
@@ -485,13 +673,13 @@ void Array::shuffle() {
 }
 
 template <typename Less>
-_FORCE_INLINE_ int bisect(const Vector<Variant> &p_array, const Variant &p_value, bool p_before, const Less &p_less) {
+_FORCE_INLINE_ int bisect(const Variant *p_array, int p_size, const Variant &p_value, bool p_before, const Less &p_less) {
 	int lo = 0;
-	int hi = p_array.size();
+	int hi = p_size;
 	if (p_before) {
 		while (lo < hi) {
 			const int mid = (lo + hi) / 2;
-			if (p_less(p_array.get(mid), p_value)) {
+			if (p_less(p_array[mid], p_value)) {
 				lo = mid + 1;
 			} else {
 				hi = mid;
@@ -500,7 +688,7 @@ _FORCE_INLINE_ int bisect(const Vector<Variant> &p_array, const Variant &p_value
 	} else {
 		while (lo < hi) {
 			const int mid = (lo + hi) / 2;
-			if (p_less(p_value, p_array.get(mid))) {
+			if (p_less(p_value, p_array[mid])) {
 				hi = mid;
 			} else {
 				lo = mid + 1;
@@ -512,7 +700,7 @@ _FORCE_INLINE_ int bisect(const Vector<Variant> &p_array, const Variant &p_value
 
 int Array::bsearch(const Variant &p_value, bool p_before) {
 	ERR_FAIL_COND_V(!_p->typed.validate(p_value, "binary search"), -1);
-	return bisect(_p->array, p_value, p_before, _ArrayVariantSort());
+	return bisect(_p->ptr(), _p->size(), p_value, p_before, _ArrayVariantSort());
 }
 
 int Array::bsearch_custom(const Variant &p_value, Callable p_callable, bool p_before) {
@@ -521,32 +709,36 @@ int Array::bsearch_custom(const Variant &p_value, Callable p_callable, bool p_be
 	_ArrayVariantSortCustom less;
 	less.func = p_callable;
 
-	return bisect(_p->array, p_value, p_before, less);
+	return bisect(_p->ptr(), _p->size(), p_value, p_before, less);
 }
 
 void Array::reverse() {
-	_p->array.reverse();
+	Variant *data = _p->ptrw();
+	int n = _p->size();
+	for (int i = 0; i < n / 2; i++) {
+		SWAP(data[i], data[n - i - 1]);
+	}
 }
 
 void Array::push_front(const Variant &p_value) {
 	ERR_FAIL_COND(!_p->typed.validate(p_value, "push_front"));
-	_p->array.insert(0, p_value);
+	_p->insert(0, p_value);
 }
 
 Variant Array::pop_back() {
-	if (!_p->array.is_empty()) {
-		int n = _p->array.size() - 1;
-		Variant ret = _p->array.get(n);
-		_p->array.resize(n);
+	if (!_p->is_empty()) {
+		int n = _p->size() - 1;
+		Variant ret = _p->get(n);
+		_p->resize(n);
 		return ret;
 	}
 	return Variant();
 }
 
 Variant Array::pop_front() {
-	if (!_p->array.is_empty()) {
-		Variant ret = _p->array.get(0);
-		_p->array.remove(0);
+	if (!_p->is_empty()) {
+		Variant ret = _p->get(0);
+		_p->remove(0);
 		return ret;
 	}
 	return Variant();
@@ -597,7 +789,7 @@ Variant Array::max() const {
 }
 
 const void *Array::id() const {
-	return _p->array.ptr();
+	return _p->ptr();
 }
 
 Array::Array(const Array &p_from, uint32_t p_type, const StringName &p_class_name, const Variant &p_script) {
@@ -612,7 +804,7 @@ bool Array::typed_assign(const Array &p_other) {
 }
 
 void Array::set_typed(uint32_t p_type, const StringName &p_class_name, const Variant &p_script) {
-	ERR_FAIL_COND_MSG(_p->array.size() > 0, "Type can only be set when array is empty.");
+	ERR_FAIL_COND_MSG(_p->size() > 0, "Type can only be set when array is empty.");
 	ERR_FAIL_COND_MSG(_p->refcount.get() > 1, "Type can only be set when array has no more than one user.");
 	ERR_FAIL_COND_MSG(_p->typed.type != Variant::NIL, "Type can only be set once.");
 	ERR_FAIL_COND_MSG(p_class_name != StringName() && p_type != Variant::OBJECT, "Class names can only be set for type OBJECT");
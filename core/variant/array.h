@@ -66,6 +66,7 @@ public:
 
 	uint32_t hash() const;
 	void operator=(const Array &p_array);
+	void operator=(Array &&p_array);
 
 	void push_back(const Variant &p_value);
 	_FORCE_INLINE_ void append(const Variant &p_value) { push_back(p_value); } //for python compatibility
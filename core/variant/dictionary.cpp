@@ -30,13 +30,15 @@
 
 #include "dictionary.h"
 
-#include "core/templates/ordered_hash_map.h"
+#include "core/templates/flat_hash_map.h"
 #include "core/templates/safe_refcount.h"
 #include "core/variant/variant.h"
 
+typedef FlatHashMap<Variant, Variant, VariantHasher, VariantComparator> DictionaryMap;
+
 struct DictionaryPrivate {
 	SafeRefCount refcount;
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> variant_map;
+	DictionaryMap variant_map;
 };
 
 void Dictionary::get_key_list(List<Variant> *p_keys) const {
@@ -44,16 +46,16 @@ void Dictionary::get_key_list(List<Variant> *p_keys) const {
 		return;
 	}
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		p_keys->push_back(E.key());
+	for (const DictionaryMap::Element *E = _p->variant_map.front(); E; E = E->next()) {
+		p_keys->push_back(E->key());
 	}
 }
 
 Variant Dictionary::get_key_at_index(int p_index) const {
 	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (const DictionaryMap::Element *E = _p->variant_map.front(); E; E = E->next()) {
 		if (index == p_index) {
-			return E.key();
+			return E->key();
 		}
 		index++;
 	}
@@ -63,9 +65,9 @@ Variant Dictionary::get_key_at_index(int p_index) const {
 
 Variant Dictionary::get_value_at_index(int p_index) const {
 	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (const DictionaryMap::Element *E = _p->variant_map.front(); E; E = E->next()) {
 		if (index == p_index) {
-			return E.value();
+			return E->value();
 		}
 		index++;
 	}
@@ -82,30 +84,20 @@ const Variant &Dictionary::operator[](const Variant &p_key) const {
 }
 
 const Variant *Dictionary::getptr(const Variant &p_key) const {
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
-
-	if (!E) {
-		return nullptr;
-	}
-	return &E.get();
+	return ((const DictionaryMap *)&_p->variant_map)->getptr(p_key);
 }
 
 Variant *Dictionary::getptr(const Variant &p_key) {
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(p_key);
-
-	if (!E) {
-		return nullptr;
-	}
-	return &E.get();
+	return _p->variant_map.getptr(p_key);
 }
 
 Variant Dictionary::get_valid(const Variant &p_key) const {
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
+	const Variant *value = ((const DictionaryMap *)&_p->variant_map)->getptr(p_key);
 
-	if (!E) {
+	if (!value) {
 		return Variant();
 	}
-	return E.get();
+	return *value;
 }
 
 Variant Dictionary::get(const Variant &p_key, const Variant &p_default) const {
@@ -182,9 +174,9 @@ void Dictionary::_unref() const {
 uint32_t Dictionary::hash() const {
 	uint32_t h = hash_djb2_one_32(Variant::DICTIONARY);
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		h = hash_djb2_one_32(E.key().hash(), h);
-		h = hash_djb2_one_32(E.value().hash(), h);
+	for (const DictionaryMap::Element *E = _p->variant_map.front(); E; E = E->next()) {
+		h = hash_djb2_one_32(E->key().hash(), h);
+		h = hash_djb2_one_32(E->value().hash(), h);
 	}
 
 	return h;
@@ -199,8 +191,8 @@ Array Dictionary::keys() const {
 	varr.resize(size());
 
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		varr[i] = E.key();
+	for (const DictionaryMap::Element *E = _p->variant_map.front(); E; E = E->next()) {
+		varr[i] = E->key();
 		i++;
 	}
 
@@ -216,8 +208,8 @@ Array Dictionary::values() const {
 	varr.resize(size());
 
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		varr[i] = E.get();
+	for (const DictionaryMap::Element *E = _p->variant_map.front(); E; E = E->next()) {
+		varr[i] = E->get();
 		i++;
 	}
 
@@ -228,23 +220,24 @@ const Variant *Dictionary::next(const Variant *p_key) const {
 	if (p_key == nullptr) {
 		// caller wants to get the first element
 		if (_p->variant_map.front()) {
-			return &_p->variant_map.front().key();
+			return &_p->variant_map.front()->key();
 		}
 		return nullptr;
 	}
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(*p_key);
+	const DictionaryMap::Element *E = _p->variant_map.find(*p_key);
 
-	if (E && E.next()) {
-		return &E.next().key();
+	if (E && E->next()) {
+		return &E->next()->key();
 	}
 	return nullptr;
 }
 
 Dictionary Dictionary::duplicate(bool p_deep) const {
 	Dictionary n;
+	n._p->variant_map.reserve(_p->variant_map.size());
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		n[E.key()] = p_deep ? E.value().duplicate(true) : E.value();
+	for (const DictionaryMap::Element *E = _p->variant_map.front(); E; E = E->next()) {
+		n[E->key()] = p_deep ? E->value().duplicate(true) : E->value();
 	}
 
 	return n;
@@ -255,7 +248,7 @@ void Dictionary::operator=(const Dictionary &p_dictionary) {
 }
 
 const void *Dictionary::id() const {
-	return _p->variant_map.id();
+	return _p;
 }
 
 Dictionary::Dictionary(const Dictionary &p_from) {
@@ -0,0 +1,351 @@
+/*************************************************************************/
+/*  packed_struct_array.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "packed_struct_array.h"
+
+#include "core/variant/variant_internal.h"
+
+template <class T>
+static _FORCE_INLINE_ Vector<T> *_get_column(Variant &r_column) {
+	return VariantGetInternalPtr<Vector<T>>::get_ptr(&r_column);
+}
+
+template <class T>
+static _FORCE_INLINE_ const Vector<T> *_get_column(const Variant &p_column) {
+	return VariantGetInternalPtr<Vector<T>>::get_ptr(&p_column);
+}
+
+template <class T>
+static _FORCE_INLINE_ T _to_element(const Variant &p_value) {
+	return p_value;
+}
+
+template <>
+_FORCE_INLINE_ uint8_t _to_element<uint8_t>(const Variant &p_value) {
+	return bool(p_value) ? 1 : 0;
+}
+
+template <class T>
+static _FORCE_INLINE_ Variant _from_element(const T &p_element) {
+	return p_element;
+}
+
+template <>
+_FORCE_INLINE_ Variant _from_element<uint8_t>(const uint8_t &p_element) {
+	return p_element != 0;
+}
+
+// Runs the code with T defined as the type of the elements stored for the field type.
+#define DISPATCH_FIELD_TYPE(m_type, ...) \
+	switch (m_type) {                    \
+		case Variant::BOOL: {            \
+			typedef uint8_t T;           \
+			__VA_ARGS__;                 \
+		} break;                         \
+		case Variant::INT: {             \
+			typedef int64_t T;           \
+			__VA_ARGS__;                 \
+		} break;                         \
+		case Variant::FLOAT: {           \
+			typedef float T;             \
+			__VA_ARGS__;                 \
+		} break;                         \
+		case Variant::VECTOR2: {         \
+			typedef Vector2 T;           \
+			__VA_ARGS__;                 \
+		} break;                         \
+		case Variant::VECTOR3: {         \
+			typedef Vector3 T;           \
+			__VA_ARGS__;                 \
+		} break;                         \
+		case Variant::COLOR: {           \
+			typedef Color T;             \
+			__VA_ARGS__;                 \
+		} break;                         \
+		default: {                       \
+		}                                \
+	}
+
+Variant::Type PackedStructArray::_get_column_type(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::BOOL:
+			return Variant::PACKED_BYTE_ARRAY;
+		case Variant::INT:
+			return Variant::PACKED_INT64_ARRAY;
+		case Variant::FLOAT:
+			return Variant::PACKED_FLOAT32_ARRAY;
+		case Variant::VECTOR2:
+			return Variant::PACKED_VECTOR2_ARRAY;
+		case Variant::VECTOR3:
+			return Variant::PACKED_VECTOR3_ARRAY;
+		case Variant::COLOR:
+			return Variant::PACKED_COLOR_ARRAY;
+		default:
+			return Variant::NIL;
+	}
+}
+
+int PackedStructArray::add_field(const StringName &p_name, Variant::Type p_type) {
+	ERR_FAIL_COND_V_MSG(p_name == StringName(), -1, "Fields must have a name.");
+	ERR_FAIL_COND_V_MSG(find_field(p_name) != -1, -1, "Field '" + String(p_name) + "' already exists.");
+	Variant::Type column_type = _get_column_type(p_type);
+	ERR_FAIL_COND_V_MSG(column_type == Variant::NIL, -1, "Fields of type " + Variant::get_type_name(p_type) + " are not supported.");
+
+	Field field;
+	field.name = p_name;
+	field.type = p_type;
+	VariantInternal::initialize(&field.column, column_type);
+	DISPATCH_FIELD_TYPE(p_type, _get_column<T>(field.column)->resize(count); _get_column<T>(field.column)->fill(T()));
+	fields.push_back(field);
+	return fields.size() - 1;
+}
+
+StringName PackedStructArray::get_field_name(int p_field) const {
+	ERR_FAIL_INDEX_V(p_field, (int)fields.size(), StringName());
+	return fields[p_field].name;
+}
+
+Variant::Type PackedStructArray::get_field_type(int p_field) const {
+	ERR_FAIL_INDEX_V(p_field, (int)fields.size(), Variant::NIL);
+	return fields[p_field].type;
+}
+
+int PackedStructArray::find_field(const StringName &p_name) const {
+	for (uint32_t i = 0; i < fields.size(); i++) {
+		if (fields[i].name == p_name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void PackedStructArray::resize(int p_size) {
+	ERR_FAIL_COND(p_size < 0);
+	for (uint32_t i = 0; i < fields.size(); i++) {
+		Field &field = fields[i];
+		DISPATCH_FIELD_TYPE(field.type, {
+			Vector<T> *column = _get_column<T>(field.column);
+			column->resize(p_size);
+			T *w = column->ptrw();
+			for (int j = count; j < p_size; j++) {
+				w[j] = T();
+			}
+		});
+	}
+	count = p_size;
+}
+
+void PackedStructArray::clear() {
+	resize(0);
+}
+
+void PackedStructArray::_set_value(Field &r_field, int p_index, const Variant &p_value) {
+	ERR_FAIL_COND_MSG(!Variant::can_convert(p_value.get_type(), r_field.type), "Can't assign a value of type " + Variant::get_type_name(p_value.get_type()) + " to field '" + String(r_field.name) + "' of type " + Variant::get_type_name(r_field.type) + ".");
+	DISPATCH_FIELD_TYPE(r_field.type, _get_column<T>(r_field.column)->ptrw()[p_index] = _to_element<T>(p_value));
+}
+
+int PackedStructArray::append(const Dictionary &p_values) {
+	int index = count;
+	resize(count + 1);
+	set_struct(index, p_values);
+	return index;
+}
+
+void PackedStructArray::remove(int p_index) {
+	ERR_FAIL_INDEX(p_index, count);
+	for (uint32_t i = 0; i < fields.size(); i++) {
+		Field &field = fields[i];
+		DISPATCH_FIELD_TYPE(field.type, _get_column<T>(field.column)->remove(p_index));
+	}
+	count--;
+}
+
+void PackedStructArray::set_struct(int p_index, const Dictionary &p_values) {
+	ERR_FAIL_INDEX(p_index, count);
+	for (const Variant *key = p_values.next(); key; key = p_values.next(key)) {
+		int field = find_field(*key);
+		ERR_CONTINUE_MSG(field == -1, "There is no field named '" + String(*key) + "'.");
+		_set_value(fields[field], p_index, *p_values.getptr(*key));
+	}
+}
+
+Dictionary PackedStructArray::get_struct(int p_index) const {
+	Dictionary ret;
+	ERR_FAIL_INDEX_V(p_index, count, ret);
+	for (uint32_t i = 0; i < fields.size(); i++) {
+		const Field &field = fields[i];
+		DISPATCH_FIELD_TYPE(field.type, ret[field.name] = _from_element<T>(_get_column<T>(field.column)->get(p_index)));
+	}
+	return ret;
+}
+
+void PackedStructArray::set_value(int p_index, int p_field, const Variant &p_value) {
+	ERR_FAIL_INDEX(p_index, count);
+	ERR_FAIL_INDEX(p_field, (int)fields.size());
+	_set_value(fields[p_field], p_index, p_value);
+}
+
+Variant PackedStructArray::get_value(int p_index, int p_field) const {
+	ERR_FAIL_INDEX_V(p_index, count, Variant());
+	ERR_FAIL_INDEX_V(p_field, (int)fields.size(), Variant());
+	const Field &field = fields[p_field];
+	DISPATCH_FIELD_TYPE(field.type, return _from_element<T>(_get_column<T>(field.column)->get(p_index)));
+	return Variant();
+}
+
+Variant PackedStructArray::get_column(int p_field) const {
+	ERR_FAIL_INDEX_V(p_field, (int)fields.size(), Variant());
+	return fields[p_field].column;
+}
+
+void PackedStructArray::set_column(int p_field, const Variant &p_column) {
+	ERR_FAIL_INDEX(p_field, (int)fields.size());
+	Field &field = fields[p_field];
+	ERR_FAIL_COND_MSG(p_column.get_type() != field.column.get_type(), "Field '" + String(field.name) + "' is stored in a " + Variant::get_type_name(field.column.get_type()) + ".");
+	DISPATCH_FIELD_TYPE(field.type, ERR_FAIL_COND_MSG(_get_column<T>(p_column)->size() != count, "The column must have one value per struct."));
+	field.column = p_column;
+}
+
+void PackedStructArray::fill(int p_field, const Variant &p_value) {
+	ERR_FAIL_INDEX(p_field, (int)fields.size());
+	Field &field = fields[p_field];
+	ERR_FAIL_COND(!Variant::can_convert(p_value.get_type(), field.type));
+	DISPATCH_FIELD_TYPE(field.type, _get_column<T>(field.column)->fill(_to_element<T>(p_value)));
+}
+
+// The loops below run over contiguous plain values, the compiler vectorizes them.
+
+template <class T>
+static void _add_to_column(Vector<T> *r_column, const T &p_value) {
+	T *w = r_column->ptrw();
+	const int size = r_column->size();
+	for (int i = 0; i < size; i++) {
+		w[i] += p_value;
+	}
+}
+
+template <class T>
+static void _scale_column(Vector<T> *r_column, real_t p_scale) {
+	T *w = r_column->ptrw();
+	const int size = r_column->size();
+	for (int i = 0; i < size; i++) {
+		w[i] *= p_scale;
+	}
+}
+
+template <class T>
+static void _add_scaled_column(Vector<T> *r_column, const Vector<T> *p_from, real_t p_scale) {
+	T *w = r_column->ptrw();
+	const T *r = p_from->ptr();
+	const int size = r_column->size();
+	for (int i = 0; i < size; i++) {
+		w[i] += r[i] * p_scale;
+	}
+}
+
+void PackedStructArray::add_to_column(int p_field, const Variant &p_value) {
+	ERR_FAIL_INDEX(p_field, (int)fields.size());
+	Field &field = fields[p_field];
+	ERR_FAIL_COND_MSG(field.type == Variant::BOOL, "Can't add to a field of type bool.");
+	ERR_FAIL_COND(!Variant::can_convert(p_value.get_type(), field.type));
+	DISPATCH_FIELD_TYPE(field.type, _add_to_column(_get_column<T>(field.column), _to_element<T>(p_value)));
+}
+
+void PackedStructArray::scale_column(int p_field, real_t p_scale) {
+	ERR_FAIL_INDEX(p_field, (int)fields.size());
+	Field &field = fields[p_field];
+	switch (field.type) {
+		case Variant::FLOAT:
+			_scale_column(_get_column<float>(field.column), p_scale);
+			break;
+		case Variant::VECTOR2:
+			_scale_column(_get_column<Vector2>(field.column), p_scale);
+			break;
+		case Variant::VECTOR3:
+			_scale_column(_get_column<Vector3>(field.column), p_scale);
+			break;
+		case Variant::COLOR:
+			_scale_column(_get_column<Color>(field.column), p_scale);
+			break;
+		default:
+			ERR_FAIL_MSG("Only fields of type float, Vector2, Vector3 and Color can be scaled.");
+	}
+}
+
+void PackedStructArray::add_scaled_column(int p_field, int p_from_field, real_t p_scale) {
+	ERR_FAIL_INDEX(p_field, (int)fields.size());
+	ERR_FAIL_INDEX(p_from_field, (int)fields.size());
+	Field &field = fields[p_field];
+	const Field &from = fields[p_from_field];
+	ERR_FAIL_COND_MSG(field.type != from.type, "Both fields must have the same type.");
+	switch (field.type) {
+		case Variant::FLOAT:
+			_add_scaled_column(_get_column<float>(field.column), _get_column<float>(from.column), p_scale);
+			break;
+		case Variant::VECTOR2:
+			_add_scaled_column(_get_column<Vector2>(field.column), _get_column<Vector2>(from.column), p_scale);
+			break;
+		case Variant::VECTOR3:
+			_add_scaled_column(_get_column<Vector3>(field.column), _get_column<Vector3>(from.column), p_scale);
+			break;
+		case Variant::COLOR:
+			_add_scaled_column(_get_column<Color>(field.column), _get_column<Color>(from.column), p_scale);
+			break;
+		default:
+			ERR_FAIL_MSG("Only fields of type float, Vector2, Vector3 and Color can be added scaled.");
+	}
+}
+
+void PackedStructArray::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("add_field", "name", "type"), &PackedStructArray::add_field);
+	ClassDB::bind_method(D_METHOD("get_field_count"), &PackedStructArray::get_field_count);
+	ClassDB::bind_method(D_METHOD("get_field_name", "field"), &PackedStructArray::get_field_name);
+	ClassDB::bind_method(D_METHOD("get_field_type", "field"), &PackedStructArray::get_field_type);
+	ClassDB::bind_method(D_METHOD("find_field", "name"), &PackedStructArray::find_field);
+
+	ClassDB::bind_method(D_METHOD("resize", "size"), &PackedStructArray::resize);
+	ClassDB::bind_method(D_METHOD("size"), &PackedStructArray::size);
+	ClassDB::bind_method(D_METHOD("is_empty"), &PackedStructArray::is_empty);
+	ClassDB::bind_method(D_METHOD("clear"), &PackedStructArray::clear);
+
+	ClassDB::bind_method(D_METHOD("append", "values"), &PackedStructArray::append);
+	ClassDB::bind_method(D_METHOD("remove", "index"), &PackedStructArray::remove);
+	ClassDB::bind_method(D_METHOD("set_struct", "index", "values"), &PackedStructArray::set_struct);
+	ClassDB::bind_method(D_METHOD("get_struct", "index"), &PackedStructArray::get_struct);
+	ClassDB::bind_method(D_METHOD("set_value", "index", "field", "value"), &PackedStructArray::set_value);
+	ClassDB::bind_method(D_METHOD("get_value", "index", "field"), &PackedStructArray::get_value);
+
+	ClassDB::bind_method(D_METHOD("get_column", "field"), &PackedStructArray::get_column);
+	ClassDB::bind_method(D_METHOD("set_column", "field", "column"), &PackedStructArray::set_column);
+
+	ClassDB::bind_method(D_METHOD("fill", "field", "value"), &PackedStructArray::fill);
+	ClassDB::bind_method(D_METHOD("add_to_column", "field", "value"), &PackedStructArray::add_to_column);
+	ClassDB::bind_method(D_METHOD("scale_column", "field", "scale"), &PackedStructArray::scale_column);
+	ClassDB::bind_method(D_METHOD("add_scaled_column", "field", "from_field", "scale"), &PackedStructArray::add_scaled_column);
+}
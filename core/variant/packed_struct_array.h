@@ -0,0 +1,86 @@
+/*************************************************************************/
+/*  packed_struct_array.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef PACKED_STRUCT_ARRAY_H
+#define PACKED_STRUCT_ARRAY_H
+
+#include "core/object/reference.h"
+#include "core/templates/local_vector.h"
+
+// Array of structs described by a schema of named, typed fields. Every field is stored in its own
+// packed array, so a whole field can be processed, or handed to servers, without boxing each value.
+class PackedStructArray : public Reference {
+	GDCLASS(PackedStructArray, Reference);
+
+	struct Field {
+		StringName name;
+		Variant::Type type = Variant::NIL;
+		Variant column; // The packed array storing the values, it has one element per struct.
+	};
+
+	LocalVector<Field> fields;
+	int count = 0;
+
+	static Variant::Type _get_column_type(Variant::Type p_type);
+	void _set_value(Field &r_field, int p_index, const Variant &p_value);
+
+protected:
+	static void _bind_methods();
+
+public:
+	int add_field(const StringName &p_name, Variant::Type p_type);
+	int get_field_count() const { return fields.size(); }
+	StringName get_field_name(int p_field) const;
+	Variant::Type get_field_type(int p_field) const;
+	int find_field(const StringName &p_name) const;
+
+	void resize(int p_size);
+	int size() const { return count; }
+	bool is_empty() const { return count == 0; }
+	void clear();
+
+	int append(const Dictionary &p_values);
+	void remove(int p_index);
+	void set_struct(int p_index, const Dictionary &p_values);
+	Dictionary get_struct(int p_index) const;
+	void set_value(int p_index, int p_field, const Variant &p_value);
+	Variant get_value(int p_index, int p_field) const;
+
+	// Columns share their buffer with the returned packed array until either is modified.
+	Variant get_column(int p_field) const;
+	void set_column(int p_field, const Variant &p_column);
+
+	void fill(int p_field, const Variant &p_value);
+	void add_to_column(int p_field, const Variant &p_value);
+	void scale_column(int p_field, real_t p_scale);
+	// column[i] += from_column[i] * scale, e.g. to integrate positions from velocities.
+	void add_scaled_column(int p_field, int p_from_field, real_t p_scale);
+};
+
+#endif // PACKED_STRUCT_ARRAY_H
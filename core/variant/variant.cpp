@@ -36,6 +36,7 @@
 #include "core/io/resource.h"
 #include "core/math/math_funcs.h"
 #include "core/string/print_string.h"
+#include "core/string/string_stream.h"
 #include "core/variant/variant_parser.h"
 #include "scene/gui/control.h"
 #include "scene/main/node.h"
@@ -1699,7 +1700,8 @@ String Variant::stringify(List<const void *> &stack) const {
 			stack.push_back(d.id());
 
 			//const String *K=nullptr;
-			String str("{");
+			StringStream str;
+			str += "{";
 			List<Variant> keys;
 			d.get_key_list(&keys);
 
@@ -1719,95 +1721,104 @@ String Variant::stringify(List<const void *> &stack) const {
 				if (i > 0) {
 					str += ", ";
 				}
-				str += pairs[i].key + ":" + pairs[i].value;
+				str += pairs[i].key;
+				str += ":";
+				str += pairs[i].value;
 			}
 			str += "}";
 
-			return str;
+			return str.as_string();
 		} break;
 		case PACKED_VECTOR2_ARRAY: {
 			Vector<Vector2> vec = operator Vector<Vector2>();
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < vec.size(); i++) {
 				if (i > 0) {
 					str += ", ";
 				}
-				str = str + Variant(vec[i]);
+				str += String(Variant(vec[i]));
 			}
 			str += "]";
-			return str;
+			return str.as_string();
 		} break;
 		case PACKED_VECTOR3_ARRAY: {
 			Vector<Vector3> vec = operator Vector<Vector3>();
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < vec.size(); i++) {
 				if (i > 0) {
 					str += ", ";
 				}
-				str = str + Variant(vec[i]);
+				str += String(Variant(vec[i]));
 			}
 			str += "]";
-			return str;
+			return str.as_string();
 		} break;
 		case PACKED_STRING_ARRAY: {
 			Vector<String> vec = operator Vector<String>();
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < vec.size(); i++) {
 				if (i > 0) {
 					str += ", ";
 				}
-				str = str + vec[i];
+				str += vec[i];
 			}
 			str += "]";
-			return str;
+			return str.as_string();
 		} break;
 		case PACKED_INT32_ARRAY: {
 			Vector<int32_t> vec = operator Vector<int32_t>();
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < vec.size(); i++) {
 				if (i > 0) {
 					str += ", ";
 				}
-				str = str + itos(vec[i]);
+				str += itos(vec[i]);
 			}
 			str += "]";
-			return str;
+			return str.as_string();
 		} break;
 		case PACKED_INT64_ARRAY: {
 			Vector<int64_t> vec = operator Vector<int64_t>();
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < vec.size(); i++) {
 				if (i > 0) {
 					str += ", ";
 				}
-				str = str + itos(vec[i]);
+				str += itos(vec[i]);
 			}
 			str += "]";
-			return str;
+			return str.as_string();
 		} break;
 		case PACKED_FLOAT32_ARRAY: {
 			Vector<float> vec = operator Vector<float>();
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < vec.size(); i++) {
 				if (i > 0) {
 					str += ", ";
 				}
-				str = str + rtos(vec[i]);
+				str += rtos(vec[i]);
 			}
 			str += "]";
-			return str;
+			return str.as_string();
 		} break;
 		case PACKED_FLOAT64_ARRAY: {
 			Vector<double> vec = operator Vector<double>();
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < vec.size(); i++) {
 				if (i > 0) {
 					str += ", ";
 				}
-				str = str + rtos(vec[i]);
+				str += rtos(vec[i]);
 			}
 			str += "]";
-			return str;
+			return str.as_string();
 		} break;
 		case ARRAY: {
 			Array arr = operator Array();
@@ -1816,7 +1827,8 @@ String Variant::stringify(List<const void *> &stack) const {
 			}
 			stack.push_back(arr.id());
 
-			String str("[");
+			StringStream str;
+			str += "[";
 			for (int i = 0; i < arr.size(); i++) {
 				if (i) {
 					str += ", ";
@@ -1826,7 +1838,7 @@ String Variant::stringify(List<const void *> &stack) const {
 			}
 
 			str += "]";
-			return str;
+			return str.as_string();
 
 		} break;
 		case OBJECT: {
@@ -2638,6 +2650,51 @@ Variant::Variant(const Vector<Color> &p_color_array) {
 	_data.packed_array = PackedArrayRef<Color>::create(p_color_array);
 }
 
+Variant::Variant(Vector<uint8_t> &&p_byte_array) {
+	type = PACKED_BYTE_ARRAY;
+	_data.packed_array = PackedArrayRef<uint8_t>::create(std::move(p_byte_array));
+}
+
+Variant::Variant(Vector<int32_t> &&p_int32_array) {
+	type = PACKED_INT32_ARRAY;
+	_data.packed_array = PackedArrayRef<int32_t>::create(std::move(p_int32_array));
+}
+
+Variant::Variant(Vector<int64_t> &&p_int64_array) {
+	type = PACKED_INT64_ARRAY;
+	_data.packed_array = PackedArrayRef<int64_t>::create(std::move(p_int64_array));
+}
+
+Variant::Variant(Vector<float> &&p_float32_array) {
+	type = PACKED_FLOAT32_ARRAY;
+	_data.packed_array = PackedArrayRef<float>::create(std::move(p_float32_array));
+}
+
+Variant::Variant(Vector<double> &&p_float64_array) {
+	type = PACKED_FLOAT64_ARRAY;
+	_data.packed_array = PackedArrayRef<double>::create(std::move(p_float64_array));
+}
+
+Variant::Variant(Vector<String> &&p_string_array) {
+	type = PACKED_STRING_ARRAY;
+	_data.packed_array = PackedArrayRef<String>::create(std::move(p_string_array));
+}
+
+Variant::Variant(Vector<Vector2> &&p_vector2_array) {
+	type = PACKED_VECTOR2_ARRAY;
+	_data.packed_array = PackedArrayRef<Vector2>::create(std::move(p_vector2_array));
+}
+
+Variant::Variant(Vector<Vector3> &&p_vector3_array) {
+	type = PACKED_VECTOR3_ARRAY;
+	_data.packed_array = PackedArrayRef<Vector3>::create(std::move(p_vector3_array));
+}
+
+Variant::Variant(Vector<Color> &&p_color_array) {
+	type = PACKED_COLOR_ARRAY;
+	_data.packed_array = PackedArrayRef<Color>::create(std::move(p_color_array));
+}
+
 Variant::Variant(const Vector<Face3> &p_face_array) {
 	Vector<Vector3> vertices;
 	int face_count = p_face_array.size();
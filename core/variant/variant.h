@@ -172,6 +172,9 @@ private:
 		static _FORCE_INLINE_ PackedArrayRef<T> *create(const Vector<T> &p_from) {
 			return memnew(PackedArrayRef<T>(p_from));
 		}
+		static _FORCE_INLINE_ PackedArrayRef<T> *create(Vector<T> &&p_from) {
+			return memnew(PackedArrayRef<T>(std::move(p_from)));
+		}
 
 		static _FORCE_INLINE_ const Vector<T> &get_array(PackedArrayRefBase *p_base) {
 			return static_cast<PackedArrayRef<T> *>(p_base)->array;
@@ -184,6 +187,10 @@ private:
 			array = p_from;
 			refcount.init();
 		}
+		_FORCE_INLINE_ PackedArrayRef(Vector<T> &&p_from) :
+				array(std::move(p_from)) {
+			refcount.init();
+		}
 		_FORCE_INLINE_ PackedArrayRef() {
 			refcount.init();
 		}
@@ -421,6 +428,17 @@ public:
 	Variant(const Vector<::RID> &p_array); // helper
 	Variant(const Vector<Vector2> &p_array); // helper
 
+	// Take over the array instead of adding a reference to it.
+	Variant(Vector<uint8_t> &&p_byte_array);
+	Variant(Vector<int32_t> &&p_int32_array);
+	Variant(Vector<int64_t> &&p_int64_array);
+	Variant(Vector<float> &&p_float32_array);
+	Variant(Vector<double> &&p_float64_array);
+	Variant(Vector<String> &&p_string_array);
+	Variant(Vector<Vector2> &&p_vector2_array);
+	Variant(Vector<Vector3> &&p_vector3_array);
+	Variant(Vector<Color> &&p_color_array);
+
 	Variant(const IPAddress &p_address);
 
 	// If this changes the table in variant_op must be updated
@@ -659,11 +677,28 @@ public:
 	static void construct_from_string(const String &p_string, Variant &r_value, ObjectConstruct p_obj_construct = nullptr, void *p_construct_ud = nullptr);
 
 	void operator=(const Variant &p_variant); // only this is enough for all the other types
+	_FORCE_INLINE_ void operator=(Variant &&p_variant) {
+		if (unlikely(this == &p_variant)) {
+			return;
+		}
+		// Take the data before clearing, p_variant may be owned by what this holds.
+		Type new_type = p_variant.type;
+		decltype(_data) new_data = p_variant._data;
+		p_variant.type = NIL;
+		clear();
+		type = new_type;
+		_data = new_data;
+	}
 
 	static void register_types();
 	static void unregister_types();
 
 	Variant(const Variant &p_variant);
+	_FORCE_INLINE_ Variant(Variant &&p_variant) {
+		type = p_variant.type;
+		_data = p_variant._data;
+		p_variant.type = NIL;
+	}
 	_FORCE_INLINE_ Variant() {}
 	_FORCE_INLINE_ ~Variant() {
 		clear();
@@ -39,6 +39,8 @@
 #include "core/os/os.h"
 #include "core/templates/local_vector.h"
 #include "core/templates/oa_hash_map.h"
+#include "core/variant/variant_call_site.h"
+#include "core/variant/variant_internal.h"
 
 typedef void (*VariantFunc)(Variant &r_ret, Variant &p_self, const Variant **p_args);
 typedef void (*VariantConstructFunc)(Variant &r_ret, const Variant **p_args);
@@ -1010,6 +1012,162 @@ void Variant::call_static(Variant::Type p_type, const StringName &p_method, cons
 	imf->call(nullptr, p_args, p_argcount, r_ret, imf->default_arguments, r_error);
 }
 
+void VariantCallSite::set_method(const StringName &p_method) {
+	method = p_method;
+	reset();
+}
+
+void VariantCallSite::reset() {
+	for (uint32_t i = 0; i < entry_count; i++) {
+		entries[i] = Entry();
+	}
+	entry_count = 0;
+	megamorphic = false;
+}
+
+VariantCallSite::Entry *VariantCallSite::_add_entry() {
+	if (entry_count == MAX_ENTRIES) {
+		megamorphic = true;
+		return nullptr;
+	}
+	return &entries[entry_count++];
+}
+
+void VariantCallSite::_call_builtin(const Entry *p_entry, Variant &p_base, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) {
+	const VariantBuiltInMethodInfo *imf = p_entry->builtin;
+
+	if (p_argcount == p_entry->validated_argcount) {
+		bool types_match = true;
+		for (int i = 0; i < p_argcount; i++) {
+			Variant::Type argtype = p_entry->validated_types[i];
+			if (argtype != Variant::NIL && p_args[i]->get_type() != argtype) {
+				types_match = false;
+				break;
+			}
+		}
+
+		if (types_match) {
+			// Written to a temporary, the return value may be the base or one of the arguments.
+			Variant ret;
+			if (imf->has_return_type && imf->return_type != Variant::NIL) {
+				VariantInternal::initialize(&ret, imf->return_type);
+			}
+			imf->validated_call(&p_base, p_args, p_argcount, &ret);
+			if (imf->has_return_type) {
+				r_ret = std::move(ret);
+			}
+			return;
+		}
+	}
+
+	imf->call(&p_base, p_args, p_argcount, r_ret, imf->default_arguments, r_error);
+}
+
+void VariantCallSite::call(Variant &p_base, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) {
+	Variant::Type type = p_base.get_type();
+
+	if (type == Variant::OBJECT) {
+		Object *obj = *VariantInternal::get_object(&p_base);
+		if (!obj) {
+			r_error.error = Callable::CallError::CALL_ERROR_INSTANCE_IS_NULL;
+			return;
+		}
+#ifdef DEBUG_ENABLED
+		if (EngineDebugger::is_active() && !VariantInternal::get_object_id(&p_base).is_reference() && ObjectDB::get_instance(VariantInternal::get_object_id(&p_base)) == nullptr) {
+			r_error.error = Callable::CallError::CALL_ERROR_INSTANCE_IS_NULL;
+			return;
+		}
+#endif
+		r_ret = call_object(obj, p_args, p_argcount, r_error);
+		return;
+	}
+
+	r_error.error = Callable::CallError::CALL_OK;
+
+	for (uint32_t i = 0; i < entry_count; i++) {
+		if (entries[i].type == type) {
+			_call_builtin(&entries[i], p_base, p_args, p_argcount, r_ret, r_error);
+			return;
+		}
+	}
+
+	const VariantBuiltInMethodInfo *imf = builtin_method_info[type].lookup_ptr(method);
+	if (!imf) {
+		r_error.error = Callable::CallError::CALL_ERROR_INVALID_METHOD;
+		return;
+	}
+
+	Entry *entry = _add_entry();
+	if (!entry) {
+		imf->call(&p_base, p_args, p_argcount, r_ret, imf->default_arguments, r_error);
+		return;
+	}
+
+	entry->type = type;
+	entry->builtin = imf;
+
+	// Validated calls skip the argument conversions, they are only used when the types match exactly.
+	// Objects are left out, validated calls don't check whether they were freed.
+	if (!imf->is_vararg && imf->argument_count <= MAX_VALIDATED_ARGS && !(imf->has_return_type && imf->return_type == Variant::OBJECT)) {
+		bool can_validate = true;
+		for (int i = 0; i < imf->argument_count; i++) {
+			entry->validated_types[i] = imf->get_argument_type(i);
+			if (entry->validated_types[i] == Variant::OBJECT) {
+				can_validate = false;
+				break;
+			}
+		}
+		if (can_validate) {
+			entry->validated_argcount = imf->argument_count;
+		}
+	}
+
+	_call_builtin(entry, p_base, p_args, p_argcount, r_ret, r_error);
+}
+
+Variant VariantCallSite::call_object(Object *p_object, const Variant **p_args, int p_argcount, Callable::CallError &r_error) {
+	r_error.error = Callable::CallError::CALL_OK;
+
+	if (p_object->get_script_instance()) {
+		// Scripts can override any method.
+		return p_object->call(method, p_args, p_argcount, r_error);
+	}
+
+	const StringName &class_name = p_object->get_class_name();
+	for (uint32_t i = 0; i < entry_count; i++) {
+		const Entry &entry = entries[i];
+		if (entry.type == Variant::OBJECT && entry.class_name == class_name) {
+			if (entry.method) {
+				return p_object->call_method_bind(entry.method, p_args, p_argcount, r_error);
+			}
+			return p_object->call(method, p_args, p_argcount, r_error);
+		}
+	}
+
+	if (!megamorphic && method != CoreStringNames::get_singleton()->_free) {
+		MethodBind *bind = nullptr;
+		if (!p_object->is_call_overridden()) {
+			bind = ClassDB::get_method(class_name, method);
+			if (!bind) {
+				// Not cached, it may still be bound later.
+				return p_object->call(method, p_args, p_argcount, r_error);
+			}
+		}
+
+		Entry *entry = _add_entry();
+		if (entry) {
+			entry->type = Variant::OBJECT;
+			entry->class_name = class_name;
+			entry->method = bind;
+		}
+		if (bind) {
+			return p_object->call_method_bind(bind, p_args, p_argcount, r_error);
+		}
+	}
+
+	return p_object->call(method, p_args, p_argcount, r_error);
+}
+
 bool Variant::has_method(const StringName &p_method) const {
 	if (type == OBJECT) {
 		Object *obj = get_validated_object();
@@ -0,0 +1,87 @@
+/*************************************************************************/
+/*  variant_call_site.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef VARIANT_CALL_SITE_H
+#define VARIANT_CALL_SITE_H
+
+#include "core/string/string_name.h"
+#include "core/variant/variant.h"
+
+class MethodBind;
+class Object;
+struct VariantBuiltInMethodInfo;
+
+// Calls a method by name, like Variant::call, but remembers what the name resolved to for the
+// last few receiver types so repeated calls from the same place skip the method lookup.
+// Builtin types are keyed by Variant::Type and objects by class name. Receivers which come after
+// the first MAX_ENTRIES are looked up on every call, like Variant::call does.
+// A call site is not thread safe, use one per caller and thread.
+class VariantCallSite {
+public:
+	enum {
+		MAX_ENTRIES = 4,
+		MAX_VALIDATED_ARGS = 8,
+	};
+
+private:
+	struct Entry {
+		Variant::Type type = Variant::NIL;
+		StringName class_name;
+		MethodBind *method = nullptr;
+		const VariantBuiltInMethodInfo *builtin = nullptr;
+		// Argument types for the validated builtin call, only set when it can be used.
+		int validated_argcount = -1;
+		Variant::Type validated_types[MAX_VALIDATED_ARGS];
+	};
+
+	StringName method;
+	Entry entries[MAX_ENTRIES];
+	uint32_t entry_count = 0;
+	bool megamorphic = false;
+
+	void _call_builtin(const Entry *p_entry, Variant &p_base, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error);
+	Entry *_add_entry();
+
+public:
+	void call(Variant &p_base, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error);
+	Variant call_object(Object *p_object, const Variant **p_args, int p_argcount, Callable::CallError &r_error);
+
+	const StringName &get_method() const { return method; }
+	void set_method(const StringName &p_method);
+	uint32_t get_cached_count() const { return entry_count; }
+	bool is_megamorphic() const { return megamorphic; }
+	void reset();
+
+	VariantCallSite() {}
+	VariantCallSite(const StringName &p_method) :
+			method(p_method) {}
+};
+
+#endif // VARIANT_CALL_SITE_H
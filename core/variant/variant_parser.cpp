@@ -1786,14 +1786,19 @@ Error VariantWriter::write(const Variant &p_variant, StoreStringFunc p_store_str
 	return OK;
 }
 
-static Error _write_to_str(void *ud, const String &p_string) {
-	String *str = (String *)ud;
-	(*str) += p_string;
+static Error _write_to_stream(void *ud, const String &p_string) {
+	StringStream *stream = (StringStream *)ud;
+	stream->append(p_string);
 	return OK;
 }
 
 Error VariantWriter::write_to_string(const Variant &p_variant, String &r_string, EncodeResourceFunc p_encode_res_func, void *p_encode_res_ud) {
-	r_string = String();
+	StringStream stream;
+	Error err = write(p_variant, _write_to_stream, &stream, p_encode_res_func, p_encode_res_ud);
+	r_string = stream.as_string();
+	return err;
+}
 
-	return write(p_variant, _write_to_str, &r_string, p_encode_res_func, p_encode_res_ud);
+Error VariantWriter::write_to_stream(const Variant &p_variant, StringStream &r_stream, EncodeResourceFunc p_encode_res_func, void *p_encode_res_ud) {
+	return write(p_variant, _write_to_stream, &r_stream, p_encode_res_func, p_encode_res_ud);
 }
@@ -33,6 +33,7 @@
 
 #include "core/io/resource.h"
 #include "core/os/file_access.h"
+#include "core/string/string_stream.h"
 #include "core/variant/variant.h"
 
 class VariantParser {
@@ -142,6 +143,7 @@ public:
 
 	static Error write(const Variant &p_variant, StoreStringFunc p_store_string_func, void *p_store_string_ud, EncodeResourceFunc p_encode_res_func, void *p_encode_res_ud);
 	static Error write_to_string(const Variant &p_variant, String &r_string, EncodeResourceFunc p_encode_res_func = nullptr, void *p_encode_res_ud = nullptr);
+	static Error write_to_stream(const Variant &p_variant, StringStream &r_stream, EncodeResourceFunc p_encode_res_func = nullptr, void *p_encode_res_ud = nullptr);
 };
 
 #endif // VARIANT_PARSER_H
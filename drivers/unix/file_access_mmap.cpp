@@ -0,0 +1,183 @@
+/*************************************************************************/
+/*  file_access_mmap.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "file_access_mmap.h"
+
+#if defined(UNIX_ENABLED)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <errno.h>
+
+Error FileAccessMMap::_open(const String &p_path, int p_mode_flags) {
+	close();
+
+	ERR_FAIL_COND_V_MSG(p_mode_flags != READ, ERR_UNAVAILABLE, "Memory mapped files can only be opened for reading.");
+
+	path_src = p_path;
+	path = fix_path(p_path);
+
+	int fd = ::open(path.utf8().get_data(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		return errno == ENOENT ? ERR_FILE_NOT_FOUND : ERR_FILE_CANT_OPEN;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		::close(fd);
+		return ERR_FILE_CANT_OPEN;
+	}
+
+	length = st.st_size;
+	if (length > 0) {
+		void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			::close(fd);
+			return ERR_FILE_CANT_OPEN;
+		}
+		data = (const uint8_t *)mapping;
+	}
+	// The mapping keeps the file alive on its own.
+	::close(fd);
+
+	pos = 0;
+	eof = false;
+	opened = true;
+	return OK;
+}
+
+void FileAccessMMap::close() {
+	if (data) {
+		munmap((void *)data, length);
+		data = nullptr;
+	}
+	length = 0;
+	opened = false;
+}
+
+bool FileAccessMMap::is_open() const {
+	return opened;
+}
+
+String FileAccessMMap::get_path() const {
+	return path_src;
+}
+
+String FileAccessMMap::get_path_absolute() const {
+	return path;
+}
+
+void FileAccessMMap::seek(uint64_t p_position) {
+	ERR_FAIL_COND_MSG(!opened, "File must be opened before use.");
+
+	pos = p_position;
+	eof = false;
+}
+
+void FileAccessMMap::seek_end(int64_t p_position) {
+	ERR_FAIL_COND_MSG(!opened, "File must be opened before use.");
+
+	pos = length + p_position;
+	eof = false;
+}
+
+uint64_t FileAccessMMap::get_position() const {
+	return pos;
+}
+
+uint64_t FileAccessMMap::get_len() const {
+	return length;
+}
+
+bool FileAccessMMap::eof_reached() const {
+	return eof;
+}
+
+uint8_t FileAccessMMap::get_8() const {
+	if (pos >= length) {
+		eof = true;
+		return 0;
+	}
+	return data[pos++];
+}
+
+uint64_t FileAccessMMap::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
+	ERR_FAIL_COND_V(!p_dst && p_length > 0, -1);
+
+	uint64_t to_read = p_length;
+	if (pos >= length) {
+		to_read = 0;
+	} else if (to_read > length - pos) {
+		to_read = length - pos;
+	}
+	if (to_read < p_length) {
+		eof = true;
+	}
+
+	if (to_read) {
+		memcpy(p_dst, data + pos, to_read);
+		pos += to_read;
+	}
+	return to_read;
+}
+
+const uint8_t *FileAccessMMap::get_buffer_view(uint64_t p_length) const {
+	if (pos > length || p_length > length - pos) {
+		return nullptr;
+	}
+
+	const uint8_t *view = data + pos;
+	pos += p_length;
+	return view;
+}
+
+Error FileAccessMMap::get_error() const {
+	return eof ? ERR_FILE_EOF : OK;
+}
+
+void FileAccessMMap::flush() {
+	ERR_FAIL_MSG("Memory mapped files are read-only.");
+}
+
+void FileAccessMMap::store_8(uint8_t p_dest) {
+	ERR_FAIL_MSG("Memory mapped files are read-only.");
+}
+
+void FileAccessMMap::store_buffer(const uint8_t *p_src, uint64_t p_length) {
+	ERR_FAIL_MSG("Memory mapped files are read-only.");
+}
+
+FileAccessMMap::~FileAccessMMap() {
+	close();
+}
+
+#endif
@@ -44,9 +44,12 @@
 #include "core/io/resource_loader.h"
 #include "core/object/message_queue.h"
 #include "core/os/dir_access.h"
+#include "core/os/frame_arena.h"
 #include "core/os/os.h"
+#include "core/os/small_object_allocator.h"
 #include "core/register_core_types.h"
 #include "core/string/translation.h"
+#include "core/templates/thread_work_pool.h"
 #include "core/version.h"
 #include "core/version_hash.gen.h"
 #include "drivers/register_driver_types.h"
@@ -430,6 +433,7 @@ Error Main::test_setup() {
 	register_driver_types();
 
 	ClassDB::set_current_api(ClassDB::API_NONE);
+	ClassDB::seal();
 
 	_start_success = true;
 
@@ -1817,6 +1821,7 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 	locale = String();
 
 	ClassDB::set_current_api(ClassDB::API_NONE); //no more APIs are registered at this point
+	ClassDB::seal(); //lookups no longer need to lock, changing a registered class later unseals
 
 	print_verbose("CORE API HASH: " + uitos(ClassDB::get_api_hash(ClassDB::API_CORE)));
 	print_verbose("EDITOR API HASH: " + uitos(ClassDB::get_api_hash(ClassDB::API_EDITOR)));
@@ -2550,6 +2555,8 @@ bool Main::iteration() {
 		}
 
 		Engine::get_singleton()->_fps = frames;
+		ThreadWorkPool::update_stats();
+		message_queue->update_stats();
 		performance->set_process_time(USEC_TO_SEC(process_max));
 		performance->set_physics_process_time(USEC_TO_SEC(physics_process_max));
 		process_max = 0;
@@ -2561,6 +2568,12 @@ bool Main::iteration() {
 
 	iterating--;
 
+	if (iterating == 0) {
+		// Scratch data allocated by the main thread only lives for a frame.
+		FrameArena::get_thread_arena()->reset();
+		CowDataStats::end_frame();
+	}
+
 	if (fixed_fps != -1) {
 		return exit;
 	}
@@ -2699,6 +2712,10 @@ void Main::cleanup(bool p_force) {
 	message_queue->flush();
 	memdelete(message_queue);
 
+	if (SmallObjectAllocator::is_enabled() && OS::get_singleton()->is_stdout_verbose()) {
+		SmallObjectAllocator::print_stats();
+	}
+
 	unregister_core_driver_types();
 	unregister_core_types();
 
@@ -32,6 +32,7 @@
 
 #include "core/object/message_queue.h"
 #include "core/os/os.h"
+#include "core/templates/thread_work_pool.h"
 #include "scene/main/node.h"
 #include "scene/main/scene_tree.h"
 #include "servers/audio_server.h"
@@ -77,6 +78,15 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(THREAD_POOL_JOBS);
+	BIND_ENUM_CONSTANT(THREAD_POOL_ELEMENTS);
+	BIND_ENUM_CONSTANT(THREAD_POOL_BATCHES);
+	BIND_ENUM_CONSTANT(THREAD_POOL_TIME);
+	BIND_ENUM_CONSTANT(MEMORY_COPY_ON_WRITE);
+	BIND_ENUM_CONSTANT(MESSAGE_QUEUE_MESSAGES);
+	BIND_ENUM_CONSTANT(MESSAGE_QUEUE_BYTES);
+	BIND_ENUM_CONSTANT(MESSAGE_QUEUE_COALESCED);
+	BIND_ENUM_CONSTANT(MESSAGE_QUEUE_TIME);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -120,6 +130,15 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/driver/output_latency",
+		"thread_pool/jobs",
+		"thread_pool/elements",
+		"thread_pool/batches",
+		"thread_pool/job_time",
+		"memory/copy_on_write",
+		"message_queue/messages",
+		"message_queue/bytes",
+		"message_queue/coalesced",
+		"message_queue/flush_time",
 
 	};
 
@@ -182,6 +201,24 @@ float Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case THREAD_POOL_JOBS:
+			return ThreadWorkPool::get_stats().jobs;
+		case THREAD_POOL_ELEMENTS:
+			return ThreadWorkPool::get_stats().elements;
+		case THREAD_POOL_BATCHES:
+			return ThreadWorkPool::get_stats().batches;
+		case THREAD_POOL_TIME:
+			return USEC_TO_SEC(ThreadWorkPool::get_stats().time_usec);
+		case MEMORY_COPY_ON_WRITE:
+			return CowDataStats::get_last_frame_copied_bytes();
+		case MESSAGE_QUEUE_MESSAGES:
+			return MessageQueue::get_singleton()->get_stats().messages;
+		case MESSAGE_QUEUE_BYTES:
+			return MessageQueue::get_singleton()->get_stats().bytes;
+		case MESSAGE_QUEUE_COALESCED:
+			return MessageQueue::get_singleton()->get_stats().coalesced;
+		case MESSAGE_QUEUE_TIME:
+			return USEC_TO_SEC(MessageQueue::get_singleton()->get_stats().time_usec);
 
 		default: {
 		}
@@ -221,6 +258,15 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
 
 	};
 
@@ -91,6 +91,15 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		THREAD_POOL_JOBS,
+		THREAD_POOL_ELEMENTS,
+		THREAD_POOL_BATCHES,
+		THREAD_POOL_TIME,
+		MEMORY_COPY_ON_WRITE,
+		MESSAGE_QUEUE_MESSAGES,
+		MESSAGE_QUEUE_BYTES,
+		MESSAGE_QUEUE_COALESCED,
+		MESSAGE_QUEUE_TIME,
 		MONITOR_MAX
 	};
 
@@ -167,6 +167,7 @@ protected:
 	void _get_property_list(List<PropertyInfo> *p_properties) const;
 
 	Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, Callable::CallError &r_error) override;
+	bool is_call_overridden() const override { return true; }
 
 	static void _bind_methods();
 
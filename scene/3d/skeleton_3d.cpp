@@ -32,6 +32,7 @@
 
 #include "core/config/engine.h"
 #include "core/config/project_settings.h"
+#include "core/math/math_batch.h"
 #include "core/object/message_queue.h"
 #include "core/variant/type_info.h"
 #include "scene/3d/physics_body_3d.h"
@@ -263,7 +264,9 @@ void Skeleton3D::_notification(int p_what) {
 				for (uint32_t i = 0; i < bind_count; i++) {
 					uint32_t bone_index = E->get()->skin_bone_indices_ptrs[i];
 					ERR_CONTINUE(bone_index >= (uint32_t)len);
-					rs->skeleton_bone_set_transform(skeleton, i, bonesptr[bone_index].pose_global * skin->get_bind_pose(i));
+					Transform bone_xform;
+					MathBatch::multiply_transform(bonesptr[bone_index].pose_global, skin->get_bind_pose(i), bone_xform);
+					rs->skeleton_bone_set_transform(skeleton, i, bone_xform);
 				}
 			}
 
@@ -934,10 +937,10 @@ void Skeleton3D::force_update_bone_children_transforms(int p_bone_idx) {
 				if (b.enabled) {
 					Transform pose = b.pose;
 					if (b.custom_pose_enable) {
-						pose = b.custom_pose * pose;
+						MathBatch::multiply_transform(b.custom_pose, pose, pose);
 					}
 					if (b.parent >= 0) {
-						b.pose_global = bonesptr[b.parent].pose_global * pose;
+						MathBatch::multiply_transform(bonesptr[b.parent].pose_global, pose, b.pose_global);
 					} else {
 						b.pose_global = pose;
 					}
@@ -953,16 +956,17 @@ void Skeleton3D::force_update_bone_children_transforms(int p_bone_idx) {
 				if (b.enabled) {
 					Transform pose = b.pose;
 					if (b.custom_pose_enable) {
-						pose = b.custom_pose * pose;
+						MathBatch::multiply_transform(b.custom_pose, pose, pose);
 					}
+					MathBatch::multiply_transform(b.rest, pose, pose);
 					if (b.parent >= 0) {
-						b.pose_global = bonesptr[b.parent].pose_global * (b.rest * pose);
+						MathBatch::multiply_transform(bonesptr[b.parent].pose_global, pose, b.pose_global);
 					} else {
-						b.pose_global = b.rest * pose;
+						b.pose_global = pose;
 					}
 				} else {
 					if (b.parent >= 0) {
-						b.pose_global = bonesptr[b.parent].pose_global * b.rest;
+						MathBatch::multiply_transform(bonesptr[b.parent].pose_global, b.rest, b.pose_global);
 					} else {
 						b.pose_global = b.rest;
 					}
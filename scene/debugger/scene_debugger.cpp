@@ -292,9 +292,16 @@ SceneDebuggerObject::SceneDebuggerObject(ObjectID p_id) {
 	// Add base object properties.
 	List<PropertyInfo> pinfo;
 	obj->get_property_list(&pinfo, true);
+	PackedStringArray names;
 	for (List<PropertyInfo>::Element *E = pinfo.front(); E; E = E->next()) {
 		if (E->get().usage & (PROPERTY_USAGE_EDITOR | PROPERTY_USAGE_CATEGORY)) {
-			properties.push_back(SceneDebuggerProperty(E->get(), obj->get(E->get().name)));
+			names.push_back(E->get().name);
+		}
+	}
+	const Dictionary values = obj->get_properties(names);
+	for (List<PropertyInfo>::Element *E = pinfo.front(); E; E = E->next()) {
+		if (E->get().usage & (PROPERTY_USAGE_EDITOR | PROPERTY_USAGE_CATEGORY)) {
+			properties.push_back(SceneDebuggerProperty(E->get(), values[E->get().name]));
 		}
 	}
 }
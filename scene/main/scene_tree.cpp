@@ -37,9 +37,11 @@
 #include "core/io/resource_loader.h"
 #include "core/object/message_queue.h"
 #include "core/os/dir_access.h"
+#include "core/os/frame_arena.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
 #include "core/string/print_string.h"
+#include "core/variant/variant_call_site.h"
 #include "node.h"
 #include "scene/debugger/scene_debugger.h"
 #include "scene/resources/font.h"
@@ -239,6 +241,20 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 	Node **nodes = nodes_copy.ptrw();
 	int node_count = nodes_copy.size();
 
+	VARIANT_ARGPTRS;
+
+	int argc = 0;
+	for (int i = 0; i < VARIANT_ARG_MAX; i++) {
+		if (argptr[i]->get_type() == Variant::NIL) {
+			break;
+		}
+		argc++;
+	}
+
+	// Nodes in a group tend to share a few classes, the method is looked up once for each.
+	VariantCallSite call_site(p_function);
+	Callable::CallError ce;
+
 	call_lock++;
 
 	if (p_call_flags & GROUP_CALL_REVERSE) {
@@ -248,7 +264,7 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 			}
 
 			if (p_call_flags & GROUP_CALL_REALTIME) {
-				nodes[i]->call(p_function, VARIANT_ARG_PASS);
+				call_site.call_object(nodes[i], argptr, argc, ce);
 			} else {
 				MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
 			}
@@ -261,7 +277,7 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 			}
 
 			if (p_call_flags & GROUP_CALL_REALTIME) {
-				nodes[i]->call(p_function, VARIANT_ARG_PASS);
+				call_site.call_object(nodes[i], argptr, argc, ce);
 			} else {
 				MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
 			}
@@ -784,12 +800,12 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 
 	_update_group_order(g, p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	Vector<Node *> nodes_copy = g.nodes;
-
-	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	//copy, so nodes added or removed from the group while being called don't affect the loop.
+	//the copy is scratch memory from the frame arena, so it doesn't cost a heap allocation.
+	FrameArena::Scope scope;
+	int node_count = g.nodes.size();
+	Node **nodes = (Node **)FrameArena::get_thread_arena()->alloc(sizeof(Node *) * node_count);
+	memcpy(nodes, g.nodes.ptr(), sizeof(Node *) * node_count);
 
 	call_lock++;
 
@@ -1138,23 +1138,32 @@ void ArrayMesh::_recompute_aabb() {
 		}
 	}
 }
-#ifndef _MSC_VER
-#warning need to add binding to add_surface using future MeshSurfaceData object
-#endif
-void ArrayMesh::add_surface(uint32_t p_format, PrimitiveType p_primitive, const Vector<uint8_t> &p_array, const Vector<uint8_t> &p_attribute_array, const Vector<uint8_t> &p_skin_array, int p_vertex_count, const Vector<uint8_t> &p_index_array, int p_index_count, const AABB &p_aabb, const Vector<uint8_t> &p_blend_shape_data, const Vector<AABB> &p_bone_aabbs, const Vector<RS::SurfaceData::LOD> &p_lods) {
+
+void ArrayMesh::_add_surface(const RS::SurfaceData &p_surface) {
 	_create_if_empty();
 
 	Surface s;
-	s.aabb = p_aabb;
-	s.is_2d = p_format & ARRAY_FLAG_USE_2D_VERTICES;
-	s.primitive = p_primitive;
-	s.array_length = p_vertex_count;
-	s.index_array_length = p_index_count;
-	s.format = p_format;
+	s.aabb = p_surface.aabb;
+	s.is_2d = p_surface.format & ARRAY_FLAG_USE_2D_VERTICES;
+	s.primitive = PrimitiveType(p_surface.primitive);
+	s.array_length = p_surface.vertex_count;
+	s.index_array_length = p_surface.index_count;
+	s.format = p_surface.format;
 
 	surfaces.push_back(s);
 	_recompute_aabb();
 
+	RenderingServer::get_singleton()->mesh_add_surface(mesh, p_surface);
+
+	clear_cache();
+	notify_property_list_changed();
+	emit_changed();
+}
+
+#ifndef _MSC_VER
+#warning need to add binding to add_surface using future MeshSurfaceData object
+#endif
+void ArrayMesh::add_surface(uint32_t p_format, PrimitiveType p_primitive, const Vector<uint8_t> &p_array, const Vector<uint8_t> &p_attribute_array, const Vector<uint8_t> &p_skin_array, int p_vertex_count, const Vector<uint8_t> &p_index_array, int p_index_count, const AABB &p_aabb, const Vector<uint8_t> &p_blend_shape_data, const Vector<AABB> &p_bone_aabbs, const Vector<RS::SurfaceData::LOD> &p_lods) {
 	RS::SurfaceData sd;
 	sd.format = p_format;
 	sd.primitive = RS::PrimitiveType(p_primitive);
@@ -1169,11 +1178,7 @@ void ArrayMesh::add_surface(uint32_t p_format, PrimitiveType p_primitive, const
 	sd.bone_aabbs = p_bone_aabbs;
 	sd.lods = p_lods;
 
-	RenderingServer::get_singleton()->mesh_add_surface(mesh, sd);
-
-	clear_cache();
-	notify_property_list_changed();
-	emit_changed();
+	_add_surface(sd);
 }
 
 void ArrayMesh::add_surface_from_arrays(PrimitiveType p_primitive, const Array &p_arrays, const Array &p_blend_shapes, const Dictionary &p_lods, uint32_t p_flags) {
@@ -1194,7 +1199,8 @@ void ArrayMesh::add_surface_from_arrays(PrimitiveType p_primitive, const Array &
 	print_line("primitive: " + itos(surface.primitive));
 	*/
 
-	add_surface(surface.format, PrimitiveType(surface.primitive), surface.vertex_data, surface.attribute_data, surface.skin_data, surface.vertex_count, surface.index_data, surface.index_count, surface.aabb, surface.blend_shape_data, surface.bone_aabbs, surface.lods);
+	// Hand the buffers over as they are, they aren't shared with anything else.
+	_add_surface(surface);
 }
 
 Array ArrayMesh::surface_get_arrays(int p_surface) const {
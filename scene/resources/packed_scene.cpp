@@ -84,6 +84,8 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	Map<Ref<Resource>, Ref<Resource>> resources_local_to_scene;
 
+	const InstanceProgram *program = p_edit_state == GEN_EDIT_STATE_DISABLED ? _get_instance_program() : nullptr;
+
 	for (int i = 0; i < nc; i++) {
 		const NodeData &n = nd[i];
 
@@ -147,6 +149,8 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 				}
 #endif
 			}
+		} else if (program && program->nodes[i].creation_func) {
+			node = Object::cast_to<Node>(program->nodes[i].creation_func());
 		} else {
 			Object *obj = nullptr;
 
@@ -187,6 +191,11 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 			int nprop_count = n.properties.size();
 			if (nprop_count) {
 				const NodeData::Property *nprops = &n.properties[0];
+				// Resolved setters are only used while no script can override the properties.
+				const ClassDB::PropertySetGet *const *setters = nullptr;
+				if (program && program->nodes[i].creation_func) {
+					setters = program->nodes[i].setters.ptr();
+				}
 
 				for (int j = 0; j < nprop_count; j++) {
 					bool valid;
@@ -244,7 +253,12 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 						} else if (p_edit_state == GEN_EDIT_STATE_INSTANCE) {
 							value = value.duplicate(true); // Duplicate arrays and dictionaries for the editor
 						}
-						node->set(snames[nprops[j].name], value, &valid);
+
+						if (setters && setters[j] && !node->get_script_instance()) {
+							ClassDB::call_property_setter(node, setters[j], value);
+						} else {
+							node->set(snames[nprops[j].name], value, &valid);
+						}
 					}
 				}
 			}
@@ -318,7 +332,9 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 		}
 
 		Vector<Variant> binds;
-		if (c.binds.size()) {
+		if (program) {
+			binds = program->connection_binds[i];
+		} else if (c.binds.size()) {
 			binds.resize(c.binds.size());
 			for (int j = 0; j < c.binds.size(); j++) {
 				binds.write[j] = props[c.binds[j]];
@@ -904,7 +920,80 @@ String SceneState::get_path() const {
 	return path;
 }
 
+const SceneState::InstanceProgram *SceneState::_get_instance_program() const {
+	InstanceProgram *program = instance_program.load(std::memory_order_acquire);
+	if (likely(program)) {
+		return program;
+	}
+
+	if (!ClassDB::is_sealed()) {
+		return nullptr; // Resolved setters could still move while classes are registered.
+	}
+
+	MutexLock lock(instance_program_mutex);
+	program = instance_program.load(std::memory_order_relaxed);
+	if (!program) {
+		program = memnew(InstanceProgram);
+		_compile_instance_program(*program);
+		instance_program.store(program, std::memory_order_release);
+	}
+	return program;
+}
+
+void SceneState::_compile_instance_program(InstanceProgram &r_program) const {
+	int name_count = names.size();
+	int nc = nodes.size();
+	r_program.nodes.resize(nc);
+
+	for (int i = 0; i < nc; i++) {
+		const NodeData &n = nodes[i];
+		InstanceProgram::NodeProgram &np = r_program.nodes[i];
+
+		// Instanced, inherited and invalid nodes are still created the slow way.
+		if ((i == 0 && base_scene_idx >= 0) || n.instance >= 0 || n.type < 0 || n.type >= name_count) {
+			continue;
+		}
+
+		const StringName &type = names[n.type];
+		ClassDB::CreationFunc creation_func = ClassDB::get_creation_func(type);
+		if (!creation_func || !ClassDB::is_parent_class(type, Node::get_class_static())) {
+			continue;
+		}
+		np.creation_func = creation_func;
+
+		np.setters.resize(n.properties.size());
+		for (int j = 0; j < n.properties.size(); j++) {
+			const ClassDB::PropertySetGet *psg = nullptr;
+			int name = n.properties[j].name;
+			if (name >= 0 && name < name_count) {
+				psg = ClassDB::get_property_setget(type, names[name]);
+			}
+			np.setters[j] = (psg && psg->setter) ? psg : nullptr;
+		}
+	}
+
+	int cc = connections.size();
+	r_program.connection_binds.resize(cc);
+	for (int i = 0; i < cc; i++) {
+		const ConnectionData &c = connections[i];
+		Vector<Variant> &binds = r_program.connection_binds[i];
+		binds.resize(c.binds.size());
+		for (int j = 0; j < c.binds.size(); j++) {
+			ERR_CONTINUE(c.binds[j] < 0 || c.binds[j] >= variants.size());
+			binds.write[j] = variants[c.binds[j]];
+		}
+	}
+}
+
+void SceneState::_clear_instance_program() {
+	InstanceProgram *program = instance_program.exchange(nullptr, std::memory_order_acq_rel);
+	if (program) {
+		memdelete(program);
+	}
+}
+
 void SceneState::clear() {
+	_clear_instance_program();
 	names.clear();
 	variants.clear();
 	nodes.clear();
@@ -1068,6 +1157,8 @@ void SceneState::set_bundled_scene(const Dictionary &p_dictionary) {
 
 	ERR_FAIL_COND_MSG(version > PACKED_SCENE_VERSION, "Save format version too new.");
 
+	_clear_instance_program();
+
 	const int node_count = p_dictionary["node_count"];
 	const Vector<int> snodes = p_dictionary["nodes"];
 	ERR_FAIL_COND(snodes.size() < node_count);
@@ -1505,6 +1596,7 @@ int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int
 	nd.instance = p_instance;
 	nd.index = p_index;
 
+	_clear_instance_program();
 	nodes.push_back(nd);
 
 	return nodes.size() - 1;
@@ -1518,6 +1610,7 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 	NodeData::Property prop;
 	prop.name = p_name;
 	prop.value = p_value;
+	_clear_instance_program();
 	nodes.write[p_node].properties.push_back(prop);
 }
 
@@ -1529,6 +1622,7 @@ void SceneState::add_node_group(int p_node, int p_group) {
 
 void SceneState::set_base_scene(int p_idx) {
 	ERR_FAIL_INDEX(p_idx, variants.size());
+	_clear_instance_program();
 	base_scene_idx = p_idx;
 }
 
@@ -1546,6 +1640,7 @@ void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method
 	c.method = p_method;
 	c.flags = p_flags;
 	c.binds = p_binds;
+	_clear_instance_program();
 	connections.push_back(c);
 }
 
@@ -1596,6 +1691,10 @@ void SceneState::_bind_methods() {
 SceneState::SceneState() {
 }
 
+SceneState::~SceneState() {
+	_clear_instance_program();
+}
+
 ////////////////
 
 void PackedScene::_set_bundled_scene(const Dictionary &p_scene) {
@@ -32,6 +32,7 @@
 #define PACKED_SCENE_H
 
 #include "core/io/resource.h"
+#include "core/templates/local_vector.h"
 #include "scene/main/node.h"
 
 class SceneState : public Reference {
@@ -87,6 +88,27 @@ class SceneState : public Reference {
 
 	Vector<ConnectionData> connections;
 
+	// Node classes and property setters resolved once, so instancing outside
+	// of the editor doesn't look them up by name again for every instance.
+	struct InstanceProgram {
+		struct NodeProgram {
+			// Null when the node isn't created from a class, or its class can't be created.
+			ClassDB::CreationFunc creation_func = nullptr;
+			// One per node property, null ones are set through Object::set().
+			LocalVector<const ClassDB::PropertySetGet *> setters;
+		};
+
+		LocalVector<NodeProgram> nodes;
+		LocalVector<Vector<Variant>> connection_binds;
+	};
+
+	mutable std::atomic<InstanceProgram *> instance_program = { nullptr };
+	mutable Mutex instance_program_mutex;
+
+	const InstanceProgram *_get_instance_program() const;
+	void _compile_instance_program(InstanceProgram &r_program) const;
+	void _clear_instance_program();
+
 	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 	Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 
@@ -184,6 +206,7 @@ public:
 	uint64_t get_last_modified_time() const { return last_modified_time; }
 
 	SceneState();
+	~SceneState();
 };
 
 VARIANT_ENUM_CAST(SceneState::GenEditState)
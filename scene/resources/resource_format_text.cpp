@@ -1492,6 +1492,18 @@ void ResourceFormatSaverTextInstance::_find_resources(const Variant &p_variant,
 	}
 }
 
+void ResourceFormatSaverTextInstance::_write_property(const String &p_name, const Variant &p_value) {
+	f->store_string(p_name.property_name_encode() + " = ");
+
+	// Stream the value to the file as it is encoded, large arrays can take
+	// hundreds of megabytes as text.
+	StringStream value(f);
+	VariantWriter::write_to_stream(p_value, value, _write_resources, this);
+	value.flush();
+
+	f->store_8('\n');
+}
+
 Error ResourceFormatSaverTextInstance::save(const String &p_path, const RES &p_resource, uint32_t p_flags) {
 	if (p_path.ends_with(".tscn")) {
 		packed_scene = p_resource;
@@ -1691,9 +1703,7 @@ Error ResourceFormatSaverTextInstance::save(const String &p_path, const RES &p_r
 					continue;
 				}
 
-				String vars;
-				VariantWriter::write_to_string(value, vars, _write_resources, this);
-				f->store_string(name.property_name_encode() + " = " + vars + "\n");
+				_write_property(name, value);
 			}
 		}
 
@@ -1759,10 +1769,7 @@ Error ResourceFormatSaverTextInstance::save(const String &p_path, const RES &p_r
 			f->store_line("]");
 
 			for (int j = 0; j < state->get_node_property_count(i); j++) {
-				String vars;
-				VariantWriter::write_to_string(state->get_node_property_value(i, j), vars, _write_resources, this);
-
-				f->store_string(String(state->get_node_property_name(i, j)).property_name_encode() + " = " + vars + "\n");
+				_write_property(state->get_node_property_name(i, j), state->get_node_property_value(i, j));
 			}
 
 			if (i < state->get_node_count() - 1) {
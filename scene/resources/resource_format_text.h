@@ -183,6 +183,7 @@ class ResourceFormatSaverTextInstance {
 
 	static String _write_resources(void *ud, const RES &p_resource);
 	String _write_resource(const RES &res);
+	void _write_property(const String &p_name, const Variant &p_value);
 
 public:
 	Error save(const String &p_path, const RES &p_resource, uint32_t p_flags = 0);
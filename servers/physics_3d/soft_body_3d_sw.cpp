@@ -32,6 +32,7 @@
 #include "space_3d_sw.h"
 
 #include "core/math/geometry_3d.h"
+#include "core/math/math_batch.h"
 #include "core/templates/map.h"
 
 // Based on Bullet soft body.
@@ -295,11 +296,14 @@ void SoftBody3DSW::apply_nodes_transform(const Transform &p_transform) {
 	}
 
 	uint32_t node_count = nodes.size();
+	if (node_count) {
+		MathBatch::xform_points(p_transform, &nodes[0].x, &nodes[0].x, node_count, sizeof(Node));
+	}
+
 	Vector3 leaf_size = Vector3(collision_margin, collision_margin, collision_margin) * 2.0;
 	for (uint32_t node_index = 0; node_index < node_count; ++node_index) {
 		Node &node = nodes[node_index];
 
-		node.x = p_transform.xform(node.x);
 		node.q = node.x;
 		node.v = Vector3();
 		node.bv = Vector3();
@@ -3521,11 +3521,16 @@ void RendererSceneCull::update_dirty_instances() {
 }
 
 void RendererSceneCull::update() {
-	//optimize bvhs
-	for (uint32_t i = 0; i < scenario_owner.get_rid_count(); i++) {
-		Scenario *s = scenario_owner.get_ptr_by_index(i);
-		s->indexers[Scenario::INDEXER_GEOMETRY].optimize_incremental(indexer_update_iterations);
-		s->indexers[Scenario::INDEXER_VOLUMES].optimize_incremental(indexer_update_iterations);
+	{
+		//optimize bvhs
+		FrameArena::Scope scope;
+		FrameList<RID> scenarios;
+		scenario_owner.get_owned_list(&scenarios);
+		for (FrameList<RID>::Element *E = scenarios.front(); E; E = E->next()) {
+			Scenario *s = scenario_owner.getornull(E->get());
+			s->indexers[Scenario::INDEXER_GEOMETRY].optimize_incremental(indexer_update_iterations);
+			s->indexers[Scenario::INDEXER_VOLUMES].optimize_incremental(indexer_update_iterations);
+		}
 	}
 	scene_render->update();
 	update_dirty_instances();
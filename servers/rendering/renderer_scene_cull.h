@@ -36,7 +36,9 @@
 
 #include "core/math/dynamic_bvh.h"
 #include "core/math/geometry_3d.h"
+#include "core/math/math_batch.h"
 #include "core/math/octree.h"
+#include "core/os/frame_arena.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
 #include "core/templates/local_vector.h"
@@ -123,63 +125,41 @@ public:
 
 	struct Instance;
 
-	struct PlaneSign {
-		_ALWAYS_INLINE_ PlaneSign() {}
-		_ALWAYS_INLINE_ PlaneSign(const Plane &p_plane) {
-			if (p_plane.normal.x > 0) {
-				signs[0] = 0;
-			} else {
-				signs[0] = 3;
-			}
-			if (p_plane.normal.y > 0) {
-				signs[1] = 1;
-			} else {
-				signs[1] = 4;
-			}
-			if (p_plane.normal.z > 0) {
-				signs[2] = 2;
-			} else {
-				signs[2] = 5;
-			}
-		}
-
-		uint32_t signs[3];
-	};
-
+	// Only valid during the frame it was built in, plane blocks are kept in the
+	// frame arena of the thread that built it.
 	struct Frustum {
 		Vector<Plane> planes;
-		Vector<PlaneSign> plane_signs;
-		const Plane *planes_ptr;
-		const PlaneSign *plane_signs_ptr;
-		uint32_t plane_count;
+		const Plane *planes_ptr = nullptr;
+		const MathBatch::PlaneBlock *plane_blocks_ptr = nullptr;
+		uint32_t plane_count = 0;
+		uint32_t plane_block_count = 0;
 
 		_ALWAYS_INLINE_ Frustum() {}
 		_ALWAYS_INLINE_ Frustum(const Frustum &p_frustum) {
 			planes = p_frustum.planes;
-			plane_signs = p_frustum.plane_signs;
 
 			planes_ptr = planes.ptr();
-			plane_signs_ptr = plane_signs.ptr();
+			plane_blocks_ptr = p_frustum.plane_blocks_ptr;
 			plane_count = p_frustum.plane_count;
+			plane_block_count = p_frustum.plane_block_count;
 		}
 		_ALWAYS_INLINE_ void operator=(const Frustum &p_frustum) {
 			planes = p_frustum.planes;
-			plane_signs = p_frustum.plane_signs;
 
 			planes_ptr = planes.ptr();
-			plane_signs_ptr = plane_signs.ptr();
+			plane_blocks_ptr = p_frustum.plane_blocks_ptr;
 			plane_count = p_frustum.plane_count;
+			plane_block_count = p_frustum.plane_block_count;
 		}
 		_ALWAYS_INLINE_ Frustum(const Vector<Plane> &p_planes) {
 			planes = p_planes;
-			planes_ptr = planes.ptrw();
+			planes_ptr = planes.ptr();
 			plane_count = planes.size();
-			for (int i = 0; i < planes.size(); i++) {
-				PlaneSign ps(p_planes[i]);
-				plane_signs.push_back(ps);
-			}
+			plane_block_count = MathBatch::get_plane_block_count(plane_count);
 
-			plane_signs_ptr = plane_signs.ptr();
+			MathBatch::PlaneBlock *plane_blocks = (MathBatch::PlaneBlock *)FrameArena::get_thread_arena()->alloc(sizeof(MathBatch::PlaneBlock) * plane_block_count);
+			MathBatch::make_plane_blocks(planes_ptr, plane_count, plane_blocks);
+			plane_blocks_ptr = plane_blocks;
 		}
 	};
 
@@ -202,19 +182,7 @@ public:
 		_ALWAYS_INLINE_ bool in_frustum(const Frustum &p_frustum) const {
 			// This is not a full SAT check and the possibility of false positives exist,
 			// but the tradeoff vs performance is still very good.
-
-			for (uint32_t i = 0; i < p_frustum.plane_count; i++) {
-				Vector3 min(
-						bounds[p_frustum.plane_signs_ptr[i].signs[0]],
-						bounds[p_frustum.plane_signs_ptr[i].signs[1]],
-						bounds[p_frustum.plane_signs_ptr[i].signs[2]]);
-
-				if (p_frustum.planes_ptr[i].distance_to(min) >= 0.0) {
-					return false;
-				}
-			}
-
-			return true;
+			return MathBatch::is_box_inside(p_frustum.plane_blocks_ptr, p_frustum.plane_block_count, bounds);
 		}
 		_ALWAYS_INLINE_ bool in_aabb(const AABB &p_aabb) const {
 			Vector3 end = p_aabb.position + p_aabb.size;
@@ -32,6 +32,7 @@
 
 #include "core/config/project_settings.h"
 #include "core/io/marshalls.h"
+#include "core/os/frame_arena.h"
 #include "core/os/os.h"
 #include "core/templates/sort_array.h"
 #include "renderer_canvas_cull.h"
@@ -335,6 +336,8 @@ void RenderingServerDefault::_thread_exit() {
 void RenderingServerDefault::_thread_draw(bool p_swap_buffers, double frame_step) {
 	if (!draw_pending.decrement()) {
 		_draw(p_swap_buffers, frame_step);
+		// The frame is done, drop the scratch data the render thread allocated for it.
+		FrameArena::get_thread_arena()->reset();
 	}
 }
 
@@ -357,8 +360,8 @@ void RenderingServerDefault::_thread_loop() {
 
 	draw_thread_up.set();
 	while (!exit.is_set()) {
-		// flush commands one by one, until exit is requested
-		command_queue.wait_and_flush_one();
+		// flush commands in batches, until exit is requested
+		command_queue.wait_and_flush();
 	}
 
 	command_queue.flush_all(); // flush all
@@ -997,8 +997,8 @@ Error RenderingServer::mesh_create_surface_data_from_arrays(SurfaceData *r_surfa
 
 			SurfaceData::LOD lod;
 			lod.edge_length = distance;
-			lod.index_data = data;
-			lods.push_back(lod);
+			lod.index_data = std::move(data);
+			lods.push_back(std::move(lod));
 		}
 	}
 
@@ -1006,15 +1006,15 @@ Error RenderingServer::mesh_create_surface_data_from_arrays(SurfaceData *r_surfa
 	surface_data.format = format;
 	surface_data.primitive = p_primitive;
 	surface_data.aabb = aabb;
-	surface_data.vertex_data = vertex_array;
-	surface_data.attribute_data = attrib_array;
-	surface_data.skin_data = skin_array;
+	surface_data.vertex_data = std::move(vertex_array);
+	surface_data.attribute_data = std::move(attrib_array);
+	surface_data.skin_data = std::move(skin_array);
 	surface_data.vertex_count = array_len;
-	surface_data.index_data = index_array;
+	surface_data.index_data = std::move(index_array);
 	surface_data.index_count = index_array_len;
-	surface_data.blend_shape_data = blend_shape_data;
-	surface_data.bone_aabbs = bone_aabb;
-	surface_data.lods = lods;
+	surface_data.blend_shape_data = std::move(blend_shape_data);
+	surface_data.bone_aabbs = std::move(bone_aabb);
+	surface_data.lods = std::move(lods);
 
 	return OK;
 }
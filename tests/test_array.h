@@ -33,10 +33,12 @@
 
 #include "core/object/class_db.h"
 #include "core/object/script_language.h"
+#include "core/os/memory.h"
 #include "core/templates/hashfuncs.h"
 #include "core/templates/vector.h"
 #include "core/variant/array.h"
 #include "core/variant/container_type_validate.h"
+#include "core/variant/dictionary.h"
 #include "core/variant/variant.h"
 #include "tests/test_macros.h"
 
@@ -70,6 +72,19 @@ TEST_CASE("[Array] Assignment and comparison operators") {
 	CHECK(arr3 == arr2);
 }
 
+TEST_CASE("[Array] Move assignment") {
+	Array arr1;
+	arr1.push_back(1);
+	Array arr2;
+	arr2.push_back(2);
+	Array reference = arr1;
+
+	arr2 = std::move(arr1);
+	CHECK(arr2 == reference);
+	CHECK(arr2[0] == Variant(1));
+	CHECK(arr1.size() == 1); // Left valid, holding what arr2 had.
+}
+
 TEST_CASE("[Array] append_array()") {
 	Array arr1;
 	Array arr2;
@@ -181,6 +196,107 @@ TEST_CASE("[Array] max() and min()") {
 	CHECK(max == 5);
 	CHECK(min == 2);
 }
+
+TEST_CASE("[Array] Growing past and shrinking below the inline storage") {
+	Array arr;
+	for (int i = 0; i < 10; i++) {
+		arr.push_back(i);
+	}
+	CHECK(arr.size() == 10);
+	for (int i = 0; i < 10; i++) {
+		CHECK(int(arr[i]) == i);
+	}
+
+	arr.insert(2, 100);
+	CHECK(int(arr[2]) == 100);
+	CHECK(int(arr[3]) == 2);
+	arr.remove(2);
+	CHECK(int(arr[2]) == 2);
+
+	arr.resize(3);
+	CHECK(arr.size() == 3);
+	CHECK(int(arr[2]) == 2);
+	arr.clear();
+	CHECK(arr.is_empty());
+
+	// Pushing one of its own elements while moving out of the inline storage.
+	for (int i = 0; i < 4; i++) {
+		arr.push_back(String::num(i));
+	}
+	arr.push_back(arr[0]);
+	CHECK(arr.size() == 5);
+	CHECK(String(arr[4]) == "0");
+
+	arr.resize(2);
+	arr.append_array(arr);
+	CHECK(arr.size() == 4);
+	CHECK(String(arr[3]) == "1");
+
+	arr.fill(7);
+	CHECK(arr.count(7) == 4);
+	arr.reverse();
+	arr.erase(7);
+	CHECK(arr.size() == 3);
+	CHECK(arr.find(7, -1) == -1);
+}
+
+TEST_CASE("[Array] Copies of typed arrays don't share writes") {
+	Array untyped;
+	for (int i = 0; i < 8; i++) {
+		untyped.push_back(i);
+	}
+	Array typed;
+	typed.set_typed(Variant::INT, StringName(), Variant());
+	CHECK(typed.typed_assign(untyped));
+	CHECK(typed.size() == 8);
+
+	Array copy;
+	CHECK(copy.typed_assign(typed));
+	copy[0] = 100;
+	CHECK(int(typed[0]) == 0);
+	CHECK(int(copy[0]) == 100);
+}
+
+// Run with `godot --test container-memory-report`, needs a build with DEBUG_ENABLED.
+static void container_memory_report() {
+	const int containers = 1000;
+	const int sizes[] = { 0, 1, 2, 4, 8, 16, 64 };
+
+	// Both containers are a single pointer, this is what the vectors holding them cost.
+	uint64_t before = Memory::get_mem_usage();
+	Vector<uint64_t> probe;
+	probe.resize(containers);
+	const uint64_t holder = Memory::get_mem_usage() - before;
+
+	for (int size : sizes) {
+		before = Memory::get_mem_usage();
+		Vector<Array> arrays;
+		arrays.resize(containers);
+		for (int i = 0; i < containers; i++) {
+			for (int j = 0; j < size; j++) {
+				arrays.write[i].push_back(j);
+			}
+		}
+		uint64_t array_bytes = Memory::get_mem_usage() - before - holder;
+
+		before = Memory::get_mem_usage();
+		Vector<Dictionary> dictionaries;
+		dictionaries.resize(containers);
+		for (int i = 0; i < containers; i++) {
+			for (int j = 0; j < size; j++) {
+				dictionaries.write[i][j] = j;
+			}
+		}
+		uint64_t dictionary_bytes = Memory::get_mem_usage() - before - holder;
+
+		print_line(vformat("%d elements: Array %d bytes (%d per element), Dictionary %d bytes (%d per element).",
+				size, array_bytes / containers, size ? array_bytes / containers / size : 0,
+				dictionary_bytes / containers, size ? dictionary_bytes / containers / size : 0));
+	}
+}
+
+REGISTER_TEST_COMMAND("container-memory-report", &container_memory_report);
+
 } // namespace TestArray
 
 #endif // TEST_ARRAY_H
@@ -34,6 +34,7 @@
 #include "core/register_core_types.h"
 
 #include "core/core_constants.h"
+#include "core/object/class_db.h"
 #include "core/os/os.h"
 #include "core/string/string_name.h"
 #include "core/string/ustring.h"
@@ -42,6 +43,47 @@
 
 #include "tests/test_macros.h"
 
+// Declared in global namespace because of GDCLASS macro warning (Windows).
+class _TestSealedObject : public Object {
+	GDCLASS(_TestSealedObject, Object);
+
+	int value = 0;
+
+protected:
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("set_value", "value"), &_TestSealedObject::set_value);
+		ClassDB::bind_method(D_METHOD("get_value"), &_TestSealedObject::get_value);
+		ADD_PROPERTY(PropertyInfo(Variant::INT, "value"), "set_value", "get_value");
+		BIND_CONSTANT(SEALED_CONSTANT);
+	}
+
+public:
+	enum {
+		SEALED_CONSTANT = 42,
+	};
+
+	void set_value(int p_value) { value = p_value; }
+	int get_value() const { return value; }
+};
+
+// Never registered, so it is added to ClassDB when the first one is created.
+class _TestLazyObject : public Object {
+	GDCLASS(_TestLazyObject, Object);
+
+	int value = 0;
+
+protected:
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("set_value", "value"), &_TestLazyObject::set_value);
+		ClassDB::bind_method(D_METHOD("get_value"), &_TestLazyObject::get_value);
+		ADD_PROPERTY(PropertyInfo(Variant::INT, "value"), "set_value", "get_value");
+	}
+
+public:
+	void set_value(int p_value) { value = p_value; }
+	int get_value() const { return value; }
+};
+
 namespace TestClassDB {
 
 struct TypeReference {
@@ -856,6 +898,123 @@ TEST_SUITE("[ClassDB]") {
 			}
 		}
 	}
+
+	TEST_CASE("[ClassDB] Sealed lookups") {
+		ClassDB::seal();
+		CHECK(ClassDB::is_sealed());
+
+		CHECK(ClassDB::class_exists("Object"));
+		CHECK(ClassDB::class_exists("Reference"));
+		CHECK_FALSE(ClassDB::class_exists("_NoSuchClass"));
+		CHECK(ClassDB::is_parent_class("Resource", "Object"));
+		CHECK(ClassDB::is_parent_class("Resource", "Resource"));
+		CHECK_FALSE(ClassDB::is_parent_class("Object", "Resource"));
+		CHECK(ClassDB::get_parent_class("Resource") == "Reference");
+		CHECK(ClassDB::get_parent_class_nocheck("Object") == StringName());
+		CHECK(ClassDB::get_method("Resource", "get_class") != nullptr);
+		CHECK(ClassDB::get_method("Resource", "_no_such_method") == nullptr);
+		CHECK(ClassDB::has_method("Resource", "get_class"));
+		CHECK_FALSE(ClassDB::has_method("Resource", "get_class", true));
+		CHECK(ClassDB::can_instance("Resource"));
+
+		Object *resource = ClassDB::instance("Resource");
+		REQUIRE(resource != nullptr);
+		CHECK(resource->get_class_name() == "Resource");
+		memdelete(resource);
+
+		// Registering a class afterwards keeps the others sealed, the new one is found in the locked tables.
+		ClassDB::register_class<_TestSealedObject>();
+		CHECK(ClassDB::is_sealed());
+		CHECK(ClassDB::class_exists("_TestSealedObject"));
+		CHECK(ClassDB::is_parent_class("_TestSealedObject", "Object"));
+		CHECK(ClassDB::get_parent_class("_TestSealedObject") == "Object");
+		CHECK(ClassDB::get_method("_TestSealedObject", "set_value") != nullptr);
+		CHECK(ClassDB::get_method("_TestSealedObject", "get_class") != nullptr);
+		CHECK(ClassDB::can_instance("_TestSealedObject"));
+
+		// Changing a sealed class does unseal.
+		ClassDB::set_class_enabled("Resource", true);
+		CHECK_FALSE(ClassDB::is_sealed());
+
+		ClassDB::seal();
+		CHECK(ClassDB::is_sealed());
+		CHECK(ClassDB::class_exists("_TestSealedObject"));
+		CHECK(ClassDB::is_parent_class("_TestSealedObject", "Object"));
+
+		_TestSealedObject *object = Object::cast_to<_TestSealedObject>(ClassDB::instance("_TestSealedObject"));
+		REQUIRE(object != nullptr);
+
+		bool valid = false;
+		CHECK(ClassDB::set_property(object, "value", 7, &valid));
+		CHECK(valid);
+		CHECK(object->get_value() == 7);
+
+		Variant value;
+		CHECK(ClassDB::get_property(object, "value", value));
+		CHECK(int(value) == 7);
+		CHECK(ClassDB::get_property(object, "SEALED_CONSTANT", value));
+		CHECK(int(value) == 42);
+		CHECK(ClassDB::get_property(object, "get_value", value));
+		CHECK(value.get_type() == Variant::CALLABLE);
+		CHECK_FALSE(ClassDB::get_property(object, "_no_such_property", value));
+		CHECK(ClassDB::get_property_type("_TestSealedObject", "value", &valid) == Variant::INT);
+		CHECK(valid);
+		CHECK(ClassDB::get_property_index("_TestSealedObject", "_no_such_property", &valid) == -1);
+		CHECK_FALSE(valid);
+		// Inherited properties are found too.
+		CHECK(ClassDB::get_property_type("_TestSealedObject", "script", &valid) == Variant::OBJECT);
+		CHECK(valid);
+
+		// Batches stop at the first property which isn't one of the class.
+		const StringName names[3] = { "value", "script", "_no_such_property" };
+		const Variant values[3] = { 11, Variant(), 0 };
+		const Variant *value_ptrs[3] = { &values[0], &values[1], &values[2] };
+		CHECK(ClassDB::set_properties(object, names, value_ptrs, 3) == 2);
+		CHECK(object->get_value() == 11);
+
+		const StringName get_names[3] = { "value", "SEALED_CONSTANT", "_no_such_property" };
+		Variant got[3];
+		bool handled[3] = {};
+		ClassDB::get_properties(object, get_names, 3, got, handled);
+		CHECK(handled[0]);
+		CHECK(int(got[0]) == 11);
+		CHECK(handled[1]);
+		CHECK(int(got[1]) == 42);
+		CHECK_FALSE(handled[2]);
+
+		memdelete(object);
+	}
+
+	TEST_CASE("[ClassDB] Creating an unregistered class keeps the tables sealed") {
+		ClassDB::seal();
+		REQUIRE(ClassDB::is_sealed());
+		REQUIRE_FALSE(ClassDB::class_exists("_TestLazyObject"));
+
+		_TestLazyObject *object = memnew(_TestLazyObject);
+		CHECK(ClassDB::is_sealed());
+		CHECK(ClassDB::class_exists("_TestLazyObject"));
+		CHECK(ClassDB::is_parent_class("_TestLazyObject", "Object"));
+		CHECK(ClassDB::has_method("_TestLazyObject", "set_value"));
+		CHECK(ClassDB::get_method("_TestLazyObject", "get_class") != nullptr);
+
+		bool valid = false;
+		CHECK(ClassDB::set_property(object, "value", 3, &valid));
+		CHECK(valid);
+		CHECK(object->get_value() == 3);
+
+		Variant value;
+		CHECK(ClassDB::get_property(object, "value", value));
+		CHECK(int(value) == 3);
+
+		const StringName names[2] = { "value", "_no_such_property" };
+		const Variant values[2] = { 5, 0 };
+		const Variant *value_ptrs[2] = { &values[0], &values[1] };
+		CHECK(ClassDB::set_properties(object, names, value_ptrs, 2) == 1);
+		CHECK(object->get_value() == 5);
+
+		memdelete(object);
+		CHECK(ClassDB::is_sealed());
+	}
 }
 } // namespace TestClassDB
 
@@ -31,7 +31,6 @@
 #ifndef TEST_DICTIONARY_H
 #define TEST_DICTIONARY_H
 
-#include "core/templates/ordered_hash_map.h"
 #include "core/templates/safe_refcount.h"
 #include "core/variant/dictionary.h"
 #include "core/variant/variant.h"
@@ -112,6 +111,7 @@ TEST_CASE("[Dictionary] get_valid()") {
 	Variant val = map.get_valid(1);
 	CHECK(int(val) == 3);
 }
+
 TEST_CASE("[Dictionary] get()") {
 	Dictionary map;
 	map[1] = 3;
@@ -155,5 +155,43 @@ TEST_CASE("[Dictionary] keys() and values()") {
 	CHECK(int(keys[0]) == 1);
 	CHECK(int(values[0]) == 3);
 }
+
+TEST_CASE("[Dictionary] Order and lookups past the small size") {
+	Dictionary map;
+	for (int i = 0; i < 100; i++) {
+		map[String::num(i)] = i;
+	}
+	CHECK(map.size() == 100);
+
+	const Variant *value = map.getptr("5");
+	REQUIRE(value != nullptr);
+	for (int i = 100; i < 1000; i++) {
+		map[String::num(i)] = i;
+	}
+	// Values stay where they are while the table grows.
+	CHECK(value == map.getptr("5"));
+
+	for (int i = 0; i < 1000; i += 2) {
+		CHECK(map.erase(String::num(i)));
+	}
+	CHECK(map.size() == 500);
+	CHECK_FALSE(map.has("0"));
+	CHECK(int(map["999"]) == 999);
+
+	int expected = 1;
+	bool ordered = true;
+	const Variant *key = nullptr;
+	while ((key = map.next(key))) {
+		ordered = ordered && int(map[*key]) == expected;
+		expected += 2;
+	}
+	CHECK(ordered);
+	CHECK(String(map.get_key_at_index(0)) == "1");
+
+	Dictionary copy = map.duplicate();
+	CHECK(copy.size() == 500);
+	CHECK(String(copy.get_key_at_index(499)) == "999");
+}
+
 } // namespace TestDictionary
 #endif // TEST_DICTIONARY_H
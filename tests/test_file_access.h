@@ -60,6 +60,54 @@ TEST_CASE("[FileAccess] CSV read") {
 	f->close();
 	memdelete(f);
 }
+
+TEST_CASE("[FileAccess] Mapped read") {
+	const String path = TestUtils::get_data_path("translations.csv");
+
+	FileAccess *f = FileAccess::open(path, FileAccess::READ);
+	REQUIRE(f);
+	const uint64_t len = f->get_len();
+	Vector<uint8_t> expected;
+	expected.resize(len);
+	f->get_buffer(expected.ptrw(), len);
+	memdelete(f);
+
+	Error err;
+	FileAccess *m = FileAccess::open_mapped(path, &err);
+	REQUIRE(m);
+	CHECK(err == OK);
+	CHECK(m->get_len() == len);
+
+	// Plain reads behave the same whether or not the file is mapped.
+	Vector<String> header = m->get_csv_line();
+	CHECK(header.size() == 3);
+	m->seek(0);
+
+	const uint8_t *view = m->get_buffer_view(len);
+	if (view) {
+		CHECK(memcmp(view, expected.ptr(), len) == 0);
+		CHECK(m->get_position() == len);
+
+		m->seek(len - 4);
+		CHECK_MESSAGE(m->get_buffer_view(5) == nullptr, "Views past the end of the file should fail.");
+		CHECK_MESSAGE(m->get_position() == len - 4, "A failed view should not move the position.");
+
+		uint8_t tail[4];
+		CHECK(m->get_buffer(tail, 4) == 4);
+		CHECK(memcmp(tail, expected.ptr() + len - 4, 4) == 0);
+		CHECK(!m->eof_reached());
+		m->get_8();
+		CHECK(m->eof_reached());
+	} else {
+		Vector<uint8_t> data;
+		data.resize(len);
+		CHECK(m->get_buffer(data.ptrw(), len) == len);
+		CHECK(data == expected);
+	}
+
+	m->close();
+	memdelete(m);
+}
 } // namespace TestFileAccess
 
 #endif // TEST_FILE_ACCESS_H
@@ -0,0 +1,337 @@
+/*************************************************************************/
+/*  test_flat_hash_map.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_FLAT_HASH_MAP_H
+#define TEST_FLAT_HASH_MAP_H
+
+#include "core/math/random_number_generator.h"
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+#include "core/templates/flat_hash_map.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/map.h"
+#include "core/templates/oa_hash_map.h"
+
+#include "tests/test_macros.h"
+
+namespace TestFlatHashMap {
+
+TEST_CASE("[FlatHashMap] Insert, find and erase") {
+	FlatHashMap<int, int> map;
+	CHECK(map.is_empty());
+	CHECK(map.find(1) == nullptr);
+	CHECK_FALSE(map.erase(1));
+
+	map.insert(1, 10);
+	map[2] = 20;
+	map.insert(1, 11);
+
+	CHECK(map.size() == 2);
+	CHECK(map.has(1));
+	CHECK(map.get(1) == 11);
+	CHECK(*map.getptr(2) == 20);
+	CHECK(map.getptr(3) == nullptr);
+
+	CHECK(map.erase(1));
+	CHECK_FALSE(map.has(1));
+	CHECK(map.size() == 1);
+
+	map.clear();
+	CHECK(map.is_empty());
+	CHECK(map.getptr(2) == nullptr);
+}
+
+TEST_CASE("[FlatHashMap] Iteration follows insertion order") {
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 1000; i++) {
+		map.insert((i * 7919) % 1000, i);
+	}
+	for (int i = 0; i < 1000; i += 3) {
+		map.erase((i * 7919) % 1000);
+	}
+
+	int expected = 1;
+	bool order_kept = true;
+	for (const FlatHashMap<int, int>::Element *E = map.front(); E; E = E->next()) {
+		if (expected % 3 == 0) {
+			expected++;
+		}
+		order_kept = order_kept && E->value() == expected && E->key() == (expected * 7919) % 1000;
+		expected++;
+	}
+	CHECK(order_kept);
+
+	const int *k = nullptr;
+	uint32_t count = 0;
+	while ((k = map.next(k))) {
+		count++;
+	}
+	CHECK(count == map.size());
+}
+
+TEST_CASE("[FlatHashMap] Small maps without a table") {
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < FlatHashMap<int, int>::SMALL_SIZE; i++) {
+		map.insert(i, i * 10);
+	}
+	CHECK(map.get_capacity() == 0);
+	CHECK(map.get(3) == 30);
+	CHECK(map.erase(3));
+	CHECK_FALSE(map.erase(3));
+	CHECK_FALSE(map.has(3));
+	CHECK(map.front()->key() == 0);
+
+	map[100] = 1;
+	map[101] = 2;
+	CHECK(map.get_capacity() > 0);
+	CHECK(map.size() == FlatHashMap<int, int>::SMALL_SIZE + 1);
+	for (int i = 0; i < FlatHashMap<int, int>::SMALL_SIZE; i++) {
+		CHECK(map.has(i) == (i != 3));
+	}
+	CHECK(map.back()->key() == 101);
+}
+
+TEST_CASE("[FlatHashMap] Pointers stay valid while inserting and erasing") {
+	FlatHashMap<int, int> map;
+	map.insert(-1, 42);
+	int *value = map.getptr(-1);
+	for (int i = 0; i < 10000; i++) {
+		map.insert(i, i);
+	}
+	for (int i = 0; i < 10000; i += 2) {
+		map.erase(i);
+	}
+	CHECK(value == map.getptr(-1));
+	CHECK(*value == 42);
+}
+
+TEST_CASE("[FlatHashMap] Matches Map under random operations") {
+	Ref<RandomNumberGenerator> rng;
+	rng.instance();
+	rng->set_seed(1234);
+
+	FlatHashMap<int, int> map;
+	Map<int, int> reference;
+	bool matches = true;
+
+	for (int i = 0; i < 50000; i++) {
+		int key = rng->randi() % 2000;
+		switch (rng->randi() % 4) {
+			case 0:
+			case 1: {
+				map.insert(key, i);
+				reference.insert(key, i);
+			} break;
+			case 2: {
+				matches = matches && (map.erase(key) == reference.erase(key));
+			} break;
+			case 3: {
+				const int *value = map.getptr(key);
+				const Map<int, int>::Element *E = reference.find(key);
+				matches = matches && (value != nullptr) == (E != nullptr) && (!value || *value == E->get());
+			} break;
+		}
+	}
+
+	CHECK(matches);
+	CHECK(map.size() == (uint32_t)reference.size());
+	for (const Map<int, int>::Element *E = reference.front(); E; E = E->next()) {
+		const int *value = map.getptr(E->key());
+		CHECK(value != nullptr);
+		CHECK(*value == E->get());
+	}
+
+	FlatHashMap<int, int> copy = map;
+	CHECK(copy.size() == map.size());
+	CHECK(copy.front()->key() == map.front()->key());
+}
+
+TEST_CASE("[FlatHashMap] Heterogeneous lookup") {
+	FlatHashMap<StringName, int> map;
+	map.insert("flat_hash_map_key", 1);
+	map.insert("flat_hash_map_other_key", 2);
+
+	const FlatHashMap<StringName, int>::Element *E = map.find_as("flat_hash_map_key");
+	CHECK(E != nullptr);
+	CHECK(E->value() == 1);
+	CHECK(map.has_as(String("flat_hash_map_other_key")));
+	CHECK_FALSE(map.has_as("flat_hash_map_missing_key"));
+	// Looking up a C string must not intern it.
+	CHECK(StringName::search("flat_hash_map_missing_key") == StringName());
+}
+
+template <class K>
+struct BenchmarkKeys {
+	LocalVector<K> present;
+	LocalVector<K> missing;
+};
+
+template <class K, class V, class M>
+struct BenchmarkHashMap {
+	M map;
+	void insert(const K &p_key, const V &p_value) { map.set(p_key, p_value); }
+	bool lookup(const K &p_key) { return map.getptr(p_key) != nullptr; }
+	void erase(const K &p_key) { map.erase(p_key); }
+	uint32_t iterate() {
+		uint32_t count = 0;
+		const K *k = nullptr;
+		while ((k = map.next(k))) {
+			count++;
+		}
+		return count;
+	}
+};
+
+template <class K, class V>
+struct BenchmarkOAHashMap {
+	OAHashMap<K, V> map;
+	void insert(const K &p_key, const V &p_value) { map.set(p_key, p_value); }
+	bool lookup(const K &p_key) { return map.lookup_ptr(p_key) != nullptr; }
+	void erase(const K &p_key) { map.remove(p_key); }
+	uint32_t iterate() {
+		uint32_t count = 0;
+		for (typename OAHashMap<K, V>::Iterator it = map.iter(); it.valid; it = map.next_iter(it)) {
+			count++;
+		}
+		return count;
+	}
+};
+
+template <class K, class V>
+struct BenchmarkMap {
+	Map<K, V> map;
+	void insert(const K &p_key, const V &p_value) { map.insert(p_key, p_value); }
+	bool lookup(const K &p_key) { return map.find(p_key) != nullptr; }
+	void erase(const K &p_key) { map.erase(p_key); }
+	uint32_t iterate() {
+		uint32_t count = 0;
+		for (const typename Map<K, V>::Element *E = map.front(); E; E = E->next()) {
+			count++;
+		}
+		return count;
+	}
+};
+
+template <class K, class V>
+struct BenchmarkFlatHashMap {
+	FlatHashMap<K, V> map;
+	void insert(const K &p_key, const V &p_value) { map.insert(p_key, p_value); }
+	bool lookup(const K &p_key) { return map.getptr(p_key) != nullptr; }
+	void erase(const K &p_key) { map.erase(p_key); }
+	uint32_t iterate() {
+		uint32_t count = 0;
+		for (const typename FlatHashMap<K, V>::Element *E = map.front(); E; E = E->next()) {
+			count++;
+		}
+		return count;
+	}
+};
+
+template <class B, class K>
+static void benchmark_map(const char *p_name, const BenchmarkKeys<K> &p_keys) {
+	const uint32_t lookup_rounds = 10;
+	B bench;
+	uint32_t found = 0;
+
+	uint64_t t0 = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < p_keys.present.size(); i++) {
+		bench.insert(p_keys.present[i], i);
+	}
+	uint64_t t1 = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t r = 0; r < lookup_rounds; r++) {
+		for (uint32_t i = 0; i < p_keys.present.size(); i++) {
+			found += bench.lookup(p_keys.present[i]);
+		}
+	}
+	uint64_t t2 = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t r = 0; r < lookup_rounds; r++) {
+		for (uint32_t i = 0; i < p_keys.missing.size(); i++) {
+			found += bench.lookup(p_keys.missing[i]);
+		}
+	}
+	uint64_t t3 = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t r = 0; r < lookup_rounds; r++) {
+		found += bench.iterate();
+	}
+	uint64_t t4 = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < p_keys.present.size(); i++) {
+		bench.erase(p_keys.present[i]);
+	}
+	uint64_t t5 = OS::get_singleton()->get_ticks_usec();
+
+	double count = p_keys.present.size();
+	String times = vformat("insert %.1f ns, hit %.1f ns, miss %.1f ns, iterate %.1f ns, erase %.1f ns.",
+			(t1 - t0) * 1000.0 / count, (t2 - t1) * 1000.0 / (count * lookup_rounds), (t3 - t2) * 1000.0 / (count * lookup_rounds),
+			(t4 - t3) * 1000.0 / (count * lookup_rounds), (t5 - t4) * 1000.0 / count);
+	print_line("  " + String(p_name).rpad(12) + times + " (" + itos(found) + " found)");
+}
+
+template <class K>
+static void benchmark_maps(const BenchmarkKeys<K> &p_keys) {
+	benchmark_map<BenchmarkHashMap<K, uint32_t, HashMap<K, uint32_t>>>("HashMap", p_keys);
+	benchmark_map<BenchmarkOAHashMap<K, uint32_t>>("OAHashMap", p_keys);
+	benchmark_map<BenchmarkMap<K, uint32_t>>("Map", p_keys);
+	benchmark_map<BenchmarkFlatHashMap<K, uint32_t>>("FlatHashMap", p_keys);
+}
+
+// Microbenchmark, run with `godot --test flat-hash-map-benchmark`.
+// Compares FlatHashMap with HashMap, OAHashMap and Map, with integer and StringName keys.
+static void benchmark() {
+	Ref<RandomNumberGenerator> rng;
+	rng.instance();
+	rng->set_seed(42);
+
+	for (uint32_t size = 100; size <= 1000000; size *= 100) {
+		BenchmarkKeys<int> int_keys;
+		for (uint32_t i = 0; i < size; i++) {
+			int_keys.present.push_back(rng->randi() & 0x7FFFFFFE);
+			int_keys.missing.push_back(rng->randi() | 1);
+		}
+		print_line(vformat("%d int keys:", size));
+		benchmark_maps(int_keys);
+	}
+
+	for (uint32_t size = 100; size <= 10000; size *= 10) {
+		BenchmarkKeys<StringName> name_keys;
+		for (uint32_t i = 0; i < size; i++) {
+			name_keys.present.push_back(StringName("benchmark_present_" + itos(i)));
+			name_keys.missing.push_back(StringName("benchmark_missing_" + itos(i)));
+		}
+		print_line(vformat("%d StringName keys:", size));
+		benchmark_maps(name_keys);
+	}
+}
+
+REGISTER_TEST_COMMAND("flat-hash-map-benchmark", &benchmark);
+
+} // namespace TestFlatHashMap
+
+#endif // TEST_FLAT_HASH_MAP_H
@@ -0,0 +1,204 @@
+/*************************************************************************/
+/*  test_frame_arena.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_FRAME_ARENA_H
+#define TEST_FRAME_ARENA_H
+
+#include "core/os/frame_arena.h"
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+
+#include "tests/test_macros.h"
+
+namespace TestFrameArena {
+
+TEST_CASE("[FrameArena] Allocations are aligned and distinct") {
+	FrameArena arena;
+
+	uint8_t *blocks[100];
+	for (uint32_t i = 0; i < 100; i++) {
+		blocks[i] = (uint8_t *)arena.alloc(i + 1);
+		memset(blocks[i], i, i + 1);
+	}
+
+	bool intact = true;
+	for (uint32_t i = 0; i < 100; i++) {
+		intact = intact && ((uintptr_t)blocks[i] & (FrameArena::ALIGNMENT - 1)) == 0;
+		for (uint32_t j = 0; j <= i; j++) {
+			intact = intact && blocks[i][j] == i;
+		}
+	}
+	CHECK_MESSAGE(intact, "Allocations should be aligned and not overlap.");
+	CHECK(arena.get_used() > 0);
+
+	arena.reset();
+	CHECK(arena.get_used() == 0);
+	CHECK(arena.get_stats().peak > 0);
+}
+
+TEST_CASE("[FrameArena] Free and realloc of the last allocation") {
+	FrameArena arena;
+
+	void *a = arena.alloc(32);
+	uint64_t used = arena.get_used();
+	void *b = arena.alloc(64);
+	arena.free(a);
+	CHECK_MESSAGE(arena.get_used() > used, "Freeing an allocation that isn't the last one should do nothing.");
+	arena.free(b);
+	CHECK(arena.get_used() == used);
+
+	uint8_t *c = (uint8_t *)arena.alloc(16);
+	for (uint32_t i = 0; i < 16; i++) {
+		c[i] = i;
+	}
+	uint8_t *grown = (uint8_t *)arena.realloc(c, 1024);
+	CHECK_MESSAGE(grown == c, "The last allocation should grow in place.");
+
+	arena.alloc(16);
+	uint8_t *moved = (uint8_t *)arena.realloc(grown, 2048);
+	CHECK(moved != grown);
+	bool intact = true;
+	for (uint32_t i = 0; i < 16; i++) {
+		intact = intact && moved[i] == i;
+	}
+	CHECK_MESSAGE(intact, "Contents should be kept when moved.");
+}
+
+TEST_CASE("[FrameArena] Scopes rewind") {
+	FrameArena arena;
+	arena.alloc(100);
+	uint64_t used = arena.get_used();
+
+	{
+		FrameArena::Scope scope(&arena);
+		arena.alloc(1000);
+		{
+			FrameArena::Scope inner(&arena);
+			// Larger than a block, forces new ones.
+			arena.alloc(FrameArena::MIN_BLOCK_SIZE * 2);
+		}
+		CHECK(arena.get_used() == used + 1024);
+	}
+	CHECK(arena.get_used() == used);
+
+	{
+		FrameArena::Scope scope(&arena);
+		ERR_PRINT_OFF;
+		arena.reset();
+		ERR_PRINT_ON;
+		CHECK_MESSAGE(arena.get_used() == used, "Reset should be refused while a scope is active.");
+	}
+}
+
+TEST_CASE("[FrameArena] Blocks are merged on reset") {
+	FrameArena arena;
+
+	for (uint32_t frame = 0; frame < 3; frame++) {
+		for (uint32_t i = 0; i < 64; i++) {
+			arena.alloc(16 * 1024);
+		}
+		arena.reset();
+	}
+	uint64_t block_allocations = arena.get_stats().block_allocations;
+	CHECK(arena.get_capacity() >= 64 * (16 * 1024 + FrameArena::ALIGNMENT));
+
+	for (uint32_t frame = 0; frame < 10; frame++) {
+		for (uint32_t i = 0; i < 64; i++) {
+			arena.alloc(16 * 1024);
+		}
+		arena.reset();
+	}
+	CHECK_MESSAGE(arena.get_stats().block_allocations == block_allocations, "Once warmed up, frames of the same size shouldn't allocate blocks.");
+}
+
+TEST_CASE("[FrameArena] Container adapters") {
+	FrameArena *arena = FrameArena::get_thread_arena();
+	FrameArena::Scope scope;
+	uint64_t used = arena->get_used();
+
+	{
+		FrameLocalVector<int> vector;
+		for (int i = 0; i < 1000; i++) {
+			vector.push_back(i);
+		}
+		CHECK(vector.size() == 1000);
+		CHECK(vector[999] == 999);
+		CHECK(arena->get_used() >= used + 1000 * sizeof(int));
+	}
+	CHECK_MESSAGE(arena->get_used() == used, "A vector that is the last allocation should give its memory back.");
+
+	FrameList<String> list;
+	list.push_back("a");
+	list.push_back("b");
+	list.push_front("c");
+	CHECK(list.size() == 3);
+	CHECK(list.front()->get() == "c");
+	CHECK(list.back()->get() == "b");
+	list.clear();
+	CHECK(list.is_empty());
+}
+
+// Microbenchmark, run with `godot --test frame-arena-benchmark`.
+// Fills short lived vectors from the frame arena and from the heap.
+static void benchmark() {
+	const uint32_t iterations = 100000;
+	const uint32_t elements = 64;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	uint64_t checksum = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		LocalVector<uint32_t> vector;
+		for (uint32_t j = 0; j < elements; j++) {
+			vector.push_back(i + j);
+		}
+		checksum += vector[elements - 1];
+	}
+	uint64_t heap_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < iterations; i++) {
+		FrameArena::Scope scope;
+		FrameLocalVector<uint32_t> vector;
+		for (uint32_t j = 0; j < elements; j++) {
+			vector.push_back(i + j);
+		}
+		checksum += vector[elements - 1];
+	}
+	uint64_t arena_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	print_line(vformat("FrameArena: %d vectors of %d elements (checksum %d).", iterations, elements, checksum));
+	print_line(vformat("  Heap %.1f ns, FrameArena %.1f ns per vector, %.2fx.", heap_usec * 1000.0 / iterations, arena_usec * 1000.0 / iterations, double(heap_usec) / arena_usec));
+}
+
+REGISTER_TEST_COMMAND("frame-arena-benchmark", &benchmark);
+
+} // namespace TestFrameArena
+
+#endif // TEST_FRAME_ARENA_H
@@ -161,6 +161,30 @@ TEST_CASE("[JSON] Parsing objects (dictionaries)") {
 			dictionary["empty_object"].hash() == Dictionary().hash(),
 			"The parsed JSON should contain the expected values.");
 }
+
+TEST_CASE("[JSON] Printing") {
+	Array array;
+	array.push_back(1);
+	array.push_back(2);
+	Dictionary dictionary;
+	dictionary["b"] = "x";
+	dictionary["a"] = array;
+	dictionary["c"] = Variant();
+
+	CHECK_MESSAGE(
+			JSON::print(dictionary) == R"({"a":[1,2],"b":"x","c":null})",
+			"Printing without indentation should produce compact JSON with sorted keys.");
+	CHECK_MESSAGE(
+			JSON::print(dictionary, "\t") == "{\n\t\"a\": [\n\t\t1,\n\t\t2\n\t],\n\t\"b\": \"x\",\n\t\"c\": null\n}",
+			"Printing with indentation should put every value on its own line.");
+
+	StringStream stream;
+	stream += "JSON: ";
+	JSON::print_to_stream(array, stream);
+	CHECK_MESSAGE(
+			stream.as_string() == "JSON: [1,2]",
+			"Printing to a stream should append to what it already contains.");
+}
 } // namespace TestJSON
 
 #endif // TEST_JSON_H
@@ -45,6 +45,8 @@
 #include "test_dictionary.h"
 #include "test_expression.h"
 #include "test_file_access.h"
+#include "test_flat_hash_map.h"
+#include "test_frame_arena.h"
 #include "test_geometry_2d.h"
 #include "test_geometry_3d.h"
 #include "test_gradient.h"
@@ -57,26 +59,38 @@
 #include "test_lru.h"
 #include "test_marshalls.h"
 #include "test_math.h"
+#include "test_math_batch.h"
+#include "test_message_queue.h"
 #include "test_method_bind.h"
 #include "test_node_path.h"
 #include "test_oa_hash_map.h"
 #include "test_object.h"
 #include "test_ordered_hash_map.h"
+#include "test_packed_scene.h"
+#include "test_packed_struct_array.h"
 #include "test_paged_array.h"
 #include "test_path_3d.h"
 #include "test_pck_packer.h"
+#include "test_perfect_hash_map.h"
 #include "test_physics_2d.h"
 #include "test_physics_3d.h"
 #include "test_random_number_generator.h"
 #include "test_rect2.h"
 #include "test_render.h"
 #include "test_resource.h"
+#include "test_rid_owner.h"
 #include "test_shader_lang.h"
+#include "test_small_object_allocator.h"
 #include "test_string.h"
+#include "test_string_name.h"
+#include "test_string_stream.h"
+#include "test_task_scheduler.h"
 #include "test_text_server.h"
+#include "test_thread_work_pool.h"
 #include "test_translation.h"
 #include "test_validate_testing.h"
 #include "test_variant.h"
+#include "test_variant_call_site.h"
 #include "test_vector.h"
 #include "test_xml_parser.h"
 
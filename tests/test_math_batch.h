@@ -0,0 +1,276 @@
+/*************************************************************************/
+/*  test_math_batch.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_MATH_BATCH_H
+#define TEST_MATH_BATCH_H
+
+#include "core/math/math_batch.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/templates/local_vector.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMathBatch {
+
+static Vector3 random_vector3(RandomPCG &p_rng) {
+	return Vector3(p_rng.random(-10.0f, 10.0f), p_rng.random(-10.0f, 10.0f), p_rng.random(-10.0f, 10.0f));
+}
+
+static Transform random_transform(RandomPCG &p_rng) {
+	return Transform(Basis(random_vector3(p_rng), random_vector3(p_rng), random_vector3(p_rng)), random_vector3(p_rng));
+}
+
+// The reference the boxes are culled against, one plane at a time.
+static bool is_box_inside_planes(const LocalVector<Plane> &p_planes, const real_t *p_min_max) {
+	for (uint32_t i = 0; i < p_planes.size(); i++) {
+		const Vector3 &normal = p_planes[i].normal;
+		Vector3 corner(
+				normal.x > 0 ? p_min_max[0] : p_min_max[3],
+				normal.y > 0 ? p_min_max[1] : p_min_max[4],
+				normal.z > 0 ? p_min_max[2] : p_min_max[5]);
+		if (p_planes[i].distance_to(corner) >= 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[MathBatch] Transform points") {
+	RandomPCG rng(7);
+	const Transform xform = random_transform(rng);
+
+	// Counts around the 4 points processed at once.
+	const int counts[] = { 0, 1, 3, 4, 5, 8, 13, 100 };
+	for (int count : counts) {
+		LocalVector<Vector3> points;
+		LocalVector<Vector3> result;
+		points.resize(count);
+		result.resize(count);
+		for (int i = 0; i < count; i++) {
+			points[i] = random_vector3(rng);
+		}
+
+		MathBatch::xform_points(xform, points.ptr(), result.ptr(), count);
+		for (int i = 0; i < count; i++) {
+			CHECK(result[i].is_equal_approx(xform.xform(points[i])));
+		}
+
+		LocalVector<Vector3> in_place = points;
+		MathBatch::xform_points(xform, in_place.ptr(), in_place.ptr(), count);
+		for (int i = 0; i < count; i++) {
+			CHECK(in_place[i].is_equal_approx(result[i]));
+		}
+	}
+}
+
+TEST_CASE("[MathBatch] Transform points inside structs") {
+	struct Particle {
+		Vector3 position;
+		Vector3 velocity;
+		real_t mass = 0;
+	};
+
+	RandomPCG rng(11);
+	const Transform xform = random_transform(rng);
+	LocalVector<Particle> particles;
+	particles.resize(10);
+	for (uint32_t i = 0; i < particles.size(); i++) {
+		particles[i].position = random_vector3(rng);
+		particles[i].velocity = Vector3(1, 2, 3);
+		particles[i].mass = 4;
+	}
+	const LocalVector<Particle> source = particles;
+
+	MathBatch::xform_points(xform, &particles[0].position, &particles[0].position, particles.size(), sizeof(Particle));
+	for (uint32_t i = 0; i < particles.size(); i++) {
+		CHECK(particles[i].position.is_equal_approx(xform.xform(source[i].position)));
+		CHECK_MESSAGE(particles[i].velocity == Vector3(1, 2, 3), "Other members should be left untouched.");
+		CHECK(particles[i].mass == 4);
+	}
+}
+
+TEST_CASE("[MathBatch] Multiply transforms") {
+	RandomPCG rng(13);
+	LocalVector<Transform> a;
+	LocalVector<Transform> b;
+	LocalVector<Transform> result;
+	a.resize(9);
+	b.resize(9);
+	result.resize(9);
+	for (int i = 0; i < 9; i++) {
+		a[i] = random_transform(rng);
+		b[i] = random_transform(rng);
+	}
+
+	MathBatch::multiply_transforms(a.ptr(), b.ptr(), result.ptr(), 9);
+	for (int i = 0; i < 9; i++) {
+		CHECK(result[i].is_equal_approx(a[i] * b[i]));
+	}
+
+	MathBatch::multiply_transforms(a[0], b.ptr(), result.ptr(), 9);
+	for (int i = 0; i < 9; i++) {
+		CHECK(result[i].is_equal_approx(a[0] * b[i]));
+	}
+
+	// The result can be one of the operands.
+	Transform in_place = a[1];
+	MathBatch::multiply_transform(in_place, b[1], in_place);
+	CHECK(in_place.is_equal_approx(a[1] * b[1]));
+	in_place = b[2];
+	MathBatch::multiply_transform(a[2], in_place, in_place);
+	CHECK(in_place.is_equal_approx(a[2] * b[2]));
+}
+
+TEST_CASE("[MathBatch] Cull boxes") {
+	RandomPCG rng(17);
+	// Plane counts which fill blocks partially and completely.
+	const int plane_counts[] = { 1, 4, 6, 9 };
+	for (int plane_count : plane_counts) {
+		LocalVector<Plane> planes;
+		for (int i = 0; i < plane_count; i++) {
+			Vector3 normal = random_vector3(rng);
+			if (i == 0) {
+				normal.x = 0; // Zero components use the maximum coordinate.
+			}
+			planes.push_back(Plane(normal.normalized(), rng.random(0.0f, 20.0f)));
+		}
+
+		LocalVector<MathBatch::PlaneBlock> blocks;
+		blocks.resize(MathBatch::get_plane_block_count(plane_count));
+		MathBatch::make_plane_blocks(planes.ptr(), plane_count, blocks.ptr());
+
+		const int box_count = 500;
+		LocalVector<real_t> boxes;
+		for (int i = 0; i < box_count; i++) {
+			const Vector3 position = random_vector3(rng);
+			const Vector3 end = position + Vector3(rng.randf(), rng.randf(), rng.randf()) * 4;
+			boxes.push_back(position.x);
+			boxes.push_back(position.y);
+			boxes.push_back(position.z);
+			boxes.push_back(end.x);
+			boxes.push_back(end.y);
+			boxes.push_back(end.z);
+		}
+
+		LocalVector<uint8_t> inside;
+		inside.resize(box_count);
+		MathBatch::cull_boxes(blocks.ptr(), blocks.size(), boxes.ptr(), box_count, inside.ptr());
+		for (int i = 0; i < box_count; i++) {
+			CHECK(bool(inside[i]) == is_box_inside_planes(planes, &boxes[i * 6]));
+		}
+	}
+}
+
+// Microbenchmark, run with `godot --test math-batch-benchmark`.
+static void math_batch_benchmark() {
+	const int count = 4096;
+	const int rounds = 1000;
+	RandomPCG rng(19);
+
+	LocalVector<Vector3> points;
+	LocalVector<Vector3> points_result;
+	LocalVector<Transform> xforms;
+	LocalVector<Transform> xforms_result;
+	LocalVector<real_t> boxes;
+	LocalVector<uint8_t> inside;
+	points.resize(count);
+	points_result.resize(count);
+	xforms.resize(count);
+	xforms_result.resize(count);
+	inside.resize(count);
+	for (int i = 0; i < count; i++) {
+		points[i] = random_vector3(rng);
+		xforms[i] = random_transform(rng);
+		const Vector3 position = random_vector3(rng) * 5;
+		boxes.push_back(position.x);
+		boxes.push_back(position.y);
+		boxes.push_back(position.z);
+		boxes.push_back(position.x + 1);
+		boxes.push_back(position.y + 1);
+		boxes.push_back(position.z + 1);
+	}
+
+	const Transform xform = random_transform(rng);
+	LocalVector<Plane> planes;
+	for (int i = 0; i < 6; i++) {
+		planes.push_back(Plane(random_vector3(rng).normalized(), 20));
+	}
+	MathBatch::PlaneBlock blocks[2];
+	MathBatch::make_plane_blocks(planes.ptr(), planes.size(), blocks);
+
+	// The scalar loops are what the callers did before, one element at a time.
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) {
+			points_result[i] = xform.xform(points[i]);
+		}
+	}
+	uint64_t scalar_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		MathBatch::xform_points(xform, points.ptr(), points_result.ptr(), count);
+	}
+	uint64_t batch_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	print_line(vformat("xform_points: scalar %.2f ns, batch %.2f ns per point.", scalar_usec * 1000.0 / (count * rounds), batch_usec * 1000.0 / (count * rounds)));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) {
+			xforms_result[i] = xform * xforms[i];
+		}
+	}
+	scalar_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		MathBatch::multiply_transforms(xform, xforms.ptr(), xforms_result.ptr(), count);
+	}
+	batch_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	print_line(vformat("multiply_transforms: scalar %.2f ns, batch %.2f ns per transform.", scalar_usec * 1000.0 / (count * rounds), batch_usec * 1000.0 / (count * rounds)));
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) {
+			inside[i] = is_box_inside_planes(planes, &boxes[i * 6]);
+		}
+	}
+	scalar_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		MathBatch::cull_boxes(blocks, 2, boxes.ptr(), count, inside.ptr());
+	}
+	batch_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	print_line(vformat("cull_boxes: scalar %.2f ns, batch %.2f ns per box.", scalar_usec * 1000.0 / (count * rounds), batch_usec * 1000.0 / (count * rounds)));
+}
+
+REGISTER_TEST_COMMAND("math-batch-benchmark", &math_batch_benchmark);
+
+} // namespace TestMathBatch
+
+#endif // TEST_MATH_BATCH_H
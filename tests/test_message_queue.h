@@ -0,0 +1,250 @@
+/*************************************************************************/
+/*  test_message_queue.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESSAGE_QUEUE_H
+#define TEST_MESSAGE_QUEUE_H
+
+#include "core/io/resource.h"
+#include "core/object/message_queue.h"
+#include "core/os/thread.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMessageQueue {
+
+class DeferredTarget : public Object {
+public:
+	int calls = 0;
+	LocalVector<int> values;
+
+	void increment() {
+		calls++;
+	}
+
+	void add_value(int p_value) {
+		values.push_back(p_value);
+	}
+};
+
+// Tests don't set up the main loop, so there is no queue unless one is created.
+class QueueScope {
+	MessageQueue *queue = nullptr;
+
+public:
+	MessageQueue *get() const { return MessageQueue::get_singleton(); }
+
+	QueueScope() {
+		if (!MessageQueue::get_singleton()) {
+			queue = memnew(MessageQueue);
+		}
+		MessageQueue::get_singleton()->flush();
+	}
+
+	~QueueScope() {
+		if (queue) {
+			memdelete(queue);
+		}
+	}
+};
+
+TEST_CASE("[MessageQueue] Identical calls are coalesced") {
+	QueueScope scope;
+	DeferredTarget target;
+
+	for (int i = 0; i < 10; i++) {
+		scope.get()->push_callable(callable_mp(&target, &DeferredTarget::increment));
+	}
+	scope.get()->push_callable(callable_mp(&target, &DeferredTarget::add_value), 1);
+	scope.get()->push_callable(callable_mp(&target, &DeferredTarget::add_value), 1);
+	scope.get()->push_callable(callable_mp(&target, &DeferredTarget::add_value), 2);
+	scope.get()->push_callable(callable_mp(&target, &DeferredTarget::add_value), 1);
+
+	CHECK(target.calls == 0);
+	scope.get()->flush();
+
+	CHECK_MESSAGE(target.calls == 1, "Repeated calls should run once.");
+	REQUIRE(target.values.size() == 3);
+	CHECK(target.values[0] == 1);
+	CHECK(target.values[1] == 2);
+	CHECK_MESSAGE(target.values[2] == 1, "Calls queued after another call for the same object should not be coalesced.");
+
+	scope.get()->push_callable(callable_mp(&target, &DeferredTarget::increment));
+	scope.get()->flush();
+	CHECK_MESSAGE(target.calls == 2, "Calls should not be coalesced with ones from an earlier flush.");
+}
+
+TEST_CASE("[MessageQueue] Repeated sets are coalesced") {
+	QueueScope scope;
+	Ref<Resource> resource;
+	resource.instance();
+
+	scope.get()->push_set(resource.ptr(), "resource_name", "first");
+	scope.get()->push_set(resource.ptr(), "resource_name", "second");
+	scope.get()->push_set(resource.ptr(), "resource_path", "");
+	scope.get()->push_set(resource.ptr(), "resource_name", "third");
+
+	CHECK(resource->get_name() == "");
+	scope.get()->flush();
+	CHECK(resource->get_name() == "third");
+}
+
+class NamedTarget : public Resource {
+public:
+	LocalVector<String> seen;
+
+	void record_name() {
+		seen.push_back(get_name());
+	}
+};
+
+TEST_CASE("[MessageQueue] Sets are not coalesced past other messages") {
+	QueueScope scope;
+	Ref<NamedTarget> target;
+	target.instance();
+
+	scope.get()->push_set(target.ptr(), "resource_name", "first");
+	scope.get()->push_callable(callable_mp(target.ptr(), &NamedTarget::record_name));
+	scope.get()->push_set(target.ptr(), "resource_name", "second");
+	scope.get()->flush();
+
+	REQUIRE(target->seen.size() == 1);
+	CHECK_MESSAGE(target->seen[0] == "first", "A call queued between two sets should see the first value.");
+	CHECK(target->get_name() == "second");
+}
+
+TEST_CASE("[MessageQueue] Deferred signals are never coalesced") {
+	QueueScope scope;
+	DeferredTarget target;
+	target.add_user_signal(MethodInfo("ping"));
+	target.connect("ping", callable_mp(&target, &DeferredTarget::increment), Vector<Variant>(), Object::CONNECT_DEFERRED);
+
+	target.emit_signal("ping");
+	target.emit_signal("ping");
+	CHECK(target.calls == 0);
+	scope.get()->flush();
+	CHECK_MESSAGE(target.calls == 2, "Every deferred emission should be delivered.");
+}
+
+TEST_CASE("[MessageQueue] Grows past a single page") {
+	QueueScope scope;
+	DeferredTarget target;
+
+	const int count = 100000;
+	for (int i = 0; i < count; i++) {
+		scope.get()->push_callable(callable_mp(&target, &DeferredTarget::add_value), i);
+	}
+	scope.get()->flush();
+
+	REQUIRE(target.values.size() == count);
+	bool in_order = true;
+	for (int i = 0; i < count; i++) {
+		if (target.values[i] != i) {
+			in_order = false;
+			break;
+		}
+	}
+	CHECK_MESSAGE(in_order, "Messages should be called in push order.");
+	CHECK(scope.get()->get_max_buffer_usage() > 64 * 1024);
+}
+
+struct PushThreadData {
+	DeferredTarget *target = nullptr;
+	int first_value = 0;
+	int count = 0;
+};
+
+static void push_values(void *p_userdata) {
+	PushThreadData *data = (PushThreadData *)p_userdata;
+	for (int i = 0; i < data->count; i++) {
+		MessageQueue::get_singleton()->push_callable(callable_mp(data->target, &DeferredTarget::add_value), data->first_value + i);
+	}
+}
+
+TEST_CASE("[MessageQueue] Messages pushed by other threads") {
+	QueueScope scope;
+	DeferredTarget target;
+
+	const int thread_count = 4;
+	const int count = 5000;
+	PushThreadData data[thread_count];
+	Thread threads[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		data[i].target = &target;
+		data[i].first_value = i * count;
+		data[i].count = count;
+		threads[i].start(push_values, &data[i]);
+	}
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].wait_to_finish();
+	}
+	scope.get()->flush();
+
+	REQUIRE(target.values.size() == thread_count * count);
+	int last[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		last[i] = -1;
+	}
+	bool in_order = true;
+	for (uint32_t i = 0; i < target.values.size(); i++) {
+		int thread = target.values[i] / count;
+		if (target.values[i] <= last[thread]) {
+			in_order = false;
+		}
+		last[thread] = target.values[i];
+	}
+	CHECK_MESSAGE(in_order, "Messages of each thread should be called in push order.");
+	for (int i = 0; i < thread_count; i++) {
+		CHECK(last[i] == (i + 1) * count - 1);
+	}
+}
+
+TEST_CASE("[MessageQueue] Statistics") {
+	QueueScope scope;
+	DeferredTarget target;
+
+	scope.get()->update_stats();
+	for (int i = 0; i < 3; i++) {
+		scope.get()->push_callable(callable_mp(&target, &DeferredTarget::increment));
+	}
+	for (int i = 0; i < 3; i++) {
+		scope.get()->push_callable(callable_mp(&target, &DeferredTarget::add_value), i);
+	}
+	scope.get()->flush();
+	scope.get()->update_stats();
+
+	MessageQueue::Stats stats = scope.get()->get_stats();
+	CHECK(stats.messages == 4);
+	CHECK(stats.coalesced == 2);
+	CHECK(stats.bytes > 0);
+}
+
+} // namespace TestMessageQueue
+
+#endif // TEST_MESSAGE_QUEUE_H
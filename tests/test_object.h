@@ -33,8 +33,9 @@
 
 #include "core/core_string_names.h"
 #include "core/object/object.h"
+#include "core/os/os.h"
 
-#include "thirdparty/doctest/doctest.h"
+#include "tests/test_macros.h"
 
 // Declared in global namespace because of GDCLASS macro warning (Windows):
 // "Unqualified friend declaration referring to type outside of the nearest enclosing namespace
@@ -56,6 +57,49 @@ public:
 	int get_property() const { return property_value; }
 };
 
+class _TestSignalReceiver : public Object {
+	GDCLASS(_TestSignalReceiver, Object);
+
+protected:
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("add_int", "value"), &_TestSignalReceiver::add_int);
+		ClassDB::bind_method(D_METHOD("add_variant", "value"), &_TestSignalReceiver::add_variant);
+		ClassDB::bind_method(D_METHOD("add_returning", "value"), &_TestSignalReceiver::add_returning);
+		ClassDB::bind_method(D_METHOD("add_with_bind", "value", "bound"), &_TestSignalReceiver::add_with_bind);
+		ClassDB::bind_method(D_METHOD("disconnect_other", "value"), &_TestSignalReceiver::disconnect_other);
+	}
+
+public:
+	int64_t sum = 0;
+	int calls = 0;
+	Object *emitter = nullptr;
+	Callable other;
+
+	void add_int(int p_value) {
+		sum += p_value;
+		calls++;
+	}
+	void add_variant(const Variant &p_value) {
+		sum += int64_t(p_value);
+		calls++;
+	}
+	int add_returning(int p_value) {
+		sum += p_value;
+		calls++;
+		return sum;
+	}
+	void add_with_bind(int p_value, int p_bound) {
+		sum += p_value * p_bound;
+		calls++;
+	}
+	void disconnect_other(int p_value) {
+		calls++;
+		if (emitter->is_connected("fired", other)) {
+			emitter->disconnect("fired", other);
+		}
+	}
+};
+
 namespace TestObject {
 
 class _MockScriptInstance : public ScriptInstance {
@@ -300,6 +344,140 @@ TEST_CASE("[Object] Absent name getter") {
 			actual_value == Variant(),
 			"The returned value should equal nil variant.");
 }
+
+TEST_CASE("[Object] Batched property setter") {
+	ClassDB::register_class<_TestDerivedObject>();
+	_TestDerivedObject derived_object;
+	derived_object.set_property(0);
+
+	Dictionary metadata;
+	metadata["key"] = "value";
+
+	Dictionary properties;
+	properties["property"] = 100;
+	properties["absent_name"] = 1;
+	properties[CoreStringNames::get_singleton()->_meta] = metadata;
+	derived_object.set_properties(properties);
+
+	CHECK_MESSAGE(
+			derived_object.get_property() == 100,
+			"The property value should equal the one which was set with built-in setter.");
+	CHECK_MESSAGE(
+			derived_object.get_meta("key") == Variant("value"),
+			"Properties after an absent one should still be set.");
+
+	// Converted by the setter, as set() does.
+	properties.clear();
+	properties["property"] = 42.0;
+	derived_object.set_properties(properties);
+	CHECK(derived_object.get_property() == 42);
+}
+
+TEST_CASE("[Object] Batched property getter") {
+	ClassDB::register_class<_TestDerivedObject>();
+	_TestDerivedObject derived_object;
+	derived_object.set_property(100);
+	derived_object.set_meta("key", "value");
+
+	PackedStringArray names;
+	names.push_back("property");
+	names.push_back("absent_name");
+	names.push_back(CoreStringNames::get_singleton()->_meta);
+	names.push_back("get_property");
+	const Dictionary properties = derived_object.get_properties(names);
+
+	CHECK(properties.size() == 4);
+	CHECK(properties["property"] == Variant(100));
+	CHECK(properties["absent_name"] == Variant());
+	CHECK(Dictionary(properties[CoreStringNames::get_singleton()->_meta]).has("key"));
+	CHECK(properties["get_property"].get_type() == Variant::CALLABLE);
+	CHECK(derived_object.get_properties(PackedStringArray()).is_empty());
+}
+
+TEST_CASE("[Object] Signal dispatch") {
+	ClassDB::register_class<_TestSignalReceiver>();
+
+	Object emitter;
+	emitter.add_user_signal(MethodInfo("fired", PropertyInfo(Variant::INT, "value")));
+	_TestSignalReceiver receiver;
+
+	emitter.connect("fired", Callable(&receiver, "add_int"));
+	emitter.connect("fired", Callable(&receiver, "add_variant"));
+	emitter.connect("fired", Callable(&receiver, "add_returning"));
+	emitter.connect("fired", Callable(&receiver, "add_with_bind"), varray(10));
+
+	emitter.emit_signal("fired", 2);
+	CHECK(receiver.calls == 4);
+	CHECK(receiver.sum == 2 + 2 + 2 + 20);
+
+	// Doesn't have the type add_int() takes, so it has to be converted.
+	emitter.emit_signal("fired", 1.5);
+	CHECK(receiver.calls == 8);
+	CHECK(receiver.sum == 26 + 1 + 1 + 1 + 10);
+
+	emitter.disconnect("fired", Callable(&receiver, "add_variant"));
+	emitter.emit_signal("fired", 1);
+	CHECK_MESSAGE(receiver.calls == 11, "Disconnected methods should no longer be called.");
+}
+
+TEST_CASE("[Object] Signal connections changed while emitting") {
+	ClassDB::register_class<_TestSignalReceiver>();
+
+	Object emitter;
+	emitter.add_user_signal(MethodInfo("fired", PropertyInfo(Variant::INT, "value")));
+	_TestSignalReceiver first;
+	_TestSignalReceiver second;
+	first.emitter = &emitter;
+	first.other = Callable(&second, "add_int");
+
+	emitter.connect("fired", Callable(&first, "disconnect_other"));
+	emitter.connect("fired", Callable(&second, "add_int"));
+
+	emitter.emit_signal("fired", 1);
+	CHECK(first.calls == 1);
+	CHECK_MESSAGE(second.calls == 1, "Targets disconnected during an emit should be called once by it.");
+
+	emitter.emit_signal("fired", 1);
+	CHECK(first.calls == 2);
+	CHECK(second.calls == 1);
+
+	emitter.disconnect("fired", Callable(&first, "disconnect_other"));
+	emitter.connect("fired", Callable(&second, "add_int"), Vector<Variant>(), Object::CONNECT_ONESHOT);
+	emitter.emit_signal("fired", 1);
+	emitter.emit_signal("fired", 1);
+	CHECK(second.calls == 2);
+	CHECK_FALSE(emitter.is_connected("fired", Callable(&second, "add_int")));
+}
+
+// Microbenchmark, run with `godot --test signal-benchmark`.
+static void signal_benchmark() {
+	ClassDB::register_class<_TestSignalReceiver>();
+
+	const int emits = 1000000;
+	const char *methods[] = { "add_int", "add_variant", "add_returning" };
+
+	for (int i = 0; i < 3; i++) {
+		Object emitter;
+		emitter.add_user_signal(MethodInfo("fired", PropertyInfo(Variant::INT, "value")));
+		_TestSignalReceiver receivers[4];
+		for (int j = 0; j < 4; j++) {
+			emitter.connect("fired", Callable(&receivers[j], methods[i]));
+		}
+
+		Variant value = 1;
+		const Variant *args[1] = { &value };
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int j = 0; j < emits; j++) {
+			emitter.emit_signal("fired", args, 1);
+		}
+		uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+
+		print_line(vformat("Signal with 4 connections to %s(): %.1f ns per emit.", methods[i], usec * 1000.0 / emits));
+	}
+}
+
+REGISTER_TEST_COMMAND("signal-benchmark", &signal_benchmark);
+
 } // namespace TestObject
 
 #endif // TEST_OBJECT_H
@@ -0,0 +1,288 @@
+/*************************************************************************/
+/*  test_packed_scene.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PACKED_SCENE_H
+#define TEST_PACKED_SCENE_H
+
+#include "core/object/class_db.h"
+#include "core/object/script_language.h"
+#include "scene/2d/node_2d.h"
+#include "scene/resources/packed_scene.h"
+
+#include "tests/test_macros.h"
+
+// Declared in global namespace because of GDCLASS macro warning (Windows).
+class _TestPackedSceneNode : public Node {
+	GDCLASS(_TestPackedSceneNode, Node);
+
+	int value = 0;
+	int dynamic = 0;
+
+protected:
+	// Not a ClassDB property, so it has no setter to resolve.
+	bool _set(const StringName &p_name, const Variant &p_value) {
+		if (p_name == "dynamic") {
+			dynamic = p_value;
+			return true;
+		}
+		return false;
+	}
+	bool _get(const StringName &p_name, Variant &r_ret) const {
+		if (p_name == "dynamic") {
+			r_ret = dynamic;
+			return true;
+		}
+		return false;
+	}
+	void _get_property_list(List<PropertyInfo> *p_list) const {
+		p_list->push_back(PropertyInfo(Variant::INT, "dynamic"));
+	}
+
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("set_value", "value"), &_TestPackedSceneNode::set_value);
+		ClassDB::bind_method(D_METHOD("get_value"), &_TestPackedSceneNode::get_value);
+		ADD_PROPERTY(PropertyInfo(Variant::INT, "value"), "set_value", "get_value");
+	}
+
+public:
+	void set_value(int p_value) { value = p_value; }
+	int get_value() const { return value; }
+	int get_dynamic() const { return dynamic; }
+};
+
+// Script instance which overrides the "value" property, like a script with a setter would.
+class _TestPackedSceneScriptInstance : public ScriptInstance {
+public:
+	Variant value;
+
+	bool set(const StringName &p_name, const Variant &p_value) override {
+		if (p_name == "value") {
+			value = p_value;
+			return true;
+		}
+		return false;
+	}
+	bool get(const StringName &p_name, Variant &r_ret) const override {
+		if (p_name == "value") {
+			r_ret = value;
+			return true;
+		}
+		return false;
+	}
+	void get_property_list(List<PropertyInfo> *p_properties) const override {
+	}
+	Variant::Type get_property_type(const StringName &p_name, bool *r_is_valid) const override {
+		return Variant::INT;
+	}
+	void get_method_list(List<MethodInfo> *p_list) const override {
+	}
+	bool has_method(const StringName &p_method) const override {
+		return false;
+	}
+	Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, Callable::CallError &r_error) override {
+		return Variant();
+	}
+	void notification(int p_notification) override {
+	}
+	Ref<Script> get_script() const override {
+		return Ref<Script>();
+	}
+	Vector<ScriptNetData> get_rpc_methods() const override {
+		return Vector<ScriptNetData>();
+	}
+	uint16_t get_rpc_method_id(const StringName &p_method) const override {
+		return 0;
+	}
+	StringName get_rpc_method(uint16_t p_id) const override {
+		return StringName();
+	}
+	MultiplayerAPI::RPCMode get_rpc_mode_by_id(uint16_t p_id) const override {
+		return MultiplayerAPI::RPC_MODE_PUPPET;
+	}
+	MultiplayerAPI::RPCMode get_rpc_mode(const StringName &p_method) const override {
+		return MultiplayerAPI::RPC_MODE_PUPPET;
+	}
+	Vector<ScriptNetData> get_rset_properties() const override {
+		return Vector<ScriptNetData>();
+	}
+	uint16_t get_rset_property_id(const StringName &p_variable) const override {
+		return 0;
+	}
+	StringName get_rset_property(uint16_t p_id) const override {
+		return StringName();
+	}
+	MultiplayerAPI::RPCMode get_rset_mode_by_id(uint16_t p_id) const override {
+		return MultiplayerAPI::RPC_MODE_PUPPET;
+	}
+	MultiplayerAPI::RPCMode get_rset_mode(const StringName &p_variable) const override {
+		return MultiplayerAPI::RPC_MODE_PUPPET;
+	}
+	ScriptLanguage *get_language() override {
+		return nullptr;
+	}
+};
+
+class _TestPackedSceneScriptedNode : public _TestPackedSceneNode {
+	GDCLASS(_TestPackedSceneScriptedNode, _TestPackedSceneNode);
+
+public:
+	_TestPackedSceneScriptInstance *get_test_script_instance() const {
+		return static_cast<_TestPackedSceneScriptInstance *>(get_script_instance());
+	}
+
+	_TestPackedSceneScriptedNode() {
+		set_script_instance(memnew(_TestPackedSceneScriptInstance));
+	}
+};
+
+namespace TestPackedScene {
+
+static Node *make_scene(const Vector2 &p_position) {
+	Node2D *root = memnew(Node2D);
+	root->set_name("Root");
+
+	Node2D *child = memnew(Node2D);
+	child->set_name("Child");
+	child->set_position(p_position);
+	child->set_rotation(0.5);
+	child->set_z_index(3);
+	root->add_child(child);
+	child->set_owner(root);
+
+	Node *logic = memnew(Node);
+	logic->set_name("Logic");
+	child->add_child(logic);
+	logic->set_owner(root);
+
+	Vector<Variant> binds;
+	binds.push_back("hits");
+	binds.push_back(5);
+	logic->connect("renamed", Callable(root, "set_meta"), binds, Object::CONNECT_PERSIST);
+
+	return root;
+}
+
+TEST_CASE("[PackedScene] Instancing repeatedly") {
+	// Scenes are only compiled while the class tables are sealed.
+	ClassDB::seal();
+	REQUIRE(ClassDB::is_sealed());
+
+	Node *scene = make_scene(Vector2(10, 20));
+	Ref<PackedScene> packed = memnew(PackedScene);
+	REQUIRE(packed->pack(scene) == OK);
+	memdelete(scene);
+
+	// The first instance compiles the scene, later ones reuse what was resolved.
+	for (int i = 0; i < 3; i++) {
+		Node *instance = packed->instance();
+		REQUIRE(instance);
+		CHECK(instance->get_class() == "Node2D");
+		CHECK(instance->get_name() == "Root");
+
+		Node2D *child = Object::cast_to<Node2D>(instance->get_node_or_null(NodePath("Child")));
+		REQUIRE(child);
+		CHECK(child->get_owner() == instance);
+		CHECK(child->get_position() == Vector2(10, 20));
+		CHECK(child->get_rotation() == doctest::Approx(0.5));
+		CHECK(child->get_z_index() == 3);
+
+		Node *logic = instance->get_node_or_null(NodePath("Child/Logic"));
+		REQUIRE(logic);
+		CHECK(logic->get_class() == "Node");
+
+		logic->emit_signal("renamed");
+		CHECK_MESSAGE(int(instance->get_meta("hits")) == 5, "The connection should have been made with its binds.");
+
+		memdelete(instance);
+	}
+
+	// Packing again replaces what was compiled.
+	scene = make_scene(Vector2(-4, 8));
+	REQUIRE(packed->pack(scene) == OK);
+	memdelete(scene);
+
+	Node *instance = packed->instance();
+	REQUIRE(instance);
+	Node2D *child = Object::cast_to<Node2D>(instance->get_node_or_null(NodePath("Child")));
+	REQUIRE(child);
+	CHECK(child->get_position() == Vector2(-4, 8));
+	memdelete(instance);
+
+	CHECK(ClassDB::is_sealed());
+}
+
+TEST_CASE("[PackedScene] Instancing falls back to Object::set() when setters can't be resolved") {
+	ClassDB::register_class<_TestPackedSceneNode>();
+	ClassDB::register_class<_TestPackedSceneScriptedNode>();
+	ClassDB::seal();
+	REQUIRE(ClassDB::is_sealed());
+
+	Node *scene = memnew(Node);
+	scene->set_name("Root");
+
+	_TestPackedSceneNode *plain = memnew(_TestPackedSceneNode);
+	plain->set_name("Plain");
+	plain->set_value(3);
+	plain->set("dynamic", 4);
+	scene->add_child(plain);
+	plain->set_owner(scene);
+
+	_TestPackedSceneScriptedNode *scripted = memnew(_TestPackedSceneScriptedNode);
+	scripted->set_name("Scripted");
+	scripted->set("value", 5);
+	scene->add_child(scripted);
+	scripted->set_owner(scene);
+
+	Ref<PackedScene> packed = memnew(PackedScene);
+	REQUIRE(packed->pack(scene) == OK);
+	memdelete(scene);
+
+	for (int i = 0; i < 2; i++) {
+		REQUIRE(ClassDB::is_sealed());
+		Node *instance = packed->instance();
+		REQUIRE(instance);
+
+		_TestPackedSceneNode *plain_instance = Object::cast_to<_TestPackedSceneNode>(instance->get_node_or_null(NodePath("Plain")));
+		REQUIRE(plain_instance);
+		CHECK(plain_instance->get_value() == 3);
+		CHECK_MESSAGE(plain_instance->get_dynamic() == 4, "Properties without a ClassDB setter should be set with Object::set().");
+
+		_TestPackedSceneScriptedNode *scripted_instance = Object::cast_to<_TestPackedSceneScriptedNode>(instance->get_node_or_null(NodePath("Scripted")));
+		REQUIRE(scripted_instance);
+		CHECK_MESSAGE(int(scripted_instance->get_test_script_instance()->value) == 5, "The script instance should get to override the property.");
+		CHECK_MESSAGE(scripted_instance->get_value() == 0, "The resolved setter should be skipped for nodes with a script instance.");
+
+		memdelete(instance);
+	}
+}
+
+} // namespace TestPackedScene
+
+#endif // TEST_PACKED_SCENE_H
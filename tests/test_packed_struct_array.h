@@ -0,0 +1,150 @@
+/*************************************************************************/
+/*  test_packed_struct_array.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_PACKED_STRUCT_ARRAY_H
+#define TEST_PACKED_STRUCT_ARRAY_H
+
+#include "core/variant/packed_struct_array.h"
+
+#include "tests/test_macros.h"
+
+namespace TestPackedStructArray {
+
+TEST_CASE("[PackedStructArray] Schema") {
+	Ref<PackedStructArray> data;
+	data.instance();
+
+	CHECK(data->add_field("position", Variant::VECTOR2) == 0);
+	CHECK(data->add_field("alive", Variant::BOOL) == 1);
+	CHECK(data->get_field_count() == 2);
+	CHECK(data->get_field_name(1) == "alive");
+	CHECK(data->get_field_type(0) == Variant::VECTOR2);
+	CHECK(data->find_field("alive") == 1);
+	CHECK(data->find_field("missing") == -1);
+
+	ERR_PRINT_OFF;
+	CHECK(data->add_field("position", Variant::FLOAT) == -1);
+	CHECK(data->add_field("name", Variant::STRING) == -1);
+	ERR_PRINT_ON;
+	CHECK(data->get_field_count() == 2);
+
+	CHECK(data->get_column(0).get_type() == Variant::PACKED_VECTOR2_ARRAY);
+	CHECK(data->get_column(1).get_type() == Variant::PACKED_BYTE_ARRAY);
+}
+
+TEST_CASE("[PackedStructArray] Structs") {
+	Ref<PackedStructArray> data;
+	data.instance();
+	const int position = data->add_field("position", Variant::VECTOR3);
+	const int health = data->add_field("health", Variant::INT);
+	const int alive = data->add_field("alive", Variant::BOOL);
+	CHECK(data->is_empty());
+
+	Dictionary values;
+	values["position"] = Vector3(1, 2, 3);
+	values["alive"] = true;
+	CHECK(data->append(values) == 0);
+	CHECK(data->append(Dictionary()) == 1);
+	CHECK(data->size() == 2);
+
+	CHECK(data->get_value(0, position) == Variant(Vector3(1, 2, 3)));
+	CHECK(data->get_value(0, health) == Variant(0));
+	CHECK(data->get_value(0, alive) == Variant(true));
+	CHECK(data->get_value(1, alive) == Variant(false));
+
+	data->set_value(1, health, 50);
+	const Dictionary second = data->get_struct(1);
+	CHECK(second.size() == 3);
+	CHECK(second["health"] == Variant(50));
+	CHECK(second["position"] == Variant(Vector3()));
+
+	data->remove(0);
+	CHECK(data->size() == 1);
+	CHECK(data->get_value(0, health) == Variant(50));
+
+	// Fields added later have default values.
+	const int speed = data->add_field("speed", Variant::FLOAT);
+	CHECK(data->get_value(0, speed) == Variant(0.0));
+
+	data->resize(3);
+	CHECK(data->get_value(2, health) == Variant(0));
+	data->clear();
+	CHECK(data->is_empty());
+	CHECK(data->get_field_count() == 4);
+
+	ERR_PRINT_OFF;
+	data->resize(1);
+	data->set_value(0, position, "not a vector");
+	CHECK(data->get_value(0, position) == Variant(Vector3()));
+	CHECK(data->get_value(5, position) == Variant());
+	ERR_PRINT_ON;
+}
+
+TEST_CASE("[PackedStructArray] Columns") {
+	Ref<PackedStructArray> data;
+	data.instance();
+	const int position = data->add_field("position", Variant::VECTOR2);
+	const int velocity = data->add_field("velocity", Variant::VECTOR2);
+	const int energy = data->add_field("energy", Variant::FLOAT);
+	data->resize(100);
+
+	data->fill(velocity, Vector2(2, -4));
+	data->add_scaled_column(position, velocity, 0.5);
+	data->add_scaled_column(position, velocity, 0.5);
+	data->add_to_column(position, Vector2(1, 1));
+	data->fill(energy, 10.0);
+	data->scale_column(energy, 0.25);
+
+	const PackedVector2Array positions = data->get_column(position);
+	CHECK(positions.size() == 100);
+	CHECK(positions[0] == Vector2(3, -3));
+	CHECK(positions[99] == Vector2(3, -3));
+	CHECK(data->get_value(50, energy) == Variant(2.5));
+
+	// Columns are shared, changing the returned array leaves the field as it was.
+	PackedVector2Array changed = positions;
+	changed.set(0, Vector2());
+	CHECK(data->get_value(0, position) == Variant(Vector2(3, -3)));
+
+	data->set_column(position, changed);
+	CHECK(data->get_value(0, position) == Variant(Vector2()));
+
+	ERR_PRINT_OFF;
+	PackedVector2Array too_short;
+	too_short.push_back(Vector2());
+	data->set_column(position, too_short);
+	data->set_column(position, PackedFloat32Array());
+	data->add_scaled_column(position, energy, 1.0);
+	ERR_PRINT_ON;
+	CHECK(data->get_column(position) == Variant(changed));
+}
+
+} // namespace TestPackedStructArray
+
+#endif // TEST_PACKED_STRUCT_ARRAY_H
@@ -109,6 +109,110 @@ TEST_CASE("[PCKPacker] Pack a PCK file with some files and directories") {
 			f->get_len() <= 35000,
 			"The generated non-empty PCK file shouldn't be too large.");
 }
+
+TEST_CASE("[PCKPacker] Mount PCK files and look up their contents") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const int file_count = 300;
+
+	// Enough files to grow the pack index a few times.
+	PCKPacker pck_packer;
+	const String first_pck_path = cache_path.plus_file("output_index_first.pck");
+	REQUIRE(pck_packer.pck_start(first_pck_path, 32, ENCRYPTION_KEY) == OK);
+	for (int i = 0; i < file_count; i++) {
+		const String src_path = cache_path.plus_file(vformat("pck_index_src_%d.txt", i));
+		{
+			FileAccessRef f = FileAccess::open(src_path, FileAccess::WRITE);
+			REQUIRE(f);
+			f->store_string(vformat("first %d", i));
+		}
+		REQUIRE(pck_packer.add_file(vformat("res://pck_index_test/dir_%d/file_%d.txt", i % 7, i), src_path) == OK);
+	}
+	REQUIRE(pck_packer.flush() == OK);
+
+	// A patch which replaces one file and adds another.
+	const String second_pck_path = cache_path.plus_file("output_index_second.pck");
+	REQUIRE(pck_packer.pck_start(second_pck_path, 32, ENCRYPTION_KEY) == OK);
+	const String patch_src_path = cache_path.plus_file("pck_index_src_patch.txt");
+	{
+		FileAccessRef f = FileAccess::open(patch_src_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_string("patched");
+	}
+	REQUIRE(pck_packer.add_file("res://pck_index_test/dir_3/file_10.txt", patch_src_path) == OK);
+	REQUIRE(pck_packer.add_file("res://pck_index_test/added.txt", patch_src_path) == OK);
+	REQUIRE(pck_packer.flush() == OK);
+
+	PackedData *packed_data = PackedData::get_singleton();
+	REQUIRE(packed_data);
+	REQUIRE(packed_data->add_pack(first_pck_path, false, 0) == OK);
+
+	for (int i = 0; i < file_count; i += 13) {
+		const String path = vformat("res://pck_index_test/dir_%d/file_%d.txt", i % 7, i);
+		CHECK_MESSAGE(packed_data->has_path(path), "Every packed file should be found.");
+		FileAccess *f = packed_data->try_open_path(path);
+		REQUIRE(f);
+		CHECK(f->get_as_utf8_string() == vformat("first %d", i));
+		memdelete(f);
+	}
+	CHECK_MESSAGE(!packed_data->has_path("res://pck_index_test/dir_0/file_1.txt"), "Files in another directory should not be found.");
+	CHECK(!packed_data->has_path("res://pck_index_test/added.txt"));
+	CHECK(packed_data->has_directory("res://pck_index_test/dir_4"));
+
+	REQUIRE(packed_data->add_pack(second_pck_path, true, 0) == OK);
+
+	FileAccess *f = packed_data->try_open_path("res://pck_index_test/dir_3/file_10.txt");
+	REQUIRE(f);
+	CHECK_MESSAGE(f->get_as_utf8_string() == "patched", "Files should be replaced by later packs.");
+	memdelete(f);
+
+	f = packed_data->try_open_path("res://pck_index_test/added.txt");
+	REQUIRE(f);
+	CHECK(f->get_as_utf8_string() == "patched");
+	memdelete(f);
+
+	f = packed_data->try_open_path("res://pck_index_test/dir_4/file_11.txt");
+	REQUIRE(f);
+	CHECK_MESSAGE(f->get_as_utf8_string() == "first 11", "Other files should still come from the first pack.");
+	memdelete(f);
+}
+
+TEST_CASE("[PCKPacker] Read from a truncated PCK file") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String src_path = cache_path.plus_file("pck_truncated_src.bin");
+	{
+		FileAccessRef f = FileAccess::open(src_path, FileAccess::WRITE);
+		REQUIRE(f);
+		for (int i = 0; i < 1000; i++) {
+			f->store_8(i % 251);
+		}
+	}
+
+	PCKPacker pck_packer;
+	const String pck_path = cache_path.plus_file("output_truncated_full.pck");
+	REQUIRE(pck_packer.pck_start(pck_path, 32, ENCRYPTION_KEY) == OK);
+	REQUIRE(pck_packer.add_file("res://pck_truncated_test/data.bin", src_path) == OK);
+	REQUIRE(pck_packer.flush() == OK);
+
+	// Cut the file data short, the directory before it stays intact.
+	const String truncated_path = cache_path.plus_file("output_truncated.pck");
+	{
+		Vector<uint8_t> contents = FileAccess::get_file_as_array(pck_path);
+		REQUIRE(contents.size() > 500);
+		FileAccessRef f = FileAccess::open(truncated_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_buffer(contents.ptr(), contents.size() - 500);
+	}
+
+	PackedData *packed_data = PackedData::get_singleton();
+	REQUIRE(packed_data);
+	REQUIRE(packed_data->add_pack(truncated_path, false, 0) == OK);
+
+	FileAccess *f = packed_data->try_open_path("res://pck_truncated_test/data.bin");
+	REQUIRE(f);
+	uint8_t buffer[1000];
+	CHECK_MESSAGE(f->get_buffer(buffer, 1000) < 1000, "Reading past the end of the pack should be short.");
+	memdelete(f);
+}
 } // namespace TestPCKPacker
 
 #endif // TEST_PCK_PACKER_H
@@ -0,0 +1,112 @@
+/*************************************************************************/
+/*  test_perfect_hash_map.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PERFECT_HASH_MAP_H
+#define TEST_PERFECT_HASH_MAP_H
+
+#include "core/string/string_name.h"
+#include "core/templates/perfect_hash_map.h"
+
+#include "tests/test_macros.h"
+
+namespace TestPerfectHashMap {
+
+struct CollidingHasher {
+	static _FORCE_INLINE_ uint32_t hash(const int p_int) { return p_int & 3; }
+};
+
+TEST_CASE("[PerfectHashMap] Empty map") {
+	PerfectHashMap<int, int> map;
+	CHECK(map.is_empty());
+	CHECK(map.getptr(1) == nullptr);
+
+	map.build(LocalVector<PerfectHashMap<int, int>::Pair>());
+	CHECK(map.is_empty());
+	CHECK_FALSE(map.has(0));
+}
+
+TEST_CASE("[PerfectHashMap] Build and lookup") {
+	LocalVector<PerfectHashMap<StringName, int>::Pair> pairs;
+	for (int i = 0; i < 5000; i++) {
+		PerfectHashMap<StringName, int>::Pair pair;
+		pair.key = StringName("key_" + itos(i));
+		pair.value = i;
+		pairs.push_back(pair);
+	}
+
+	PerfectHashMap<StringName, int> map;
+	map.build(pairs);
+	CHECK(map.size() == 5000);
+
+	bool all_found = true;
+	for (int i = 0; i < 5000; i++) {
+		const int *value = map.getptr(StringName("key_" + itos(i)));
+		all_found = all_found && value && *value == i;
+	}
+	CHECK(all_found);
+
+	bool none_found = true;
+	for (int i = 5000; i < 10000; i++) {
+		none_found = none_found && !map.has(StringName("key_" + itos(i)));
+	}
+	CHECK(none_found);
+
+	map.clear();
+	CHECK(map.is_empty());
+	CHECK_FALSE(map.has(StringName("key_0")));
+}
+
+TEST_CASE("[PerfectHashMap] Keys with equal hashes") {
+	LocalVector<PerfectHashMap<int, int, CollidingHasher>::Pair> pairs;
+	for (int i = 0; i < 64; i++) {
+		PerfectHashMap<int, int, CollidingHasher>::Pair pair;
+		pair.key = i;
+		pair.value = i * 10;
+		pairs.push_back(pair);
+	}
+
+	PerfectHashMap<int, int, CollidingHasher> map;
+	map.build(pairs);
+	CHECK(map.size() == 64);
+	// Only one key per distinct hash can get a slot, the rest are kept aside.
+	CHECK(map.get_overflow_count() == 60);
+
+	bool all_found = true;
+	for (int i = 0; i < 64; i++) {
+		const int *value = map.getptr(i);
+		all_found = all_found && value && *value == i * 10;
+	}
+	CHECK(all_found);
+	CHECK_FALSE(map.has(64));
+}
+
+} // namespace TestPerfectHashMap
+
+#endif // TEST_PERFECT_HASH_MAP_H
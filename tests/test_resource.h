@@ -34,6 +34,7 @@
 #include "core/io/resource.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
+#include "core/os/file_access.h"
 #include "core/os/os.h"
 
 #include "thirdparty/doctest/doctest.h"
@@ -109,6 +110,201 @@ TEST_CASE("[Resource] Saving and loading") {
 			loaded_child_resource_text->get_name() == "I'm a child resource",
 			"The loaded child resource name should be equal to the expected value.");
 }
+
+TEST_CASE("[Resource] Saving and loading large packed arrays") {
+	Vector<uint8_t> bytes;
+	bytes.resize(100000);
+	for (int i = 0; i < bytes.size(); i++) {
+		bytes.write[i] = i % 7;
+	}
+	Vector<float> floats;
+	floats.resize(20000);
+	for (int i = 0; i < floats.size(); i++) {
+		floats.write[i] = i * 0.5;
+	}
+	Vector<Vector3> vectors;
+	vectors.resize(5000);
+	for (int i = 0; i < vectors.size(); i++) {
+		vectors.write[i] = Vector3(i, -i, i * 0.25);
+	}
+	Vector<int32_t> small_ints;
+	small_ints.push_back(42);
+
+	Ref<Resource> resource = memnew(Resource);
+	resource->set_meta("bytes", bytes);
+	resource->set_meta("floats", floats);
+	resource->set_meta("small_ints", small_ints);
+	Array nested;
+	nested.push_back(vectors);
+	resource->set_meta("nested", nested);
+
+	const String save_path_raw = OS::get_singleton()->get_cache_path().plus_file("resource_sections.res");
+	const String save_path_compressed = OS::get_singleton()->get_cache_path().plus_file("resource_sections_compressed.res");
+	REQUIRE(ResourceSaver::save(save_path_raw, resource) == OK);
+	REQUIRE(ResourceSaver::save(save_path_compressed, resource, ResourceSaver::FLAG_COMPRESS_SECTIONS) == OK);
+
+	uint64_t raw_size = 0;
+	uint64_t compressed_size = 0;
+	{
+		FileAccessRef f = FileAccess::open(save_path_raw, FileAccess::READ);
+		REQUIRE(f);
+		raw_size = f->get_len();
+		FileAccessRef fc = FileAccess::open(save_path_compressed, FileAccess::READ);
+		REQUIRE(fc);
+		compressed_size = fc->get_len();
+	}
+	CHECK_MESSAGE(compressed_size < raw_size, "Compressed sections should make the repetitive arrays smaller.");
+
+	const String paths[] = { save_path_raw, save_path_compressed };
+	for (const String &path : paths) {
+		Ref<Resource> loaded = ResourceLoader::load(path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+		REQUIRE(loaded.is_valid());
+		CHECK(Vector<uint8_t>(loaded->get_meta("bytes")) == bytes);
+		CHECK(Vector<float>(loaded->get_meta("floats")) == floats);
+		CHECK(Vector<int32_t>(loaded->get_meta("small_ints")) == small_ints);
+		Array loaded_nested = loaded->get_meta("nested");
+		REQUIRE(loaded_nested.size() == 1);
+		CHECK(Vector<Vector3>(loaded_nested[0]) == vectors);
+	}
+}
+
+TEST_CASE("[Resource] Vector array sections don't depend on the precision of real_t") {
+	Vector<Vector2> vectors2;
+	vectors2.resize(4096);
+	for (int i = 0; i < vectors2.size(); i++) {
+		vectors2.write[i] = Vector2(i * 0.5, -i);
+	}
+	Vector<Vector3> vectors3;
+	vectors3.resize(4096);
+	for (int i = 0; i < vectors3.size(); i++) {
+		vectors3.write[i] = Vector3(i, i * 0.25, -i);
+	}
+
+	Ref<Resource> resource = memnew(Resource);
+	resource->set_meta("vectors2", vectors2);
+	resource->set_meta("vectors3", vectors3);
+
+	const String save_path = OS::get_singleton()->get_cache_path().plus_file("resource_real_sections.res");
+	REQUIRE(ResourceSaver::save(save_path, resource) == OK);
+
+	// Components are stored as 32-bit floats, so a build using doubles for
+	// real_t writes the same sections as a build using floats.
+	const uint64_t data_size = vectors2.size() * 2 * sizeof(float) + vectors3.size() * 3 * sizeof(float);
+	{
+		FileAccessRef f = FileAccess::open(save_path, FileAccess::READ);
+		REQUIRE(f);
+		CHECK(f->get_len() >= data_size);
+		CHECK(f->get_len() < data_size + 4096);
+	}
+
+	Ref<Resource> loaded = ResourceLoader::load(save_path, "", ResourceFormatLoader::CACHE_MODE_IGNORE);
+	REQUIRE(loaded.is_valid());
+	CHECK(Vector<Vector2>(loaded->get_meta("vectors2")) == vectors2);
+	CHECK(Vector<Vector3>(loaded->get_meta("vectors3")) == vectors3);
+}
+
+TEST_CASE("[Resource] Threaded loading with dependencies") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String parent_path = cache_path.plus_file("resource_threaded_parent.tres");
+	const int child_count = 8;
+
+	{
+		Ref<Resource> resource = memnew(Resource);
+		resource->set_name("Parent");
+		for (int i = 0; i < child_count; i++) {
+			Ref<Resource> child_resource = memnew(Resource);
+			child_resource->set_name(vformat("Child %d", i));
+			// Saved to their own files, so they are loaded as dependencies.
+			const String child_path = cache_path.plus_file(vformat("resource_threaded_child_%d.res", i));
+			REQUIRE(ResourceSaver::save(child_path, child_resource, ResourceSaver::FLAG_CHANGE_PATH) == OK);
+			resource->set_meta(vformat("child_%d", i), child_resource);
+		}
+		REQUIRE(ResourceSaver::save(parent_path, resource) == OK);
+	}
+	// Nothing is cached anymore, everything has to be loaded again.
+	REQUIRE(!ResourceCache::has(parent_path));
+
+	List<String> dependencies;
+	ResourceLoader::get_dependencies(parent_path, &dependencies);
+	CHECK(dependencies.size() == child_count);
+
+	REQUIRE(ResourceLoader::load_threaded_request(parent_path, "", true) == OK);
+	CHECK_MESSAGE(
+			ResourceLoader::load_threaded_get_status(parent_path) != ResourceLoader::THREAD_LOAD_INVALID_RESOURCE,
+			"The load should be known until its result is taken.");
+
+	// Let the worker threads do the work, rather than this thread.
+	for (int i = 0; i < 10000 && ResourceLoader::load_threaded_get_status(parent_path) == ResourceLoader::THREAD_LOAD_IN_PROGRESS; i++) {
+		OS::get_singleton()->delay_usec(1000);
+	}
+
+	Error err;
+	Ref<Resource> loaded = ResourceLoader::load_threaded_get(parent_path, &err);
+	REQUIRE(loaded.is_valid());
+	CHECK(err == OK);
+	CHECK(loaded->get_name() == "Parent");
+	for (int i = 0; i < child_count; i++) {
+		Ref<Resource> child_resource = loaded->get_meta(vformat("child_%d", i));
+		REQUIRE(child_resource.is_valid());
+		CHECK(child_resource->get_name() == vformat("Child %d", i));
+	}
+	CHECK_MESSAGE(
+			ResourceLoader::load_threaded_get_status(parent_path) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE,
+			"The load should be forgotten once its result is taken.");
+
+	List<ResourceLoader::LoadTiming> timings;
+	ResourceLoader::get_load_timings(&timings);
+	const ResourceLoader::LoadTiming *parent_timing = nullptr;
+	int child_timings = 0;
+	for (List<ResourceLoader::LoadTiming>::Element *E = timings.back(); E; E = E->prev()) {
+		if (!parent_timing && E->get().path == parent_path) {
+			parent_timing = &E->get();
+		} else if (parent_timing && E->get().path.begins_with(cache_path.plus_file("resource_threaded_child_"))) {
+			child_timings++;
+			CHECK_MESSAGE(E->get().finished_usec <= parent_timing->started_usec, "Dependencies should be loaded before the resource needing them.");
+		}
+	}
+	REQUIRE(parent_timing);
+	CHECK_MESSAGE(parent_timing->dependencies.size() == child_count, "The dependencies should have been requested ahead of the load.");
+	CHECK(child_timings == child_count);
+	CHECK(parent_timing->requested_usec <= parent_timing->started_usec);
+	CHECK(parent_timing->started_usec <= parent_timing->finished_usec);
+}
+
+TEST_CASE("[Resource] Threaded loading, shared and canceled requests") {
+	const String path = OS::get_singleton()->get_cache_path().plus_file("resource_threaded_shared.tres");
+	{
+		Ref<Resource> resource = memnew(Resource);
+		resource->set_name("Shared");
+		REQUIRE(ResourceSaver::save(path, resource) == OK);
+	}
+
+	// Two requests share one load, and each needs its own get or cancel.
+	REQUIRE(ResourceLoader::load_threaded_request(path) == OK);
+	REQUIRE(ResourceLoader::load_threaded_request(path) == OK);
+
+	Ref<Resource> loaded = ResourceLoader::load_threaded_get(path);
+	REQUIRE(loaded.is_valid());
+	CHECK(loaded->get_name() == "Shared");
+	CHECK(ResourceLoader::load_threaded_get_status(path) == ResourceLoader::THREAD_LOAD_LOADED);
+
+	CHECK(ResourceLoader::load_threaded_cancel(path) == OK);
+	CHECK(ResourceLoader::load_threaded_get_status(path) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE);
+
+	ERR_PRINT_OFF;
+	CHECK_MESSAGE(ResourceLoader::load_threaded_cancel(path) == ERR_INVALID_PARAMETER, "Canceling a load which was not requested should fail.");
+	ERR_PRINT_ON;
+
+	loaded.unref();
+
+	// Canceled right away, the load may be skipped, but is forgotten either way.
+	REQUIRE(ResourceLoader::load_threaded_request(path) == OK);
+	CHECK(ResourceLoader::load_threaded_cancel(path) == OK);
+	for (int i = 0; i < 10000 && ResourceLoader::load_threaded_get_status(path) != ResourceLoader::THREAD_LOAD_INVALID_RESOURCE; i++) {
+		OS::get_singleton()->delay_usec(1000);
+	}
+	CHECK(ResourceLoader::load_threaded_get_status(path) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE);
+}
 } // namespace TestResource
 
 #endif // TEST_RESOURCE
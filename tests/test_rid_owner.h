@@ -0,0 +1,285 @@
+/*************************************************************************/
+/*  test_rid_owner.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RID_OWNER_H
+#define TEST_RID_OWNER_H
+
+#include "core/os/os.h"
+#include "core/os/spin_lock.h"
+#include "core/os/thread.h"
+#include "core/string/print_string.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/rid_owner.h"
+
+#include "tests/test_macros.h"
+
+namespace TestRIDOwner {
+
+struct Item {
+	uint64_t value = 0;
+	uint64_t check = 0;
+
+	Item() {}
+	Item(uint64_t p_value) {
+		value = p_value;
+		check = ~p_value;
+	}
+};
+
+TEST_CASE("[RID_Owner] Make, get and free") {
+	RID_Owner<Item> owner;
+
+	LocalVector<RID> rids;
+	for (uint32_t i = 0; i < 1000; i++) {
+		rids.push_back(owner.make_rid(Item(i)));
+	}
+	CHECK(owner.get_rid_count() == 1000);
+
+	bool found = true;
+	for (uint32_t i = 0; i < rids.size(); i++) {
+		Item *item = owner.getornull(rids[i]);
+		found = found && item && item->value == i && owner.owns(rids[i]);
+	}
+	CHECK_MESSAGE(found, "Every RID should resolve to its own item.");
+
+	for (uint32_t i = 0; i < rids.size(); i += 2) {
+		owner.free(rids[i]);
+	}
+	CHECK(owner.get_rid_count() == 500);
+
+	bool stale = true;
+	for (uint32_t i = 0; i < rids.size(); i += 2) {
+		stale = stale && owner.getornull(rids[i]) == nullptr && !owner.owns(rids[i]);
+	}
+	CHECK_MESSAGE(stale, "Freed RIDs should not resolve anymore.");
+
+	// Freed slots are reused, with a new validator.
+	LocalVector<RID> reused;
+	for (uint32_t i = 0; i < 500; i++) {
+		reused.push_back(owner.make_rid(Item(i + 1000)));
+	}
+	bool distinct = true;
+	for (uint32_t i = 0; i < rids.size(); i += 2) {
+		distinct = distinct && owner.getornull(rids[i]) == nullptr;
+	}
+	CHECK(distinct);
+
+	List<RID> owned;
+	owner.get_owned_list(&owned);
+	CHECK(owned.size() == 1000);
+
+	for (uint32_t i = 1; i < rids.size(); i += 2) {
+		owner.free(rids[i]);
+	}
+	for (uint32_t i = 0; i < reused.size(); i++) {
+		CHECK(owner.getornull(reused[i])->value == i + 1000);
+		owner.free(reused[i]);
+	}
+	CHECK(owner.get_rid_count() == 0);
+	CHECK(owner.getornull(RID()) == nullptr);
+}
+
+TEST_CASE("[RID_Owner] Allocate and initialize") {
+	RID_Owner<Item> owner;
+
+	RID rid = owner.allocate_rid();
+	CHECK(owner.owns(rid));
+
+	List<RID> owned;
+	owner.get_owned_list(&owned);
+	CHECK_MESSAGE(owned.is_empty(), "Uninitialized RIDs should not be listed.");
+
+	ERR_PRINT_OFF;
+	CHECK(owner.getornull(rid) == nullptr);
+	ERR_PRINT_ON;
+
+	owner.initialize_rid(rid, Item(42));
+	CHECK(owner.getornull(rid)->value == 42);
+
+	ERR_PRINT_OFF;
+	owner.initialize_rid(rid, Item(43));
+	ERR_PRINT_ON;
+	CHECK(owner.getornull(rid)->value == 42);
+
+	owner.free(rid);
+	CHECK(owner.get_rid_count() == 0);
+}
+
+TEST_CASE("[RID_Owner] RIDs are unique across owners") {
+	RID_Owner<Item> owner_a;
+	RID_PtrOwner<Item> owner_b;
+	Item item(7);
+
+	RID a = owner_a.make_rid(Item(1));
+	RID b = owner_b.make_rid(&item);
+	CHECK(a != b);
+	CHECK(owner_a.owns(a));
+	CHECK(!owner_a.owns(b));
+	CHECK(owner_b.owns(b));
+	CHECK(!owner_b.owns(a));
+	CHECK(owner_b.getornull(b) == &item);
+
+	owner_a.free(a);
+	owner_b.free(b);
+}
+
+// Same owner behind a single lock, as RID_Owner was before lookups became lock free.
+class LockedOwner {
+	RID_Owner<Item> owner;
+	SpinLock lock;
+
+public:
+	RID make_rid(const Item &p_item) {
+		lock.lock();
+		RID rid = owner.make_rid(p_item);
+		lock.unlock();
+		return rid;
+	}
+	Item *getornull(const RID &p_rid) {
+		lock.lock();
+		Item *item = owner.getornull(p_rid);
+		lock.unlock();
+		return item;
+	}
+	void free(const RID &p_rid) {
+		lock.lock();
+		owner.free(p_rid);
+		lock.unlock();
+	}
+};
+
+template <class O>
+struct ChurnData {
+	O *owner = nullptr;
+	uint32_t seed = 0;
+	uint32_t iterations = 0;
+	uint32_t lookups_per_change = 0;
+	bool intact = true;
+};
+
+// Every thread keeps a window of RIDs, looks them up and keeps replacing them.
+template <class O>
+static void churn_thread(void *p_data) {
+	ChurnData<O> *cd = (ChurnData<O> *)p_data;
+	const uint32_t window = 64;
+	RID rids[window];
+	uint64_t values[window];
+
+	uint32_t state = cd->seed;
+	for (uint32_t i = 0; i < window; i++) {
+		values[i] = (uint64_t(cd->seed) << 32) | i;
+		rids[i] = cd->owner->make_rid(Item(values[i]));
+	}
+
+	for (uint32_t i = 0; i < cd->iterations; i++) {
+		for (uint32_t j = 0; j < cd->lookups_per_change; j++) {
+			state = state * 1664525 + 1013904223;
+			uint32_t slot = (state >> 16) % window;
+			Item *item = cd->owner->getornull(rids[slot]);
+			cd->intact = cd->intact && item && item->value == values[slot] && item->check == ~values[slot];
+		}
+
+		state = state * 1664525 + 1013904223;
+		uint32_t slot = (state >> 16) % window;
+		cd->owner->free(rids[slot]);
+		values[slot] += window;
+		rids[slot] = cd->owner->make_rid(Item(values[slot]));
+	}
+
+	for (uint32_t i = 0; i < window; i++) {
+		cd->owner->free(rids[i]);
+	}
+}
+
+template <class O>
+static uint64_t run_churn(O *p_owner, int p_threads, uint32_t p_iterations, uint32_t p_lookups_per_change, bool &r_intact) {
+	Thread *threads = memnew_arr(Thread, p_threads);
+	LocalVector<ChurnData<O>> data;
+	data.resize(p_threads);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_threads; i++) {
+		data[i].owner = p_owner;
+		data[i].seed = i + 1;
+		data[i].iterations = p_iterations;
+		data[i].lookups_per_change = p_lookups_per_change;
+		threads[i].start(&churn_thread<O>, &data[i]);
+	}
+	for (int i = 0; i < p_threads; i++) {
+		threads[i].wait_to_finish();
+	}
+	uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	memdelete_arr(threads);
+
+	r_intact = true;
+	for (int i = 0; i < p_threads; i++) {
+		r_intact = r_intact && data[i].intact;
+	}
+	return usec;
+}
+
+TEST_CASE("[RID_Owner] Concurrent make, get and free") {
+	RID_Owner<Item, true> owner;
+	bool intact = false;
+	run_churn(&owner, 8, 20000, 4, intact);
+	CHECK_MESSAGE(intact, "Lookups should always find the item their RID was made with.");
+	CHECK(owner.get_rid_count() == 0);
+}
+
+// Microbenchmark, run with `godot --test rid-owner-benchmark`.
+// Compares the thread safe RID_Owner with one behind a single lock, from 1 thread up to the processor count.
+static void benchmark() {
+	const uint32_t iterations = 1 << 18;
+	const uint32_t lookups_per_change = 8;
+	int max_threads = OS::get_singleton()->get_processor_count();
+
+	print_line(vformat("RID_Owner: %d changes and %d lookups per thread.", iterations, iterations * lookups_per_change));
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+		bool intact;
+		LockedOwner locked;
+		uint64_t locked_usec = run_churn(&locked, threads, iterations, lookups_per_change, intact);
+		RID_Owner<Item, true> lock_free;
+		uint64_t lock_free_usec = run_churn(&lock_free, threads, iterations, lookups_per_change, intact);
+
+		uint64_t operations = uint64_t(threads) * iterations * (lookups_per_change + 2);
+		print_line(vformat("  %d threads: single lock %.1f Mops/s, RID_Owner %.1f Mops/s, %.2fx.", threads,
+				double(operations) / locked_usec, double(operations) / lock_free_usec, double(locked_usec) / lock_free_usec));
+
+		if (threads < max_threads && threads * 2 > max_threads) {
+			threads = max_threads / 2; // Make sure the processor count itself is measured.
+		}
+	}
+}
+
+REGISTER_TEST_COMMAND("rid-owner-benchmark", &benchmark);
+
+} // namespace TestRIDOwner
+
+#endif // TEST_RID_OWNER_H
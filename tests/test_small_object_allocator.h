@@ -0,0 +1,198 @@
+/*************************************************************************/
+/*  test_small_object_allocator.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_SMALL_OBJECT_ALLOCATOR_H
+#define TEST_SMALL_OBJECT_ALLOCATOR_H
+
+#include "core/os/os.h"
+#include "core/os/small_object_allocator.h"
+#include "core/os/thread.h"
+#include "core/string/print_string.h"
+#include "core/templates/local_vector.h"
+
+#include "tests/test_macros.h"
+
+#include <stdlib.h>
+
+namespace TestSmallObjectAllocator {
+
+TEST_CASE("[SmallObjectAllocator] Size classes") {
+	CHECK(SmallObjectAllocator::get_size_class(1) == 1);
+	CHECK(SmallObjectAllocator::get_size_class(SmallObjectAllocator::MAX_BLOCK_SIZE) == SmallObjectAllocator::SIZE_CLASS_COUNT);
+	CHECK(SmallObjectAllocator::get_size_class(SmallObjectAllocator::MAX_BLOCK_SIZE + 1) == 0);
+
+	bool fits = true;
+	for (uint32_t size = 1; size <= SmallObjectAllocator::MAX_BLOCK_SIZE; size++) {
+		uint32_t size_class = SmallObjectAllocator::get_size_class(size);
+		fits = fits && SmallObjectAllocator::get_block_size(size_class) >= size;
+		fits = fits && (size_class == 1 || SmallObjectAllocator::get_block_size(size_class - 1) < size);
+	}
+	CHECK_MESSAGE(fits, "Every size should map to the smallest block that fits it.");
+}
+
+TEST_CASE("[SmallObjectAllocator] Blocks are distinct and counted") {
+	const uint32_t size_class = SmallObjectAllocator::get_size_class(100);
+	const uint32_t block_size = SmallObjectAllocator::get_block_size(size_class);
+
+	SmallObjectAllocator::SizeClassStats before[SmallObjectAllocator::SIZE_CLASS_COUNT];
+	SmallObjectAllocator::get_stats(before);
+
+	LocalVector<uint8_t *> blocks;
+	for (uint32_t i = 0; i < 1000; i++) {
+		uint8_t *block = (uint8_t *)SmallObjectAllocator::alloc(size_class);
+		memset(block, i & 0xFF, block_size);
+		blocks.push_back(block);
+	}
+
+	bool intact = true;
+	for (uint32_t i = 0; i < blocks.size(); i++) {
+		intact = intact && ((uintptr_t)blocks[i] & 15) == 0;
+		for (uint32_t j = 0; j < block_size; j++) {
+			intact = intact && blocks[i][j] == (i & 0xFF);
+		}
+	}
+	CHECK_MESSAGE(intact, "Blocks should be aligned and should not overlap.");
+
+	for (uint32_t i = 0; i < blocks.size(); i++) {
+		SmallObjectAllocator::free(blocks[i], size_class);
+	}
+
+	SmallObjectAllocator::SizeClassStats after[SmallObjectAllocator::SIZE_CLASS_COUNT];
+	SmallObjectAllocator::get_stats(after);
+	CHECK(after[size_class - 1].block_size == block_size);
+	CHECK(after[size_class - 1].allocations - before[size_class - 1].allocations >= 1000);
+	CHECK(after[size_class - 1].frees - before[size_class - 1].frees >= 1000);
+	CHECK(after[size_class - 1].reserved_blocks >= 1000);
+}
+
+struct ChurnData {
+	uint32_t seed = 0;
+	uint32_t iterations = 0;
+	bool use_malloc = false;
+	bool intact = true;
+};
+
+static void churn_thread(void *p_userdata) {
+	ChurnData *cd = (ChurnData *)p_userdata;
+	const uint32_t slots = 256;
+	uint8_t *blocks[slots] = {};
+	uint32_t sizes[slots] = {};
+	uint32_t state = cd->seed;
+
+	for (uint32_t i = 0; i < cd->iterations; i++) {
+		state = state * 1664525 + 1013904223;
+		uint32_t slot = (state >> 8) % slots;
+		if (blocks[slot]) {
+			cd->intact = cd->intact && blocks[slot][0] == uint8_t(sizes[slot]) && blocks[slot][sizes[slot] - 1] == uint8_t(sizes[slot]);
+			if (cd->use_malloc) {
+				::free(blocks[slot]);
+			} else {
+				SmallObjectAllocator::free(blocks[slot], SmallObjectAllocator::get_size_class(sizes[slot]));
+			}
+			blocks[slot] = nullptr;
+		} else {
+			uint32_t size = 8 + (state >> 20) % 248;
+			blocks[slot] = (uint8_t *)(cd->use_malloc ? malloc(size) : SmallObjectAllocator::alloc(SmallObjectAllocator::get_size_class(size)));
+			sizes[slot] = size;
+			blocks[slot][0] = uint8_t(size);
+			blocks[slot][size - 1] = uint8_t(size);
+		}
+	}
+
+	for (uint32_t i = 0; i < slots; i++) {
+		if (!blocks[i]) {
+			continue;
+		}
+		if (cd->use_malloc) {
+			::free(blocks[i]);
+		} else {
+			SmallObjectAllocator::free(blocks[i], SmallObjectAllocator::get_size_class(sizes[i]));
+		}
+	}
+}
+
+static uint64_t run_churn(int p_threads, uint32_t p_iterations, bool p_use_malloc, bool &r_intact) {
+	Thread *threads = memnew_arr(Thread, p_threads);
+	LocalVector<ChurnData> data;
+	data.resize(p_threads);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_threads; i++) {
+		data[i].seed = i + 1;
+		data[i].iterations = p_iterations;
+		data[i].use_malloc = p_use_malloc;
+		threads[i].start(&churn_thread, &data[i]);
+	}
+	for (int i = 0; i < p_threads; i++) {
+		threads[i].wait_to_finish();
+	}
+	uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+	memdelete_arr(threads);
+
+	r_intact = true;
+	for (int i = 0; i < p_threads; i++) {
+		r_intact = r_intact && data[i].intact;
+	}
+	return usec;
+}
+
+TEST_CASE("[SmallObjectAllocator] Concurrent allocation") {
+	bool intact = false;
+	run_churn(8, 100000, false, intact);
+	CHECK_MESSAGE(intact, "Blocks should not be handed to two owners at once.");
+}
+
+// Microbenchmark, run with `godot --test small-object-allocator-benchmark`.
+// Compares small allocations from SmallObjectAllocator and malloc(), from 1 thread up to the processor count.
+static void benchmark() {
+	const uint32_t iterations = 1 << 22;
+	int max_threads = OS::get_singleton()->get_processor_count();
+
+	print_line(vformat("SmallObjectAllocator: %d allocations and frees per thread, used by Memory: %s.", iterations, SmallObjectAllocator::is_enabled() ? "yes" : "no"));
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+		bool intact;
+		uint64_t malloc_usec = run_churn(threads, iterations, true, intact);
+		uint64_t allocator_usec = run_churn(threads, iterations, false, intact);
+		print_line(vformat("  %d threads: malloc %.1f ns, SmallObjectAllocator %.1f ns, %.2fx.", threads,
+				malloc_usec * 1000.0 / iterations, allocator_usec * 1000.0 / iterations, double(malloc_usec) / allocator_usec));
+
+		if (threads < max_threads && threads * 2 > max_threads) {
+			threads = max_threads / 2; // Make sure the processor count itself is measured.
+		}
+	}
+
+	SmallObjectAllocator::print_stats();
+}
+
+REGISTER_TEST_COMMAND("small-object-allocator-benchmark", &benchmark);
+
+} // namespace TestSmallObjectAllocator
+
+#endif // TEST_SMALL_OBJECT_ALLOCATOR_H
@@ -36,6 +36,7 @@
 #include <wchar.h>
 
 #include "core/io/ip_address.h"
+#include "core/math/random_pcg.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
 #include "core/string/ustring.h"
@@ -1343,6 +1344,284 @@ TEST_CASE("[String] validate_node_name") {
 	String name_with_invalid_chars = "Name with invalid characters :.@removed!";
 	CHECK(name_with_invalid_chars.validate_node_name() == "Name with invalid characters removed!");
 }
+
+// Plain scalar versions of the String kernels, which the vectorized ones are
+// checked against on random input.
+namespace Reference {
+
+static int find(const String &p_str, const String &p_what, int p_from) {
+	if (p_from < 0 || p_what.is_empty()) {
+		return -1;
+	}
+	for (int i = p_from; i <= p_str.length() - p_what.length(); i++) {
+		int j = 0;
+		while (j < p_what.length() && p_str[i + j] == p_what[j]) {
+			j++;
+		}
+		if (j == p_what.length()) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static String replace(const String &p_str, const String &p_key, const String &p_with) {
+	String ret;
+	int from = 0;
+	int found = 0;
+	while ((found = find(p_str, p_key, from)) >= 0) {
+		ret += p_str.substr(from, found - from) + p_with;
+		from = found + p_key.length();
+	}
+	return ret + p_str.substr(from, p_str.length() - from);
+}
+
+static String map_case(const String &p_str, bool p_upper) {
+	String ret;
+	for (int i = 0; i < p_str.length(); i++) {
+		ret += p_upper ? String::char_uppercase(p_str[i]) : String::char_lowercase(p_str[i]);
+	}
+	return ret;
+}
+
+static uint32_t hash(const String &p_str) {
+	uint32_t hashv = 5381;
+	for (int i = 0; i < p_str.length() && p_str[i]; i++) {
+		hashv = ((hashv << 5) + hashv) + p_str[i];
+	}
+	return hashv;
+}
+
+static bool equal(const String &p_a, const String &p_b) {
+	if (p_a.length() != p_b.length()) {
+		return false;
+	}
+	for (int i = 0; i < p_a.length(); i++) {
+		if (p_a[i] != p_b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static Vector<uint8_t> utf8(const String &p_str) {
+	Vector<uint8_t> ret;
+	for (int i = 0; i < p_str.length(); i++) {
+		const uint32_t c = p_str[i];
+		if (c <= 0x7f) {
+			ret.push_back(c);
+		} else if (c <= 0x7ff) {
+			ret.push_back(0xc0 | (c >> 6));
+			ret.push_back(0x80 | (c & 0x3f));
+		} else if (c <= 0xffff) {
+			ret.push_back(0xe0 | (c >> 12));
+			ret.push_back(0x80 | ((c >> 6) & 0x3f));
+			ret.push_back(0x80 | (c & 0x3f));
+		} else {
+			ret.push_back(0xf0 | (c >> 18));
+			ret.push_back(0x80 | ((c >> 12) & 0x3f));
+			ret.push_back(0x80 | ((c >> 6) & 0x3f));
+			ret.push_back(0x80 | (c & 0x3f));
+		}
+	}
+	return ret;
+}
+
+// The byte by byte decoder String::parse_utf8() used before, with the same
+// quirks. Returns true on error, in which case r_str is left undefined.
+static bool parse_utf8(String &r_str, const char *p_utf8, int p_len) {
+	if (p_len < 0 || p_len >= 3) {
+		if (uint8_t(p_utf8[0]) == 0xef && uint8_t(p_utf8[1]) == 0xbb && uint8_t(p_utf8[2]) == 0xbf) {
+			if (p_len >= 0) {
+				p_len -= 3;
+			}
+			p_utf8 += 3;
+		}
+	}
+
+	int cstr_size = 0;
+	int str_size = 0;
+	int skip = 0;
+	for (const char *ptr = p_utf8; ptr != &p_utf8[p_len] && *ptr; ptr++, cstr_size++) {
+		if (skip) {
+			skip--;
+			continue;
+		}
+		const uint8_t c = *ptr;
+		if ((c & 0x80) == 0) {
+			skip = 0;
+		} else if ((c & 0xe0) == 0xc0) {
+			skip = 1;
+		} else if ((c & 0xf0) == 0xe0) {
+			skip = 2;
+		} else if ((c & 0xf8) == 0xf0) {
+			skip = 3;
+		} else {
+			return true;
+		}
+		if (skip == 1 && (c & 0x1e) == 0) {
+			return true;
+		}
+		str_size++;
+	}
+	if (skip) {
+		return true;
+	}
+
+	r_str = String();
+	while (cstr_size) {
+		int len = 0;
+		if ((*p_utf8 & 0x80) == 0) {
+			len = 1;
+		} else if ((*p_utf8 & 0xe0) == 0xc0) {
+			len = 2;
+		} else if ((*p_utf8 & 0xf0) == 0xe0) {
+			len = 3;
+		} else if ((*p_utf8 & 0xf8) == 0xf0) {
+			len = 4;
+		} else {
+			return true;
+		}
+		if (len > cstr_size || (len == 2 && (*p_utf8 & 0x1e) == 0)) {
+			return true;
+		}
+
+		uint32_t unichar = 0;
+		if (len == 1) {
+			unichar = *p_utf8;
+		} else {
+			unichar = (0xff >> (len + 1)) & *p_utf8;
+			for (int i = 1; i < len; i++) {
+				if ((p_utf8[i] & 0xc0) != 0x80) {
+					return true;
+				}
+				if (unichar == 0 && i == 2 && ((p_utf8[i] & 0x7f) >> (7 - len)) == 0) {
+					return true;
+				}
+				unichar = (unichar << 6) | (p_utf8[i] & 0x3f);
+			}
+		}
+		if (unichar >= 0xd800 && unichar <= 0xdfff) {
+			return true;
+		}
+		r_str += char32_t(unichar);
+		cstr_size -= len;
+		p_utf8 += len;
+	}
+	return false;
+}
+
+} // namespace Reference
+
+// Mostly ASCII with some accented, Cyrillic, CJK and astral characters, with
+// runs long enough to fill whole blocks. A small alphabet makes searches hit.
+static String random_string(RandomPCG &p_rng, int p_max_length, bool p_small_alphabet = false) {
+	static const char32_t pool[] = { 'a', 'b', 'Z', '0', ' ', '~', 0xe9, 0xc9, 0x416, 0x436, 0x3042, 0x1f600 };
+	const int pool_size = p_small_alphabet ? 4 : sizeof(pool) / sizeof(pool[0]);
+	const bool ascii_only = p_rng.rand() % 3 == 0;
+
+	String ret;
+	const int length = p_rng.rand() % (p_max_length + 1);
+	for (int i = 0; i < length; i++) {
+		char32_t c;
+		if (p_small_alphabet) {
+			c = pool[p_rng.rand() % pool_size + (ascii_only ? 0 : 4 + (p_rng.rand() % 2) * 4)];
+		} else if (ascii_only || p_rng.rand() % 8) {
+			c = 1 + p_rng.rand() % 0x7f;
+		} else {
+			c = pool[p_rng.rand() % pool_size];
+		}
+		ret += c;
+	}
+	return ret;
+}
+
+TEST_CASE("[String] Differential fuzz of search, replace and split") {
+	RandomPCG rng(1);
+	for (int iteration = 0; iteration < 2000; iteration++) {
+		const String str = random_string(rng, 70, true);
+		const String what = (iteration % 2 && str.length()) ? str.substr(rng.rand() % str.length(), 1 + rng.rand() % 4) : random_string(rng, 4, true);
+		const int from = int(rng.rand() % (str.length() + 2)) - 1;
+
+		CHECK(str.find(what, from) == Reference::find(str, what, from));
+		if (what.length()) {
+			CHECK(str.replace(what, "<>") == Reference::replace(str, what, "<>"));
+
+			const Vector<String> parts = str.split(what);
+			CHECK(String("|").join(parts) == Reference::replace(str, what, "|"));
+		}
+
+		bool ascii = what.length() > 0;
+		for (int i = 0; i < what.length(); i++) {
+			ascii = ascii && what[i] < 0x80;
+		}
+		if (ascii) {
+			CHECK(str.find(what.ascii().get_data(), from) == Reference::find(str, what, from));
+		}
+	}
+}
+
+TEST_CASE("[String] Differential fuzz of comparison and hashing") {
+	RandomPCG rng(2);
+	for (int iteration = 0; iteration < 2000; iteration++) {
+		const String a = random_string(rng, 40, true);
+		String b = a;
+		if (rng.rand() % 2) {
+			// Change or append one character, so strings share long prefixes.
+			const int at = rng.rand() % (a.length() + 1);
+			b = a.substr(0, at) + random_string(rng, 3, true) + a.substr(at + 1, a.length());
+		}
+
+		CHECK((a == b) == Reference::equal(a, b));
+		CHECK((a < b) == is_str_less(a.get_data(), b.get_data()));
+		CHECK((b < a) == is_str_less(b.get_data(), a.get_data()));
+		CHECK(a.hash() == Reference::hash(a));
+		CHECK(String::hash(a.get_data(), a.length()) == Reference::hash(a));
+	}
+}
+
+TEST_CASE("[String] Differential fuzz of case conversion") {
+	RandomPCG rng(3);
+	for (int iteration = 0; iteration < 2000; iteration++) {
+		const String str = random_string(rng, 70);
+		CHECK(Reference::equal(str.to_lower(), Reference::map_case(str, false)));
+		CHECK(Reference::equal(str.to_upper(), Reference::map_case(str, true)));
+	}
+}
+
+TEST_CASE("[String] Differential fuzz of UTF-8 transcoding") {
+	RandomPCG rng(4);
+	ERR_PRINT_OFF
+	for (int iteration = 0; iteration < 4000; iteration++) {
+		const String str = random_string(rng, 70);
+		Vector<uint8_t> bytes = Reference::utf8(str);
+
+		const CharString encoded = str.utf8();
+		CHECK(encoded.length() == bytes.size());
+		CHECK(memcmp(encoded.get_data(), bytes.ptr(), bytes.size()) == 0);
+
+		// Corrupt some of the input, with nulls and invalid sequences.
+		if (iteration % 2) {
+			const int changes = 1 + rng.rand() % 3;
+			for (int i = 0; i < changes && bytes.size(); i++) {
+				const uint8_t values[] = { 0, 0x80, 0xc0, 0xc3, 0xe0, 0xed, 0xf0, 0xff, uint8_t(rng.rand()) };
+				bytes.write[rng.rand() % bytes.size()] = values[rng.rand() % 9];
+			}
+		}
+		bytes.push_back(0);
+
+		const char *utf8 = (const char *)bytes.ptr();
+		const int len = (iteration % 3 == 0) ? -1 : bytes.size() - 1;
+		String decoded;
+		String expected;
+		const bool error = decoded.parse_utf8(utf8, len);
+		CHECK(error == Reference::parse_utf8(expected, utf8, len));
+		if (!error) {
+			CHECK(Reference::equal(decoded, expected));
+		}
+	}
+	ERR_PRINT_ON
+}
 } // namespace TestString
 
 #endif // TEST_STRING_H
@@ -0,0 +1,236 @@
+/*************************************************************************/
+/*  test_string_name.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_STRING_NAME_H
+#define TEST_STRING_NAME_H
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string/print_string.h"
+#include "core/string/string_name.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+
+#include "tests/test_macros.h"
+
+namespace TestStringName {
+
+TEST_CASE("[StringName] Interning") {
+	StringName from_cstr("test_string_name_interning");
+	StringName from_string(String("test_string_name_interning"));
+	StringName from_static = _scs_create("test_string_name_interning");
+
+	CHECK(from_cstr == from_string);
+	CHECK(from_cstr == from_static);
+	CHECK(from_cstr.data_unique_pointer() == from_static.data_unique_pointer());
+	CHECK(from_cstr == "test_string_name_interning");
+	CHECK(from_cstr == String("test_string_name_interning"));
+	CHECK(from_cstr != String("test_string_name_interning_"));
+	CHECK(String(from_static) == "test_string_name_interning");
+}
+
+TEST_CASE("[StringName] Search does not insert") {
+	CHECK(StringName::search("test_string_name_never_interned") == StringName());
+	CHECK(StringName::search(String("test_string_name_never_interned")) == StringName());
+	CHECK(StringName::search(U"test_string_name_never_interned") == StringName());
+
+	StringName name = _scs_create("test_string_name_searched");
+	CHECK(StringName::search("test_string_name_searched") == name);
+	CHECK(StringName::search(String("test_string_name_searched")) == name);
+	CHECK(StringName::search(U"test_string_name_searched") == name);
+}
+
+TEST_CASE("[StringName] Table grows and shrinks") {
+	const int count = 20000;
+	StringName::TableStats before = StringName::get_table_stats();
+
+	LocalVector<StringName> names;
+	for (int i = 0; i < count; i++) {
+		names.push_back(StringName("test_string_name_grow_" + itos(i)));
+	}
+
+	StringName::TableStats grown = StringName::get_table_stats();
+	CHECK(grown.names == before.names + count);
+	CHECK(grown.buckets > before.buckets);
+	CHECK(grown.load_factor <= 1.1);
+
+	for (int i = 0; i < count; i++) {
+		CHECK(StringName::search("test_string_name_grow_" + itos(i)) == names[i]);
+	}
+
+	names.clear();
+	CHECK(StringName::get_table_stats().names == before.names);
+	CHECK(StringName::search("test_string_name_grow_0") == StringName());
+}
+
+class InternJob {
+public:
+	static const int NAME_COUNT = 2000;
+	static const int ROUNDS = 20;
+
+	LocalVector<String> strings;
+	LocalVector<const void *> pointers[8];
+	SafeNumeric<uint32_t> mismatches;
+
+	struct ThreadData {
+		InternJob *job = nullptr;
+		int index = 0;
+	};
+
+	static void thread_func(void *p_userdata) {
+		ThreadData *td = (ThreadData *)p_userdata;
+		InternJob *job = td->job;
+		LocalVector<const void *> &pointers = job->pointers[td->index];
+		pointers.resize(NAME_COUNT);
+
+		for (int r = 0; r < ROUNDS; r++) {
+			// Keep half of the names alive, so the others are created and freed concurrently.
+			LocalVector<StringName> kept;
+			for (int i = 0; i < NAME_COUNT; i++) {
+				int n = (i + td->index * 97) % NAME_COUNT;
+				StringName name(job->strings[n]);
+				if ((n & 1) == 0) {
+					kept.push_back(name);
+					pointers[n] = name.data_unique_pointer();
+				} else if (StringName::search(job->strings[n]) != name) {
+					job->mismatches.increment();
+				}
+			}
+		}
+	}
+
+	InternJob() {
+		for (int i = 0; i < NAME_COUNT; i++) {
+			strings.push_back("test_string_name_thread_" + itos(i));
+		}
+	}
+};
+
+TEST_CASE("[StringName] Concurrent interning") {
+	InternJob job;
+	StringName::TableStats before = StringName::get_table_stats();
+
+	// Names with even indices stay interned for the whole test, to compare across threads.
+	LocalVector<StringName> anchors;
+	for (int i = 0; i < InternJob::NAME_COUNT; i += 2) {
+		anchors.push_back(StringName(job.strings[i]));
+	}
+
+	Thread threads[8];
+	InternJob::ThreadData data[8];
+	for (int i = 0; i < 8; i++) {
+		data[i].job = &job;
+		data[i].index = i;
+		threads[i].start(&InternJob::thread_func, &data[i]);
+	}
+	for (int i = 0; i < 8; i++) {
+		threads[i].wait_to_finish();
+	}
+
+	CHECK_MESSAGE(job.mismatches.get() == 0, "Searching a live name should find it.");
+	for (int i = 0; i < 8; i++) {
+		for (int n = 0; n < InternJob::NAME_COUNT; n += 2) {
+			CHECK_MESSAGE(job.pointers[i][n] == anchors[n / 2].data_unique_pointer(), "Every thread should get the same interned name.");
+		}
+	}
+
+	anchors.clear();
+	CHECK(StringName::get_table_stats().names == before.names);
+}
+
+struct BenchmarkData {
+	const LocalVector<String> *strings = nullptr;
+	uint32_t offset = 0;
+	uint32_t iterations = 0;
+};
+
+static void benchmark_thread(void *p_userdata) {
+	BenchmarkData *bd = (BenchmarkData *)p_userdata;
+	const LocalVector<String> &strings = *bd->strings;
+	for (uint32_t i = 0; i < bd->iterations; i++) {
+		const String &s = strings[(bd->offset + i) % strings.size()];
+		if (i & 1) {
+			StringName::search(s);
+		} else {
+			StringName name(s);
+		}
+	}
+}
+
+// Microbenchmark, run with `godot --test string-name-benchmark`.
+// Prints the time to intern and look up names from 1 thread up to the processor count.
+static void benchmark() {
+	const uint32_t iterations = 1 << 20;
+	const uint32_t name_count = 50000;
+	int max_threads = OS::get_singleton()->get_processor_count();
+
+	LocalVector<String> strings;
+	LocalVector<StringName> kept;
+	for (uint32_t i = 0; i < name_count; i++) {
+		strings.push_back("benchmark_name_" + itos(i));
+		if (i & 1) {
+			kept.push_back(StringName(strings[i]));
+		}
+	}
+
+	StringName::TableStats stats = StringName::get_table_stats();
+	print_line(vformat("StringName table: %d names in %d buckets, %d used, load factor %.2f, longest chain %d.", stats.names, stats.buckets, stats.used_buckets, stats.load_factor, stats.longest_chain));
+
+	for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+		Thread *threads = memnew_arr(Thread, thread_count);
+		LocalVector<BenchmarkData> data;
+		data.resize(thread_count);
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < thread_count; i++) {
+			data[i].strings = &strings;
+			data[i].offset = i * (name_count / thread_count);
+			data[i].iterations = iterations;
+			threads[i].start(&benchmark_thread, &data[i]);
+		}
+		for (int i = 0; i < thread_count; i++) {
+			threads[i].wait_to_finish();
+		}
+		uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+		memdelete_arr(threads);
+
+		print_line(vformat("  %d threads: %.1f ns per operation, %.2f M operations per second.", thread_count, usec * 1000.0 / iterations, double(iterations) * thread_count / usec));
+
+		if (thread_count < max_threads && thread_count * 2 > max_threads) {
+			thread_count = max_threads / 2; // Make sure the processor count itself is measured.
+		}
+	}
+}
+
+REGISTER_TEST_COMMAND("string-name-benchmark", &benchmark);
+
+} // namespace TestStringName
+
+#endif // TEST_STRING_NAME_H
@@ -0,0 +1,109 @@
+/*************************************************************************/
+/*  test_string_stream.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_STRING_STREAM_H
+#define TEST_STRING_STREAM_H
+
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/string/string_stream.h"
+#include "core/variant/variant_parser.h"
+
+#include "tests/test_macros.h"
+
+namespace TestStringStream {
+
+TEST_CASE("[StringStream] Appending") {
+	StringStream stream;
+	CHECK(stream.get_length() == 0);
+	CHECK(stream.as_string().is_empty());
+
+	stream += "Latin-1 ";
+	stream += String::utf8("ünïcödé ");
+	stream += char32_t(0x1f600);
+	stream.append(U"chars", 3);
+	CHECK(stream.as_string() == String::utf8("Latin-1 ünïcödé 😀cha"));
+	CHECK(stream.get_length() == 20);
+
+	stream.clear();
+	CHECK(stream.get_length() == 0);
+	CHECK(stream.as_string().is_empty());
+}
+
+TEST_CASE("[StringStream] Appending across chunks") {
+	// Mix small and large pieces, so they start and end at every offset in a chunk.
+	StringStream stream;
+	String expected;
+	for (int i = 0; i < 3000; i++) {
+		const String piece = String::num_int64(i) + String("-").repeat(i % 7 ? 1 : i * 3);
+		stream += piece;
+		expected += piece;
+	}
+
+	CHECK(stream.get_length() == (uint64_t)expected.length());
+	CHECK(stream.as_string() == expected);
+}
+
+TEST_CASE("[StringStream] Writing to a file") {
+#ifdef WINDOWS_ENABLED
+	const String path = OS::get_singleton()->get_environment("TEMP").plus_file("string_stream.txt");
+#else
+	const String path = "/tmp/string_stream.txt";
+#endif
+
+	PackedInt32Array array;
+	for (int i = 0; i < 10000; i++) {
+		array.push_back(i * 7);
+	}
+	String expected;
+	VariantWriter::write_to_string(array, expected);
+	expected = String::utf8("ëxpected: ") + expected + String("!").repeat(5000);
+
+	FileAccessRef file = FileAccess::open(path, FileAccess::WRITE);
+	{
+		StringStream stream(file.f);
+		stream += String::utf8("ëxpected: ");
+		VariantWriter::write_to_stream(array, stream);
+		CHECK_MESSAGE(
+				stream.as_string().length() < expected.length(),
+				"Full chunks should have been written to the file already.");
+		stream += String("!").repeat(5000);
+		CHECK(stream.get_length() == (uint64_t)expected.length());
+	}
+	file->close();
+
+	FileAccessRef read = FileAccess::open(path, FileAccess::READ);
+	CHECK_MESSAGE(
+			read->get_as_utf8_string() == expected,
+			"The file should contain everything appended, encoded as UTF-8.");
+}
+
+} // namespace TestStringStream
+
+#endif // TEST_STRING_STREAM_H
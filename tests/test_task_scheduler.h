@@ -0,0 +1,197 @@
+/*************************************************************************/
+/*  test_task_scheduler.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_TASK_SCHEDULER_H
+#define TEST_TASK_SCHEDULER_H
+
+#include "core/os/os.h"
+#include "core/os/task_scheduler.h"
+#include "core/os/thread.h"
+#include "core/templates/thread_work_pool.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestTaskScheduler {
+
+class Counter {
+public:
+	std::atomic<uint32_t> calls;
+	LocalVector<uint32_t> hits;
+
+	void count(uint32_t p_index, void *p_userdata) {
+		calls.fetch_add(1);
+		hits[p_index]++;
+	}
+
+	void nested(uint32_t p_index, Counter *p_inner) {
+		TaskScheduler::get_singleton()->parallel_for(16, p_inner, &Counter::count_offset, p_index * 16);
+	}
+
+	void count_offset(uint32_t p_index, uint32_t p_offset) {
+		count(p_offset + p_index, nullptr);
+	}
+
+	Counter(uint32_t p_size) {
+		calls.store(0);
+		hits.resize(p_size);
+		for (uint32_t i = 0; i < p_size; i++) {
+			hits[i] = 0;
+		}
+	}
+};
+
+static bool all_hit_once(const Counter &p_counter) {
+	for (uint32_t i = 0; i < p_counter.hits.size(); i++) {
+		if (p_counter.hits[i] != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[TaskScheduler] parallel_for visits every element once") {
+	Counter counter(10000);
+	TaskScheduler::get_singleton()->parallel_for(10000, &counter, &Counter::count, (void *)nullptr);
+
+	CHECK(counter.calls.load() == 10000);
+	CHECK_MESSAGE(all_hit_once(counter), "Every element should be processed exactly once.");
+}
+
+TEST_CASE("[TaskScheduler] Nested parallel_for") {
+	Counter outer(64);
+	Counter inner(64 * 16);
+	TaskScheduler::get_singleton()->parallel_for(64, &outer, &Counter::nested, &inner);
+
+	CHECK(inner.calls.load() == 64 * 16);
+	CHECK_MESSAGE(all_hit_once(inner), "Every element of the nested loops should be processed exactly once.");
+}
+
+struct ChainData {
+	std::atomic<uint32_t> step;
+	uint32_t order[3] = {};
+};
+
+static void chain_first(void *p_data) {
+	ChainData *data = static_cast<ChainData *>(p_data);
+	data->order[0] = data->step.fetch_add(1);
+}
+
+static void chain_second(void *p_data) {
+	ChainData *data = static_cast<ChainData *>(p_data);
+	data->order[1] = data->step.fetch_add(1);
+}
+
+static void chain_third(void *p_data) {
+	ChainData *data = static_cast<ChainData *>(p_data);
+	data->order[2] = data->step.fetch_add(1);
+}
+
+TEST_CASE("[TaskScheduler] Tasks run after their dependencies") {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	ChainData data;
+	data.step.store(0);
+
+	TaskScheduler::TaskID first = scheduler->add_task(chain_first, &data);
+	TaskScheduler::TaskID second = scheduler->add_task(chain_second, &data, &first, 1);
+	TaskScheduler::TaskID deps[2] = { first, second };
+	TaskScheduler::TaskID third = scheduler->add_task(chain_third, &data, deps, 2);
+
+	scheduler->wait_for_task(third);
+	CHECK(data.step.load() == 3);
+	CHECK(data.order[0] == 0);
+	CHECK(data.order[1] == 1);
+	CHECK(data.order[2] == 2);
+
+	scheduler->wait_for_task(second);
+	scheduler->wait_for_task(first);
+}
+
+static void record_thread(void *p_thread) {
+	*static_cast<Thread::ID *>(p_thread) = Thread::get_caller_id();
+}
+
+TEST_CASE("[TaskScheduler] Low priority tasks only run on workers") {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	if (scheduler->get_worker_count() == 0) {
+		return; // Waiters run everything then.
+	}
+
+	Thread::ID ran_on = 0;
+	TaskScheduler::TaskID background = scheduler->add_task(record_thread, &ran_on, nullptr, 0, TaskScheduler::PRIORITY_LOW);
+
+	// Waiting on high priority work must not pick up the background task.
+	for (int i = 0; i < 16; i++) {
+		Counter counter(256);
+		scheduler->parallel_for(256, &counter, &Counter::count, (void *)nullptr);
+	}
+
+	while (!scheduler->is_task_completed(background)) {
+		OS::get_singleton()->delay_usec(1000);
+	}
+	CHECK(ran_on != 0);
+	CHECK(ran_on != Thread::get_caller_id());
+	scheduler->release_task(background);
+}
+
+TEST_CASE("[TaskScheduler] Promoted low priority tasks still run after their dependencies") {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	ChainData data;
+	data.step.store(0);
+
+	TaskScheduler::TaskID first = scheduler->add_task(chain_first, &data, nullptr, 0, TaskScheduler::PRIORITY_LOW);
+	TaskScheduler::TaskID second = scheduler->add_task(chain_second, &data, &first, 1, TaskScheduler::PRIORITY_LOW);
+	scheduler->promote_task(second);
+	scheduler->promote_task(first);
+
+	// Waiting on a low priority task runs low priority tasks too, so this can't hang without workers.
+	scheduler->wait_for_task(second);
+	CHECK(data.step.load() == 2);
+	CHECK(data.order[0] == 0);
+	CHECK(data.order[1] == 1);
+
+	scheduler->wait_for_task(first);
+}
+
+TEST_CASE("[TaskScheduler] ThreadWorkPool runs on the scheduler") {
+	ThreadWorkPool pool;
+	pool.init(4);
+
+	Counter counter(4096);
+	pool.do_work(4096, &counter, &Counter::count, (void *)nullptr);
+	CHECK(counter.calls.load() == 4096);
+	CHECK_MESSAGE(all_hit_once(counter), "Every element should be processed exactly once.");
+	CHECK(!pool.is_working());
+
+	pool.finish();
+}
+
+} // namespace TestTaskScheduler
+
+#endif // TEST_TASK_SCHEDULER_H
@@ -0,0 +1,178 @@
+/*************************************************************************/
+/*  test_thread_work_pool.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_THREAD_WORK_POOL_H
+#define TEST_THREAD_WORK_POOL_H
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+#include "core/templates/thread_work_pool.h"
+
+#include "tests/test_macros.h"
+
+namespace TestThreadWorkPool {
+
+class Job {
+public:
+	LocalVector<float> values;
+	LocalVector<uint32_t> hits;
+
+	void process(uint32_t p_index, uint32_t p_iterations) {
+		float v = p_index;
+		for (uint32_t i = 0; i < p_iterations; i++) {
+			v = Math::sqrt(v + 1.0f);
+		}
+		values[p_index] = v;
+		hits[p_index]++;
+	}
+
+	Job(uint32_t p_size) {
+		values.resize(p_size);
+		hits.resize(p_size);
+		for (uint32_t i = 0; i < p_size; i++) {
+			hits[i] = 0;
+		}
+	}
+};
+
+TEST_CASE("[ThreadWorkPool] Batched dispatch processes every element once") {
+	ThreadWorkPool pool;
+	pool.init(4);
+
+	// Run the same job a few times, so the batch size adapts to the timings of earlier runs.
+	for (uint32_t run = 0; run < 5; run++) {
+		uint32_t elements = 1000 + run * 12345;
+		Job job(elements);
+		pool.do_work(elements, &job, &Job::process, (uint32_t)8);
+
+		bool all_once = true;
+		for (uint32_t i = 0; i < elements; i++) {
+			if (job.hits[i] != 1) {
+				all_once = false;
+				break;
+			}
+		}
+		CHECK_MESSAGE(all_once, "Every element should be processed exactly once.");
+	}
+
+	pool.finish();
+}
+
+TEST_CASE("[ThreadWorkPool] Fewer elements than threads") {
+	ThreadWorkPool pool;
+	pool.init(8);
+
+	Job job(3);
+	pool.do_work(3, &job, &Job::process, (uint32_t)1);
+	CHECK(job.hits[0] == 1);
+	CHECK(job.hits[1] == 1);
+	CHECK(job.hits[2] == 1);
+
+	pool.finish();
+}
+
+TEST_CASE("[ThreadWorkPool] Several asynchronous jobs in flight") {
+	ThreadWorkPool pool;
+	pool.init(4);
+
+	Job job_a(20000);
+	Job job_b(30000);
+	ThreadWorkPool::WorkID work_a = pool.add_work(20000, &job_a, &Job::process, (uint32_t)4);
+	ThreadWorkPool::WorkID work_b = pool.add_work(30000, &job_b, &Job::process, (uint32_t)4);
+
+	// The calling thread is free to do other work until it waits.
+	Job job_c(100);
+	for (uint32_t i = 0; i < 100; i++) {
+		job_c.process(i, 4);
+	}
+
+	pool.wait_for_work(work_b);
+	pool.wait_for_work(work_a);
+
+	bool all_once = true;
+	for (uint32_t i = 0; i < 20000; i++) {
+		all_once = all_once && job_a.hits[i] == 1;
+	}
+	for (uint32_t i = 0; i < 30000; i++) {
+		all_once = all_once && job_b.hits[i] == 1;
+	}
+	CHECK_MESSAGE(all_once, "Every element of both jobs should be processed exactly once.");
+
+	pool.finish();
+}
+
+// Microbenchmark, run with `godot --test thread-work-pool-benchmark`.
+// Prints the throughput of cheap and expensive jobs from 1 thread up to the processor count.
+// The thread that waits on a job takes part in it, so a pool with N tasks runs on N + 1 threads.
+static void benchmark() {
+	const uint32_t elements = 1 << 20;
+	const uint32_t runs = 10;
+	int max_threads = OS::get_singleton()->get_processor_count();
+
+	for (uint32_t iterations = 1; iterations <= 64; iterations *= 64) {
+		print_line(vformat("ThreadWorkPool: %d elements, %d iterations per element.", elements, iterations));
+
+		// Single threaded baseline, without the pool.
+		Job single_job(elements);
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (uint32_t i = 0; i < runs; i++) {
+			for (uint32_t j = 0; j < elements; j++) {
+				single_job.process(j, iterations);
+			}
+		}
+		uint64_t single_thread_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+		print_line(vformat("  1 thread: %.2f ms per job, 1.00x.", single_thread_usec / 1000.0 / runs));
+
+		for (int threads = 2; threads <= max_threads;) {
+			ThreadWorkPool pool;
+			pool.init(threads - 1); // Plus the calling thread.
+			Job job(elements);
+
+			pool.do_work(elements, &job, &Job::process, iterations); // Warm up, and let the batch size adapt.
+			begin = OS::get_singleton()->get_ticks_usec();
+			for (uint32_t i = 0; i < runs; i++) {
+				pool.do_work(elements, &job, &Job::process, iterations);
+			}
+			uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+			print_line(vformat("  %d threads: %.2f ms per job, %.2fx.", threads, usec / 1000.0 / runs, double(single_thread_usec) / usec));
+
+			pool.finish();
+			// Make sure the processor count itself is measured.
+			threads = (threads < max_threads && threads * 2 > max_threads) ? max_threads : threads * 2;
+		}
+	}
+}
+
+REGISTER_TEST_COMMAND("thread-work-pool-benchmark", &benchmark);
+
+} // namespace TestThreadWorkPool
+
+#endif // TEST_THREAD_WORK_POOL_H
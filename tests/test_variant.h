@@ -699,6 +699,41 @@ TEST_CASE("[Variant] Assignment To Color from Bool,Int,Float,String,Vec2,Vec2i,V
 	vec3i_v = col_v;
 	CHECK(vec3i_v.get_type() == Variant::COLOR);
 }
+
+TEST_CASE("[Variant] Move semantics") {
+	PackedVector3Array points;
+	points.push_back(Vector3(1, 2, 3));
+	const Vector3 *data = points.ptr();
+
+	Variant v = std::move(points);
+	CHECK(v.get_type() == Variant::PACKED_VECTOR3_ARRAY);
+	CHECK(points.is_empty());
+	CHECK_MESSAGE(PackedVector3Array(v).ptr() == data, "Moving into a Variant should take over the buffer.");
+
+	Variant moved = std::move(v);
+	CHECK(v.get_type() == Variant::NIL);
+	CHECK(moved.get_type() == Variant::PACKED_VECTOR3_ARRAY);
+
+	Variant assigned = "Hello";
+	assigned = std::move(moved);
+	CHECK(moved.get_type() == Variant::NIL);
+	CHECK(PackedVector3Array(assigned)[0] == Vector3(1, 2, 3));
+
+	// Moving from a Variant that only lives inside the target.
+	Variant holder;
+	{
+		Array arr;
+		arr.push_back(String("World"));
+		holder = arr;
+	}
+	Variant *element;
+	{
+		Array arr = holder;
+		element = &arr[0];
+	}
+	holder = std::move(*element);
+	CHECK(holder == Variant("World"));
+}
 } // namespace TestVariant
 
 #endif // TEST_VARIANT_H
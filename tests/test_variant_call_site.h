@@ -0,0 +1,193 @@
+/*************************************************************************/
+/*  test_variant_call_site.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_VARIANT_CALL_SITE_H
+#define TEST_VARIANT_CALL_SITE_H
+
+#include "core/os/os.h"
+#include "core/variant/variant_call_site.h"
+#include "scene/main/node.h"
+
+#include "tests/test_macros.h"
+
+namespace TestVariantCallSite {
+
+TEST_CASE("[VariantCallSite] Builtin calls match Variant::call") {
+	VariantCallSite site("dot");
+	CHECK(site.get_method() == "dot");
+
+	Variant base = Vector3(1, 2, 3);
+	Variant arg = Vector3(4, 5, 6);
+	const Variant *args[1] = { &arg };
+	Variant ret;
+	Callable::CallError ce;
+
+	site.call(base, args, 1, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_OK);
+	CHECK(ret == Variant(32.0));
+	CHECK(site.get_cached_count() == 1);
+
+	// Converted arguments take the regular path.
+	Variant int_arg = 2;
+	VariantCallSite rotated("rotated");
+	Variant vec2 = Vector2(1, 0);
+	const Variant *int_args[1] = { &int_arg };
+	Variant expected;
+	vec2.call("rotated", int_args, 1, expected, ce);
+	rotated.call(vec2, int_args, 1, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_OK);
+	CHECK(ret == expected);
+
+	// Wrong argument counts and types report the same errors.
+	site.call(base, args, 0, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS);
+	Variant string_arg = "text";
+	const Variant *bad_args[1] = { &string_arg };
+	site.call(base, bad_args, 1, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_ERROR_INVALID_ARGUMENT);
+
+	VariantCallSite missing("_no_such_method");
+	missing.call(base, args, 1, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_ERROR_INVALID_METHOD);
+}
+
+TEST_CASE("[VariantCallSite] Return value aliasing the base") {
+	VariantCallSite site("normalized");
+	Variant v = Vector3(0, 3, 0);
+	Callable::CallError ce;
+	site.call(v, nullptr, 0, v, ce);
+	CHECK(ce.error == Callable::CallError::CALL_OK);
+	CHECK(v == Variant(Vector3(0, 1, 0)));
+}
+
+TEST_CASE("[VariantCallSite] Polymorphic and megamorphic sites") {
+	VariantCallSite site("size");
+	Variant bases[] = { Array(), Dictionary(), PackedByteArray(), PackedInt32Array(), PackedStringArray(), PackedVector3Array() };
+	bases[0].operator Array().push_back(1);
+	Callable::CallError ce;
+
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < 6; i++) {
+			Variant ret;
+			site.call(bases[i], nullptr, 0, ret, ce);
+			CHECK(ce.error == Callable::CallError::CALL_OK);
+			CHECK(int(ret) == (i == 0 ? 1 : 0));
+		}
+	}
+	CHECK(site.get_cached_count() == VariantCallSite::MAX_ENTRIES);
+	CHECK(site.is_megamorphic());
+
+	site.set_method("is_empty");
+	CHECK(site.get_cached_count() == 0);
+	CHECK_FALSE(site.is_megamorphic());
+	Variant ret;
+	site.call(bases[1], nullptr, 0, ret, ce);
+	CHECK(bool(ret));
+}
+
+TEST_CASE("[VariantCallSite] Object calls") {
+	VariantCallSite site("get_class");
+	Object *object = memnew(Object);
+	Node *node = memnew(Node);
+	Variant object_var = object;
+	Variant node_var = node;
+	Variant ret;
+	Callable::CallError ce;
+
+	site.call(object_var, nullptr, 0, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_OK);
+	CHECK(ret == Variant("Object"));
+	site.call(node_var, nullptr, 0, ret, ce);
+	CHECK(ret == Variant("Node"));
+	CHECK(site.call_object(node, nullptr, 0, ce) == Variant("Node"));
+	CHECK(site.get_cached_count() == 2);
+
+	VariantCallSite missing("_no_such_method");
+	missing.call(node_var, nullptr, 0, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_ERROR_INVALID_METHOD);
+
+	Variant null_object = (Object *)nullptr;
+	site.call(null_object, nullptr, 0, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_ERROR_INSTANCE_IS_NULL);
+
+	memdelete(node);
+	memdelete(object);
+}
+
+// Microbenchmark, run with `godot --test variant-call-benchmark`.
+static void variant_call_benchmark() {
+	const int calls = 1000000;
+
+	Node *node = memnew(Node);
+	Array array;
+	array.push_back(1);
+	array.push_back(2);
+
+	struct Case {
+		const char *name;
+		Variant base;
+		StringName method;
+		Variant arg;
+		int argcount;
+	} cases[] = {
+		{ "Vector3.dot", Vector3(1, 2, 3), "dot", Vector3(4, 5, 6), 1 },
+		{ "Array.find", array, "find", 2, 1 },
+		{ "Node.get_child_count", node, "get_child_count", Variant(), 0 },
+	};
+
+	for (Case &c : cases) {
+		const Variant *args[1] = { &c.arg };
+		Variant ret;
+		Callable::CallError ce;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < calls; i++) {
+			c.base.call(c.method, args, c.argcount, ret, ce);
+		}
+		uint64_t plain_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+
+		VariantCallSite site(c.method);
+		begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < calls; i++) {
+			site.call(c.base, args, c.argcount, ret, ce);
+		}
+		uint64_t site_usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+
+		print_line(vformat("%s: Variant::call %.1f ns, VariantCallSite %.1f ns per call.", c.name, plain_usec * 1000.0 / calls, site_usec * 1000.0 / calls));
+	}
+
+	memdelete(node);
+}
+
+REGISTER_TEST_COMMAND("variant-call-benchmark", &variant_call_benchmark);
+
+} // namespace TestVariantCallSite
+
+#endif // TEST_VARIANT_CALL_SITE_H
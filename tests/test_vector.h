@@ -491,6 +491,47 @@ TEST_CASE("[Vector] Operators") {
 	CHECK(vector != vector_other);
 }
 
+TEST_CASE("[Vector] Move semantics") {
+	Vector<int> vector;
+	vector.push_back(1);
+	vector.push_back(2);
+	const int *data = vector.ptr();
+
+	Vector<int> moved = std::move(vector);
+	CHECK_MESSAGE(moved.ptr() == data, "Moving should take over the buffer.");
+	CHECK(moved.size() == 2);
+	CHECK(vector.is_empty());
+
+	Vector<int> assigned;
+	assigned.push_back(3);
+	assigned = std::move(moved);
+	CHECK(assigned.ptr() == data);
+	CHECK(assigned[1] == 2);
+	CHECK(moved.is_empty());
+
+	// A buffer that was moved rather than shared is written to in place.
+	assigned.write[0] = 10;
+	CHECK(assigned.ptr() == data);
+	CHECK(assigned[0] == 10);
+}
+
+#ifdef DEBUG_ENABLED
+TEST_CASE("[Vector] Copy on write statistics") {
+	Vector<uint8_t> vector;
+	vector.resize(1000);
+
+	CowDataStats::end_frame();
+	Vector<uint8_t> shared = vector;
+	CHECK(shared.ptr() == vector.ptr());
+	shared.write[0] = 1;
+	CHECK(shared.ptr() != vector.ptr());
+	vector.write[0] = 2;
+
+	CowDataStats::end_frame();
+	CHECK_MESSAGE(CowDataStats::get_last_frame_copied_bytes() == 1000, "Only the write to the shared buffer should have copied it.");
+}
+#endif
+
 } // namespace TestVector
 
 #endif // TEST_VECTOR_H